@@ -111,6 +111,7 @@ MLN_GENERATED_OPENGL_SHADER_HEADERS = [
 
 MLN_CORE_SOURCE = [
     "src/mbgl/actor/mailbox.cpp",
+    "src/mbgl/actor/message.cpp",
     "src/mbgl/actor/scheduler.cpp",
     "src/mbgl/algorithm/update_renderables.hpp",
     "src/mbgl/algorithm/update_tile_masks.hpp",
@@ -478,6 +479,8 @@ MLN_CORE_SOURCE = [
     "src/mbgl/text/quads.hpp",
     "src/mbgl/text/shaping.cpp",
     "src/mbgl/text/shaping.hpp",
+    "src/mbgl/text/shaping_cache.cpp",
+    "src/mbgl/text/shaping_cache.hpp",
     "src/mbgl/text/tagged_string.cpp",
     "src/mbgl/text/tagged_string.hpp",
     "src/mbgl/text/harfbuzz.cpp",
@@ -567,6 +570,8 @@ MLN_CORE_SOURCE = [
     "src/mbgl/util/mat4.hpp",
     "src/mbgl/util/math.hpp",
     "src/mbgl/util/padding.cpp",
+    "src/mbgl/util/parallel_jobs.cpp",
+    "src/mbgl/util/parallel_jobs.hpp",
     "src/mbgl/util/premultiply.cpp",
     "src/mbgl/util/quaternion.cpp",
     "src/mbgl/util/quaternion.hpp",
@@ -679,6 +684,7 @@ MLN_CORE_HEADERS = [
     "include/mbgl/renderer/renderer_frontend.hpp",
     "include/mbgl/renderer/renderer_observer.hpp",
     "include/mbgl/renderer/renderer_state.hpp",
+    "include/mbgl/renderer/tile_cache_stats.hpp",
     "include/mbgl/shaders/program_parameters.hpp",
     "include/mbgl/storage/database_file_source.hpp",
     "include/mbgl/storage/file_source.hpp",
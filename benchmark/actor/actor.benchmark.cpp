@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/actor/actor.hpp>
+#include <mbgl/actor/scheduler.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr std::size_t kMessageCount = 20000;
+
+struct Receiver {
+    void receive(std::size_t value, std::shared_ptr<const std::string> data) {
+        benchmark::DoNotOptimize(sum += value + data->size());
+    }
+
+    std::size_t finish() { return sum; }
+
+    std::size_t sum = 0;
+};
+
+// Send many small messages to one actor from several threads at once, the way tile
+// workers and file requests all report to the same actor, and wait for it to take them.
+void ActorMessages(benchmark::State& state) {
+    const auto senders = static_cast<std::size_t>(state.range(0));
+    const auto data = std::make_shared<const std::string>("data");
+    Actor<Receiver> receiver(Scheduler::GetBackground());
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < senders; ++i) {
+            threads.emplace_back([&, ref = receiver.self()] {
+                for (std::size_t j = 0; j < kMessageCount / senders; ++j) {
+                    ref.invoke(&Receiver::receive, j, data);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        benchmark::DoNotOptimize(receiver.self().ask(&Receiver::finish).get());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (kMessageCount / senders) * senders));
+}
+
+// Only the sending half of the above: messages pile up in a mailbox that isn't opened yet
+// and are dropped along with it, leaving out the scheduler and the receiving thread.
+void ActorMessagesQueued(benchmark::State& state) {
+    const auto senders = static_cast<std::size_t>(state.range(0));
+    const auto data = std::make_shared<const std::string>("data");
+    Receiver receiver;
+
+    for (auto _ : state) {
+        auto mailbox = std::make_shared<Mailbox>();
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < senders; ++i) {
+            threads.emplace_back([&, ref = ActorRef<Receiver>(receiver, mailbox)] {
+                for (std::size_t j = 0; j < kMessageCount / senders; ++j) {
+                    ref.invoke(&Receiver::receive, j, data);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * (kMessageCount / senders) * senders));
+}
+
+} // namespace
+
+BENCHMARK(ActorMessages)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+BENCHMARK(ActorMessagesQueued)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/annotation/annotation.hpp>
+#include <mbgl/gfx/headless_frontend.hpp>
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/map_observer.hpp>
+#include <mbgl/map/map_options.hpp>
+#include <mbgl/storage/network_status.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/style/image.hpp>
+#include <mbgl/style/style.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr double pixelRatio{1.0};
+constexpr Size size{1000, 1000};
+const LatLng center{40.726989, -73.992857}; // Manhattan
+
+Point<double> randomPosition(std::mt19937& gen) {
+    std::uniform_real_distribution<double> offset(-0.2, 0.2);
+    return {center.longitude() + offset(gen), center.latitude() + offset(gen)};
+}
+
+} // end namespace
+
+// Moves `state.range(1)` of `state.range(0)` markers before each frame, as a
+// fleet tracking view does.
+static void API_annotationPositionUpdates(::benchmark::State& state) {
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    util::RunLoop loop;
+    HeadlessFrontend frontend{size, pixelRatio};
+    Map map{frontend,
+            MapObserver::nullObserver(),
+            MapOptions().withMapMode(MapMode::Static).withSize(size).withPixelRatio(pixelRatio),
+            ResourceOptions().withCachePath("benchmark/fixtures/api/cache.db").withApiKey("foobar")};
+    map.getStyle().loadJSON(R"({"version": 8, "sources": {}, "layers": []})");
+    map.jumpTo(CameraOptions().withCenter(center).withZoom(12.0));
+    map.addAnnotationImage(std::make_unique<style::Image>(
+        "default_marker", decodeImage(util::read_file("benchmark/fixtures/api/default_marker.png")), 1.0f));
+
+    std::mt19937 gen;
+    std::vector<AnnotationID> ids;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        ids.push_back(map.addAnnotation(SymbolAnnotation{randomPosition(gen), "default_marker"}));
+    }
+    frontend.render(map);
+
+    std::size_t next = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < state.range(1); ++i) {
+            map.updateAnnotation(ids[next++ % ids.size()], SymbolAnnotation{randomPosition(gen), "default_marker"});
+        }
+        frontend.render(map);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+BENCHMARK(API_annotationPositionUpdates)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({20000, 1})
+    ->Args({20000, 100})
+    ->Args({20000, 1000});
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/gfx/headless_frontend.hpp>
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/map_observer.hpp>
+#include <mbgl/map/map_options.hpp>
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/renderer/renderer.hpp>
+#include <mbgl/storage/network_status.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/style/image.hpp>
+#include <mbgl/style/style.hpp>
+#include <mbgl/style/transition_options.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <limits>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr double pixelRatio{1.0};
+constexpr Size size{1000, 1000};
+
+class FrameObserver : public MapObserver {
+public:
+    explicit FrameObserver(util::RunLoop& loop_)
+        : loop(loop_) {}
+
+    void onDidFinishRenderingFrame(const RenderFrameStatus& status) override {
+        if (!waitForFullFrame || status.mode == RenderMode::Full) {
+            loop.stop();
+        }
+    }
+
+    util::RunLoop& loop;
+    bool waitForFullFrame = true;
+};
+
+} // end namespace
+
+// Pans the map by a few pixels before each frame, as a drag gesture does. Placement transitions are disabled so that
+// every frame places the symbols; `state.range(0)` enables incremental placement, which is all that differs.
+static void API_placementPan(::benchmark::State& state) {
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    util::RunLoop loop;
+    FrameObserver observer{loop};
+    HeadlessFrontend frontend{size, pixelRatio};
+    Map map{frontend,
+            observer,
+            MapOptions().withMapMode(MapMode::Continuous).withSize(size).withPixelRatio(pixelRatio),
+            ResourceOptions().withCachePath("benchmark/fixtures/api/cache.db").withApiKey("foobar")};
+    frontend.getRenderer()->setIncrementalPlacementEnabled(state.range(0) != 0);
+
+    map.getStyle().loadJSON(util::read_file("benchmark/fixtures/api/style.json"));
+    map.getStyle().setTransitionOptions(style::TransitionOptions{{}, {}, false});
+    map.jumpTo(CameraOptions().withCenter(LatLng{40.726989, -73.992857}).withZoom(15.0)); // Manhattan
+    map.getStyle().addImage(std::make_unique<style::Image>(
+        "test-icon", decodeImage(util::read_file("benchmark/fixtures/api/default_marker.png")), 1.0f));
+    loop.run();
+
+    // Back and forth, so that the pan stays over the cached tiles.
+    observer.waitForFullFrame = false;
+    int64_t frame = 0;
+    for (auto _ : state) {
+        const double dx = (frame++ / 50) % 2 ? -4.0 : 4.0;
+        map.moveBy({dx, 1.0});
+        loop.run();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(API_placementPan)->Unit(benchmark::kMillisecond)->Iterations(200)->Arg(0)->Arg(1);
+
+// Same pan as above without incremental placement, so that every frame places all symbols. `state.range(0)` selects
+// whether their collision boxes are projected on the thread pool ahead of the serial placement pass.
+static void API_placementProjection(::benchmark::State& state) {
+    auto& settings = platform::Settings::getInstance();
+    settings.set(platform::EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD,
+                 state.range(0) ? uint64_t{0} : std::numeric_limits<uint64_t>::max());
+
+    NetworkStatus::Set(NetworkStatus::Status::Offline);
+    util::RunLoop loop;
+    FrameObserver observer{loop};
+    HeadlessFrontend frontend{size, pixelRatio};
+    Map map{frontend,
+            observer,
+            MapOptions().withMapMode(MapMode::Continuous).withSize(size).withPixelRatio(pixelRatio),
+            ResourceOptions().withCachePath("benchmark/fixtures/api/cache.db").withApiKey("foobar")};
+    frontend.getRenderer()->setIncrementalPlacementEnabled(false);
+
+    map.getStyle().loadJSON(util::read_file("benchmark/fixtures/api/style.json"));
+    map.getStyle().setTransitionOptions(style::TransitionOptions{{}, {}, false});
+    map.jumpTo(CameraOptions().withCenter(LatLng{40.726989, -73.992857}).withZoom(15.0)); // Manhattan
+    map.getStyle().addImage(std::make_unique<style::Image>(
+        "test-icon", decodeImage(util::read_file("benchmark/fixtures/api/default_marker.png")), 1.0f));
+    loop.run();
+
+    observer.waitForFullFrame = false;
+    int64_t frame = 0;
+    for (auto _ : state) {
+        const double dx = (frame++ / 50) % 2 ? -4.0 : 4.0;
+        map.moveBy({dx, 1.0});
+        loop.run();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    settings.set(platform::EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD, mapbox::base::NullValue());
+}
+
+BENCHMARK(API_placementProjection)->Unit(benchmark::kMillisecond)->Iterations(200)->Arg(0)->Arg(1);
@@ -1,5 +1,6 @@
 #include <benchmark/benchmark.h>
 
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/gfx/headless_frontend.hpp>
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/map_observer.hpp>
@@ -11,6 +12,7 @@
 #include <mbgl/style/layers/symbol_layer.hpp>
 #include <mbgl/style/sources/geojson_source.hpp>
 #include <mbgl/style/style.hpp>
+#include <mbgl/text/shaping_cache.hpp>
 #include <mbgl/util/image.hpp>
 #include <mbgl/util/io.hpp>
 #include <mbgl/util/run_loop.hpp>
@@ -123,6 +125,55 @@ static void API_renderStill_recreate_map_2(::benchmark::State& state) {
     }
 }
 
+// Tiles are parsed again for every map, on a pool of `state.range(0)` threads
+static void API_renderStill_recreate_map_threads(::benchmark::State& state) {
+    RenderBenchmark bench;
+    auto threadPool = Scheduler::MakeBackground(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        HeadlessFrontend frontend{size,
+                                  pixelRatio,
+                                  gfx::HeadlessBackend::SwapBehaviour::NoFlush,
+                                  gfx::ContextMode::Unique,
+                                  std::nullopt,
+                                  true,
+                                  threadPool};
+        Map map{frontend,
+                MapObserver::nullObserver(),
+                MapOptions().withMapMode(MapMode::Static).withSize(size).withPixelRatio(pixelRatio),
+                ResourceOptions().withCachePath(cachePath).withApiKey("foobar")};
+        prepare(map);
+        frontend.render(map);
+    }
+}
+
+// Tiles are laid out again for every map. With `state.range(0)` the shapings of the previous maps are kept, and
+// otherwise only the labels repeated within one map are shaped once.
+static void API_renderStill_recreate_map_shaping_cache(::benchmark::State& state) {
+    RenderBenchmark bench;
+    auto& cache = ShapingCache::get();
+    cache.clear();
+
+    for (auto _ : state) {
+        if (!state.range(0)) {
+            cache.clear();
+        }
+        HeadlessFrontend frontend{size, pixelRatio};
+        Map map{frontend,
+                MapObserver::nullObserver(),
+                MapOptions().withMapMode(MapMode::Static).withSize(size).withPixelRatio(pixelRatio),
+                ResourceOptions().withCachePath(cachePath).withApiKey("foobar")};
+        prepare(map);
+        frontend.render(map);
+    }
+
+    const auto stats = cache.getStats();
+    state.counters["shaping_hit_rate"] = stats.hits + stats.misses
+                                             ? static_cast<double>(stats.hits) / (stats.hits + stats.misses)
+                                             : 0.0;
+    state.counters["shapings_cached"] = static_cast<double>(stats.size);
+}
+
 static void API_renderStill_multiple_sources(::benchmark::State& state) {
     using namespace mbgl::style;
     RenderBenchmark bench;
@@ -159,4 +210,12 @@ BENCHMARK(API_renderStill_reuse_map_formatted_labels)->Unit(benchmark::kMillisec
 BENCHMARK(API_renderStill_reuse_map_switch_styles)->Unit(benchmark::kMillisecond)->Iterations(50);
 BENCHMARK(API_renderStill_recreate_map)->Unit(benchmark::kMillisecond)->Iterations(50);
 BENCHMARK(API_renderStill_recreate_map_2)->Unit(benchmark::kMillisecond)->Iterations(50);
+BENCHMARK(API_renderStill_recreate_map_threads)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(50)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+BENCHMARK(API_renderStill_recreate_map_shaping_cache)->Unit(benchmark::kMillisecond)->Iterations(50)->Arg(0)->Arg(1);
 BENCHMARK(API_renderStill_multiple_sources)->Unit(benchmark::kMillisecond)->Iterations(50);
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/actor/optional_actor.hpp>
+#include <mbgl/style/expression/dsl.hpp>
+#include <mbgl/style/filter.hpp>
+#include <mbgl/style/layers/fill_layer.hpp>
+#include <mbgl/style/layers/fill_layer_impl.hpp>
+#include <mbgl/style/layers/fill_layer_properties.hpp>
+#include <mbgl/style/layers/line_layer.hpp>
+#include <mbgl/style/layers/line_layer_impl.hpp>
+#include <mbgl/style/layers/line_layer_properties.hpp>
+#include <mbgl/tile/geometry_tile.hpp>
+#include <mbgl/tile/geometry_tile_worker.hpp>
+#include <mbgl/tile/vector_mvt_tile_data.hpp>
+#include <mbgl/util/io.hpp>
+
+#include <atomic>
+
+using namespace mbgl;
+using namespace mbgl::style;
+using namespace mbgl::style::expression::dsl;
+
+namespace {
+
+// Several layers with different filters over each source layer, like the groups of a typical style
+std::vector<Immutable<LayerProperties>> makeLayers() {
+    std::vector<Immutable<LayerProperties>> layers;
+    const auto addFill = [&](const char* sourceLayer, const char* className) {
+        FillLayer layer(std::string(sourceLayer) + "-" + className, "source");
+        layer.setSourceLayer(sourceLayer);
+        layer.setFilter(Filter(eq(get("class"), literal(className))));
+        layers.push_back(makeMutable<FillLayerProperties>(staticImmutableCast<FillLayer::Impl>(layer.baseImpl)));
+    };
+    const auto addLine = [&](const char* sourceLayer, const char* className) {
+        LineLayer layer(std::string(sourceLayer) + "-" + className, "source");
+        layer.setSourceLayer(sourceLayer);
+        layer.setFilter(Filter(eq(get("class"), literal(className))));
+        layers.push_back(makeMutable<LineLayerProperties>(staticImmutableCast<LineLayer::Impl>(layer.baseImpl)));
+    };
+
+    for (const auto* className : {"wood", "scrub", "grass", "crop", "snow"}) {
+        addFill("landcover", className);
+    }
+    for (const auto* className : {"park", "residential", "industrial", "cemetery", "school"}) {
+        addFill("landuse", className);
+    }
+    for (const auto* className : {"motorway", "main", "street", "street_limited", "path", "service"}) {
+        addLine("road", className);
+    }
+    for (const auto* className : {"river", "stream", "canal"}) {
+        addLine("waterway", className);
+    }
+    FillLayer water("water", "source");
+    water.setSourceLayer("water");
+    layers.push_back(makeMutable<FillLayerProperties>(staticImmutableCast<FillLayer::Impl>(water.baseImpl)));
+    return layers;
+}
+
+} // namespace
+
+// Parses a vector tile into buckets on a pool of `state.range(0)` threads
+static void Parse_GeometryTileWorker(benchmark::State& state) {
+    auto data = std::make_shared<std::string>(
+        util::read_file("test/fixtures/api/assets/streets/10-163-395.vector.pbf"));
+    const auto layers = makeLayers();
+    const std::atomic<bool> obsolete{false};
+    const TaggedScheduler threadPool{Scheduler::MakeBackground(static_cast<std::size_t>(state.range(0))),
+                                     util::SimpleIdentity()};
+
+    {
+        // A synchronous worker parses as soon as it has both data and layers. Without a parent the results are
+        // dropped right away.
+        OptionalActor<GeometryTileWorker> worker(true,
+                                                 threadPool,
+                                                 OptionalActorRef<GeometryTile>(),
+                                                 threadPool,
+                                                 OverscaledTileID(10, 163, 395),
+                                                 "source",
+                                                 obsolete,
+                                                 MapMode::Static,
+                                                 1.0f,
+                                                 false,
+                                                 nullptr,
+                                                 nullptr);
+        worker.self().invoke(&GeometryTileWorker::setLayers, layers, std::set<std::string>(), uint64_t(0));
+
+        uint64_t correlationID = 0;
+        for (auto _ : state) {
+            worker.self().invoke(&GeometryTileWorker::setData,
+                                 std::unique_ptr<const GeometryTileData>(std::make_unique<VectorMVTTileData>(data)),
+                                 std::set<std::string>(),
+                                 ++correlationID);
+        }
+    }
+    threadPool.runRenderJobs(true);
+}
+
+BENCHMARK(Parse_GeometryTileWorker)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
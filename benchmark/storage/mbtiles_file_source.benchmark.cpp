@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/storage/mbtiles_file_source.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/resource_options.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/storage/sqlite3.hpp>
+#include <mbgl/util/client_options.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr uint8_t fixtureZoom = 6;
+
+// Local archive with every tile of one zoom level, generated once per run
+class MBTilesFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State&) override {
+        path = (std::filesystem::temp_directory_path() / "mbgl-benchmark.mbtiles").string();
+        std::remove(path.c_str());
+
+        auto db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadWriteCreate);
+        db.exec("CREATE TABLE metadata (name TEXT, value TEXT)");
+        db.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)");
+        db.exec("CREATE UNIQUE INDEX tile_index ON tiles (zoom_level, tile_column, tile_row)");
+        db.exec("INSERT INTO metadata VALUES ('format', 'png'), ('minzoom', '6'), ('maxzoom', '6')");
+
+        std::mt19937 generator(42);
+        std::vector<uint8_t> tileData(8 * 1024);
+
+        mapbox::sqlite::Transaction transaction(db);
+        mapbox::sqlite::Statement insert(db, "INSERT INTO tiles VALUES (?1, ?2, ?3, ?4)");
+        for (int32_t x = 0; x < (1 << fixtureZoom); ++x) {
+            for (int32_t y = 0; y < (1 << fixtureZoom); ++y) {
+                for (auto& byte : tileData) {
+                    byte = static_cast<uint8_t>(generator());
+                }
+
+                mapbox::sqlite::Query query(insert);
+                query.bind(1, int32_t{fixtureZoom});
+                query.bind(2, x);
+                query.bind(3, y);
+                query.bindBlob(4, tileData);
+                query.run();
+            }
+        }
+        transaction.commit();
+    }
+
+    void TearDown(const ::benchmark::State&) override { std::remove(path.c_str()); }
+
+    std::string url() const { return "mbtiles://" + path; }
+
+    std::string path;
+};
+
+} // namespace
+
+// Request every tile of the archive at once and wait for all of them, reports tiles per second
+BENCHMARK_F(MBTilesFixture, ReadTiles)(benchmark::State& state) {
+    util::RunLoop loop;
+    MBTilesFileSource fileSource(ResourceOptions::Default(), ClientOptions());
+
+    const int32_t tileCount = 1 << fixtureZoom;
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    requests.reserve(tileCount * tileCount);
+
+    for (auto _ : state) {
+        std::size_t pending = tileCount * tileCount;
+        for (int32_t x = 0; x < tileCount; ++x) {
+            for (int32_t y = 0; y < tileCount; ++y) {
+                requests.push_back(fileSource.request(
+                    Resource::tile(url() + "?file={x}/{y}/{z}.png", 1.0, x, y, fixtureZoom, Tileset::Scheme::XYZ),
+                    [&](const Response& response) {
+                        benchmark::DoNotOptimize(response.data);
+                        if (--pending == 0) {
+                            loop.stop();
+                        }
+                    }));
+            }
+        }
+        loop.run();
+        requests.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * tileCount * tileCount);
+}
+
+// TileJSON is generated once and reused while the archive doesn't change
+BENCHMARK_F(MBTilesFixture, TileJSON)(benchmark::State& state) {
+    util::RunLoop loop;
+    MBTilesFileSource fileSource(ResourceOptions::Default(), ClientOptions());
+
+    for (auto _ : state) {
+        auto request = fileSource.request(Resource::source(url()), [&](const Response& response) {
+            benchmark::DoNotOptimize(response.data);
+            loop.stop();
+        });
+        loop.run();
+    }
+}
@@ -4,9 +4,12 @@
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/storage/sqlite3.hpp>
+#include <mbgl/util/compression.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/logging.hpp>
 
+#include <cstdio>
+#include <filesystem>
 #include <random>
 
 class OfflineDatabase : public benchmark::Fixture {
@@ -200,3 +203,145 @@ BENCHMARK_F(OfflineDatabase, ResizeDatabase)(benchmark::State& state) {
         }
     }
 }
+
+namespace {
+
+mbgl::Resource mixedReadWriteTile(int32_t i) {
+    using namespace mbgl;
+    return Resource::tile("mapbox://tile_mixed/{z}/{x}/{y}", 1, i % 1024, i / 1024, 10, Tileset::Scheme::XYZ);
+}
+
+// Roughly what a vector tile looks like to a compressor: the same keys and values over and over, with
+// coordinates that differ from tile to tile.
+std::shared_ptr<std::string> vectorTileLikeData(std::mt19937& gen) {
+    static const char* const layers[] = {"transportation", "building", "water", "landuse", "poi", "place"};
+    static const char* const classes[] = {"primary", "secondary", "residential", "service", "track", "path"};
+    auto data = std::make_shared<std::string>();
+    std::uniform_int_distribution<int> pick(0, 5);
+    std::uniform_int_distribution<int> coordinate(0, 4096);
+    while (data->size() < 24 * 1024) {
+        *data += std::string(layers[pick(gen)]) + "\x1a" + classes[pick(gen)] + "\x12";
+        for (int i = 0; i < 8; ++i) {
+            const auto value = coordinate(gen);
+            data->push_back(static_cast<char>(value & 0x7f));
+            data->push_back(static_cast<char>(value >> 7));
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+// Three cache hits for every new tile, as seen by a render service with a warm cache. Uses a file
+// rather than an in-memory database so that the journal mode and syncing are taken into account.
+static void OfflineDatabase_MixedReadWrite(benchmark::State& state) {
+    using namespace mbgl;
+
+    const auto path = (std::filesystem::temp_directory_path() / "mbgl-benchmark-cache.db").string();
+    auto removeFiles = [&] {
+        for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+            std::remove((path + suffix).c_str());
+        }
+    };
+    removeFiles();
+
+    {
+        mbgl::OfflineDatabase db(
+            path, TileServerOptions::DefaultConfiguration(), static_cast<CacheDurability>(state.range(0)));
+
+        std::mt19937 gen(42);
+        Response response;
+        response.data = std::make_shared<std::string>(16 * 1024, 0);
+        for (auto& byte : *response.data) {
+            byte = static_cast<char>(gen());
+        }
+
+        constexpr int32_t warmTiles = 256;
+        for (int32_t i = 0; i < warmTiles; ++i) {
+            db.put(mixedReadWriteTile(i), response);
+        }
+        db.flushPendingWrites();
+
+        std::uniform_int_distribution<int32_t> dis(0, warmTiles - 1);
+        int32_t next = warmTiles;
+        while (state.KeepRunning()) {
+            for (int i = 0; i < 3; ++i) {
+                benchmark::DoNotOptimize(db.get(mixedReadWriteTile(dis(gen))));
+            }
+            db.put(mixedReadWriteTile(next++), response);
+        }
+        state.SetItemsProcessed(state.iterations() * 4);
+    }
+
+    removeFiles();
+}
+
+BENCHMARK(OfflineDatabase_MixedReadWrite)
+    ->ArgName("durability")
+    ->Arg(static_cast<int>(mbgl::CacheDurability::Full))
+    ->Arg(static_cast<int>(mbgl::CacheDurability::Normal))
+    ->Arg(static_cast<int>(mbgl::CacheDurability::Off));
+
+// Writes and reads back tiles through the cache with each codec, and reports how large the
+// database gets. The second argument trains a dictionary on the stored tiles first.
+static void OfflineDatabase_CodecRoundTrip(benchmark::State& state) {
+    using namespace mbgl;
+
+    const auto codec = static_cast<util::Codec>(state.range(0));
+    const bool dictionary = state.range(1) != 0;
+    if (!util::isAvailable(codec)) {
+        state.SkipWithError("Codec not available in this build");
+        return;
+    }
+
+    const auto path = (std::filesystem::temp_directory_path() / "mbgl-benchmark-codec.db").string();
+    auto removeFiles = [&] {
+        for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+            std::remove((path + suffix).c_str());
+        }
+    };
+    removeFiles();
+
+    {
+        mbgl::OfflineDatabase db(path, TileServerOptions::DefaultConfiguration(), CacheDurability::Full, codec);
+        db.setOfflineMapboxTileCountLimit(100000);
+
+        OfflineTilePyramidRegionDefinition definition{"mapbox://style", LatLngBounds::world(), 0, 10, 1.0, false};
+        const auto regionID = db.createRegion(definition, OfflineRegionMetadata())->getID();
+
+        std::mt19937 gen(42);
+        constexpr int32_t storedTiles = 512;
+        for (int32_t i = 0; i < storedTiles; ++i) {
+            Response response;
+            response.data = vectorTileLikeData(gen);
+            db.putRegionResource(regionID, mixedReadWriteTile(i), response);
+        }
+        if (dictionary) {
+            db.trainCompressionDictionary();
+        }
+
+        Response response;
+        response.data = vectorTileLikeData(gen);
+        std::uniform_int_distribution<int32_t> dis(0, storedTiles - 1);
+        int32_t next = storedTiles;
+        while (state.KeepRunning()) {
+            db.putRegionResource(regionID, mixedReadWriteTile(next++), response);
+            benchmark::DoNotOptimize(db.get(mixedReadWriteTile(dis(gen))));
+        }
+        state.SetItemsProcessed(state.iterations() * 2);
+        state.SetBytesProcessed(state.iterations() * 2 * response.data->size());
+
+        const auto status = db.getRegionCompletedStatus(regionID);
+        state.counters["stored_bytes_per_tile"] = static_cast<double>(status->completedTileSize) /
+                                                  static_cast<double>(status->completedTileCount);
+        state.counters["raw_bytes_per_tile"] = static_cast<double>(response.data->size());
+    }
+
+    removeFiles();
+}
+
+BENCHMARK(OfflineDatabase_CodecRoundTrip)
+    ->ArgNames({"codec", "dictionary"})
+    ->Args({static_cast<int>(mbgl::util::Codec::Zlib), 0})
+    ->Args({static_cast<int>(mbgl::util::Codec::Zstd), 0})
+    ->Args({static_cast<int>(mbgl::util::Codec::Zstd), 1});
@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/renderer/buckets/symbol_bucket.hpp>
+#include <mbgl/style/variable_anchor_offset_collection.hpp>
+#include <mbgl/text/cross_tile_symbol_index.hpp>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+SymbolInstance makeSymbolInstance(float x, float y, std::u16string key) {
+    GeometryCoordinates line;
+    ImageMap imageMap;
+    const ShapedTextOrientations shaping{};
+    style::SymbolLayoutProperties::Evaluated layout_;
+    IndexedSubfeature subfeature(0, {}, {}, 0);
+    Anchor anchor(x, y, 0, 0);
+    std::array<float, 2> textOffset{{0.0f, 0.0f}};
+    std::array<float, 2> iconOffset{{0.0f, 0.0f}};
+    std::array<float, 2> variableTextOffset{{0.0f, 0.0f}};
+    std::vector<AnchorOffsetPair> anchorOffsets = {{style::SymbolAnchorType::Left, variableTextOffset}};
+    VariableAnchorOffsetCollection variableAnchorOffsetCollection(std::move(anchorOffsets));
+    style::SymbolPlacementType placementType = style::SymbolPlacementType::Point;
+
+    auto sharedData = std::make_shared<SymbolInstanceSharedData>(std::move(line),
+                                                                 shaping,
+                                                                 std::nullopt,
+                                                                 std::nullopt,
+                                                                 layout_,
+                                                                 placementType,
+                                                                 textOffset,
+                                                                 imageMap,
+                                                                 0.0f,
+                                                                 SymbolContent::IconSDF,
+                                                                 false,
+                                                                 false);
+    return SymbolInstance(anchor,
+                          std::move(sharedData),
+                          shaping,
+                          std::nullopt,
+                          std::nullopt,
+                          0,
+                          0,
+                          placementType,
+                          textOffset,
+                          0,
+                          0,
+                          iconOffset,
+                          subfeature,
+                          0,
+                          0,
+                          std::move(key),
+                          0.0f,
+                          0.0f,
+                          0.0f,
+                          variableAnchorOffsetCollection,
+                          false);
+}
+
+// The street labels of `sourceID` that fall within `tileID`: `count` symbols spread over the source tile, with each
+// name repeated four times as it is along a long street.
+std::unique_ptr<SymbolBucket> makeBucket(const OverscaledTileID& tileID,
+                                         const OverscaledTileID& sourceID,
+                                         std::size_t count,
+                                         uint32_t bucketInstanceId) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(0.0f, util::EXTENT);
+
+    const double scale = std::pow(2.0, tileID.canonical.z - sourceID.canonical.z);
+    std::vector<SymbolInstance> instances;
+    for (std::size_t i = 0; i < count; ++i) {
+        const float x = static_cast<float>(position(generator) * scale -
+                                           (tileID.canonical.x - sourceID.canonical.x * scale) * util::EXTENT);
+        const float y = static_cast<float>(position(generator) * scale -
+                                           (tileID.canonical.y - sourceID.canonical.y * scale) * util::EXTENT);
+        if (x < 0 || y < 0 || x >= util::EXTENT || y >= util::EXTENT) continue;
+        const auto number = std::to_string(i / 4);
+        std::u16string name = u"Street ";
+        name.append(number.begin(), number.end());
+        instances.push_back(makeSymbolInstance(x, y, std::move(name)));
+    }
+
+    Immutable<style::SymbolLayoutProperties::PossiblyEvaluated> layout =
+        makeMutable<style::SymbolLayoutProperties::PossiblyEvaluated>();
+    auto bucket = std::make_unique<SymbolBucket>(layout,
+                                                 std::map<std::string, Immutable<style::LayerProperties>>{},
+                                                 16.0f,
+                                                 1.0f,
+                                                 0,
+                                                 false,
+                                                 false,
+                                                 "streets",
+                                                 std::move(instances),
+                                                 std::vector<SortKeyRange>{},
+                                                 1.0f,
+                                                 false,
+                                                 std::vector<style::TextWritingModeType>{},
+                                                 false);
+    bucket->bucketInstanceId = bucketInstanceId;
+    return bucket;
+}
+
+} // namespace
+
+// Zooming in by one level: the parent tile is indexed, then its four children are matched against it
+static void CrossTileSymbolIndex_ZoomIn(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const OverscaledTileID parentID(6, 0, 6, 8, 8);
+    uint32_t bucketInstanceId = 0;
+
+    auto parent = makeBucket(parentID, parentID, count, ++bucketInstanceId);
+    std::vector<std::pair<OverscaledTileID, std::unique_ptr<SymbolBucket>>> children;
+    for (const auto& canonical : parentID.canonical.children()) {
+        const OverscaledTileID childID(canonical.z, 0, canonical);
+        children.emplace_back(childID, makeBucket(childID, parentID, count, ++bucketInstanceId));
+    }
+
+    for (auto _ : state) {
+        uint32_t maxCrossTileID = 0;
+        CrossTileSymbolLayerIndex index(maxCrossTileID);
+        index.addBucket(parentID, mat4{}, *parent);
+        for (auto& child : children) {
+            index.addBucket(child.first, mat4{}, *child.second);
+        }
+        benchmark::DoNotOptimize(maxCrossTileID);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count * 2);
+}
+
+BENCHMARK(CrossTileSymbolIndex_ZoomIn)->Arg(500)->Arg(2000)->Arg(8000);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/grid_index.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+using Grid = GridIndex<uint32_t>;
+
+// Label boxes of a dense screen, about 50 per 256px tile on a 2048x2048 viewport
+std::vector<Grid::BBox> makeLabels(std::size_t count) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(0.0f, 2048.0f);
+    std::uniform_real_distribution<float> width(20.0f, 160.0f);
+    std::uniform_real_distribution<float> height(10.0f, 30.0f);
+
+    std::vector<Grid::BBox> labels;
+    labels.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float x = position(generator);
+        const float y = position(generator);
+        labels.emplace_back(Grid::BBox{{x, y}, {x + width(generator), y + height(generator)}});
+    }
+    return labels;
+}
+
+} // namespace
+
+// Test each label against the ones placed before it and insert it if there is room, like placement does
+static void GridIndex_Placement(benchmark::State& state) {
+    const auto labels = makeLabels(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        Grid grid(2048.0f, 2048.0f, 25);
+        std::size_t placed = 0;
+        for (uint32_t i = 0; i < labels.size(); ++i) {
+            if (!grid.hitTest(labels[i])) {
+                grid.insert(uint32_t{i}, labels[i]);
+                ++placed;
+            }
+        }
+        benchmark::DoNotOptimize(placed);
+    }
+}
+
+// Same, with the collision group predicate used when labels only collide within their group
+static void GridIndex_PlacementWithPredicate(benchmark::State& state) {
+    const auto labels = makeLabels(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        Grid grid(2048.0f, 2048.0f, 25);
+        std::size_t placed = 0;
+        for (uint32_t i = 0; i < labels.size(); ++i) {
+            if (!grid.hitTest(labels[i], [i](const uint32_t& other) { return other % 4 == i % 4; })) {
+                grid.insert(uint32_t{i}, labels[i]);
+                ++placed;
+            }
+        }
+        benchmark::DoNotOptimize(placed);
+    }
+}
+
+static void GridIndex_Query(benchmark::State& state) {
+    const auto labels = makeLabels(static_cast<std::size_t>(state.range(0)));
+    Grid grid(2048.0f, 2048.0f, 25);
+    for (uint32_t i = 0; i < labels.size(); ++i) {
+        grid.insert(uint32_t{i}, labels[i]);
+    }
+
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (const auto& label : labels) {
+            found += grid.query(label).size();
+        }
+        benchmark::DoNotOptimize(found);
+    }
+}
+
+BENCHMARK(GridIndex_Placement)->Arg(1000)->Arg(4000)->Arg(16000);
+BENCHMARK(GridIndex_PlacementWithPredicate)->Arg(1000)->Arg(4000)->Arg(16000);
+BENCHMARK(GridIndex_Query)->Arg(1000)->Arg(4000)->Arg(16000);
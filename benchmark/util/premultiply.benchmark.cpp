@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/premultiply.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+// `state.range(0)` selects the kernels, `state.range(1)` the width of a square image: a raster tile, a sprite sheet
+// or a still image.
+UnassociatedImage makeImage(benchmark::State& state) {
+    const auto kernels = static_cast<util::PixelKernels>(state.range(0));
+    if (!util::isSupported(kernels)) {
+        state.SkipWithError("kernels not supported");
+        return {};
+    }
+    util::setPixelKernels(kernels);
+
+    const auto width = static_cast<uint32_t>(state.range(1));
+    UnassociatedImage image({width, width});
+    for (std::size_t i = 0; i < image.bytes(); ++i) {
+        image.data[i] = static_cast<uint8_t>(i * 7);
+    }
+    return image;
+}
+
+void Premultiply(benchmark::State& state) {
+    const auto original = util::getPixelKernels();
+    auto image = makeImage(state);
+    for (auto _ : state) {
+        auto premultiplied = util::premultiply(std::move(image));
+        benchmark::DoNotOptimize(premultiplied.data.get());
+        image = UnassociatedImage(premultiplied.size, std::move(premultiplied.data));
+    }
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+    util::setPixelKernels(original);
+}
+
+void Unpremultiply(benchmark::State& state) {
+    const auto original = util::getPixelKernels();
+    auto image = makeImage(state);
+    for (auto _ : state) {
+        auto unpremultiplied = util::unpremultiply(PremultipliedImage(image.size, std::move(image.data)));
+        benchmark::DoNotOptimize(unpremultiplied.data.get());
+        image = std::move(unpremultiplied);
+    }
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+    util::setPixelKernels(original);
+}
+
+void kernelsAndSizes(benchmark::internal::Benchmark* benchmark) {
+    for (const auto kernels :
+         {util::PixelKernels::Scalar, util::PixelKernels::SSE2, util::PixelKernels::AVX2, util::PixelKernels::NEON}) {
+        for (const int64_t width : {256, 1024, 4096}) {
+            benchmark->Args({static_cast<int64_t>(kernels), width});
+        }
+    }
+}
+
+} // namespace
+
+BENCHMARK(Premultiply)->Apply(kernelsAndSizes);
+BENCHMARK(Unpremultiply)->Apply(kernelsAndSizes);
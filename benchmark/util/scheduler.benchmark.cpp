@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <mbgl/util/thread_pool.hpp>
+
+#include <array>
+#include <atomic>
+
+using namespace mbgl;
+
+namespace {
+
+constexpr std::size_t kTaskCount = 20000;
+
+// Schedule many small tasks spread over a few tags, the way tile workers of
+// several sources share the background pool, then wait for all of them.
+void ScheduleTasks(benchmark::State& state, Scheduler& scheduler) {
+    std::array<util::SimpleIdentity, 8> tags;
+    std::atomic<std::size_t> executed{0};
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < kTaskCount; ++i) {
+            scheduler.schedule(tags[i % tags.size()], [&executed] {
+                std::size_t sum = 0;
+                for (std::size_t j = 0; j < 256; ++j) {
+                    benchmark::DoNotOptimize(sum += j);
+                }
+                executed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        for (const auto& tag : tags) {
+            scheduler.waitForEmpty(tag);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(executed.load()));
+}
+
+// Pools of `state.range(0)` threads, as `Scheduler::MakeBackground` creates them, running either loop
+void ThreadPoolClassicTasks(benchmark::State& state) {
+    ThreadPool pool(static_cast<std::size_t>(state.range(0)), false);
+    ScheduleTasks(state, pool);
+}
+
+void ThreadPoolWorkStealingTasks(benchmark::State& state) {
+    ThreadPool pool(static_cast<std::size_t>(state.range(0)), true);
+    ScheduleTasks(state, pool);
+}
+
+// The shared pool that tile workers run on, as configured by the platform settings
+void BackgroundPoolTasks(benchmark::State& state) {
+    auto pool = Scheduler::GetBackground();
+    ScheduleTasks(state, *pool);
+}
+
+} // namespace
+
+BENCHMARK(ThreadPoolClassicTasks)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->UseRealTime();
+BENCHMARK(ThreadPoolWorkStealingTasks)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->UseRealTime();
+BENCHMARK(BackgroundPoolTasks)->UseRealTime();
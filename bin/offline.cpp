@@ -231,7 +231,10 @@ int main(int argc, char* argv[]) {
                       << status.completedTileCount << " / " << status.requiredTileCount << " tiles"
                       << (status.requiredResourceCountIsPrecise ? " | " : " (indeterminate); ")
                       << status.completedResourceSize << " bytes downloaded"
-                      << " (" << bytesPerSecond << " bytes/sec)" << std::endl;
+                      << " (" << bytesPerSecond << " bytes/sec, "
+                      << static_cast<uint64_t>(metrics.tilesPerSecond) << " tiles/sec, "
+                      << metrics.pendingRequestCount << " requests and " << metrics.pendingWriteCount
+                      << " writes pending)" << std::endl;
 
             if (status.complete()) {
                 std::cout << "Finished Download" << std::endl;
@@ -247,11 +250,14 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error: reached limit of " << limit << " offline tiles" << std::endl;
         }
 
+        void downloadMetricsChanged(OfflineRegionDownloadMetrics metrics_) override { metrics = metrics_; }
+
         OfflineRegion& region;
         std::shared_ptr<DatabaseFileSource> fileSource;
         util::RunLoop& loop;
         std::optional<std::string> mergePath;
         Timestamp start;
+        OfflineRegionDownloadMetrics metrics;
     };
 
     static auto stop = [&] {
@@ -1,5 +1,6 @@
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/map_options.hpp>
+#include <mbgl/platform/settings.hpp>
 #include <mbgl/util/image.hpp>
 #include <mbgl/util/run_loop.hpp>
 
@@ -9,9 +10,14 @@
 
 #include <args.hxx>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
 
 int main(int argc, char* argv[]) {
     args::ArgumentParser argumentParser("MapLibre Native render tool");
@@ -47,6 +53,28 @@ int main(int argc, char* argv[]) {
 
     args::ValueFlag<std::string> mapModeValue(
         argumentParser, "MapMode", "Map mode (e.g. 'static', 'tile', 'continuous')", {'m', "mode"});
+    args::ValueFlag<uint32_t> threadsValue(
+        argumentParser, "number", "Worker threads (default: hardware threads)", {"threads"});
+    args::ValueFlag<std::string> batchValue(argumentParser,
+                                            "file",
+                                            "Render one image per line of 'lon lat zoom [bearing [pitch]]' in the "
+                                            "file, named after the output file with their index inserted",
+                                            {"batch"});
+    args::ValueFlag<int> pngLevelValue(
+        argumentParser, "number", "PNG compression level, 0 (fastest) to 9 (smallest)", {"png-level"});
+    args::ValueFlag<std::string> pngFilterValue(argumentParser,
+                                                "filter",
+                                                "PNG filter: none, sub, up, average, paeth or adaptive",
+                                                {"png-filter"});
+    args::Flag pngPaletteFlag(
+        argumentParser, "png-palette", "Write images with no more than 256 colors with a palette", {"png-palette"});
+    args::ValueFlag<uint32_t> pngThreadsValue(
+        argumentParser, "number", "Threads compressing each PNG at once", {"png-threads"});
+    args::ValueFlag<std::string> metatileValue(argumentParser,
+                                               "z/x/y/n",
+                                               "Render the n by n 256 pixel tiles from tile z/x/y on as one image, "
+                                               "and write each tile to a file named after the output file and its ID",
+                                               {"metatile"});
 
     try {
         argumentParser.ParseCLI(argc, argv);
@@ -87,6 +115,35 @@ int main(int argc, char* argv[]) {
     auto mapTilerConfiguration = mbgl::TileServerOptions::MapTilerConfiguration();
     std::string style = styleValue ? args::get(styleValue) : mapTilerConfiguration.defaultStyles().at(0).getUrl();
 
+    if (threadsValue && args::get(threadsValue) > 0) {
+        platform::Settings::getInstance().set(platform::EXPERIMENTAL_THREAD_POOL_SIZE,
+                                              static_cast<uint64_t>(args::get(threadsValue)));
+    }
+
+    PNGEncodeOptions pngOptions;
+    if (pngLevelValue) {
+        pngOptions.compressionLevel = std::clamp(args::get(pngLevelValue), 0, 9);
+    }
+    if (pngFilterValue) {
+        const auto& filter = args::get(pngFilterValue);
+        using Filter = PNGEncodeOptions::Filter;
+        const std::map<std::string, Filter> filters{{"none", Filter::None},
+                                                    {"sub", Filter::Sub},
+                                                    {"up", Filter::Up},
+                                                    {"average", Filter::Average},
+                                                    {"paeth", Filter::Paeth},
+                                                    {"adaptive", Filter::Adaptive}};
+        if (!filters.contains(filter)) {
+            std::cerr << "Unknown PNG filter " << filter << std::endl;
+            exit(2);
+        }
+        pngOptions.filter = filters.at(filter);
+    }
+    pngOptions.palette = pngPaletteFlag;
+    if (pngThreadsValue) {
+        pngOptions.threads = std::max<uint32_t>(args::get(pngThreadsValue), 1);
+    }
+
     util::RunLoop loop;
 
     MapMode mapMode = MapMode::Static;
@@ -128,10 +185,78 @@ int main(int argc, char* argv[]) {
                            : mbgl::MapDebugOptions::NoDebug);
     }
 
+    // Splits the output file name before its extension, to insert into it
+    const auto splitOutput = [&] {
+        auto extension = output.rfind('.');
+        if (extension != std::string::npos && output.find('/', extension) != std::string::npos) {
+            extension = std::string::npos;
+        }
+        return std::pair<std::string, std::string>{
+            output.substr(0, extension), extension == std::string::npos ? std::string() : output.substr(extension)};
+    };
+
     try {
-        std::ofstream out(output, std::ios::binary);
-        out << encodePNG(frontend.render(map).image);
-        out.close();
+        if (metatileValue) {
+            uint32_t z = 0, x = 0, y = 0, n = 0;
+            char separator = 0;
+            std::istringstream fields(args::get(metatileValue));
+            if (!(fields >> z >> separator >> x >> separator >> y >> separator >> n) || z > 30 || x >= (1u << z) ||
+                y >= (1u << z)) {
+                throw std::runtime_error("Invalid metatile " + args::get(metatileValue));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            // The buffer keeps labels along the edges of the block from being placed differently than inside it
+            const auto tiles = frontend.renderMetatile(
+                map, CanonicalTileID(static_cast<uint8_t>(z), x, y), n, 256, 64);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const auto [stem, suffix] = splitOutput();
+            for (const auto& tile : tiles) {
+                std::ofstream out(stem + "-" + std::to_string(tile.id.z) + "-" + std::to_string(tile.id.x) + "-" +
+                                      std::to_string(tile.id.y) + suffix,
+                                  std::ios::binary);
+                out << encodePNG(tile.image, pngOptions);
+            }
+            std::cout << "Rendered " << tiles.size() << " tiles in " << elapsed.count() << " s" << std::endl;
+        } else if (batchValue) {
+            std::ifstream batch(args::get(batchValue));
+            if (!batch) {
+                throw std::runtime_error("Cannot read " + args::get(batchValue));
+            }
+            std::vector<CameraOptions> cameras;
+            for (std::string line; std::getline(batch, line);) {
+                std::istringstream fields(line);
+                double lineLon = 0, lineLat = 0, lineZoom = 0, lineBearing = bearing, linePitch = pitch;
+                if (!(fields >> lineLon >> lineLat >> lineZoom)) {
+                    continue;
+                }
+                fields >> lineBearing >> linePitch;
+                cameras.push_back(CameraOptions()
+                                      .withCenter(LatLng{lineLat, lineLon})
+                                      .withZoom(lineZoom)
+                                      .withBearing(lineBearing)
+                                      .withPitch(linePitch));
+            }
+
+            // out.png becomes out-0.png, out-1.png, ...
+            const auto name = splitOutput();
+            const std::string& stem = name.first;
+            const std::string& suffix = name.second;
+            const auto stats = frontend.renderBatch(
+                map,
+                cameras,
+                [&](const PremultipliedImage& image) { return encodePNG(image, pngOptions); },
+                [&](std::size_t index, std::string encoded) {
+                    std::ofstream out(stem + "-" + std::to_string(index) + suffix, std::ios::binary);
+                    out << encoded;
+                });
+            std::cout << "Rendered " << stats.frames << " images in " << stats.elapsed.count() << " s ("
+                      << stats.framesPerSecond() << " images/s)" << std::endl;
+        } else {
+            std::ofstream out(output, std::ios::binary);
+            out << encodePNG(frontend.render(map).image, pngOptions);
+            out.close();
+        }
     } catch (std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl;
         exit(1);
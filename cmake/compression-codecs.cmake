@@ -0,0 +1,45 @@
+# Optional compression backends of platform/default/src/mbgl/util/compression.cpp. Every platform compiles that file
+# into mbgl-core, so they are wired here once. A backend that is requested but can't be found stops the configuration
+# instead of silently building without it.
+
+set(MLN_COMPRESSION_SOURCE ${PROJECT_SOURCE_DIR}/platform/default/src/mbgl/util/compression.cpp)
+
+find_package(PkgConfig QUIET)
+
+# Looks for a CMake package config first, then for a pkg-config module, and links the first found to mbgl-core.
+function(mln_link_compression_codec option package pkg_config_module)
+    set(targets ${ARGN})
+
+    find_package(${package} CONFIG QUIET)
+    foreach(target IN LISTS targets)
+        if(TARGET ${target})
+            set(codec_target ${target})
+            break()
+        endif()
+    endforeach()
+
+    if(NOT codec_target AND PKG_CONFIG_FOUND)
+        pkg_search_module(MLN_${option} IMPORTED_TARGET ${pkg_config_module})
+        if(MLN_${option}_FOUND)
+            set(codec_target PkgConfig::MLN_${option})
+        endif()
+    endif()
+
+    if(NOT codec_target)
+        message(FATAL_ERROR "${option} is ON, but ${package} was found neither as a CMake package nor through "
+                            "pkg-config (${pkg_config_module}). Install it or turn ${option} off.")
+    endif()
+
+    message(STATUS "${option}: using ${codec_target}")
+    target_link_libraries(mbgl-core PRIVATE ${codec_target})
+    set_property(SOURCE ${MLN_COMPRESSION_SOURCE} APPEND PROPERTY COMPILE_DEFINITIONS ${option})
+endfunction()
+
+if(MLN_WITH_ZSTD)
+    mln_link_compression_codec(MLN_WITH_ZSTD zstd libzstd zstd::libzstd_shared zstd::libzstd_static)
+endif()
+
+if(MLN_WITH_LIBDEFLATE)
+    mln_link_compression_codec(MLN_WITH_LIBDEFLATE libdeflate libdeflate libdeflate::libdeflate_shared
+                               libdeflate::libdeflate_static)
+endif()
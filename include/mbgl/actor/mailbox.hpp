@@ -1,18 +1,18 @@
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <queue>
 
 #include <mapbox/std/weak.hpp>
+#include <mbgl/actor/message.hpp>
 #include <mbgl/actor/scheduler.hpp>
 
 namespace mbgl {
 
 class Scheduler;
-class Message;
 
 class Mailbox : public std::enable_shared_from_this<Mailbox> {
 public:
@@ -24,6 +24,7 @@ public:
 
     Mailbox(Scheduler&);
     Mailbox(const TaggedScheduler&);
+    ~Mailbox();
 
     /// Attach the given scheduler to this mailbox and begin processing messages
     /// sent to it. The mailbox must be a "holding" mailbox, as created by the
@@ -37,11 +38,21 @@ public:
 
     bool isOpen() const;
 
+    /// Set the priority with which this mailbox's messages are scheduled.
+    /// Takes effect for the next message handed to the scheduler.
+    void setPriority(TaskPriority priority_) { priority = priority_; }
+
+    /// Where messages pushed to this mailbox are best allocated, see actor::makeMessage()
+    MessagePool& getMessagePool() { return messagePool; }
+
+    /// Safe to call from any number of threads at once, without blocking each other or receive().
     void push(std::unique_ptr<Message>);
     void receive();
 
 private:
     void scheduleToRecieve(const std::optional<util::SimpleIdentity>& tag = std::nullopt);
+    void enqueue(Message*);
+    Message* dequeue();
     enum class State : uint32_t {
         Idle = 0,
         Processing,
@@ -52,13 +63,31 @@ private:
     mapbox::base::WeakPtr<Scheduler> weakScheduler;
 
     std::recursive_mutex receivingMutex;
-    std::mutex pushingMutex;
+    // Calls to push() in progress, which close() waits for
+    std::atomic<uint32_t> pushing{0};
 
     std::atomic<State> state{State::Idle};
-    bool closed{false};
+    std::atomic<TaskPriority> priority{TaskPriority::Normal};
+    std::atomic<bool> opened{false};
+    std::atomic<bool> closed{false};
+
+    // Declared ahead of the queue, which gives its messages back when destroyed
+    MessagePool messagePool;
+
+    // Messages are linked into an intrusive multi-producer, single-consumer queue (Dmitry Vyukov's),
+    // which starts and ends at a stub once the last message is taken. `head` is the message pushed
+    // last and `tail` the next one to receive, which only receive() touches.
+    struct Stub final : Message {
+        void operator()() override {}
+    };
+    Stub stub;
+    std::atomic<Message*> head{&stub};
+    Message* tail{&stub};
 
-    std::mutex queueMutex;
-    std::queue<std::unique_ptr<Message>> queue;
+    // Messages pushed and not yet received. A receive is scheduled whenever this becomes nonzero,
+    // and again after each message while it stays so. It can briefly go below zero when a message
+    // is received before the push() linking it in has counted it.
+    std::atomic<int64_t> pending{0};
 };
 
 } // namespace mbgl
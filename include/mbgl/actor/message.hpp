@@ -1,10 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <future>
+#include <memory>
 #include <utility>
 
 namespace mbgl {
 
+class Mailbox;
+class MessagePool;
+
 // A movable type-erasing function wrapper. This allows to store arbitrary
 // invokable things (like std::function<>, or the result of a movable-only
 // std::bind()) in the queue. Source: http://stackoverflow.com/a/29642072/331379
@@ -12,6 +19,54 @@ class Message {
 public:
     virtual ~Message() = default;
     virtual void operator()() = 0;
+
+    // Messages made for a mailbox take their storage from its pool, and other ones from the
+    // heap. Deleting a message gives its storage back to where it came from.
+    static void* operator new(std::size_t size);
+    static void* operator new(std::size_t size, MessagePool&);
+    static void operator delete(void*) noexcept;
+    static void operator delete(void*, MessagePool&) noexcept;
+
+private:
+    friend class Mailbox;
+
+    // The message pushed after this one, linking the mailbox queue
+    std::atomic<Message*> next{nullptr};
+};
+
+// Storage for the messages sent to one mailbox. Sending threads allocate from it and the
+// receiving thread frees to it without locking. Messages that don't fit a slot, or that are
+// allocated when every slot is taken, go to the heap. So do the first messages, until the
+// mailbox holds a burst of them at once.
+class MessagePool {
+public:
+    static constexpr std::size_t slotSize = 128;
+    static constexpr std::size_t slotCount = 32;
+    // Messages waiting at once that make the pool allocate its slots
+    static constexpr std::size_t burstSize = 4;
+
+    MessagePool() = default;
+    MessagePool(const MessagePool&) = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+    ~MessagePool();
+
+    void* allocate(std::size_t size);
+    void deallocate(void*) noexcept;
+
+private:
+    struct Slab;
+
+    // A free slot, or nullptr if the message goes to the heap
+    void* allocateSlot();
+
+    // Allocated along with the first message that fits once a burst was seen
+    std::atomic<Slab*> slab{nullptr};
+    // Index + 1 of the first free slot in the low half, 0 if none, and a count of the changes
+    // in the high half, which keeps a thread from taking a slot that was taken and freed again
+    // while it looked at it.
+    std::atomic<uint64_t> freeSlots{0};
+    // Messages allocated and not yet freed
+    std::atomic<std::size_t> pending{0};
 };
 
 template <class Object, class MemberFn, class ArgsTuple>
@@ -84,19 +139,20 @@ public:
 namespace actor {
 
 template <class Object, class MemberFn, class... Args>
-std::unique_ptr<Message> makeMessage(Object& object, MemberFn memberFn, Args&&... args) {
+std::unique_ptr<Message> makeMessage(MessagePool& pool, Object& object, MemberFn memberFn, Args&&... args) {
     auto tuple = std::make_tuple(std::forward<Args>(args)...);
-    return std::make_unique<MessageImpl<Object, MemberFn, decltype(tuple)>>(object, memberFn, std::move(tuple));
+    using Impl = MessageImpl<Object, MemberFn, decltype(tuple)>;
+    static_assert(alignof(Impl) <= alignof(std::max_align_t));
+    return std::unique_ptr<Message>(new (pool) Impl(object, memberFn, std::move(tuple)));
 }
 
 template <class ResultType, class Object, class MemberFn, class... Args>
-std::unique_ptr<Message> makeMessage(std::promise<ResultType>&& promise,
-                                     Object& object,
-                                     MemberFn memberFn,
-                                     Args&&... args) {
+std::unique_ptr<Message> makeMessage(
+    MessagePool& pool, std::promise<ResultType>&& promise, Object& object, MemberFn memberFn, Args&&... args) {
     auto tuple = std::make_tuple(std::forward<Args>(args)...);
-    return std::make_unique<AskMessageImpl<ResultType, Object, MemberFn, decltype(tuple)>>(
-        std::move(promise), object, memberFn, std::move(tuple));
+    using Impl = AskMessageImpl<ResultType, Object, MemberFn, decltype(tuple)>;
+    static_assert(alignof(Impl) <= alignof(std::max_align_t));
+    return std::unique_ptr<Message>(new (pool) Impl(std::move(promise), object, memberFn, std::move(tuple)));
 }
 
 } // namespace actor
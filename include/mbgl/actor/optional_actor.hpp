@@ -47,6 +47,14 @@ public:
 
     const OptionalActorRef<Object>& self() { return selfRef; }
 
+    /// Set the scheduling priority of messages sent to the actor. Has no
+    /// effect when the object is synchronous.
+    void setPriority(TaskPriority priority) {
+        if (actor) {
+            actor->setPriority(priority);
+        }
+    }
+
 private:
     class SyncObject {
     public:
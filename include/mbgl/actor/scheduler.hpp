@@ -4,6 +4,8 @@
 
 #include <mapbox/std/weak.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -12,6 +14,15 @@ namespace mbgl {
 
 class Mailbox;
 
+/// Relative urgency of a scheduled task. Schedulers that support priorities
+/// start higher priority tasks first; tasks of equal priority that share a
+/// tag keep their FIFO order.
+enum class TaskPriority : uint8_t {
+    Low,    ///< Work that may be needed later, e.g. prefetched tiles
+    Normal, ///< Default
+    High,   ///< Work blocking visible content, e.g. tiles at the center of the viewport
+};
+
 /**
     A `Scheduler` is responsible for coordinating the processing of messages by
     one or more actors via their mailboxes. It's an abstract interface. Currently,
@@ -41,9 +52,20 @@ public:
     /// Enqueues a function for execution.
     virtual void schedule(std::function<void()>&&) = 0;
     virtual void schedule(const util::SimpleIdentity, std::function<void()>&&) = 0;
+    /// Enqueues a function for execution with the given priority. Schedulers
+    /// without priority support run it like any other task.
+    virtual void schedule(const util::SimpleIdentity tag, TaskPriority, std::function<void()>&& fn) {
+        if (tag.isEmpty()) {
+            schedule(std::move(fn));
+        } else {
+            schedule(tag, std::move(fn));
+        }
+    }
 
     /// Makes a weak pointer to this Scheduler.
     virtual mapbox::base::WeakPtr<Scheduler> makeWeakPtr() = 0;
+    /// Number of threads that run the scheduled tasks.
+    virtual std::size_t getThreadCount() const { return 1; }
     /// Enqueues a function for execution on the render thread owned by the given tag.
     virtual void runOnRenderThread(const util::SimpleIdentity, std::function<void()>&&) {}
     /// Run render thread jobs for the given tag
@@ -92,6 +114,13 @@ public:
     /// TODO : Rename to GetPool()
     [[nodiscard]] static std::shared_ptr<Scheduler> GetBackground();
 
+    /// Create a new worker pool that is not shared with `GetBackground()`.
+    /// Passing it to a renderer backend isolates that map's background work
+    /// from other maps in the same process.
+    /// @param threadCount Number of worker threads, or zero to use the same
+    /// default as the shared pool.
+    [[nodiscard]] static std::shared_ptr<Scheduler> MakeBackground(std::size_t threadCount = 0);
+
     /// Get the *sequenced* scheduler for asynchronous tasks.
     /// Unlike the method above, the returned scheduler
     /// (once stored) represents a single thread, thus each
@@ -5,6 +5,7 @@
 
 #include <memory>
 #include <mutex>
+#include <optional>
 
 namespace mbgl {
 
@@ -35,7 +36,12 @@ public:
     RendererBackend& operator=(const RendererBackend&) = delete;
 
     // Return the background thread pool assigned to this backend
-    TaggedScheduler& getThreadPool() noexcept { return threadPool; }
+    TaggedScheduler& getThreadPool() noexcept { return *threadPool; }
+
+    /// Replace the background thread pool, e.g., with one from `Scheduler::MakeBackground`
+    /// to keep this backend's work off the shared pool.
+    /// Must be called before a `Renderer` or `Map` is created with this backend.
+    void setThreadPool(std::shared_ptr<Scheduler>);
 
     /// Returns the device's context.
     Context& getContext();
@@ -75,7 +81,7 @@ protected:
     std::unique_ptr<Context> context;
     const ContextMode contextMode;
     std::once_flag initialized;
-    TaggedScheduler threadPool;
+    std::optional<TaggedScheduler> threadPool;
 
     friend class BackendScope;
 };
@@ -63,6 +63,8 @@ public:
     virtual void onDidFinishRenderingMap(RenderMode) {}
     virtual void onDidFinishLoadingStyle() {}
     virtual void onSourceChanged(style::Source&) {}
+    /// Fraction of a source's data indexed so far, reported while a large GeoJSON source loads from a URL
+    virtual void onSourceLoadingProgress(style::Source&, double /* progress */) {}
     virtual void onDidBecomeIdle() {}
     virtual void onStyleImageMissing(const std::string&) {}
     /// This method should return true if unused image can be removed,
@@ -15,6 +15,27 @@ DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_THREAD_PRIORITY_FILE, thread_priority_file
 DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_THREAD_PRIORITY_NETWORK, thread_priority_network);
 DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_THREAD_PRIORITY_DATABASE, thread_priority_database);
 
+// The value for EXPERIMENTAL_THREAD_POOL_SIZE must be a positive integer. It sets the number
+// of worker threads in the shared background pool, and must be set before that pool is first used.
+DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_THREAD_POOL_SIZE, thread_pool_size);
+
+// The value for EXPERIMENTAL_THREAD_POOL_WORK_STEALING must be a boolean. Thread pools distribute their tasks through
+// per-worker run queues unless it is false, which falls back to workers scanning every tag's queue. It is read when a
+// pool is created.
+DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_THREAD_POOL_WORK_STEALING, thread_pool_work_stealing);
+
+// The value for EXPERIMENTAL_MBTILES_READER_THREADS must be a positive integer. It caps the number
+// of threads each MBTiles file source reads tiles on, and is read when the file source is created.
+DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_MBTILES_READER_THREADS, mbtiles_reader_threads);
+
+// The value for EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD must be a non-negative integer. Placements of at least
+// this many symbols project their collision boxes on the thread pool before placing them; defaults to 1024.
+DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD, placement_projection_threshold);
+
+// The value for EXPERIMENTAL_SHAPING_CACHE_SIZE must be a non-negative integer. It caps the number of text shapings
+// shared between tiles, 0 turning that cache off, and must be set before the first label is laid out.
+DECLARE_MAPLIBRE_SETTING(EXPERIMENTAL_SHAPING_CACHE_SIZE, shaping_cache_size);
+
 /// Settings class provides non-persistent, in-process key-value storage.
 class Settings final {
 public:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mbgl/renderer/query.hpp>
+#include <mbgl/renderer/tile_cache_stats.hpp>
 #include <mbgl/annotation/annotation.hpp>
 #include <mbgl/util/geo.hpp>
 #include <mbgl/util/geojson.hpp>
@@ -107,9 +108,29 @@ public:
      */
     const std::vector<PlacedSymbolData>& getPlacedSymbolsData() const;
 
+    /**
+     * @brief In Continuous map mode, enables or disables incremental symbol
+     * placement.
+     *
+     * When enabled, a placement after a pan keeps the previous results of the
+     * symbols the pan only moved, and places again the symbols around the
+     * regions it exposed or changed.
+     *
+     * Incremental placement is disabled by default.
+     */
+    void setIncrementalPlacementEnabled(bool enable);
+    bool getIncrementalPlacementEnabled() const;
+
     // Memory
     void setTileCacheEnabled(bool);
     bool getTileCacheEnabled() const;
+
+    /// Limit the bytes held by the tiles cached for each source, see `Tile::getByteSize`
+    void setTileCacheMaxBytes(std::size_t);
+    std::size_t getTileCacheMaxBytes() const;
+
+    /// Occupancy of the tile caches and hit, miss and eviction counts since the sources were created
+    TileCacheStats getTileCacheStats() const;
     void reduceMemoryUse();
     void clearData();
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mbgl {
+
+/// Occupancy and activity of the tile caches, summed over all sources
+struct TileCacheStats {
+    /// Number of tiles held in the caches
+    std::size_t tiles = 0;
+    /// Approximate bytes of CPU memory held by the cached tiles
+    std::size_t bytes = 0;
+    /// Approximate bytes of GPU buffers and textures held by the cached tiles, not counted against the budget
+    std::size_t gpuBytes = 0;
+    /// Sum of the byte budgets of the caches
+    std::size_t maxBytes = 0;
+
+    /// Number of times a tile was taken back out of a cache
+    uint64_t hits = 0;
+    /// Number of times a tile had to be created because it wasn't cached
+    uint64_t misses = 0;
+    /// Number of tiles dropped to stay within the budget
+    uint64_t evictions = 0;
+
+    TileCacheStats& operator+=(const TileCacheStats& other) {
+        tiles += other.tiles;
+        bytes += other.bytes;
+        gpuBytes += other.gpuBytes;
+        maxBytes += other.maxBytes;
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        return *this;
+    }
+};
+
+} // namespace mbgl
@@ -52,6 +52,22 @@ public:
      */
     virtual void packDatabase(std::function<void(std::exception_ptr)> callback);
 
+    /**
+     * Trains a Zstandard dictionary on a sample of the stored tiles and
+     * recompresses every tile with it; later writes use it as well. Tiles of
+     * one source share most of their strings, so this shrinks offline regions
+     * considerably. Fails unless the cache codec is `util::Codec::Zstd` (see
+     * ResourceOptions::withCacheCodec()).
+     *
+     * This operation is as slow as packDatabase(), which it runs afterwards if
+     * packing occurs automatically.
+     *
+     * When the operation is complete or encounters an error, the given callback
+     * will be executed on the database thread; it is the responsibility of the
+     * SDK bindings to re-execute a user-provided callback on the main thread.
+     */
+    virtual void trainCompressionDictionary(std::function<void(std::exception_ptr)> callback);
+
     /**
      * Sets whether packing the database file occurs automatically after an
      * offline region is deleted (deleteOfflineRegion()) or the ambient cache is
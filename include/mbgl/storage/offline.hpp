@@ -165,6 +165,37 @@ public:
     bool complete() const { return completedResourceCount >= requiredResourceCount; }
 };
 
+/*
+ * Throughput of an active offline download. The rates are averaged over the
+ * time since the download was last activated.
+ */
+class OfflineRegionDownloadMetrics {
+public:
+    /**
+     * The number of resource requests that have been issued and haven't
+     * completed yet.
+     */
+    uint64_t pendingRequestCount = 0;
+
+    /**
+     * The number of downloaded resources that are waiting to be written to the
+     * database.
+     */
+    uint64_t pendingWriteCount = 0;
+
+    /**
+     * Resources and tiles completed per second, including those that were
+     * already in the database.
+     */
+    double resourcesPerSecond = 0;
+    double tilesPerSecond = 0;
+
+    /**
+     * Bytes of completed resources per second.
+     */
+    double bytesPerSecond = 0;
+};
+
 /*
  * A region can have a single observer, which gets notified whenever a change
  * to the region's status occurs.
@@ -211,6 +242,17 @@ public:
      * that re-executes the user-provided implementation on the main thread.
      */
     virtual void mapboxTileCountLimitExceeded(uint64_t /* limit */) {}
+
+    /*
+     * Implement this method to be notified of the throughput of an active
+     * download. It is called whenever a batch of resources has been written
+     * to the database.
+     *
+     * Note that this method will be executed on the database thread; it is the
+     * responsibility of the SDK bindings to wrap this object in an interface
+     * that re-executes the user-provided implementation on the main thread.
+     */
+    virtual void downloadMetricsChanged(OfflineRegionDownloadMetrics) {}
 };
 
 class OfflineRegion {
@@ -3,10 +3,25 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <mbgl/util/compression.hpp>
 #include <mbgl/util/tile_server_options.hpp>
 
 namespace mbgl {
 
+/**
+ * @brief Trade-off between write throughput and crash safety of the cache database.
+ */
+enum class CacheDurability : uint8_t {
+    /// Rollback journal, fully synced. Every cached resource is committed on its own.
+    Full,
+    /// Write-ahead log, synced at checkpoints. Ambient cache writes and access times are
+    /// committed in batches, so the most recent batch can be lost when the process dies.
+    Normal,
+    /// Like `Normal`, without syncing at all. A power failure can lose or corrupt the cache,
+    /// in which case it is discarded and rebuilt.
+    Off,
+};
+
 /**
  * @brief Holds values for resource options.
  */
@@ -101,6 +116,59 @@ public:
      */
     uint64_t maximumCacheSize() const;
 
+    /**
+     * @brief Sets the memory budget for deserialized PMTiles directories.
+     * Least recently used directories are dropped once they take up more.
+     *
+     * @param size Directory cache size in bytes.
+     * @return reference to ResourceOptions for chaining options together.
+     */
+    ResourceOptions& withPMTilesDirectoryCacheSize(uint64_t size);
+
+    /**
+     * @brief Gets the previously set (or default) PMTiles directory cache size.
+     *
+     * @return PMTiles directory cache size in bytes.
+     */
+    uint64_t pmtilesDirectoryCacheSize() const;
+
+    /**
+     * @brief Sets the durability of the cache database. Relaxing it lets a busy
+     * process, or several processes sharing one cache file, read tiles while
+     * writes are pending. Only used when the database file source is created.
+     *
+     * @param durability Cache durability, `CacheDurability::Full` by default.
+     * @return reference to ResourceOptions for chaining options together.
+     */
+    ResourceOptions& withCacheDurability(CacheDurability durability);
+
+    /**
+     * @brief Gets the previously set (or default) cache durability.
+     *
+     * @return cache durability.
+     */
+    CacheDurability cacheDurability() const;
+
+    /**
+     * @brief Sets the codec that resources and tiles are compressed with in
+     * the cache database. Zstandard decodes several times faster than zlib
+     * and can use dictionaries (see DatabaseFileSource::trainCompressionDictionary()),
+     * but databases using it can't be read by builds without it, and it's
+     * only available when built with MLN_WITH_ZSTD. Only used when the
+     * database file source is created.
+     *
+     * @param codec Cache codec, `util::Codec::Zlib` by default.
+     * @return reference to ResourceOptions for chaining options together.
+     */
+    ResourceOptions& withCacheCodec(util::Codec codec);
+
+    /**
+     * @brief Gets the previously set (or default) cache codec.
+     *
+     * @return cache codec.
+     */
+    util::Codec cacheCodec() const;
+
     /**
      * @brief Sets the platform context. A platform context is usually an object
      * that assists the creation of a file source.
@@ -6,9 +6,12 @@
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/geojson.hpp>
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace mbgl {
 
@@ -37,16 +40,43 @@ struct GeoJSONOptions {
 
     // Update options
     bool synchronousUpdate = false;
+    // Keep a copy of the features so that diffs can be applied to them
+    bool updatable = false;
 
     static Immutable<GeoJSONOptions> defaultOptions();
 };
+
+/// A change to the features of a GeoJSON source, identifying features by their IDs. Features are removed first;
+/// updated features replace the ones with the same ID, or are added if there is none.
+struct GeoJSONDiff {
+    mapbox::feature::feature_collection<double> update;
+    std::vector<mapbox::feature::identifier> remove;
+};
+
 class GeoJSONData {
 public:
     using TileFeatures = mapbox::feature::feature_collection<int16_t>;
     using Features = mapbox::feature::feature_collection<double>;
+
+    /// Hooks into building the index of a large feature collection, which `create()` splits into parts built
+    /// on `pool`, the background thread pool if null, with one part per pool thread at most. `onProgress` is
+    /// called from any thread with the fraction of the features indexed so far. Once `isCancelled` returns true,
+    /// no further parts are started and `create()` returns nullptr.
+    struct BuildControl {
+        std::function<void(double)> onProgress;
+        std::function<bool()> isCancelled;
+        std::shared_ptr<Scheduler> pool;
+    };
+
     static std::shared_ptr<GeoJSONData> create(const GeoJSON&,
                                                std::shared_ptr<Scheduler> sequencedScheduler,
-                                               const Immutable<GeoJSONOptions>& = GeoJSONOptions::defaultOptions());
+                                               const Immutable<GeoJSONOptions>& = GeoJSONOptions::defaultOptions(),
+                                               const BuildControl& = {});
+    /// Like the above, but moves the features into the parts of a split index instead of copying them.
+    static std::shared_ptr<GeoJSONData> create(GeoJSON&&,
+                                               std::shared_ptr<Scheduler> sequencedScheduler,
+                                               const Immutable<GeoJSONOptions>& = GeoJSONOptions::defaultOptions(),
+                                               const BuildControl& = {});
 
     virtual ~GeoJSONData() = default;
     virtual void getTile(const CanonicalTileID&, const std::function<void(TileFeatures)>&, bool runSynchronously) = 0;
@@ -55,6 +85,25 @@ public:
     virtual Features getChildren(std::uint32_t) = 0;
     virtual Features getLeaves(std::uint32_t, std::uint32_t limit, std::uint32_t offset) = 0;
     virtual std::uint8_t getClusterExpansionZoom(std::uint32_t) = 0;
+
+    /// Returns the data with the diff applied, sharing the index of the unchanged features with this data, or
+    /// nullptr if the data doesn't support diffs. Only unclustered feature collections created with the `updatable`
+    /// option, in which every feature has a unique ID, do.
+    /// Changed features draw after the others until enough changes pile up to rebuild the index in the background.
+    /// The rebuilt index draws updated features in their original place and added ones last, as GL JS does.
+    virtual std::shared_ptr<GeoJSONData> applyDiff(const GeoJSONDiff&) { return nullptr; }
+
+    /// Whether the tile may differ from its version in `previous`. Data made by `applyDiff()` tells which tiles
+    /// the features it changed touch; any other data may differ in every tile.
+    virtual bool affectsTile(const GeoJSONData& /* previous */, const CanonicalTileID&) const { return true; }
+
+private:
+    // Moves the features out of `movable`, the features of the GeoJSON if not null
+    static std::shared_ptr<GeoJSONData> create(const GeoJSON&,
+                                               Features* movable,
+                                               std::shared_ptr<Scheduler> sequencedScheduler,
+                                               const Immutable<GeoJSONOptions>&,
+                                               const BuildControl&);
 };
 
 // NOTE: Any derived class must invalidate `weakFactory` in the destructor
@@ -66,6 +115,10 @@ public:
     void setURL(const std::string& url);
     void setGeoJSON(const GeoJSON&);
     void setGeoJSONData(std::shared_ptr<GeoJSONData>);
+    /// Applies the diff to the current data, so that only the tiles showing the changed features are reloaded.
+    /// Returns false, changing nothing, if the data doesn't support diffs, e.g. because the source isn't
+    /// `updatable`; set the full data instead then.
+    bool updateGeoJSON(const GeoJSONDiff&);
 
     std::optional<std::string> getURL() const;
     const GeoJSONOptions& getOptions() const;
@@ -87,7 +140,8 @@ protected:
 private:
     std::optional<std::string> url;
     std::unique_ptr<AsyncRequest> req;
-    std::atomic<uint64_t> requestGeneration{0};
+    // Shared with the background tasks loading the data, which give up once a newer request supersedes them
+    std::shared_ptr<std::atomic<uint64_t>> requestGeneration = std::make_shared<std::atomic<uint64_t>>(0);
     std::shared_ptr<Scheduler> sequencedScheduler;
     mapbox::base::WeakPtrFactory<Source> weakFactory{this};
     // Do not add members here, see `WeakPtrFactory`
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace mbgl {
 namespace util {
@@ -13,10 +15,61 @@ enum CompressionFormat {
     DETECT = 15 + 32
 };
 
+/// Codecs for stored payloads. The offline database records them in the `compressed` column of its tables, so the
+/// values must never change.
+enum class Codec : uint8_t {
+    None = 0,
+    Zlib = 1,
+    Zstd = 2,
+};
+
+/// Whether this build can encode and decode the codec. Zstandard needs a build with MLN_WITH_ZSTD.
+bool isAvailable(Codec) noexcept;
+
+class CompressionDictionary;
+
 bool is_compressed(const std::string&);
 std::string compress(const std::string& raw, int windowBits = CompressionFormat::ZLIB);
 std::string decompress(const std::string& raw, int windowBits = CompressionFormat::DETECT);
 
+/// Compresses with the given codec, and with the dictionary if the codec is Zstd. Zlib produces the same framing as
+/// `compress(raw)`. Throws std::runtime_error if the codec isn't available.
+std::string compress(const std::string& raw, Codec, const CompressionDictionary* dictionary = nullptr);
+
+/// Inverse of the above. `dictionary` must be the one whose ID `getDictionaryID()` reports for `compressed`.
+std::string decompress(const std::string& compressed, Codec, const CompressionDictionary* dictionary = nullptr);
+
+/// The ID of the dictionary a Zstandard frame was compressed with, or 0 if it was compressed without one.
+uint32_t getDictionaryID(const std::string& compressed) noexcept;
+
+/// A Zstandard dictionary. Tiles of one source repeat the same layer names, keys and values, which are too
+/// small to compress well within a single tile; a dictionary trained on a sample of them supplies that context.
+class CompressionDictionary {
+public:
+    /// Wraps dictionary data produced by `train()`.
+    explicit CompressionDictionary(std::string data);
+    ~CompressionDictionary();
+
+    /// Trains a dictionary of at most `maxSize` bytes on uncompressed sample payloads. Returns nullptr if Zstandard
+    /// isn't available or the samples are too few or too small to train on.
+    static std::shared_ptr<const CompressionDictionary> train(const std::vector<std::string>& samples,
+                                                              std::size_t maxSize = 110 * 1024);
+
+    /// The ID recorded in the header of every frame compressed with this dictionary; never 0.
+    uint32_t getID() const { return id; }
+    const std::string& getData() const { return data; }
+
+private:
+    friend std::string compress(const std::string&, Codec, const CompressionDictionary*);
+    friend std::string decompress(const std::string&, Codec, const CompressionDictionary*);
+
+    struct Impl;
+
+    std::string data;
+    uint32_t id;
+    std::unique_ptr<Impl> impl;
+};
+
 std::uint32_t crc32(const void* raw, size_t size) noexcept;
 
 } // namespace util
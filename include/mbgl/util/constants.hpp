@@ -46,6 +46,12 @@ constexpr uint8_t DEFAULT_PREFETCH_ZOOM_DELTA = 4;
 
 constexpr uint64_t DEFAULT_MAX_CACHE_SIZE = 50 * 1024 * 1024;
 
+// Memory for deserialized PMTiles directories, shared by all archives of a file source.
+constexpr uint64_t DEFAULT_PMTILES_DIRECTORY_CACHE_SIZE = 16 * 1024 * 1024;
+
+// Memory for tiles kept around after leaving the viewport, per source.
+constexpr std::size_t DEFAULT_TILE_CACHE_SIZE = 64 * 1024 * 1024;
+
 // Default ImageManager's cache size for images added via onStyleImageMissing API.
 // Average sprite size with 1.0 pixel ratio is ~2kB, 8kB for pixel ratio of 2.0.
 constexpr std::size_t DEFAULT_ON_DEMAND_IMAGES_CACHE_SIZE = 100 * 8192;
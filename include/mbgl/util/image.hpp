@@ -4,6 +4,7 @@
 #include <mbgl/util/geometry.hpp>
 #include <mbgl/util/size.hpp>
 
+#include <cstdint>
 #include <string>
 #include <cstring>
 #include <memory>
@@ -175,8 +176,33 @@ using UnassociatedImage = Image<ImageAlphaMode::Unassociated>;
 using PremultipliedImage = Image<ImageAlphaMode::Premultiplied>;
 using AlphaImage = Image<ImageAlphaMode::Exclusive>;
 
+/// Trade-offs for encodePNG(). The defaults give small files at moderate speed.
+struct PNGEncodeOptions {
+    /// Per-row filters that predict each byte from its neighbours before compression
+    enum class Filter : uint8_t {
+        None,
+        Sub,
+        Up,
+        Average,
+        Paeth,
+        /// Picks a filter for each row, as libpng does by default. Smaller, slower output.
+        Adaptive,
+    };
+
+    /// zlib compression level from 0 (store only) to 9 (smallest), or -1 for the default of 6
+    int compressionLevel = -1;
+    Filter filter = Filter::None;
+    /// Writes an indexed image with a palette if the image has no more than 256 colors, which maps rendered with few
+    /// colors often have. Images with more colors are written as RGBA, unchanged.
+    bool palette = false;
+    /// Compresses this many parts of the image data at once on the thread pool, as independent deflate blocks in
+    /// a single stream. Parts are at least 128 KiB, so small images use fewer threads.
+    std::size_t threads = 1;
+};
+
 // TODO: don't use std::string for binary data.
 PremultipliedImage decodeImage(const std::string&);
 std::string encodePNG(const PremultipliedImage&);
+std::string encodePNG(const PremultipliedImage&, const PNGEncodeOptions&);
 
 } // namespace mbgl
@@ -2,9 +2,25 @@
 
 #include <mbgl/util/image.hpp>
 
+#include <cstdint>
+
 namespace mbgl {
 namespace util {
 
+/// Instruction sets that premultiply() and unpremultiply() can use. They default to the fastest one the CPU
+/// supports; all of them give exactly the same output.
+enum class PixelKernels : uint8_t {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+bool isSupported(PixelKernels) noexcept;
+PixelKernels getPixelKernels() noexcept;
+/// For comparing kernels in tests and benchmarks. Throws std::invalid_argument if the kernels aren't supported.
+void setPixelKernels(PixelKernels);
+
 PremultipliedImage premultiply(UnassociatedImage&&);
 UnassociatedImage unpremultiply(PremultipliedImage&&);
 
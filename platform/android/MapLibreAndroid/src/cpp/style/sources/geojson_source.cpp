@@ -290,7 +290,7 @@ void FeatureConverter::convertJson(std::shared_ptr<std::string> json, ActorRef<G
     }
 
     callback.invoke(&GeoJSONDataCallback::operator(),
-                    style::GeoJSONData::create(*converted, sequencedScheduler, options));
+                    style::GeoJSONData::create(std::move(*converted), sequencedScheduler, options));
 }
 
 template <class JNIType>
@@ -4,11 +4,16 @@
 #include <mbgl/gfx/rendering_stats.hpp>
 #include <mbgl/map/camera.hpp>
 #include <mbgl/renderer/renderer_frontend.hpp>
+#include <mbgl/tile/tile_id.hpp>
 #include <mbgl/util/async_task.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace mbgl {
 
@@ -23,6 +28,25 @@ public:
         gfx::RenderingStats stats;
     };
 
+    /// Encodes a frame of `renderBatch()`, e.g. with `encodePNG()`. Runs on the thread pool.
+    using BatchEncoder = std::function<std::string(const PremultipliedImage&)>;
+    /// Receives the encoded frames of `renderBatch()` on the calling thread, in the order of the cameras.
+    using BatchOutput = std::function<void(std::size_t index, std::string encoded)>;
+
+    /// A tile cut out of the frame of `renderMetatile()`
+    struct TileImage {
+        CanonicalTileID id;
+        PremultipliedImage image;
+    };
+
+    struct BatchStats {
+        std::size_t frames = 0;
+        /// Wall time from the first render to the last output, including encoding
+        std::chrono::duration<double> elapsed{0};
+
+        double framesPerSecond() const { return elapsed.count() > 0 ? frames / elapsed.count() : 0; }
+    };
+
     HeadlessFrontend(float pixelRatio_,
                      gfx::HeadlessBackend::SwapBehaviour swapBehavior = gfx::HeadlessBackend::SwapBehaviour::NoFlush,
                      gfx::ContextMode mode = gfx::ContextMode::Unique,
@@ -32,7 +56,8 @@ public:
                      gfx::HeadlessBackend::SwapBehaviour swapBehavior = gfx::HeadlessBackend::SwapBehaviour::NoFlush,
                      gfx::ContextMode mode = gfx::ContextMode::Unique,
                      const std::optional<std::string>& localFontFamily = std::nullopt,
-                     bool invalidateOnUpdate_ = true);
+                     bool invalidateOnUpdate_ = true,
+                     std::shared_ptr<Scheduler> threadPool = {});
     ~HeadlessFrontend() override;
 
     void reset() override;
@@ -57,6 +82,25 @@ public:
 
     PremultipliedImage readStillImage();
     RenderResult render(Map&);
+
+    /// Renders a still image from each camera with the same map, back to back. Each image is read back as soon as it
+    /// is rendered and encoded on the thread pool while the next one renders. At most `maxPendingFrames` frames are
+    /// held in memory awaiting encoding or output. Rethrows errors from rendering and encoding once the frames in
+    /// flight are done.
+    BatchStats renderBatch(Map&,
+                           const std::vector<CameraOptions>&,
+                           const BatchEncoder&,
+                           const BatchOutput&,
+                           std::size_t maxPendingFrames = 4);
+
+    /// Renders the block of `size` by `size` raster tiles of `tileSize` logical pixels whose top left tile is
+    /// `topLeft` as a single still frame, and cuts the frame into tile images, row by row, on the thread pool.
+    /// Sources are loaded and symbols placed once for the whole block, so labels run across the tile edges inside
+    /// it. `buffer` pixels are rendered around the block and cut off, so that labels along its outer edges are placed
+    /// as they would be in a larger map. The block ends at the edges of the world. Leaves the frontend and the map
+    /// at the size of the frame, with the camera over the block.
+    std::vector<TileImage> renderMetatile(
+        Map&, const CanonicalTileID& topLeft, uint32_t size, uint32_t tileSize = 256, uint32_t buffer = 0);
     void renderOnce(Map&);
     void renderFrame();
 
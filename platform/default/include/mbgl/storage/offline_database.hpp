@@ -2,7 +2,9 @@
 
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/offline.hpp>
+#include <mbgl/storage/resource_options.hpp>
 #include <mbgl/util/tile_server_options.hpp>
+#include <mbgl/util/compression.hpp>
 #include <mbgl/util/exception.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/mapbox.hpp>
@@ -11,6 +13,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <optional>
 
@@ -39,7 +42,36 @@ struct MapboxTileLimitExceededException : util::Exception {
 
 class OfflineDatabase {
 public:
-    OfflineDatabase(std::string path, const TileServerOptions& options);
+    // How the database currently encodes stored payloads. Copies may be used
+    // on any thread, which lets writers compress data before handing it to
+    // putRegionResources().
+    struct Encoder {
+        util::Codec codec = util::Codec::None;
+        std::shared_ptr<const util::CompressionDictionary> dictionary;
+
+        // Encoding with the codec, unless that doesn't make the data any
+        // smaller, in which case the codec is None and the string is empty.
+        std::pair<std::string, util::Codec> encode(const std::string&) const;
+    };
+
+    // A region resource whose response data was encoded by an Encoder.
+    struct EncodedResource {
+        Resource resource;
+        Response response;
+        std::pair<std::string, util::Codec> data;
+    };
+
+    // Batched writes are committed once this many are queued, or when the oldest one is this old.
+    static constexpr std::size_t maxPendingWrites = 64;
+    static constexpr Duration maxPendingWriteAge = Milliseconds(500);
+
+    // Number of tiles sampled to train a compression dictionary.
+    static constexpr int64_t maxDictionarySamples = 2000;
+
+    OfflineDatabase(std::string path,
+                    const TileServerOptions& options,
+                    CacheDurability durability = CacheDurability::Full,
+                    util::Codec codec = util::Codec::Zlib);
     ~OfflineDatabase();
 
     void changePath(const std::string&);
@@ -47,9 +79,17 @@ public:
 
     std::optional<Response> get(const Resource&);
 
-    // Return value is (inserted, stored size)
+    // Return value is (inserted, stored size). Unless the durability is
+    // `CacheDurability::Full`, the write is only queued and the returned
+    // size is the uncompressed size of the response.
     std::pair<bool, uint64_t> put(const Resource&, const Response&);
 
+    // Commit the queued ambient cache writes and access times in one
+    // transaction. Called periodically by the owner of the database;
+    // operations other than get() and put() flush on their own.
+    void flushPendingWrites();
+    bool hasPendingWrites() const;
+
     // Force Mapbox GL Native to revalidate tiles stored in the ambient
     // cache with the tile server before using them, making sure they
     // are the latest version. This is more efficient than cleaning the
@@ -81,6 +121,8 @@ public:
     std::optional<int64_t> hasRegionResource(const Resource&);
     uint64_t putRegionResource(int64_t regionID, const Resource&, const Response&);
     void putRegionResources(int64_t regionID, const std::list<std::tuple<Resource, Response>>&, OfflineRegionStatus&);
+    void putRegionResources(int64_t regionID, const std::list<EncodedResource>&, OfflineRegionStatus&);
+    Encoder getEncoder() const;
 
     expected<OfflineRegionDefinition, std::exception_ptr> getRegionDefinition(int64_t regionID);
     expected<OfflineRegionStatus, std::exception_ptr> getRegionCompletedStatus(int64_t regionID);
@@ -93,6 +135,12 @@ public:
     bool exceedsOfflineMapboxTileCountLimit(const Resource&);
     void markUsedResources(int64_t regionID, const std::list<Resource>&);
     std::exception_ptr pack();
+
+    // Train a Zstandard dictionary on a sample of the stored tiles, and
+    // recompress all tiles with it. Tiles and resources written later use it
+    // too. Requires the database to be opened with `util::Codec::Zstd`.
+    std::exception_ptr trainCompressionDictionary();
+
     void runPackDatabaseAutomatically(bool autopack_) { autopack = autopack_; }
 
     void reopenDatabaseReadOnly(bool readOnly);
@@ -101,6 +149,8 @@ private:
     class DatabaseSizeChangeStats;
 
     void initialize();
+    void applyDurability();
+    bool batchesWrites() const { return durability != CacheDurability::Full; }
     void handleError(const mapbox::sqlite::Exception&, const char* action);
     void handleError(const util::IOException&, const char* action);
     void handleError(const std::runtime_error& ex, const char* action);
@@ -112,6 +162,8 @@ private:
     void migrateToVersion5();
     void migrateToVersion3();
     void migrateToVersion6();
+    void migrateToVersion7();
+    void loadDictionaries();
     void cleanup();
     bool disabled();
     void vacuum();
@@ -119,19 +171,36 @@ private:
 
     mapbox::sqlite::Statement& getStatement(const char*);
 
+    void updateTileAccessed(const Resource::TileData&, Timestamp);
+    void updateResourceAccessed(const std::string& url, Timestamp);
+
+    std::pair<bool, uint64_t> queueWrite(const Resource&, const Response&);
+    void flushPendingWritesIfDue();
+    void discardPendingWrites();
+    std::optional<std::pair<Response, uint64_t>> getPendingWrite(const std::string& key) const;
+
     std::optional<std::pair<Response, uint64_t>> getTile(const Resource::TileData&);
     std::optional<int64_t> hasTile(const Resource::TileData&);
-    bool putTile(const Resource::TileData&, const Response&, const std::string&, bool compressed);
+    bool putTile(const Resource::TileData&, const Response&, const std::string&, util::Codec);
 
     std::optional<std::pair<Response, uint64_t>> getResource(const Resource&);
     std::optional<int64_t> hasResource(const Resource&);
-    bool putResource(const Resource&, const Response&, const std::string&, bool compressed);
+    bool putResource(const Resource&, const Response&, const std::string&, util::Codec);
+
+    std::string decompress(const std::string&, int64_t codec) const;
 
-    uint64_t putRegionResourceInternal(int64_t regionID, const Resource&, const Response&);
+    uint64_t putRegionResourceInternal(int64_t regionID,
+                                       const Resource&,
+                                       const Response&,
+                                       const std::pair<std::string, util::Codec>* encoded = nullptr);
 
     std::optional<std::pair<Response, uint64_t>> getInternal(const Resource&);
     std::optional<int64_t> hasInternal(const Resource&);
-    std::pair<bool, uint64_t> putInternal(const Resource&, const Response&, bool evict);
+    // Stores `encoded` if given, and otherwise encodes the response data itself.
+    std::pair<bool, uint64_t> putInternal(const Resource&,
+                                          const Response&,
+                                          bool evict,
+                                          const std::pair<std::string, util::Codec>* encoded = nullptr);
 
     // Return value is true iff the resource was previously unused by any other regions.
     bool markUsed(int64_t regionID, const Resource&);
@@ -186,6 +255,25 @@ private:
 
     bool autopack = true;
     bool readOnly = false;
+
+    CacheDurability durability;
+    util::Codec codec;
+
+    // Compression dictionaries stored in the database, by ID. New data is
+    // compressed with the most recent one.
+    std::map<uint32_t, std::shared_ptr<const util::CompressionDictionary>> dictionaries;
+    std::shared_ptr<const util::CompressionDictionary> currentDictionary;
+
+    // Ambient cache writes and access time updates waiting for the next
+    // batch, keyed by the tile or resource they apply to.
+    struct PendingWrite {
+        Resource resource;
+        Response response;
+    };
+    std::map<std::string, PendingWrite> pendingWrites;
+    std::map<std::string, Resource::TileData> pendingTileAccesses;
+    std::set<std::string> pendingResourceAccesses;
+    std::optional<TimePoint> pendingSince;
 };
 
 } // namespace mbgl
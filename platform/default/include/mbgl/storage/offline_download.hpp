@@ -2,7 +2,11 @@
 
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/storage/offline.hpp>
+#include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/resource.hpp>
+#include <mbgl/util/chrono.hpp>
+
+#include <mapbox/std/weak.hpp>
 
 #include <list>
 #include <unordered_set>
@@ -11,11 +15,11 @@
 
 namespace mbgl {
 
-class OfflineDatabase;
 class FileSource;
 class AsyncRequest;
 class Response;
 class Tileset;
+class Scheduler;
 
 namespace style {
 class Parser;
@@ -23,6 +27,10 @@ class Parser;
 
 /**
  * Coordinates the request and storage of all resources for an offline region.
+ *
+ * Tile resources are generated from the region's tile cover as requests go
+ * out, and responses are compressed in batches on a background thread before
+ * they are written to the database, while the next requests are in flight.
 
  * @private
  */
@@ -40,7 +48,9 @@ private:
     void activateDownload();
     void continueDownload();
     void deactivateDownload();
-    bool flushResourcesBuffer();
+    void flushResourcesBuffer();
+    void writeResources(const std::list<OfflineDatabase::EncodedResource>&);
+    OfflineRegionDownloadMetrics getMetrics() const;
 
     /*
      * Ensure that the resource is stored in the database, requesting it if necessary.
@@ -58,15 +68,32 @@ private:
     OfflineRegionStatus status;
     std::unique_ptr<OfflineRegionObserver> observer;
 
+    class TileGenerator;
+
     std::list<std::unique_ptr<AsyncRequest>> requests;
     std::set<std::string> requiredSourceURLs;
     std::deque<Resource> resourcesRemaining;
+    std::deque<std::unique_ptr<TileGenerator>> tilesRemaining;
     std::list<Resource> resourcesToBeMarkedAsUsed;
     std::list<std::tuple<Resource, Response>> buffer;
 
+    // Batches taken from `buffer` that are being encoded, and the number of
+    // resources in them. Incrementing `generation` drops the batches of an
+    // earlier activation when they come back.
+    std::shared_ptr<Scheduler> encodeScheduler;
+    std::size_t pendingBatches = 0;
+    std::size_t pendingWrites = 0;
+    uint64_t generation = 0;
+    TimePoint activated;
+
+    bool hasResourcesRemaining();
+    Resource nextResource();
     void queueResource(Resource&&);
     void queueTiles(style::SourceType, uint16_t tileSize, const Tileset&);
     void markPendingUsedResources();
+
+    mapbox::base::WeakPtrFactory<OfflineDownload> weakFactory{this};
+    // Do not add members here, see `WeakPtrFactory`
 };
 
 } // namespace mbgl
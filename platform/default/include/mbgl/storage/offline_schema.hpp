@@ -50,6 +50,11 @@ static constexpr const char* offlineDatabaseSchema =
     "  tile_id INTEGER NOT NULL REFERENCES tiles(id),\n"
     "  UNIQUE (region_id, tile_id)\n"
     ");\n"
+    "CREATE TABLE dictionaries (\n"
+    "  id INTEGER NOT NULL PRIMARY KEY,\n"
+    "  created INTEGER NOT NULL,\n"
+    "  data BLOB NOT NULL\n"
+    ");\n"
     "CREATE INDEX resources_accessed\n"
     "ON resources (accessed);\n"
     "CREATE INDEX tiles_accessed\n"
@@ -29,10 +29,15 @@ CREATE TABLE resources (
 
   data BLOB,                                       -- Contents of the resource.
 
-  compressed INTEGER NOT NULL DEFAULT 0,           -- If the resource is compressed with Deflate or not. Compression is
-                                                   -- optional and should be used when the compression ratio is
-                                                   -- significant. Using compression will make decoding time slower
-                                                   -- because it will add an extra decompression step.
+  compressed INTEGER NOT NULL DEFAULT 0,           -- Codec the resource is compressed with, taken from the
+                                                   -- util::Codec enumeration:
+                                                   -- none = 0
+                                                   -- zlib = 1
+                                                   -- zstd = 2 (possibly with one of the dictionaries below)
+                                                   -- Compression is optional and should be used when the
+                                                   -- compression ratio is significant. Using compression will make
+                                                   -- decoding time slower because it will add an extra
+                                                   -- decompression step.
 
   accessed INTEGER NOT NULL,                       -- Last time the resource was used by GL Native. Useful for when
                                                    -- evicting the least used resources from the cache.
@@ -74,10 +79,15 @@ CREATE TABLE tiles (
 
   data BLOB,                                       -- Contents of the tile.
 
-  compressed INTEGER NOT NULL DEFAULT 0,           -- If the tile is compressed with Deflate or not. Compression is
-                                                   -- optional and should be used when the compression ratio is
-                                                   -- significant. Using compression will make decoding time slower
-                                                   -- because it will add an extra decompression step.
+  compressed INTEGER NOT NULL DEFAULT 0,           -- Codec the tile is compressed with, taken from the
+                                                   -- util::Codec enumeration:
+                                                   -- none = 0
+                                                   -- zlib = 1
+                                                   -- zstd = 2 (possibly with one of the dictionaries below)
+                                                   -- Compression is optional and should be used when the
+                                                   -- compression ratio is significant. Using compression will make
+                                                   -- decoding time slower because it will add an extra
+                                                   -- decompression step.
 
   accessed INTEGER NOT NULL,                       -- Last time the tile was used by GL Native. Useful for when
                                                    -- evicting the least used tiles from the cache.
@@ -148,6 +158,20 @@ CREATE TABLE region_tiles (
   UNIQUE (region_id, tile_id)
 );
 
+--
+-- Zstandard dictionaries trained on the tiles of this database.
+-- Every compressed frame records the ID of the dictionary it
+-- needs; new tiles and resources are compressed with the most
+-- recently created one.
+--
+CREATE TABLE dictionaries (
+  id INTEGER NOT NULL PRIMARY KEY,                  -- Dictionary ID, as recorded in the header of the dictionary.
+
+  created INTEGER NOT NULL,                         -- When the dictionary was trained.
+
+  data BLOB NOT NULL                                -- Contents of the dictionary.
+);
+
 --
 -- Indexes for efficient eviction queries.
 --
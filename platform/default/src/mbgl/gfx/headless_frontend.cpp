@@ -7,10 +7,31 @@
 #include <mbgl/renderer/renderer_state.hpp>
 #include <mbgl/renderer/update_parameters.hpp>
 #include <mbgl/util/monotonic_timer.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
+#include <mbgl/util/projection.hpp>
 #include <mbgl/util/run_loop.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 namespace mbgl {
 
+namespace {
+
+/// Frames of a batch on their way from the encoding tasks back to the rendering thread
+struct EncodedFrames {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::size_t, std::string> frames;
+    std::size_t finished = 0;
+    std::exception_ptr error;
+};
+
+} // namespace
+
 HeadlessFrontend::HeadlessFrontend(float pixelRatio_,
                                    gfx::HeadlessBackend::SwapBehaviour swapBehavior,
                                    const gfx::ContextMode contextMode,
@@ -22,7 +43,8 @@ HeadlessFrontend::HeadlessFrontend(Size size_,
                                    gfx::HeadlessBackend::SwapBehaviour swapBehavior,
                                    const gfx::ContextMode contextMode,
                                    const std::optional<std::string>& localFontFamily,
-                                   bool invalidateOnUpdate_)
+                                   bool invalidateOnUpdate_,
+                                   std::shared_ptr<Scheduler> threadPool)
     : size(size_),
       pixelRatio(pixelRatio_),
       frameTime(0),
@@ -31,8 +53,13 @@ HeadlessFrontend::HeadlessFrontend(Size size_,
           swapBehavior,
           contextMode)),
       asyncInvalidate([this] { renderFrame(); }),
-      invalidateOnUpdate(invalidateOnUpdate_),
-      renderer(std::make_unique<Renderer>(*getBackend(), pixelRatio, localFontFamily)) {}
+      invalidateOnUpdate(invalidateOnUpdate_) {
+    // The renderer picks up the backend's pool, so it has to be swapped in first
+    if (threadPool) {
+        getBackend()->setThreadPool(std::move(threadPool));
+    }
+    renderer = std::make_unique<Renderer>(*getBackend(), pixelRatio, localFontFamily);
+}
 
 HeadlessFrontend::~HeadlessFrontend() = default;
 
@@ -157,6 +184,147 @@ HeadlessFrontend::RenderResult HeadlessFrontend::render(Map& map) {
     return result;
 }
 
+HeadlessFrontend::BatchStats HeadlessFrontend::renderBatch(Map& map,
+                                                           const std::vector<CameraOptions>& cameras,
+                                                           const BatchEncoder& encode,
+                                                           const BatchOutput& output,
+                                                           std::size_t maxPendingFrames) {
+    assert(encode && output);
+    maxPendingFrames = std::max<std::size_t>(maxPendingFrames, 1);
+
+    auto encoded = std::make_shared<EncodedFrames>();
+    std::size_t scheduled = 0;
+    std::size_t written = 0;
+
+    // Outputs the frames that are ready in order. With `wait`, blocks until the next one is.
+    const auto writeFrames = [&](bool wait) {
+        std::unique_lock lock(encoded->mutex);
+        while (!encoded->error) {
+            auto it = encoded->frames.find(written);
+            if (it == encoded->frames.end()) {
+                if (!wait) {
+                    return;
+                }
+                encoded->cv.wait(lock);
+                continue;
+            }
+            std::string frame = std::move(it->second);
+            encoded->frames.erase(it);
+            lock.unlock();
+            output(written++, std::move(frame));
+            wait = false;
+            lock.lock();
+        }
+        std::rethrow_exception(encoded->error);
+    };
+
+    const auto start = util::MonotonicTimer::now();
+    try {
+        for (const auto& camera : cameras) {
+            map.jumpTo(camera);
+            auto image = std::make_shared<PremultipliedImage>(render(map).image);
+
+            // `encode` is borrowed; this doesn't return before all tasks are finished
+            getThreadPool().schedule([encoded, &encode, image, index = scheduled] {
+                std::string frame;
+                std::exception_ptr error;
+                try {
+                    frame = encode(*image);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::scoped_lock lock(encoded->mutex);
+                if (error && !encoded->error) {
+                    encoded->error = error;
+                }
+                encoded->frames.emplace(index, std::move(frame));
+                encoded->finished++;
+                encoded->cv.notify_all();
+            });
+            scheduled++;
+
+            writeFrames(false);
+            while (scheduled - written >= maxPendingFrames) {
+                writeFrames(true);
+            }
+        }
+        while (written < scheduled) {
+            writeFrames(true);
+        }
+    } catch (...) {
+        std::unique_lock lock(encoded->mutex);
+        encoded->cv.wait(lock, [&] { return encoded->finished == scheduled; });
+        throw;
+    }
+
+    return {written, util::MonotonicTimer::now() - start};
+}
+
+std::vector<HeadlessFrontend::TileImage> HeadlessFrontend::renderMetatile(
+    Map& map, const CanonicalTileID& topLeft, uint32_t size_, uint32_t tileSize, uint32_t buffer) {
+    const uint32_t worldTiles = 1u << topLeft.z;
+    const uint32_t columns = std::min(size_, worldTiles - topLeft.x);
+    const uint32_t rows = std::min(size_, worldTiles - topLeft.y);
+    if (columns == 0 || rows == 0) {
+        return {};
+    }
+
+    const Size frameSize{columns * tileSize + 2 * buffer, rows * tileSize + 2 * buffer};
+    setSize(frameSize);
+    map.setSize(frameSize);
+
+    // The buffer reaches past the poles and the antimeridian at the edges of the world, which the map may not
+    // show unless unconstrained.
+    const auto constrainMode = map.getMapOptions().constrainMode();
+    map.setConstrainMode(ConstrainMode::None);
+    const double scale = std::ldexp(static_cast<double>(tileSize) / util::tileSize_D, topLeft.z);
+    const Point<double> center{(topLeft.x + columns / 2.0) * tileSize, (topLeft.y + rows / 2.0) * tileSize};
+    map.jumpTo(CameraOptions()
+                   .withCenter(Projection::unproject(center, scale))
+                   .withZoom(std::log2(scale))
+                   .withBearing(0.0)
+                   .withPitch(0.0));
+    PremultipliedImage frame;
+    try {
+        frame = render(map).image;
+    } catch (...) {
+        map.setConstrainMode(constrainMode);
+        throw;
+    }
+    map.setConstrainMode(constrainMode);
+
+    const auto tilePixels = static_cast<uint32_t>(tileSize * pixelRatio);
+    std::vector<TileImage> tiles;
+    tiles.reserve(columns * rows);
+    for (uint32_t row = 0; row < rows; ++row) {
+        for (uint32_t column = 0; column < columns; ++column) {
+            tiles.push_back({CanonicalTileID(topLeft.z, topLeft.x + column, topLeft.y + row),
+                             PremultipliedImage({tilePixels, tilePixels})});
+        }
+    }
+
+    // Copy the tiles out of the frame, one row of tiles per job
+    const auto bufferPixels = static_cast<uint32_t>(buffer * pixelRatio);
+    const auto& threadPool = getThreadPool();
+    ParallelJobs::run(
+        rows,
+        [&](std::size_t row) {
+            for (uint32_t column = 0; column < columns; ++column) {
+                auto& tile = tiles[row * columns + column];
+                PremultipliedImage::copy(
+                    frame,
+                    tile.image,
+                    {bufferPixels + column * tilePixels, bufferPixels + static_cast<uint32_t>(row) * tilePixels},
+                    {0, 0},
+                    tile.image.size);
+            }
+        },
+        *threadPool.get(),
+        threadPool.tag);
+
+    return tiles;
+}
+
 void HeadlessFrontend::renderOnce(Map&) {
     util::RunLoop::Get()->runOnce();
 }
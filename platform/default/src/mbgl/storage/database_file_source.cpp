@@ -11,6 +11,7 @@
 #include <mbgl/util/logging.hpp>
 #include <mbgl/util/platform.hpp>
 #include <mbgl/util/thread.hpp>
+#include <mbgl/util/timer.hpp>
 
 #include <map>
 #include <utility>
@@ -18,9 +19,20 @@
 namespace mbgl {
 class DatabaseFileSourceThread {
 public:
-    DatabaseFileSourceThread(std::shared_ptr<FileSource> onlineFileSource_, const std::string& cachePath)
-        : db(std::make_unique<OfflineDatabase>(cachePath, onlineFileSource_->getResourceOptions().tileServerOptions())),
-          onlineFileSource(std::move(onlineFileSource_)) {}
+    DatabaseFileSourceThread(std::shared_ptr<FileSource> onlineFileSource_,
+                             const std::string& cachePath,
+                             CacheDurability durability,
+                             util::Codec codec)
+        : db(std::make_unique<OfflineDatabase>(
+              cachePath, onlineFileSource_->getResourceOptions().tileServerOptions(), durability, codec)),
+          onlineFileSource(std::move(onlineFileSource_)) {
+        if (durability != CacheDurability::Full) {
+            // Commit queued writes even when no further requests come in to trigger it.
+            flushTimer.start(OfflineDatabase::maxPendingWriteAge, OfflineDatabase::maxPendingWriteAge, [this] {
+                db->flushPendingWrites();
+            });
+        }
+    }
 
     void request(const Resource& resource, const ActorRef<FileSourceRequest>& req) {
         std::optional<Response> offlineResponse = (resource.storagePolicy != Resource::StoragePolicy::Volatile)
@@ -56,6 +68,10 @@ public:
 
     void packDatabase(const std::function<void(std::exception_ptr)>& callback) { callback(db->pack()); }
 
+    void trainCompressionDictionary(const std::function<void(std::exception_ptr)>& callback) {
+        callback(db->trainCompressionDictionary());
+    }
+
     void runPackDatabaseAutomatically(bool autopack) { db->runPackDatabaseAutomatically(autopack); }
 
     void put(const Resource& resource, const Response& response) { db->put(resource, response); }
@@ -155,6 +171,7 @@ private:
     std::unique_ptr<OfflineDatabase> db;
     std::map<int64_t, std::unique_ptr<OfflineDownload>> downloads;
     std::shared_ptr<FileSource> onlineFileSource;
+    util::Timer flushTimer;
 };
 
 class DatabaseFileSource::Impl {
@@ -166,7 +183,9 @@ public:
               util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_DATABASE),
               "DatabaseFileSource",
               std::move(onlineFileSource),
-              resourceOptions_.cachePath())),
+              resourceOptions_.cachePath(),
+              resourceOptions_.cacheDurability(),
+              resourceOptions_.cacheCodec())),
           resourceOptions(resourceOptions_.clone()),
           clientOptions(clientOptions_.clone()) {}
 
@@ -245,6 +264,10 @@ void DatabaseFileSource::packDatabase(std::function<void(std::exception_ptr)> ca
     impl->actor().invoke(&DatabaseFileSourceThread::packDatabase, std::move(callback));
 }
 
+void DatabaseFileSource::trainCompressionDictionary(std::function<void(std::exception_ptr)> callback) {
+    impl->actor().invoke(&DatabaseFileSourceThread::trainCompressionDictionary, std::move(callback));
+}
+
 void DatabaseFileSource::runPackDatabaseAutomatically(bool autopack) {
     impl->actor().invoke(&DatabaseFileSourceThread::runPackDatabaseAutomatically, autopack);
 }
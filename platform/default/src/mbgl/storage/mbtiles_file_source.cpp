@@ -28,6 +28,24 @@
 #endif
 
 namespace {
+// Tile reads are independent of each other, but sqlite connections are not thread-safe,
+// so each reader thread has its own
+constexpr std::size_t defaultReaderThreadCount = 4;
+
+std::size_t readerThreadCount() {
+    auto value = mbgl::platform::Settings::getInstance().get(mbgl::platform::EXPERIMENTAL_MBTILES_READER_THREADS);
+    if (auto *count = value.getUint(); count && *count > 0) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto *count = value.getInt(); count && *count > 0) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto *count = value.getDouble(); count && *count >= 1.0) {
+        return static_cast<std::size_t>(*count);
+    }
+    return defaultReaderThreadCount;
+}
+
 bool acceptsURL(const std::string &url) {
     return url.starts_with(mbgl::util::MBTILES_PROTOCOL);
 }
@@ -35,6 +53,10 @@ bool acceptsURL(const std::string &url) {
 std::string url_to_path(const std::string &url) {
     return mbgl::util::percentDecode(url.substr(std::char_traits<char>::length(mbgl::util::MBTILES_PROTOCOL)));
 }
+
+std::string db_path(const std::string &path) {
+    return path.substr(0, path.find('?'));
+}
 } // namespace
 
 namespace mbgl {
@@ -70,14 +92,25 @@ public:
         return std::string(buffer.GetString(), buffer.GetSize());
     }
 
-    std::string db_path(const std::string &path) { return path.substr(0, path.find('?')); }
-
     // Generate a tilejson resource from .mbtiles file
     void request_tilejson(const Resource &resource, ActorRef<FileSourceRequest> req) {
         const auto path = url_to_path(resource.url);
 
         Response response;
 
+        // Styles usually ask for the same archives again, reuse the TileJSON while the file is unchanged
+        struct stat file;
+        const bool hasFileStat = stat(path.c_str(), &file) == 0;
+        if (hasFileStat) {
+            const auto cached = tilejson_cache.find(resource.url);
+            if (cached != tilejson_cache.end() && cached->second.modified == static_cast<int64_t>(file.st_mtime) &&
+                cached->second.size == static_cast<int64_t>(file.st_size)) {
+                response.data = cached->second.data;
+                req.invoke(&FileSourceRequest::setResponse, response);
+                return;
+            }
+        }
+
         Document doc;
         auto &allocator = doc.GetAllocator();
 
@@ -183,41 +216,10 @@ public:
         }
 
         response.data = std::make_shared<std::string>(serialize(doc));
-        req.invoke(&FileSourceRequest::setResponse, response);
-    }
-
-    // Load data for specific tile
-    void request_tile(const Resource &resource, ActorRef<FileSourceRequest> req) {
-        std::string base_path = url_to_path(resource.url);
-        std::string path = db_path(base_path);
-        auto &db = get_db(path);
-
-        int iy = resource.tileData->y;
-        int iz = resource.tileData->z;
-
-        auto x = std::to_string(resource.tileData->x);
-        auto y = std::to_string((int)(pow(2, iz) - 1) - iy);
-        auto z = std::to_string(iz);
-
-        std::string sql = "SELECT tile_data FROM tiles where zoom_level = " + z + " AND tile_column = " + x +
-                          " AND tile_row = " + y;
-        mapbox::sqlite::Statement stmt(db, sql.c_str());
-
-        Response response;
-        response.noContent = true;
-
-        for (mapbox::sqlite::Query q(stmt); q.run();) {
-            std::optional<std::string> data = q.get<std::optional<std::string>>(0);
-            if (data) {
-                response.data = std::make_shared<std::string>(*data);
-                response.noContent = false;
-                response.expires = Timestamp::max();
-                response.etag = resource.url;
-
-                if (util::is_compressed(*response.data)) {
-                    response.data = std::make_shared<std::string>(util::decompress(*response.data));
-                }
-            }
+        if (hasFileStat) {
+            tilejson_cache[resource.url] = {.modified = static_cast<int64_t>(file.st_mtime),
+                                            .size = static_cast<int64_t>(file.st_size),
+                                            .data = response.data};
         }
         req.invoke(&FileSourceRequest::setResponse, response);
     }
@@ -243,33 +245,78 @@ public:
     }
 
 private:
-    std::map<std::string, mapbox::sqlite::Database> db_cache;
+    struct CachedTileJSON {
+        int64_t modified;
+        int64_t size;
+        std::shared_ptr<const std::string> data;
+    };
+
+    std::map<std::string, CachedTileJSON> tilejson_cache;
 
-    void close_db(const std::string &path) {
-        auto ptr = db_cache.find(path);
-        if (ptr != db_cache.end()) {
-            db_cache.erase(path);
+    mutable std::mutex resourceOptionsMutex;
+    mutable std::mutex clientOptionsMutex;
+    ResourceOptions resourceOptions;
+    ClientOptions clientOptions;
+};
+
+class MBTilesFileSource::Reader {
+public:
+    explicit Reader(const ActorRef<Reader> &) {}
+
+    // Load data for specific tile
+    void request_tile(const Resource &resource, ActorRef<FileSourceRequest> req) {
+        auto &archive = get_archive(db_path(url_to_path(resource.url)));
+
+        const auto z = static_cast<int32_t>(resource.tileData->z);
+        const auto x = static_cast<int64_t>(resource.tileData->x);
+        const auto y = (int64_t{1} << z) - 1 - static_cast<int64_t>(resource.tileData->y);
+
+        Response response;
+        response.noContent = true;
+
+        mapbox::sqlite::Query q(archive.tileStatement);
+        q.bind(1, z);
+        q.bind(2, x);
+        q.bind(3, y);
+        while (q.run()) {
+            std::optional<std::string> data = q.get<std::optional<std::string>>(0);
+            if (data) {
+                response.data = std::make_shared<std::string>(std::move(*data));
+                response.noContent = false;
+                response.expires = Timestamp::max();
+                response.etag = resource.url;
+
+                if (util::is_compressed(*response.data)) {
+                    response.data = std::make_shared<std::string>(util::decompress(*response.data));
+                }
+            }
         }
+        req.invoke(&FileSourceRequest::setResponse, response);
     }
 
-    void close_all() { db_cache.clear(); }
+private:
+    // Read-only connection with the tile query prepared once
+    struct Archive {
+        explicit Archive(const std::string &path)
+            : db(mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly)),
+              tileStatement(db,
+                            "SELECT tile_data FROM tiles "
+                            "WHERE zoom_level = ?1 AND tile_column = ?2 AND tile_row = ?3") {}
+
+        mapbox::sqlite::Database db;
+        mapbox::sqlite::Statement tileStatement;
+    };
 
     // Multiple databases open simultaneously, to effectively support multiple .mbtiles maps
-    mapbox::sqlite::Database &get_db(const std::string &path) {
-        auto ptr = db_cache.find(path);
-        if (ptr != db_cache.end()) {
-            return ptr->second;
-        };
-
-        auto ptr2 = db_cache.insert(std::pair<std::string, mapbox::sqlite::Database>(
-            path, mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly)));
-        return ptr2.first->second;
+    Archive &get_archive(const std::string &path) {
+        auto it = archives.find(path);
+        if (it == archives.end()) {
+            it = archives.emplace(path, std::make_unique<Archive>(path)).first;
+        }
+        return *it->second;
     }
 
-    mutable std::mutex resourceOptionsMutex;
-    mutable std::mutex clientOptionsMutex;
-    ResourceOptions resourceOptions;
-    ClientOptions clientOptions;
+    std::map<std::string, std::unique_ptr<Archive>> archives;
 };
 
 MBTilesFileSource::MBTilesFileSource(const ResourceOptions &resourceOptions, const ClientOptions &clientOptions)
@@ -277,14 +324,26 @@ MBTilesFileSource::MBTilesFileSource(const ResourceOptions &resourceOptions, con
           util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE),
           "MBTilesFileSource",
           resourceOptions.clone(),
-          clientOptions.clone())) {}
+          clientOptions.clone())),
+      readerCount(readerThreadCount()) {}
+
+util::Thread<MBTilesFileSource::Reader> &MBTilesFileSource::nextReaderThread() {
+    std::scoped_lock lock(readersMutex);
+    const auto index = nextReader++ % readerCount;
+    if (index == readers.size()) {
+        // Sources that are never asked for tiles, or only for a few at a time, don't need every thread
+        readers.push_back(std::make_unique<util::Thread<Reader>>(
+            util::makeThreadPrioritySetter(platform::EXPERIMENTAL_THREAD_PRIORITY_FILE), "MBTilesReader"));
+    }
+    return *readers[index];
+}
 
 std::unique_ptr<AsyncRequest> MBTilesFileSource::request(const Resource &resource, FileSource::Callback callback) {
     auto req = std::make_unique<FileSourceRequest>(std::move(callback));
 
     // assume if there is a tile request, that the mbtiles file has been validated
     if (resource.kind == Resource::Tile) {
-        thread->actor().invoke(&Impl::request_tile, resource, req->actor());
+        nextReaderThread().actor().invoke(&Reader::request_tile, resource, req->actor());
         return req;
     }
 
@@ -11,11 +11,38 @@
 #include <mbgl/storage/offline_schema.hpp>
 #include <mbgl/storage/merge_sideloaded.hpp>
 
+#include <tuple>
+
 namespace mbgl {
 
-OfflineDatabase::OfflineDatabase(std::string path_, const TileServerOptions& options)
+namespace {
+
+std::string tileKey(const Resource::TileData& tile) {
+    // A line break can't appear in the URLs used as keys for other resources.
+    return tile.urlTemplate + '\n' + std::to_string(tile.pixelRatio) + '/' + std::to_string(tile.x) + '/' +
+           std::to_string(tile.y) + '/' + std::to_string(tile.z);
+}
+
+std::string resourceKey(const Resource& resource) {
+    assert(resource.kind != Resource::Kind::Tile || resource.tileData);
+    return resource.kind == Resource::Kind::Tile ? tileKey(*resource.tileData) : resource.url;
+}
+
+} // namespace
+
+OfflineDatabase::OfflineDatabase(std::string path_,
+                                 const TileServerOptions& options,
+                                 CacheDurability durability_,
+                                 util::Codec codec_)
     : path(std::move(path_)),
-      tileServerOptions(options) {
+      tileServerOptions(options),
+      durability(durability_),
+      codec(codec_) {
+    if (!util::isAvailable(codec)) {
+        Log::Warning(Event::Database, "Cache codec not available in this build, using zlib");
+        codec = util::Codec::Zlib;
+    }
+
     try {
         initialize();
     } catch (...) {
@@ -25,6 +52,7 @@ OfflineDatabase::OfflineDatabase(std::string path_, const TileServerOptions& opt
 }
 
 OfflineDatabase::~OfflineDatabase() {
+    flushPendingWrites();
     cleanup();
 }
 
@@ -37,6 +65,7 @@ void OfflineDatabase::initialize() {
 
         db->setBusyTimeout(Milliseconds::max());
         db->exec("PRAGMA foreign_keys = ON");
+        loadDictionaries();
 
         return;
     }
@@ -53,7 +82,7 @@ void OfflineDatabase::initialize() {
             // Newly created database, or old cache-only database; remove old table if it exists.
             removeOldCacheTable();
             createSchema();
-            return;
+            break;
         case 2:
             migrateToVersion3();
             // fall through
@@ -67,17 +96,39 @@ void OfflineDatabase::initialize() {
             migrateToVersion6();
             // fall through
         case 6:
+            migrateToVersion7();
+            // fall through
+        case 7:
             // Happy path; we're done
-            return;
+            break;
         default:
             // Downgrade: delete the database and try to reinitialize.
             removeExisting();
             initialize();
+            return;
     }
+
+    applyDurability();
+    loadDictionaries();
+}
+
+void OfflineDatabase::applyDurability() {
+    assert(db);
+
+    if (!batchesWrites()) {
+        // Keep the journal mode of the file as is: switching back from a write-ahead log would block on other
+        // processes sharing it, and fully synced commits are just as durable with either journal.
+        return;
+    }
+
+    // With a write-ahead log, readers (in this and other processes) don't wait for a batch being written.
+    db->exec("PRAGMA journal_mode = WAL");
+    db->exec(durability == CacheDurability::Normal ? "PRAGMA synchronous = NORMAL" : "PRAGMA synchronous = OFF");
 }
 
 void OfflineDatabase::changePath(const std::string& path_) {
     Log::Info(Event::Database, "Changing the database path.");
+    flushPendingWrites();
     cleanup();
     path = path_;
     initialize();
@@ -88,6 +139,8 @@ void OfflineDatabase::cleanup() {
     try {
         statements.clear();
         db.reset();
+        dictionaries.clear();
+        currentDictionary.reset();
     } catch (...) {
         handleError("close database");
     }
@@ -152,6 +205,8 @@ void OfflineDatabase::removeExisting() {
 
     statements.clear();
     db.reset();
+    dictionaries.clear();
+    currentDictionary.reset();
 
     util::deleteFile(path);
 }
@@ -173,7 +228,7 @@ void OfflineDatabase::createSchema() {
     db->exec("PRAGMA synchronous = FULL");
     mapbox::sqlite::Transaction transaction(*db);
     db->exec(offlineDatabaseSchema);
-    db->exec("PRAGMA user_version = 6");
+    db->exec("PRAGMA user_version = 7");
     transaction.commit();
 }
 
@@ -215,6 +270,40 @@ void OfflineDatabase::migrateToVersion6() {
     transaction.commit();
 }
 
+void OfflineDatabase::migrateToVersion7() {
+    assert(db);
+    checkFlags();
+
+    // The `compressed` columns now hold a util::Codec rather than a boolean, which is compatible with the existing
+    // rows. Zstandard frames can reference dictionaries stored in the new table.
+    mapbox::sqlite::Transaction transaction(*db);
+    db->exec(
+        "CREATE TABLE dictionaries ("
+        "id INTEGER NOT NULL PRIMARY KEY, "
+        "created INTEGER NOT NULL, "
+        "data BLOB NOT NULL)");
+    db->exec("PRAGMA user_version = 7");
+    transaction.commit();
+}
+
+void OfflineDatabase::loadDictionaries() {
+    assert(db);
+
+    dictionaries.clear();
+    currentDictionary.reset();
+
+    // A database opened read-only may predate the table.
+    if (getPragma<int64_t>("PRAGMA user_version") < 7) {
+        return;
+    }
+
+    mapbox::sqlite::Query query{getStatement("SELECT data FROM dictionaries ORDER BY created, id")};
+    while (query.run()) {
+        currentDictionary = std::make_shared<const util::CompressionDictionary>(query.get<std::string>(0));
+        dictionaries.emplace(currentDictionary->getID(), currentDictionary);
+    }
+}
+
 void OfflineDatabase::vacuum() {
     assert(db);
     checkFlags();
@@ -250,6 +339,7 @@ std::optional<Response> OfflineDatabase::get(const Resource& resource) try {
     }
 
     auto result = getInternal(resource);
+    flushPendingWritesIfDue();
     return result ? std::optional<Response>{result->first} : std::nullopt;
 } catch (...) {
     handleError("read resource");
@@ -285,6 +375,10 @@ std::pair<bool, uint64_t> OfflineDatabase::put(const Resource& resource, const R
         return {false, 0};
     }
 
+    if (batchesWrites()) {
+        return queueWrite(resource, response);
+    }
+
     mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
     auto result = putInternal(resource, response, true);
     transaction.commit();
@@ -294,24 +388,111 @@ std::pair<bool, uint64_t> OfflineDatabase::put(const Resource& resource, const R
     return {false, 0};
 }
 
+std::pair<bool, uint64_t> OfflineDatabase::queueWrite(const Resource& resource, const Response& response) {
+    if (response.error) {
+        return {false, 0};
+    }
+
+    auto key = resourceKey(resource);
+    auto it = pendingWrites.find(key);
+    if (it != pendingWrites.end() && response.notModified && !it->second.response.notModified) {
+        // Revalidating a queued response only extends its lifetime.
+        it->second.response.expires = response.expires;
+        it->second.response.mustRevalidate = response.mustRevalidate;
+    } else {
+        pendingWrites.insert_or_assign(std::move(key), PendingWrite{resource, response});
+    }
+
+    pendingSince = pendingSince.value_or(Clock::now());
+    flushPendingWritesIfDue();
+
+    return {true, response.data ? response.data->size() : 0};
+}
+
+void OfflineDatabase::flushPendingWritesIfDue() {
+    const std::size_t pending = pendingWrites.size() + pendingTileAccesses.size() + pendingResourceAccesses.size();
+    if (pendingSince && (pending >= maxPendingWrites || Clock::now() - *pendingSince >= maxPendingWriteAge)) {
+        flushPendingWrites();
+    }
+}
+
+std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getPendingWrite(const std::string& key) const {
+    const auto it = pendingWrites.find(key);
+    if (it == pendingWrites.end() || it->second.response.notModified) {
+        return std::nullopt;
+    }
+
+    const Response& response = it->second.response;
+    return std::make_pair(response, response.data ? response.data->size() : 0);
+}
+
+void OfflineDatabase::discardPendingWrites() {
+    pendingWrites.clear();
+    pendingTileAccesses.clear();
+    pendingResourceAccesses.clear();
+    pendingSince.reset();
+}
+
+bool OfflineDatabase::hasPendingWrites() const {
+    return !pendingWrites.empty() || !pendingTileAccesses.empty() || !pendingResourceAccesses.empty();
+}
+
+void OfflineDatabase::flushPendingWrites() try {
+    if (!hasPendingWrites()) {
+        return;
+    }
+
+    auto writes = std::move(pendingWrites);
+    auto tileAccesses = std::move(pendingTileAccesses);
+    auto resourceAccesses = std::move(pendingResourceAccesses);
+    discardPendingWrites();
+
+    if (readOnly) {
+        return;
+    }
+
+    if (!db) {
+        initialize();
+    }
+
+    mapbox::sqlite::Transaction transaction(*db, mapbox::sqlite::Transaction::Immediate);
+    const auto accessed = util::now();
+    for (const auto& entry : tileAccesses) {
+        updateTileAccessed(entry.second, accessed);
+    }
+    for (const auto& url : resourceAccesses) {
+        updateResourceAccessed(url, accessed);
+    }
+    for (const auto& entry : writes) {
+        putInternal(entry.second.resource, entry.second.response, true);
+    }
+    transaction.commit();
+} catch (...) {
+    handleError("write resources");
+}
+
 std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
                                                        const Response& response,
-                                                       bool evict_) {
+                                                       bool evict_,
+                                                       const std::pair<std::string, util::Codec>* encoded) {
     checkFlags();
 
     if (response.error) {
         return {false, 0};
     }
 
-    std::string compressedData;
-    bool compressed = false;
+    std::pair<std::string, util::Codec> encoding;
     uint64_t size = 0;
 
     if (response.data) {
-        compressedData = util::compress(*response.data);
-        compressed = compressedData.size() < response.data->size();
-        size = compressed ? compressedData.size() : response.data->size();
+        if (!encoded) {
+            encoding = getEncoder().encode(*response.data);
+            encoded = &encoding;
+        }
+        size = encoded->second != util::Codec::None ? encoded->first.size() : response.data->size();
     }
+    const auto& compressedData = encoded ? encoded->first : encoding.first;
+    const auto dataCodec = encoded ? encoded->second : util::Codec::None;
 
     std::optional<DatabaseSizeChangeStats> stats;
     if (evict_) {
@@ -328,17 +509,17 @@ std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
         assert(resource.tileData);
         inserted = putTile(*resource.tileData,
                            response,
-                           compressed      ? compressedData
-                           : response.data ? *response.data
-                                           : "",
-                           compressed);
+                           dataCodec != util::Codec::None ? compressedData
+                           : response.data                ? *response.data
+                                                          : "",
+                           dataCodec);
     } else {
         inserted = putResource(resource,
                                response,
-                               compressed      ? compressedData
-                               : response.data ? *response.data
-                                               : "",
-                               compressed);
+                               dataCodec != util::Codec::None ? compressedData
+                               : response.data                ? *response.data
+                                                              : "",
+                               dataCodec);
     }
 
     if (stats) {
@@ -348,14 +529,58 @@ std::pair<bool, uint64_t> OfflineDatabase::putInternal(const Resource& resource,
     return {inserted, size};
 }
 
+std::pair<std::string, util::Codec> OfflineDatabase::Encoder::encode(const std::string& data) const {
+    auto compressed = util::compress(data, codec, dictionary.get());
+    if (compressed.size() >= data.size()) {
+        return {std::string(), util::Codec::None};
+    }
+    return {std::move(compressed), codec};
+}
+
+OfflineDatabase::Encoder OfflineDatabase::getEncoder() const {
+    return {codec, codec == util::Codec::Zstd ? currentDictionary : nullptr};
+}
+
+std::string OfflineDatabase::decompress(const std::string& data, int64_t dataCodec) const {
+    if (dataCodec < static_cast<int64_t>(util::Codec::None) || dataCodec > static_cast<int64_t>(util::Codec::Zstd)) {
+        throw std::runtime_error("Unknown compression codec");
+    }
+
+    const util::CompressionDictionary* dictionary = nullptr;
+    if (dataCodec == static_cast<int64_t>(util::Codec::Zstd)) {
+        if (const auto id = util::getDictionaryID(data)) {
+            const auto it = dictionaries.find(id);
+            if (it == dictionaries.end()) {
+                throw std::runtime_error("Missing compression dictionary");
+            }
+            dictionary = it->second.get();
+        }
+    }
+
+    return util::decompress(data, static_cast<util::Codec>(dataCodec), dictionary);
+}
+
+void OfflineDatabase::updateResourceAccessed(const std::string& url, Timestamp accessed) {
+    mapbox::sqlite::Query accessedQuery{getStatement("UPDATE resources SET accessed = ?1 WHERE url = ?2")};
+    accessedQuery.bind(1, accessed);
+    accessedQuery.bind(2, url);
+    accessedQuery.run();
+}
+
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getResource(const Resource& resource) {
+    if (batchesWrites()) {
+        if (auto pending = getPendingWrite(resource.url)) {
+            return pending;
+        }
+    }
+
     // Update accessed timestamp used for LRU eviction.
-    if (!readOnly) {
+    if (!readOnly && batchesWrites()) {
+        pendingResourceAccesses.insert(resource.url);
+        pendingSince = pendingSince.value_or(Clock::now());
+    } else if (!readOnly) {
         try {
-            mapbox::sqlite::Query accessedQuery{getStatement("UPDATE resources SET accessed = ?1 WHERE url = ?2")};
-            accessedQuery.bind(1, util::now());
-            accessedQuery.bind(2, resource.url);
-            accessedQuery.run();
+            updateResourceAccessed(resource.url, util::now());
         } catch (const mapbox::sqlite::Exception& ex) {
             if (ex.code == mapbox::sqlite::ResultCode::NotADB || ex.code == mapbox::sqlite::ResultCode::Corrupt) {
                 throw;
@@ -392,8 +617,8 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getResource(const
     auto data = query.get<std::optional<std::string>>(4);
     if (!data) {
         response.noContent = true;
-    } else if (query.get<bool>(5)) {
-        response.data = std::make_shared<std::string>(util::decompress(*data));
+    } else if (const auto dataCodec = query.get<int64_t>(5)) {
+        response.data = std::make_shared<std::string>(decompress(*data, dataCodec));
         size = data->length();
     } else {
         response.data = std::make_shared<std::string>(*data);
@@ -416,7 +641,7 @@ std::optional<int64_t> OfflineDatabase::hasResource(const Resource& resource) {
 bool OfflineDatabase::putResource(const Resource& resource,
                                   const Response& response,
                                   const std::string& data,
-                                  bool compressed) {
+                                  util::Codec dataCodec) {
     checkFlags();
 
     if (response.notModified) {
@@ -465,7 +690,7 @@ bool OfflineDatabase::putResource(const Resource& resource,
         updateQuery.bind(8, false);
     } else {
         updateQuery.bindBlob(7, data.data(), data.size(), false);
-        updateQuery.bind(8, compressed);
+        updateQuery.bind(8, static_cast<uint8_t>(dataCodec));
     }
 
     updateQuery.run();
@@ -492,7 +717,7 @@ bool OfflineDatabase::putResource(const Resource& resource,
         insertQuery.bind(9, false);
     } else {
         insertQuery.bindBlob(8, data.data(), data.size(), false);
-        insertQuery.bind(9, compressed);
+        insertQuery.bind(9, static_cast<uint8_t>(dataCodec));
     }
 
     insertQuery.run();
@@ -500,28 +725,43 @@ bool OfflineDatabase::putResource(const Resource& resource,
     return true;
 }
 
+void OfflineDatabase::updateTileAccessed(const Resource::TileData& tile, Timestamp accessed) {
+    // clang-format off
+    mapbox::sqlite::Query accessedQuery{ getStatement(
+        "UPDATE tiles "
+        "SET accessed       = ?1 "
+        "WHERE url_template = ?2 "
+        "  AND pixel_ratio  = ?3 "
+        "  AND x            = ?4 "
+        "  AND y            = ?5 "
+        "  AND z            = ?6 ") };
+    // clang-format on
+
+    accessedQuery.bind(1, accessed);
+    accessedQuery.bind(2, tile.urlTemplate);
+    accessedQuery.bind(3, tile.pixelRatio);
+    accessedQuery.bind(4, tile.x);
+    accessedQuery.bind(5, tile.y);
+    accessedQuery.bind(6, tile.z);
+    accessedQuery.run();
+}
+
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getTile(const Resource::TileData& tile) {
+    std::optional<std::string> key;
+    if (batchesWrites()) {
+        key = tileKey(tile);
+        if (auto pending = getPendingWrite(*key)) {
+            return pending;
+        }
+    }
+
     // Update accessed timestamp used for LRU eviction.
-    if (!readOnly) {
+    if (!readOnly && key) {
+        pendingTileAccesses.emplace(std::move(*key), tile);
+        pendingSince = pendingSince.value_or(Clock::now());
+    } else if (!readOnly) {
         try {
-            // clang-format off
-            mapbox::sqlite::Query accessedQuery{ getStatement(
-                "UPDATE tiles "
-                "SET accessed       = ?1 "
-                "WHERE url_template = ?2 "
-                "  AND pixel_ratio  = ?3 "
-                "  AND x            = ?4 "
-                "  AND y            = ?5 "
-                "  AND z            = ?6 ") };
-            // clang-format on
-
-            accessedQuery.bind(1, util::now());
-            accessedQuery.bind(2, tile.urlTemplate);
-            accessedQuery.bind(3, tile.pixelRatio);
-            accessedQuery.bind(4, tile.x);
-            accessedQuery.bind(5, tile.y);
-            accessedQuery.bind(6, tile.z);
-            accessedQuery.run();
+            updateTileAccessed(tile, util::now());
         } catch (const mapbox::sqlite::Exception& ex) {
             if (ex.code == mapbox::sqlite::ResultCode::NotADB || ex.code == mapbox::sqlite::ResultCode::Corrupt) {
                 throw;
@@ -566,8 +806,8 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getTile(const Reso
     std::optional<std::string> data = query.get<std::optional<std::string>>(4);
     if (!data) {
         response.noContent = true;
-    } else if (query.get<bool>(5)) {
-        response.data = std::make_shared<std::string>(util::decompress(*data));
+    } else if (const auto dataCodec = query.get<int64_t>(5)) {
+        response.data = std::make_shared<std::string>(decompress(*data, dataCodec));
         size = data->length();
     } else {
         response.data = std::make_shared<std::string>(*data);
@@ -605,7 +845,7 @@ std::optional<int64_t> OfflineDatabase::hasTile(const Resource::TileData& tile)
 bool OfflineDatabase::putTile(const Resource::TileData& tile,
                               const Response& response,
                               const std::string& data,
-                              bool compressed) {
+                              util::Codec dataCodec) {
     checkFlags();
 
     if (response.notModified) {
@@ -669,7 +909,7 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
         updateQuery.bind(7, false);
     } else {
         updateQuery.bindBlob(6, data.data(), data.size(), false);
-        updateQuery.bind(7, compressed);
+        updateQuery.bind(7, static_cast<uint8_t>(dataCodec));
     }
 
     updateQuery.run();
@@ -699,7 +939,7 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
         insertQuery.bind(12, false);
     } else {
         insertQuery.bindBlob(11, data.data(), data.size(), false);
-        insertQuery.bind(12, compressed);
+        insertQuery.bind(12, static_cast<uint8_t>(dataCodec));
     }
 
     insertQuery.run();
@@ -708,6 +948,7 @@ bool OfflineDatabase::putTile(const Resource::TileData& tile,
 }
 
 std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
+    flushPendingWrites();
     checkFlags();
 
     // clang-format off
@@ -741,6 +982,7 @@ std::exception_ptr OfflineDatabase::invalidateAmbientCache() try {
 }
 
 std::exception_ptr OfflineDatabase::clearAmbientCache() try {
+    discardPendingWrites();
     checkFlags();
 
     // clang-format off
@@ -774,6 +1016,7 @@ std::exception_ptr OfflineDatabase::clearAmbientCache() try {
 }
 
 std::exception_ptr OfflineDatabase::invalidateRegion(int64_t regionID) try {
+    flushPendingWrites();
     checkFlags();
 
     {
@@ -875,6 +1118,7 @@ expected<OfflineRegion, std::exception_ptr> OfflineDatabase::createRegion(const
 }
 
 expected<OfflineRegions, std::exception_ptr> OfflineDatabase::mergeDatabase(const std::string& sideDatabasePath) {
+    flushPendingWrites();
     checkFlags();
 
     try {
@@ -892,12 +1136,13 @@ expected<OfflineRegions, std::exception_ptr> OfflineDatabase::mergeDatabase(cons
         return unexpected<std::exception_ptr>(std::current_exception());
     }
     try {
-        // Support sideloaded databases at user_version = 6. Future schema
-        // version changes will need to implement migration paths for sideloaded
-        // databases at version 6.
+        // Support sideloaded databases at user_version = 6 and 7. Version 7
+        // only added the dictionaries table, which is copied when present.
+        // Future schema version changes will need to implement migration
+        // paths for sideloaded databases at version 6.
         auto sideUserVersion = static_cast<int>(getPragma<int64_t>("PRAGMA side.user_version"));
         const auto mainUserVersion = getPragma<int64_t>("PRAGMA user_version");
-        if (sideUserVersion < 6 || sideUserVersion != mainUserVersion) {
+        if (sideUserVersion < 6 || sideUserVersion > mainUserVersion) {
             throw std::runtime_error("Merge database has incorrect user_version");
         }
 
@@ -926,7 +1171,12 @@ expected<OfflineRegions, std::exception_ptr> OfflineDatabase::mergeDatabase(cons
 
         mapbox::sqlite::Transaction transaction(*db);
         db->exec(mergeSideloadedDatabaseSQL);
+        if (sideUserVersion >= 7) {
+            // Dictionary IDs are random, so equal IDs are the same dictionary.
+            db->exec("INSERT OR IGNORE INTO dictionaries SELECT id, created, data FROM side.dictionaries");
+        }
         transaction.commit();
+        loadDictionaries();
 
         // clang-format off
         mapbox::sqlite::Query queryRegions{ getStatement(
@@ -975,6 +1225,7 @@ expected<OfflineRegionMetadata, std::exception_ptr> OfflineDatabase::updateMetad
 }
 
 std::exception_ptr OfflineDatabase::deleteRegion(OfflineRegion&& region) try {
+    flushPendingWrites();
     checkFlags();
 
     {
@@ -998,6 +1249,7 @@ std::exception_ptr OfflineDatabase::deleteRegion(OfflineRegion&& region) try {
 }
 
 std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getRegionResource(const Resource& resource) try {
+    flushPendingWrites();
     return getInternal(resource);
 } catch (...) {
     handleError("read region resource");
@@ -1005,6 +1257,7 @@ std::optional<std::pair<Response, uint64_t>> OfflineDatabase::getRegionResource(
 }
 
 std::optional<int64_t> OfflineDatabase::hasRegionResource(const Resource& resource) try {
+    flushPendingWrites();
     return hasInternal(resource);
 } catch (...) {
     handleError("query region resource");
@@ -1012,6 +1265,7 @@ std::optional<int64_t> OfflineDatabase::hasRegionResource(const Resource& resour
 }
 
 uint64_t OfflineDatabase::putRegionResource(int64_t regionID, const Resource& resource, const Response& response) try {
+    flushPendingWrites();
     checkFlags();
 
     if (!db) {
@@ -1028,7 +1282,28 @@ uint64_t OfflineDatabase::putRegionResource(int64_t regionID, const Resource& re
 
 void OfflineDatabase::putRegionResources(int64_t regionID,
                                          const std::list<std::tuple<Resource, Response>>& resources,
+                                         OfflineRegionStatus& status) {
+    std::list<EncodedResource> encodedResources;
+    try {
+        const auto encoder = getEncoder();
+        for (const auto& [resource, response] : resources) {
+            auto& encoded = encodedResources.emplace_back(EncodedResource{resource, response, {}});
+            if (response.data && !response.error) {
+                encoded.data = encoder.encode(*response.data);
+            }
+        }
+    } catch (...) {
+        handleError("write region resources");
+        return;
+    }
+
+    putRegionResources(regionID, encodedResources, status);
+}
+
+void OfflineDatabase::putRegionResources(int64_t regionID,
+                                         const std::list<EncodedResource>& resources,
                                          OfflineRegionStatus& status) try {
+    flushPendingWrites();
     checkFlags();
 
     if (!db) {
@@ -1044,12 +1319,9 @@ void OfflineDatabase::putRegionResources(int64_t regionID,
     uint64_t completedTileCount = 0;
     uint64_t completedTileSize = 0;
 
-    for (const auto& elem : resources) {
-        const auto& resource = std::get<0>(elem);
-        const auto& response = std::get<1>(elem);
-
+    for (const auto& [resource, response, data] : resources) {
         try {
-            uint64_t resourceSize = putRegionResourceInternal(regionID, resource, response);
+            uint64_t resourceSize = putRegionResourceInternal(regionID, resource, response, &data);
             completedResourceCount++;
             completedResourceSize += resourceSize;
             if (resource.kind == Resource::Kind::Tile) {
@@ -1076,10 +1348,11 @@ void OfflineDatabase::putRegionResources(int64_t regionID,
 
 uint64_t OfflineDatabase::putRegionResourceInternal(int64_t regionID,
                                                     const Resource& resource,
-                                                    const Response& response) {
+                                                    const Response& response,
+                                                    const std::pair<std::string, util::Codec>* encoded) {
     checkFlags();
 
-    uint64_t size = putInternal(resource, response, false).second;
+    uint64_t size = putInternal(resource, response, false, encoded).second;
     bool previouslyUnused = markUsed(regionID, resource);
 
     if (previouslyUnused && exceedsOfflineMapboxTileCountLimit(resource)) {
@@ -1377,6 +1650,7 @@ std::exception_ptr OfflineDatabase::initAmbientCacheSize() {
 }
 
 std::exception_ptr OfflineDatabase::setMaximumAmbientCacheSize(uint64_t size) {
+    flushPendingWrites();
     uint64_t previousMaximumAmbientCacheSize = maximumAmbientCacheSize;
 
     if (auto exception = initAmbientCacheSize()) {
@@ -1446,6 +1720,7 @@ bool OfflineDatabase::exceedsOfflineMapboxTileCountLimit(const Resource& resourc
 }
 
 void OfflineDatabase::markUsedResources(int64_t regionID, const std::list<Resource>& resources) try {
+    flushPendingWrites();
     if (!db) {
         initialize();
     }
@@ -1459,6 +1734,7 @@ void OfflineDatabase::markUsedResources(int64_t regionID, const std::list<Resour
 }
 
 std::exception_ptr OfflineDatabase::pack() try {
+    flushPendingWrites();
     if (!db) initialize();
     vacuum();
     return nullptr;
@@ -1467,7 +1743,89 @@ std::exception_ptr OfflineDatabase::pack() try {
     return std::current_exception();
 }
 
+std::exception_ptr OfflineDatabase::trainCompressionDictionary() try {
+    flushPendingWrites();
+    checkFlags();
+
+    if (codec != util::Codec::Zstd) {
+        throw std::runtime_error("Compression dictionaries need the Zstd cache codec");
+    }
+
+    // clang-format off
+    mapbox::sqlite::Query sampleQuery{ getStatement(
+        "SELECT data, compressed FROM tiles "
+        "WHERE data IS NOT NULL "
+        "ORDER BY RANDOM() "
+        "LIMIT ?1") };
+    // clang-format on
+
+    sampleQuery.bind(1, maxDictionarySamples);
+    std::vector<std::string> samples;
+    while (sampleQuery.run()) {
+        samples.push_back(decompress(sampleQuery.get<std::string>(0), sampleQuery.get<int64_t>(1)));
+    }
+    sampleQuery.reset();
+
+    auto dictionary = util::CompressionDictionary::train(samples);
+    if (!dictionary) {
+        throw std::runtime_error("Not enough tiles to train a compression dictionary");
+    }
+
+    mapbox::sqlite::Transaction transaction(*db);
+
+    mapbox::sqlite::Query insertQuery{
+        getStatement("INSERT INTO dictionaries (id, created, data) VALUES (?1, ?2, ?3)")};
+    insertQuery.bind(1, int64_t{dictionary->getID()});
+    insertQuery.bind(2, util::now());
+    insertQuery.bindBlob(3, dictionary->getData().data(), dictionary->getData().size(), false);
+    insertQuery.run();
+
+    // Collect the IDs first rather than updating the rows while iterating over them.
+    std::vector<int64_t> tileIDs;
+    mapbox::sqlite::Query idQuery{getStatement("SELECT id FROM tiles WHERE data IS NOT NULL")};
+    while (idQuery.run()) {
+        tileIDs.push_back(idQuery.get<int64_t>(0));
+    }
+    idQuery.reset();
+
+    mapbox::sqlite::Query selectQuery{getStatement("SELECT data, compressed FROM tiles WHERE id = ?1")};
+    mapbox::sqlite::Query updateQuery{getStatement("UPDATE tiles SET data = ?1, compressed = ?2 WHERE id = ?3")};
+    for (const auto tileID : tileIDs) {
+        selectQuery.bind(1, tileID);
+        if (!selectQuery.run()) {
+            selectQuery.reset();
+            continue;
+        }
+        const auto data = decompress(selectQuery.get<std::string>(0), selectQuery.get<int64_t>(1));
+        selectQuery.reset();
+
+        auto recompressed = util::compress(data, util::Codec::Zstd, dictionary.get());
+        const bool smaller = recompressed.size() < data.size();
+        const auto& stored = smaller ? recompressed : data;
+        updateQuery.bindBlob(1, stored.data(), stored.size(), false);
+        updateQuery.bind(2, static_cast<uint8_t>(smaller ? util::Codec::Zstd : util::Codec::None));
+        updateQuery.bind(3, tileID);
+        updateQuery.run();
+        updateQuery.reset();
+    }
+
+    transaction.commit();
+
+    dictionaries.emplace(dictionary->getID(), dictionary);
+    currentDictionary = std::move(dictionary);
+
+    // Sizes changed all over the ambient cache.
+    currentAmbientCacheSize = std::nullopt;
+    if (autopack) vacuum();
+
+    return nullptr;
+} catch (...) {
+    handleError("train compression dictionary");
+    return std::current_exception();
+}
+
 std::exception_ptr OfflineDatabase::resetDatabase() try {
+    discardPendingWrites();
     removeExisting();
     initialize();
     return nullptr;
@@ -1477,6 +1835,7 @@ std::exception_ptr OfflineDatabase::resetDatabase() try {
 }
 
 void OfflineDatabase::reopenDatabaseReadOnly(bool readOnly_) {
+    flushPendingWrites();
     if (readOnly == readOnly_) return;
     try {
         cleanup();
@@ -1,4 +1,3 @@
-#include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/offline_download.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
@@ -13,7 +12,9 @@
 #include <mbgl/style/conversion/tileset.hpp>
 #include <mbgl/style/sprite.hpp>
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/i18n.hpp>
+#include <mbgl/util/logging.hpp>
 #include <mbgl/util/mapbox.hpp>
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/tile_cover.hpp>
@@ -25,6 +26,8 @@ namespace {
 
 const size_t kResourcesBatchSize = 64;
 const size_t kMarkBatchSize = 200;
+// Requests are held back while this many batches are waiting to be written.
+const size_t kMaxPendingBatches = 4;
 
 } // namespace
 
@@ -49,30 +52,14 @@ Range<uint8_t> coveringZoomRange(const RegionDefinition& definition,
     return {static_cast<uint8_t>(minZ), static_cast<uint8_t>(maxZ)};
 }
 
-template <class Geometry, class Fn>
-void tileCover(const Geometry& geometry, uint8_t z, Fn&& fn) {
-    util::TileCover cover(geometry, z);
-    while (cover.hasNext()) {
-        fn(cover.next()->canonical);
-    }
-}
-
-template <class Fn>
-void tileCover(const OfflineRegionDefinition& definition,
-               style::SourceType type,
-               uint16_t tileSize,
-               const Range<uint8_t>& zoomRange,
-               Fn&& fn) {
-    const Range<uint8_t> clampedZoomRange = std::visit(
-        [&](auto& reg) { return coveringZoomRange(reg, type, tileSize, zoomRange); }, definition);
-
-    for (uint8_t z = clampedZoomRange.min; z <= clampedZoomRange.max; z++) {
-        std::visit(overloaded{[&](const OfflineTilePyramidRegionDefinition& reg) { tileCover(reg.bounds, z, fn); },
-                              [&](const OfflineGeometryRegionDefinition& reg) {
-                                  tileCover(reg.geometry, z, fn);
-                              }},
-                   definition);
-    }
+std::unique_ptr<util::TileCover> makeTileCover(const OfflineRegionDefinition& definition, uint8_t z) {
+    return std::visit(overloaded{[&](const OfflineTilePyramidRegionDefinition& reg) {
+                                     return std::make_unique<util::TileCover>(reg.bounds, z);
+                                 },
+                                 [&](const OfflineGeometryRegionDefinition& reg) {
+                                     return std::make_unique<util::TileCover>(reg.geometry, z);
+                                 }},
+                      definition);
 }
 
 uint64_t tileCount(const OfflineRegionDefinition& definition,
@@ -95,6 +82,69 @@ uint64_t tileCount(const OfflineRegionDefinition& definition,
     return result;
 }
 
+// Enumerates the tiles of one source zoom level by zoom level, so that
+// resources are created as they are requested instead of all at once.
+class OfflineDownload::TileGenerator {
+public:
+    TileGenerator(const OfflineRegionDefinition& definition_, const Range<uint8_t>& zoomRange_, const Tileset& tileset)
+        : definition(definition_),
+          zoomRange(zoomRange_),
+          urlTemplate(tileset.tiles[0]),
+          scheme(tileset.scheme),
+          z(zoomRange.min) {
+        advance();
+    }
+
+    // Number of tiles this generator yields, counted with a pass over the
+    // same covers so that it is exact.
+    uint64_t count() const {
+        uint64_t result = 0;
+        for (unsigned zoom = zoomRange.min; zoom <= zoomRange.max; zoom++) {
+            auto tiles = makeTileCover(definition, static_cast<uint8_t>(zoom));
+            while (tiles->next()) {
+                result++;
+            }
+        }
+        return result;
+    }
+
+    bool done() const { return !cover; }
+
+    Resource next() {
+        assert(!done());
+        const auto tile = cover->next()->canonical;
+        auto resource = Resource::tile(urlTemplate,
+                                       std::visit([](auto& def) { return def.pixelRatio; }, definition),
+                                       tile.x,
+                                       tile.y,
+                                       tile.z,
+                                       scheme);
+        resource.setPriority(Resource::Priority::Low);
+        resource.setUsage(Resource::Usage::Offline);
+        advance();
+        return resource;
+    }
+
+private:
+    // Moves on to the next zoom level with tiles, once the current one has none left.
+    void advance() {
+        while (!cover || !cover->hasNext()) {
+            if (z > zoomRange.max) {
+                cover.reset();
+                return;
+            }
+            cover = makeTileCover(definition, static_cast<uint8_t>(z++));
+        }
+    }
+
+    const OfflineRegionDefinition& definition;
+    const Range<uint8_t> zoomRange;
+    const std::string urlTemplate;
+    const Tileset::Scheme scheme;
+    unsigned z; // Next zoom level to cover.
+    std::unique_ptr<util::TileCover> cover;
+};
+
 // OfflineDownload
 
 OfflineDownload::OfflineDownload(int64_t id_,
@@ -104,7 +154,8 @@ OfflineDownload::OfflineDownload(int64_t id_,
     : id(id_),
       definition(std::move(definition_)),
       offlineDatabase(offlineDatabase_),
-      onlineFileSource(onlineFileSource_) {
+      onlineFileSource(onlineFileSource_),
+      encodeScheduler(Scheduler::GetBackground()) {
     setObserver(nullptr);
 }
 
@@ -243,6 +294,7 @@ void OfflineDownload::activateDownload() {
     status = OfflineRegionStatus();
     status.downloadState = OfflineRegionDownloadState::Active;
     status.requiredResourceCount++;
+    activated = Clock::now();
 
     auto styleResource = Resource::style(std::visit([](auto& reg) { return reg.styleURL; }, definition));
     styleResource.setPriority(Resource::Priority::Low);
@@ -393,10 +445,10 @@ void OfflineDownload::activateDownload() {
    fruitless anyway.
 */
 void OfflineDownload::continueDownload() {
-    if (resourcesRemaining.empty()) {
-        // Flush pending buffers.
-        if (!flushResourcesBuffer()) return;
-        if (status.complete()) {
+    if (!hasResourcesRemaining()) {
+        // Flush pending buffers. The download completes once they are written.
+        flushResourcesBuffer();
+        if (pendingBatches == 0 && status.complete()) {
             markPendingUsedResources();
             setState(OfflineRegionDownloadState::Inactive);
             return;
@@ -411,30 +463,102 @@ void OfflineDownload::continueDownload() {
         maxConcurrentRequests = static_cast<uint32_t>(*maxRequests);
     }
 
-    while (!resourcesRemaining.empty() && requests.size() < maxConcurrentRequests) {
-        ensureResource(std::move(resourcesRemaining.front()));
-        resourcesRemaining.pop_front();
+    // Hold back while writing falls behind, rather than buffering responses
+    // without bound; the next written batch continues the download.
+    while (requests.size() < maxConcurrentRequests && pendingBatches < kMaxPendingBatches && hasResourcesRemaining()) {
+        ensureResource(nextResource());
     }
 }
 
 void OfflineDownload::deactivateDownload() {
     requiredSourceURLs.clear();
     resourcesRemaining.clear();
+    tilesRemaining.clear();
     requests.clear();
     buffer.clear();
+    pendingBatches = 0;
+    pendingWrites = 0;
+    generation++;
+}
+
+void OfflineDownload::flushResourcesBuffer() {
+    if (buffer.empty()) return;
+
+    auto resources = std::make_shared<std::list<std::tuple<Resource, Response>>>(std::move(buffer));
+    buffer.clear();
+    pendingBatches++;
+    pendingWrites += resources->size();
+
+    encodeScheduler->scheduleAndReplyValue(
+        util::SimpleIdentity::Empty,
+        [resources, encoder = offlineDatabase.getEncoder()] {
+            auto encoded = std::make_shared<std::list<OfflineDatabase::EncodedResource>>();
+            for (auto& [resource, response] : *resources) {
+                auto& entry = encoded->emplace_back(
+                    OfflineDatabase::EncodedResource{std::move(resource), std::move(response), {}});
+                if (entry.response.data && !entry.response.error) {
+                    try {
+                        entry.data = encoder.encode(*entry.response.data);
+                    } catch (const std::exception& ex) {
+                        // Stored uncompressed instead.
+                        Log::Warning(Event::Database, std::string("Can't compress resource: ") + ex.what());
+                    }
+                }
+            }
+            return encoded;
+        },
+        [weak = weakFactory.makeWeakPtr(), batchGeneration = generation, count = resources->size()](
+            std::shared_ptr<std::list<OfflineDatabase::EncodedResource>> encoded) {
+            if (auto guard = weak.lock(); weak && batchGeneration == weak->generation) {
+                weak->pendingBatches--;
+                weak->pendingWrites -= count;
+                weak->writeResources(*encoded);
+            }
+        });
 }
 
-bool OfflineDownload::flushResourcesBuffer() {
-    if (buffer.empty()) return true;
+void OfflineDownload::writeResources(const std::list<OfflineDatabase::EncodedResource>& resources) {
     try {
-        offlineDatabase.putRegionResources(id, buffer, status);
-        buffer.clear();
-        observer->statusChanged(status);
-        return true;
+        offlineDatabase.putRegionResources(id, resources, status);
     } catch (const MapboxTileLimitExceededException&) {
         onMapboxTileCountLimitExceeded();
-        return false;
+        return;
+    }
+
+    observer->statusChanged(status);
+    observer->downloadMetricsChanged(getMetrics());
+    continueDownload();
+}
+
+OfflineRegionDownloadMetrics OfflineDownload::getMetrics() const {
+    OfflineRegionDownloadMetrics metrics;
+    metrics.pendingRequestCount = requests.size();
+    metrics.pendingWriteCount = buffer.size() + pendingWrites;
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - activated).count();
+    if (seconds > 0) {
+        metrics.resourcesPerSecond = static_cast<double>(status.completedResourceCount) / seconds;
+        metrics.tilesPerSecond = static_cast<double>(status.completedTileCount) / seconds;
+        metrics.bytesPerSecond = static_cast<double>(status.completedResourceSize) / seconds;
     }
+    return metrics;
+}
+
+bool OfflineDownload::hasResourcesRemaining() {
+    while (!tilesRemaining.empty() && tilesRemaining.front()->done()) {
+        tilesRemaining.pop_front();
+    }
+    return !resourcesRemaining.empty() || !tilesRemaining.empty();
+}
+
+Resource OfflineDownload::nextResource() {
+    assert(hasResourcesRemaining());
+    if (!resourcesRemaining.empty()) {
+        Resource resource = std::move(resourcesRemaining.front());
+        resourcesRemaining.pop_front();
+        return resource;
+    }
+    return tilesRemaining.front()->next();
 }
 
 void OfflineDownload::queueResource(Resource&& resource) {
@@ -448,22 +572,14 @@ void OfflineDownload::queueResource(Resource&& resource) {
 }
 
 void OfflineDownload::queueTiles(SourceType type, uint16_t tileSize, const Tileset& tileset) {
-    tileCover(definition, type, tileSize, tileset.zoomRange, [&](const auto& tile) {
-        status.requiredResourceCount++;
-        status.requiredTileCount++;
-
-        auto tileResource = Resource::tile(tileset.tiles[0],
-                                           std::visit([](auto& def) { return def.pixelRatio; }, definition),
-                                           tile.x,
-                                           tile.y,
-                                           tile.z,
-                                           tileset.scheme);
-
-        tileResource.setPriority(Resource::Priority::Low);
-        tileResource.setUsage(Resource::Usage::Offline);
-
-        resourcesRemaining.push_back(std::move(tileResource));
-    });
+    const Range<uint8_t> zoomRange = std::visit(
+        [&](auto& reg) { return coveringZoomRange(reg, type, tileSize, tileset.zoomRange); }, definition);
+
+    auto tiles = std::make_unique<TileGenerator>(definition, zoomRange, tileset);
+    const uint64_t count = tiles->count();
+    status.requiredResourceCount += count;
+    status.requiredTileCount += count;
+    tilesRemaining.push_back(std::move(tiles));
 }
 
 void OfflineDownload::markPendingUsedResources() {
@@ -538,11 +654,11 @@ void OfflineDownload::ensureResource(Resource&& resource, std::function<void(Res
             // Queue up for batched insertion
             buffer.emplace_back(resource, onlineResponse);
 
-            // Flush buffer periodically.
-            // Have to keep `resourcesRemaining.empty()` as the following
-            // condition would fail otherwise.
-            // TODO: Simplify the tile count limit check code path!
-            if ((buffer.size() == kResourcesBatchSize || resourcesRemaining.empty()) && !flushResourcesBuffer()) return;
+            // Flush buffer periodically, and right away once nothing is left
+            // to request.
+            if (buffer.size() == kResourcesBatchSize || !hasResourcesRemaining()) {
+                flushResourcesBuffer();
+            }
 
             if (offlineDatabase.exceedsOfflineMapboxTileCountLimit(resource)) {
                 onMapboxTileCountLimitExceeded();
@@ -1,4 +1,5 @@
 #include <sstream>
+#include <list>
 #include <map>
 
 #include <mbgl/platform/settings.hpp>
@@ -16,13 +17,27 @@
 #include <mbgl/util/url.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/compression.hpp>
+#include <mbgl/util/containers.hpp>
 #include <mbgl/util/filesystem.hpp>
+#include <mbgl/util/hash.hpp>
 
 #include <pmtiles.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #if defined(__QT__) && (defined(_WIN32) || defined(__EMSCRIPTEN__))
 #include <QtZlib/zlib.h>
 #else
@@ -34,10 +49,6 @@ namespace {
 constexpr int pmtilesHeaderOffset = 0;
 constexpr int pmtilesHeaderLength = 127;
 
-// To avoid allocating lots of memory with PMTiles directory caching,
-// set a limit so it doesn't grow unlimited
-constexpr int MAX_DIRECTORY_CACHE_ENTRIES = 100;
-
 bool acceptsURL(const std::string& url) {
     return url.starts_with(mbgl::util::PMTILES_PROTOCOL);
 }
@@ -55,18 +66,253 @@ const uint8_t TILETYPE_MLT = 0x6;
 namespace mbgl {
 using namespace rapidjson;
 
+namespace {
+
+using Directory = std::vector<pmtiles::entryv3>;
+
+bool isSupportedCompression(uint8_t compression) {
+    return compression == pmtiles::COMPRESSION_NONE || compression == pmtiles::COMPRESSION_GZIP ||
+           (compression == pmtiles::COMPRESSION_ZSTD && util::isAvailable(util::Codec::Zstd));
+}
+
+std::string decompress(const std::string& data, uint8_t compression) {
+    switch (compression) {
+        case pmtiles::COMPRESSION_GZIP:
+            return util::decompress(data);
+        case pmtiles::COMPRESSION_ZSTD:
+            return util::decompress(data, util::Codec::Zstd);
+        default:
+            return data;
+    }
+}
+
+// Deserialized directories of all archives, dropping the least recently used
+// ones once they take up more memory than the budget
+class DirectoryCache {
+public:
+    struct Key {
+        uint32_t archive;
+        uint32_t length;
+        uint64_t offset;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    explicit DirectoryCache(uint64_t maxBytes_)
+        : maxBytes(maxBytes_) {}
+
+    std::shared_ptr<const Directory> get(const Key& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            stats.misses++;
+            return nullptr;
+        }
+
+        stats.hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->directory;
+    }
+
+    void add(const Key& key, std::shared_ptr<const Directory> directory) {
+        // Concurrent requests may have fetched the same directory already
+        if (auto it = index.find(key); it != index.end()) {
+            bytes -= it->second->bytes;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+
+        const uint64_t size = sizeof(Entry) + directory->capacity() * sizeof(pmtiles::entryv3);
+        entries.push_front({.key = key, .directory = std::move(directory), .bytes = size});
+        index.emplace(key, entries.begin());
+        bytes += size;
+
+        evict();
+    }
+
+    void setMaxBytes(uint64_t maxBytes_) {
+        maxBytes = maxBytes_;
+        evict();
+    }
+
+    PMTilesFileSource::DirectoryCacheStats getStats() const {
+        auto result = stats;
+        result.entries = entries.size();
+        result.bytes = bytes;
+        return result;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<const Directory> directory;
+        uint64_t bytes;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept {
+            return util::hash(key.archive, key.length, key.offset);
+        }
+    };
+
+    void evict() {
+        while (bytes > maxBytes && !entries.empty()) {
+            const Entry& entry = entries.back();
+            bytes -= entry.bytes;
+            index.erase(entry.key);
+            entries.pop_back();
+            stats.evictions++;
+        }
+    }
+
+    uint64_t maxBytes;
+    uint64_t bytes = 0;
+    PMTilesFileSource::DirectoryCacheStats stats;
+
+    // Most recently used first
+    std::list<Entry> entries;
+    mbgl::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+};
+
+#ifndef _WIN32
+// A local archive, read through a read-only mapping so that headers, directories and tiles are read
+// without a seek and a read call each. Files that can't be mapped are read with `pread` instead.
+class LocalFile {
+public:
+    // Tells the file at a path apart from the one that was there when it was opened
+    struct Identity {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        time_t modified;
+        long modifiedNanoseconds;
+
+        bool operator==(const Identity&) const = default;
+    };
+
+    static std::optional<Identity> identify(const std::string& path) {
+        struct stat buf;
+        if (::stat(path.c_str(), &buf) != 0) {
+            return std::nullopt;
+        }
+        return identify(buf);
+    }
+
+    static std::unique_ptr<LocalFile> open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        struct stat buf;
+        if (fstat(fd, &buf) != 0 || !S_ISREG(buf.st_mode)) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        const auto size = static_cast<std::size_t>(buf.st_size);
+        void* address = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (address == MAP_FAILED) {
+            return std::unique_ptr<LocalFile>(new LocalFile(identify(buf), fd, nullptr, size));
+        }
+
+        // The mapping stays valid without the descriptor
+        ::close(fd);
+        // Directories and tiles are read at scattered offsets, reading ahead only wastes memory
+        madvise(address, size, MADV_RANDOM);
+        return std::unique_ptr<LocalFile>(new LocalFile(identify(buf), -1, static_cast<const char*>(address), size));
+    }
+
+    ~LocalFile() {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    LocalFile(const LocalFile&) = delete;
+    LocalFile& operator=(const LocalFile&) = delete;
+
+    const Identity& getIdentity() const { return identity; }
+
+    // Bytes past the end of the file read as zeros, as with `util::readFile`
+    std::string read(uint64_t offset, uint64_t length) const {
+        std::string result(static_cast<std::size_t>(length), '\0');
+        if (offset >= size) {
+            return result;
+        }
+
+        const auto available = static_cast<std::size_t>(std::min<uint64_t>(length, size - offset));
+        if (data) {
+            std::memcpy(result.data(), data + offset, available);
+            return result;
+        }
+
+        for (std::size_t done = 0; done < available;) {
+            const auto count = pread(fd, result.data() + done, available - done, static_cast<off_t>(offset + done));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                throw std::runtime_error(std::string("Error reading file: ") + std::strerror(errno));
+            }
+            if (count == 0) {
+                break;
+            }
+            done += static_cast<std::size_t>(count);
+        }
+        return result;
+    }
+
+private:
+    LocalFile(const Identity& identity_, int fd_, const char* data_, std::size_t size_)
+        : identity(identity_),
+          fd(fd_),
+          data(data_),
+          size(size_) {}
+
+    static Identity identify(const struct stat& buf) {
+#ifdef __APPLE__
+        const auto& modified = buf.st_mtimespec;
+#else
+        const auto& modified = buf.st_mtim;
+#endif
+        return {.device = buf.st_dev,
+                .inode = buf.st_ino,
+                .size = buf.st_size,
+                .modified = modified.tv_sec,
+                .modifiedNanoseconds = static_cast<long>(modified.tv_nsec)};
+    }
+
+    const Identity identity;
+    // Only open when the file isn't mapped
+    const int fd;
+    const char* const data;
+    const std::size_t size;
+};
+#endif
+
+} // namespace
+
 using AsyncCallback = std::function<void(std::unique_ptr<Response::Error>)>;
+using AsyncDirectoryCallback =
+    std::function<void(std::shared_ptr<const Directory>, std::unique_ptr<Response::Error>)>;
 using AsyncTileCallback = std::function<void(std::pair<uint64_t, uint32_t>, std::unique_ptr<Response::Error>)>;
 
 class PMTilesFileSource::Impl {
 public:
     explicit Impl(const ActorRef<Impl>&, const ResourceOptions& resourceOptions_, const ClientOptions& clientOptions_)
         : resourceOptions(resourceOptions_.clone()),
-          clientOptions(clientOptions_.clone()) {}
+          clientOptions(clientOptions_.clone()),
+          directory_cache(resourceOptions.pmtilesDirectoryCacheSize()) {}
 
     // Generate a tilejson resource from .pmtiles file
     void request_tilejson(AsyncRequest* req, const Resource& resource, const ActorRef<FileSourceRequest>& ref) {
         auto url = extract_url(resource.url);
+#ifndef _WIN32
+        openLocalFile(url);
+#endif
 
         getMetadata(url, req, [=, this](std::unique_ptr<Response::Error> error) {
             Response response;
@@ -85,6 +331,9 @@ public:
     // Load data for specific tile
     void request_tile(AsyncRequest* req, const Resource& resource, ActorRef<FileSourceRequest> ref) {
         auto url = extract_url(resource.url);
+#ifndef _WIN32
+        openLocalFile(url);
+#endif
 
         getHeader(url, req, [=, this](std::unique_ptr<Response::Error> error) {
             if (error) {
@@ -142,12 +391,7 @@ public:
                         return;
                     }
 
-                    Resource tileResource(Resource::Kind::Source, url);
-                    tileResource.loadingMethod = Resource::LoadingMethod::Network;
-                    tileResource.dataRange = std::make_pair(tileAddress.first,
-                                                            tileAddress.first + tileAddress.second - 1);
-
-                    tasks[req] = getFileSource()->request(tileResource, [=](const Response& tileResponse) {
+                    readRange(url, req, tileAddress.first, tileAddress.second, [=](const Response& tileResponse) {
                         Response response;
                         response.noContent = true;
 
@@ -165,8 +409,9 @@ public:
                         response.expires = tileResponse.expires;
                         response.etag = tileResponse.etag;
 
-                        if (header.tile_compression == pmtiles::COMPRESSION_GZIP) {
-                            response.data = std::make_shared<std::string>(util::decompress(*tileResponse.data));
+                        if (header.tile_compression != pmtiles::COMPRESSION_NONE) {
+                            response.data = std::make_shared<std::string>(
+                                decompress(*tileResponse.data, header.tile_compression));
                         }
 
                         ref.invoke(&FileSourceRequest::setResponse, response);
@@ -178,6 +423,7 @@ public:
 
     void setResourceOptions(ResourceOptions options) {
         std::scoped_lock lock(resourceOptionsMutex);
+        directory_cache.setMaxBytes(options.pmtilesDirectoryCacheSize());
         resourceOptions = options;
     }
 
@@ -196,6 +442,8 @@ public:
         return clientOptions.clone();
     }
 
+    PMTilesFileSource::DirectoryCacheStats getDirectoryCacheStats() { return directory_cache.getStats(); }
+
 private:
     mutable std::mutex resourceOptionsMutex;
     mutable std::mutex clientOptionsMutex;
@@ -205,8 +453,12 @@ private:
     std::shared_ptr<FileSource> fileSource;
     std::map<std::string, pmtiles::headerv3> header_cache;
     std::map<std::string, std::string> metadata_cache;
-    std::map<std::string, std::map<std::string, std::vector<pmtiles::entryv3>>> directory_cache;
-    std::map<std::string, std::vector<std::string>> directory_cache_control;
+    mbgl::unordered_map<std::string, uint32_t> archive_ids;
+    uint32_t nextArchiveID = 0;
+    DirectoryCache directory_cache;
+#ifndef _WIN32
+    std::map<std::string, std::unique_ptr<LocalFile>> local_files;
+#endif
     std::map<AsyncRequest*, std::unique_ptr<AsyncRequest>> tasks;
 
     std::shared_ptr<FileSource> getFileSource() {
@@ -221,16 +473,15 @@ private:
     void getHeader(const std::string& url, AsyncRequest* req, AsyncCallback callback) {
         if (header_cache.contains(url)) {
             callback(std::unique_ptr<Response::Error>());
+            return;
         }
 
-        Resource resource(Resource::Kind::Source, url);
-        resource.loadingMethod = Resource::LoadingMethod::Network;
-
-        resource.dataRange = std::make_pair<uint64_t, uint64_t>(pmtilesHeaderOffset,
-                                                                pmtilesHeaderOffset + pmtilesHeaderLength - 1);
-
-        tasks[req] = getFileSource()->request(
-            resource, [=, this](const Response& response) { // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
+        readRange(
+            url,
+            req,
+            pmtilesHeaderOffset,
+            pmtilesHeaderLength,
+            [=, this](const Response& response) { // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
                 if (response.error) {
                     std::string message = std::string("Error fetching PMTiles header: ") + response.error->message;
 
@@ -252,10 +503,8 @@ private:
                 try {
                     pmtiles::headerv3 header = pmtiles::deserialize_header(response.data->substr(0, 127));
 
-                    if ((header.internal_compression != pmtiles::COMPRESSION_NONE &&
-                         header.internal_compression != pmtiles::COMPRESSION_GZIP) ||
-                        (header.tile_compression != pmtiles::COMPRESSION_NONE &&
-                         header.tile_compression != pmtiles::COMPRESSION_GZIP)) {
+                    if (!isSupportedCompression(header.internal_compression) ||
+                        !isSupportedCompression(header.tile_compression)) {
                         throw std::runtime_error("Compression method not supported");
                     }
 
@@ -272,6 +521,7 @@ private:
     void getMetadata(std::string& url, AsyncRequest* req, AsyncCallback callback) {
         if (metadata_cache.contains(url)) {
             callback(std::unique_ptr<Response::Error>());
+            return;
         }
 
         getHeader(
@@ -385,28 +635,27 @@ private:
                 };
 
                 if (header.json_metadata_bytes > 0) {
-                    Resource resource(Resource::Kind::Source, url);
-                    resource.loadingMethod = Resource::LoadingMethod::Network;
-                    resource.dataRange = std::make_pair(header.json_metadata_offset,
-                                                        header.json_metadata_offset + header.json_metadata_bytes - 1);
+                    readRange(
+                        url,
+                        req,
+                        header.json_metadata_offset,
+                        header.json_metadata_bytes,
+                        [=](const Response& responseMetadata) {
+                            if (responseMetadata.error) {
+                                callback(std::make_unique<Response::Error>(
+                                    responseMetadata.error->reason,
+                                    std::string("Error fetching PMTiles metadata: ") +
+                                        responseMetadata.error->message));
 
-                    tasks[req] = getFileSource()->request(resource, [=](const Response& responseMetadata) {
-                        if (responseMetadata.error) {
-                            callback(std::make_unique<Response::Error>(
-                                responseMetadata.error->reason,
-                                std::string("Error fetching PMTiles metadata: ") + responseMetadata.error->message));
-
-                            return;
-                        }
+                                return;
+                            }
 
-                        std::string data = *responseMetadata.data;
+                            std::string data = *responseMetadata.data;
 
-                        if (header.internal_compression == pmtiles::COMPRESSION_GZIP) {
-                            data = util::decompress(data);
-                        }
+                            data = decompress(data, header.internal_compression);
 
-                        parse_callback(data);
-                    });
+                            parse_callback(data);
+                        });
 
                     return;
                 }
@@ -415,87 +664,116 @@ private:
             });
     }
 
-    void storeDirectory(const std::string& url,
-                        uint64_t directoryOffset,
-                        uint64_t directoryLength,
-                        const std::string& directoryData) {
-        if (!directory_cache.contains(url)) {
-            directory_cache.emplace(url, std::map<std::string, std::vector<pmtiles::entryv3>>());
-            directory_cache_control.emplace(url, std::vector<std::string>());
+    // Read a range of the archive, straight from a mapping of the file if it is local
+    void readRange(
+        const std::string& url, AsyncRequest* req, uint64_t offset, uint64_t length, FileSource::Callback callback) {
+#ifndef _WIN32
+        if (auto it = local_files.find(url); it != local_files.end()) {
+            Response response;
+            try {
+                response.data = std::make_shared<const std::string>(it->second->read(offset, length));
+            } catch (const std::exception& e) {
+                response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, e.what());
+            }
+            callback(response);
+            return;
+        }
+#endif
+
+        Resource resource(Resource::Kind::Source, url);
+        resource.loadingMethod = Resource::LoadingMethod::Network;
+        resource.dataRange = std::make_pair(offset, offset + length - 1);
+
+        tasks[req] = getFileSource()->request(resource, std::move(callback));
+    }
+
+#ifndef _WIN32
+    // Makes sure that what is cached about a local archive comes from the file that is at its path now.
+    // A file replaced or truncated in place must not be read through an old mapping, which would fault
+    // on pages past its new end. Files that can't be opened aren't remembered, they go through the file
+    // source, which also reports missing files.
+    void openLocalFile(const std::string& url) {
+        if (!url.starts_with(util::FILE_PROTOCOL)) {
+            return;
         }
 
-        std::string directory_cache_key = url + "|" + std::to_string(directoryOffset) + "|" +
-                                          std::to_string(directoryLength);
-        directory_cache.at(url).emplace(directory_cache_key, pmtiles::deserialize_directory(directoryData));
-        directory_cache_control.at(url).emplace_back(directory_cache_key);
+        const auto path = util::percentDecode(url.substr(std::char_traits<char>::length(util::FILE_PROTOCOL)));
+        const auto identity = LocalFile::identify(path);
+        if (auto it = local_files.find(url); it != local_files.end()) {
+            if (identity && it->second->getIdentity() == *identity) {
+                return;
+            }
+            // Everything read from the file is synchronous, so nothing is waiting on what we drop here
+            forgetArchive(url);
+            local_files.erase(it);
+        }
+        if (auto file = identity ? LocalFile::open(path) : nullptr) {
+            local_files.emplace(url, std::move(file));
+        }
+    }
+#endif
+
+    // Drops the header and metadata of an archive. Its directories age out of the cache, since the
+    // archive gets a new ID.
+    void forgetArchive(const std::string& url) {
+        header_cache.erase(url);
+        metadata_cache.erase(url);
+        archive_ids.erase(url);
+    }
 
-        if (directory_cache_control.at(url).size() > MAX_DIRECTORY_CACHE_ENTRIES) {
-            directory_cache.at(url).erase(directory_cache_control.at(url).front());
-            directory_cache_control.at(url).erase(directory_cache_control.at(url).begin());
+    uint32_t getArchiveID(const std::string& url) {
+        auto it = archive_ids.find(url);
+        if (it == archive_ids.end()) {
+            it = archive_ids.emplace(url, nextArchiveID++).first;
         }
+        return it->second;
     }
 
     void getDirectory(const std::string& url,
                       AsyncRequest* req,
                       uint64_t directoryOffset,
                       uint32_t directoryLength,
-                      AsyncCallback callback) {
-        std::string directory_cache_key = url + "|" + std::to_string(directoryOffset) + "|" +
-                                          std::to_string(directoryLength);
-
-        if (directory_cache.contains(url) && directory_cache.at(url).contains(directory_cache_key)) {
-            if (directory_cache_control.at(url).back() != directory_cache_key) {
-                directory_cache_control.at(url).emplace_back(directory_cache_key);
-
-                for (auto it = directory_cache_control.at(url).begin(); it != directory_cache_control.at(url).end();
-                     ++it) {
-                    if (*it == directory_cache_key) {
-                        directory_cache_control.at(url).erase(it);
-                        break;
-                    }
-                }
-            }
+                      AsyncDirectoryCallback callback) {
+        const DirectoryCache::Key key{
+            .archive = getArchiveID(url), .length = directoryLength, .offset = directoryOffset};
 
-            callback(std::unique_ptr<Response::Error>());
+        if (auto directory = directory_cache.get(key)) {
+            callback(std::move(directory), {});
             return;
         }
 
         getHeader(url, req, [=, this](std::unique_ptr<Response::Error> error) {
             if (error) {
-                callback(std::move(error));
+                callback(nullptr, std::move(error));
                 return;
             }
 
             pmtiles::headerv3 header = header_cache.at(url);
 
-            Resource resource(Resource::Kind::Source, url);
-            resource.loadingMethod = Resource::LoadingMethod::Network;
-            resource.dataRange = std::make_pair(directoryOffset, directoryOffset + directoryLength - 1);
-
-            tasks[req] = getFileSource()->request(resource, [=, this](const Response& response) {
+            readRange(url, req, directoryOffset, directoryLength, [=, this](const Response& response) {
                 if (response.error) {
-                    callback(std::make_unique<Response::Error>(
-                        response.error->reason,
-                        std::string("Error fetching PMTiles directory: ") + response.error->message));
+                    callback(nullptr,
+                             std::make_unique<Response::Error>(
+                                 response.error->reason,
+                                 std::string("Error fetching PMTiles directory: ") + response.error->message));
 
                     return;
                 }
 
+                std::shared_ptr<const Directory> directory;
                 try {
-                    std::string directoryData = *response.data;
-
-                    if (header.internal_compression == pmtiles::COMPRESSION_GZIP) {
-                        directoryData = util::decompress(directoryData);
-                    }
-
-                    storeDirectory(url, directoryOffset, directoryLength, directoryData);
-
-                    callback(std::unique_ptr<Response::Error>());
+                    directory = std::make_shared<const Directory>(
+                        pmtiles::deserialize_directory(decompress(*response.data, header.internal_compression)));
                 } catch (const std::exception& e) {
-                    callback(std::make_unique<Response::Error>(
-                        Response::Error::Reason::Other,
-                        std::string(std::string("Error parsing PMTiles directory: ") + e.what())));
+                    callback(nullptr,
+                             std::make_unique<Response::Error>(
+                                 Response::Error::Reason::Other,
+                                 std::string(std::string("Error parsing PMTiles directory: ") + e.what())));
+                    return;
                 }
+
+                directory_cache.add(key, directory);
+                callback(std::move(directory), {});
             });
         });
     }
@@ -521,17 +799,15 @@ private:
             req,
             directoryOffset,
             directoryLength,
-            [=, this](std::unique_ptr<Response::Error> error) { // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
+            [=, this](std::shared_ptr<const Directory> directory,
+                      std::unique_ptr<Response::Error> error) { // NOLINT(clang-analyzer-cplusplus.NewDeleteLeaks)
                 if (error) {
                     callback(std::make_pair(0, 0), std::move(error));
                     return;
                 }
 
-                pmtiles::headerv3 header = header_cache.at(url);
-                std::vector<pmtiles::entryv3> directory = directory_cache.at(url).at(
-                    url + "|" + std::to_string(directoryOffset) + "|" + std::to_string(directoryLength));
-
-                pmtiles::entryv3 entry = pmtiles::find_tile(directory, tileID);
+                const pmtiles::headerv3& header = header_cache.at(url);
+                pmtiles::entryv3 entry = pmtiles::find_tile(*directory, tileID);
 
                 if (entry.length > 0) {
                     if (entry.run_length > 0) {
@@ -605,4 +881,8 @@ ClientOptions PMTilesFileSource::getClientOptions() {
     return thread->actor().ask(&Impl::getClientOptions).get();
 }
 
+PMTilesFileSource::DirectoryCacheStats PMTilesFileSource::getDirectoryCacheStats() {
+    return thread->actor().ask(&Impl::getDirectoryCacheStats).get();
+}
+
 } // namespace mbgl
@@ -35,4 +35,8 @@ ClientOptions PMTilesFileSource::getClientOptions() {
     return {};
 }
 
+PMTilesFileSource::DirectoryCacheStats PMTilesFileSource::getDirectoryCacheStats() {
+    return {};
+}
+
 } // namespace mbgl
@@ -6,8 +6,19 @@
 #include <zlib.h>
 #endif
 
+#if defined(MLN_WITH_LIBDEFLATE)
+#include <libdeflate.h>
+#endif
+
+#if defined(MLN_WITH_ZSTD)
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <optional>
 #include <stdexcept>
 
 // Check zlib library version.
@@ -31,30 +42,9 @@ namespace util {
 // cause a link error.
 #undef compress
 
-bool is_compressed(const std::string &v) {
-    if (v.size() > 2) {
-        const auto byte0 = static_cast<uint8_t>(v[0]);
-        const auto byte1 = static_cast<uint8_t>(v[1]);
-        if (byte0 == 0x1f && byte1 == 0x8b) {
-            // gzip (rfc1952)
-            return true;
-        } else if (byte0 == 0x78) {
-            // zlib (rfc1950)
-            switch (byte1) {
-                case 0x01: // 78 01 - No Compression/low
-                case 0x5E: // 78 5E - Fast Compression
-                case 0x9C: // 78 9C - Default Compression
-                case 0xDA: // 78 DA - Best Compression
-                    return true;
-                default:
-                    return false;
-            }
-        }
-    }
-    return false;
-}
+namespace {
 
-std::string compress(const std::string &raw, int windowBits) {
+std::string zlibCompress(const std::string &raw, int windowBits) {
     z_stream deflate_stream;
     memset(&deflate_stream, 0, sizeof(deflate_stream));
 
@@ -89,7 +79,7 @@ std::string compress(const std::string &raw, int windowBits) {
     return result;
 }
 
-std::string decompress(const std::string &raw, int windowBits) {
+std::string zlibDecompress(const std::string &raw, int windowBits) {
     z_stream inflate_stream;
     memset(&inflate_stream, 0, sizeof(inflate_stream));
 
@@ -123,6 +113,363 @@ std::string decompress(const std::string &raw, int windowBits) {
     return result;
 }
 
+// Sizes recorded in headers and trailers are part of the input, so a decompressed size beyond this isn't trusted to
+// allocate the result up front. Larger outputs grow as decompression actually needs the memory.
+constexpr size_t maxPresizedContent = 16 * 1024 * 1024;
+
+#if defined(MLN_WITH_LIBDEFLATE)
+
+// libdeflate only works on whole buffers, which is all we need, and does so several times faster than zlib. Its
+// (de)compressors are expensive to allocate, so each thread keeps one.
+struct DeflateDeleter {
+    void operator()(libdeflate_compressor *compressor) const { libdeflate_free_compressor(compressor); }
+    void operator()(libdeflate_decompressor *decompressor) const { libdeflate_free_decompressor(decompressor); }
+};
+
+libdeflate_compressor &threadCompressor() {
+    // Level 6 is what zlib uses for Z_DEFAULT_COMPRESSION, and gets the same 78 9C zlib header.
+    thread_local std::unique_ptr<libdeflate_compressor, DeflateDeleter> compressor{libdeflate_alloc_compressor(6)};
+    if (!compressor) {
+        throw std::runtime_error("failed to initialize deflate");
+    }
+    return *compressor;
+}
+
+libdeflate_decompressor &threadDecompressor() {
+    thread_local std::unique_ptr<libdeflate_decompressor, DeflateDeleter> decompressor{
+        libdeflate_alloc_decompressor()};
+    if (!decompressor) {
+        throw std::runtime_error("failed to initialize inflate");
+    }
+    return *decompressor;
+}
+
+// Returns nullopt for window sizes libdeflate doesn't handle.
+std::optional<std::string> deflateCompress(const std::string &raw, int windowBits) {
+    size_t (*bound)(libdeflate_compressor *, size_t);
+    size_t (*compressBuffer)(libdeflate_compressor *, const void *, size_t, void *, size_t);
+    switch (windowBits) {
+        case CompressionFormat::ZLIB:
+            bound = libdeflate_zlib_compress_bound;
+            compressBuffer = libdeflate_zlib_compress;
+            break;
+        case CompressionFormat::GZIP:
+            bound = libdeflate_gzip_compress_bound;
+            compressBuffer = libdeflate_gzip_compress;
+            break;
+        case CompressionFormat::DEFLATE:
+            bound = libdeflate_deflate_compress_bound;
+            compressBuffer = libdeflate_deflate_compress;
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    auto &compressor = threadCompressor();
+    std::string result(bound(&compressor, raw.size()), '\0');
+    const size_t size = compressBuffer(&compressor, raw.data(), raw.size(), result.data(), result.size());
+    if (size == 0) {
+        return std::nullopt;
+    }
+    result.resize(size);
+    return result;
+}
+
+// Returns nullopt where zlib should have the final say: window sizes libdeflate doesn't handle, data it rejects
+// (zlib produces the error message, and accepts trailing garbage), and implausibly large outputs.
+std::optional<std::string> deflateDecompress(const std::string &raw, int windowBits) {
+    const bool gzip = raw.size() > 2 && static_cast<uint8_t>(raw[0]) == 0x1f && static_cast<uint8_t>(raw[1]) == 0x8b;
+    if (windowBits == CompressionFormat::DETECT) {
+        windowBits = gzip ? CompressionFormat::GZIP : CompressionFormat::ZLIB;
+    }
+
+    libdeflate_result (*decompressBuffer)(libdeflate_decompressor *, const void *, size_t, void *, size_t, size_t *);
+    switch (windowBits) {
+        case CompressionFormat::ZLIB:
+            decompressBuffer = libdeflate_zlib_decompress;
+            break;
+        case CompressionFormat::GZIP:
+            decompressBuffer = libdeflate_gzip_decompress;
+            break;
+        case CompressionFormat::DEFLATE:
+            decompressBuffer = libdeflate_deflate_decompress;
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    // The output size has to be known up front. Gzip records it (modulo 2^32) in its trailer, which is only a hint,
+    // as deflate can't expand data more than 1032 times; otherwise guess a typical ratio and grow.
+    size_t capacity = raw.size() * 4 + 64;
+    if (windowBits == CompressionFormat::GZIP && gzip && raw.size() >= 18) {
+        const auto *trailer = reinterpret_cast<const uint8_t *>(raw.data() + raw.size() - 4);
+        const size_t recorded = size_t(trailer[0]) | (size_t(trailer[1]) << 8) | (size_t(trailer[2]) << 16) |
+                                (size_t(trailer[3]) << 24);
+        capacity = std::max(capacity, std::min({recorded, raw.size() * 1032, maxPresizedContent}));
+    }
+    constexpr size_t maxCapacity = size_t(1) << 30;
+
+    auto &decompressor = threadDecompressor();
+    std::string result;
+    while (capacity <= maxCapacity) {
+        result.resize(capacity);
+        size_t size = 0;
+        switch (decompressBuffer(&decompressor, raw.data(), raw.size(), result.data(), result.size(), &size)) {
+            case LIBDEFLATE_SUCCESS:
+                result.resize(size);
+                return result;
+            case LIBDEFLATE_INSUFFICIENT_SPACE:
+                capacity *= 2;
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+#endif
+
+#if defined(MLN_WITH_ZSTD)
+
+struct ZstdDeleter {
+    void operator()(ZSTD_CCtx *context) const { ZSTD_freeCCtx(context); }
+    void operator()(ZSTD_DCtx *context) const { ZSTD_freeDCtx(context); }
+    void operator()(ZSTD_CDict *dictionary) const { ZSTD_freeCDict(dictionary); }
+    void operator()(ZSTD_DDict *dictionary) const { ZSTD_freeDDict(dictionary); }
+};
+
+ZSTD_CCtx &threadCompressionContext() {
+    thread_local std::unique_ptr<ZSTD_CCtx, ZstdDeleter> context{ZSTD_createCCtx()};
+    if (!context) {
+        throw std::runtime_error("failed to initialize zstd compression");
+    }
+    return *context;
+}
+
+ZSTD_DCtx &threadDecompressionContext() {
+    thread_local std::unique_ptr<ZSTD_DCtx, ZstdDeleter> context{ZSTD_createDCtx()};
+    if (!context) {
+        throw std::runtime_error("failed to initialize zstd decompression");
+    }
+    return *context;
+}
+
+void checkZstd(size_t code) {
+    if (ZSTD_isError(code)) {
+        throw std::runtime_error(ZSTD_getErrorName(code));
+    }
+}
+
+#endif
+
+} // namespace
+
+#if defined(MLN_WITH_ZSTD)
+struct CompressionDictionary::Impl {
+    std::unique_ptr<ZSTD_CDict, ZstdDeleter> compression;
+    std::unique_ptr<ZSTD_DDict, ZstdDeleter> decompression;
+};
+#else
+struct CompressionDictionary::Impl {};
+#endif
+
+CompressionDictionary::CompressionDictionary(std::string data_)
+    : data(std::move(data_)),
+      impl(std::make_unique<Impl>()) {
+    // Header of a Zstandard dictionary: a magic number, then the ID, both little endian.
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    const auto readUint32 = [&](size_t offset) {
+        return uint32_t(bytes[offset]) | (uint32_t(bytes[offset + 1]) << 8) | (uint32_t(bytes[offset + 2]) << 16) |
+               (uint32_t(bytes[offset + 3]) << 24);
+    };
+    if (data.size() < 8 || readUint32(0) != 0xEC30A437 || readUint32(4) == 0) {
+        throw std::runtime_error("invalid compression dictionary");
+    }
+    id = readUint32(4);
+
+#if defined(MLN_WITH_ZSTD)
+    impl->compression.reset(ZSTD_createCDict(data.data(), data.size(), ZSTD_CLEVEL_DEFAULT));
+    impl->decompression.reset(ZSTD_createDDict(data.data(), data.size()));
+    if (!impl->compression || !impl->decompression) {
+        throw std::runtime_error("invalid compression dictionary");
+    }
+#endif
+}
+
+CompressionDictionary::~CompressionDictionary() = default;
+
+std::shared_ptr<const CompressionDictionary> CompressionDictionary::train(
+    [[maybe_unused]] const std::vector<std::string> &samples, [[maybe_unused]] std::size_t maxSize) {
+#if defined(MLN_WITH_ZSTD)
+    std::string buffer;
+    std::vector<size_t> sizes;
+    for (const auto &sample : samples) {
+        if (!sample.empty()) {
+            buffer += sample;
+            sizes.push_back(sample.size());
+        }
+    }
+
+    std::string dictionary(maxSize, '\0');
+    const size_t size = ZDICT_trainFromBuffer(
+        dictionary.data(), dictionary.size(), buffer.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size)) {
+        return nullptr;
+    }
+    dictionary.resize(size);
+    return std::make_shared<const CompressionDictionary>(std::move(dictionary));
+#else
+    return nullptr;
+#endif
+}
+
+bool isAvailable(Codec codec) noexcept {
+    switch (codec) {
+        case Codec::None:
+        case Codec::Zlib:
+            return true;
+        case Codec::Zstd:
+#if defined(MLN_WITH_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool is_compressed(const std::string &v) {
+    if (v.size() > 2) {
+        const auto byte0 = static_cast<uint8_t>(v[0]);
+        const auto byte1 = static_cast<uint8_t>(v[1]);
+        if (byte0 == 0x1f && byte1 == 0x8b) {
+            // gzip (rfc1952)
+            return true;
+        } else if (byte0 == 0x78) {
+            // zlib (rfc1950)
+            switch (byte1) {
+                case 0x01: // 78 01 - No Compression/low
+                case 0x5E: // 78 5E - Fast Compression
+                case 0x9C: // 78 9C - Default Compression
+                case 0xDA: // 78 DA - Best Compression
+                    return true;
+                default:
+                    return false;
+            }
+        }
+    }
+    return false;
+}
+
+std::string compress(const std::string &raw, int windowBits) {
+#if defined(MLN_WITH_LIBDEFLATE)
+    if (auto result = deflateCompress(raw, windowBits)) {
+        return std::move(*result);
+    }
+#endif
+    return zlibCompress(raw, windowBits);
+}
+
+std::string decompress(const std::string &raw, int windowBits) {
+#if defined(MLN_WITH_LIBDEFLATE)
+    if (auto result = deflateDecompress(raw, windowBits)) {
+        return std::move(*result);
+    }
+#endif
+    return zlibDecompress(raw, windowBits);
+}
+
+std::string compress(const std::string &raw, Codec codec, [[maybe_unused]] const CompressionDictionary *dictionary) {
+    switch (codec) {
+        case Codec::None:
+            return raw;
+        case Codec::Zlib:
+            return compress(raw);
+        case Codec::Zstd: {
+#if defined(MLN_WITH_ZSTD)
+            auto &context = threadCompressionContext();
+            checkZstd(ZSTD_CCtx_reset(&context, ZSTD_reset_session_and_parameters));
+            if (dictionary) {
+                checkZstd(ZSTD_CCtx_refCDict(&context, dictionary->impl->compression.get()));
+            }
+
+            std::string result(ZSTD_compressBound(raw.size()), '\0');
+            const size_t size = ZSTD_compress2(&context, result.data(), result.size(), raw.data(), raw.size());
+            checkZstd(size);
+            result.resize(size);
+            return result;
+#else
+            break;
+#endif
+        }
+    }
+    throw std::runtime_error("compression codec not available");
+}
+
+std::string decompress(const std::string &compressed,
+                       Codec codec,
+                       [[maybe_unused]] const CompressionDictionary *dictionary) {
+    switch (codec) {
+        case Codec::None:
+            return compressed;
+        case Codec::Zlib:
+            return decompress(compressed);
+        case Codec::Zstd: {
+#if defined(MLN_WITH_ZSTD)
+            auto &context = threadDecompressionContext();
+            checkZstd(ZSTD_DCtx_reset(&context, ZSTD_reset_session_and_parameters));
+            if (dictionary) {
+                checkZstd(ZSTD_DCtx_refDDict(&context, dictionary->impl->decompression.get()));
+            }
+
+            const auto contentSize = ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+            if (contentSize == ZSTD_CONTENTSIZE_ERROR) {
+                throw std::runtime_error("decompression error");
+            }
+
+            std::string result;
+            if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize <= maxPresizedContent) {
+                result.resize(static_cast<std::size_t>(contentSize));
+                const size_t size = ZSTD_decompressDCtx(
+                    &context, result.data(), result.size(), compressed.data(), compressed.size());
+                checkZstd(size);
+                result.resize(size);
+                return result;
+            }
+
+            // Frames written by a streaming encoder don't record their size, and large sizes aren't trusted.
+            ZSTD_inBuffer input{compressed.data(), compressed.size(), 0};
+            char out[16384];
+            size_t code;
+            bool full;
+            do {
+                ZSTD_outBuffer output{out, sizeof(out), 0};
+                code = ZSTD_decompressStream(&context, &output, &input);
+                checkZstd(code);
+                result.append(out, output.pos);
+                full = output.pos == output.size;
+            } while (code != 0 && (input.pos < input.size || full));
+            if (code != 0) {
+                throw std::runtime_error("decompression error");
+            }
+            return result;
+#else
+            break;
+#endif
+        }
+    }
+    throw std::runtime_error("compression codec not available");
+}
+
+uint32_t getDictionaryID([[maybe_unused]] const std::string &compressed) noexcept {
+#if defined(MLN_WITH_ZSTD)
+    return ZSTD_getDictID_fromFrame(compressed.data(), compressed.size());
+#else
+    return 0;
+#endif
+}
+
 std::uint32_t crc32(const void *raw, size_t size) noexcept {
     auto hash = ::crc32(0L, Z_NULL, 0);
     if (raw) {
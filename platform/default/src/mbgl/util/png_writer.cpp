@@ -1,11 +1,29 @@
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/image.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
 #include <mbgl/util/premultiply.hpp>
 
 #include <boost/crc.hpp>
 
+#if defined(__QT__) && (defined(_WIN32) || defined(__EMSCRIPTEN__))
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+// Needed when using a zlib compiled with -DZ_PREFIX
+// because it will mess with util::compress.
+#undef compress
+
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #define NETWORK_BYTE_UINT32(value) char((value) >> 24), char((value) >> 16), char((value) >> 8), char((value) >> 0)
 
@@ -33,6 +51,250 @@ void addChunk(std::string& png, const char* type, const char* data = "", const u
 
 namespace mbgl {
 
+namespace {
+
+using Filter = PNGEncodeOptions::Filter;
+
+// Scanlines as they go into the image data: RGBA pixels, or palette indices packed into bytes.
+struct Scanlines {
+    std::vector<uint8_t> data;
+    std::size_t stride = 0;
+    uint32_t height = 0;
+    // Distance between a byte and the corresponding byte of the pixel to its left, as the filters see it
+    std::size_t bytesPerPixel = 4;
+
+    const uint8_t* row(uint32_t y) const { return data.data() + y * stride; }
+};
+
+struct Palette {
+    std::vector<uint32_t> colors; // RGBA in memory order
+    uint8_t bitDepth = 8;
+};
+
+// The distinct colors of the image, if there are no more than 256, in order of first appearance
+std::optional<Palette> findPalette(const UnassociatedImage& image) {
+    Palette palette;
+    std::unordered_map<uint32_t, uint8_t> indices;
+    const auto* pixels = image.data.get();
+    for (std::size_t i = 0; i < image.bytes(); i += 4) {
+        uint32_t color;
+        std::memcpy(&color, pixels + i, 4);
+        if (indices.emplace(color, static_cast<uint8_t>(palette.colors.size())).second) {
+            if (palette.colors.size() == 256) {
+                return std::nullopt;
+            }
+            palette.colors.push_back(color);
+        }
+    }
+    const auto count = palette.colors.size();
+    palette.bitDepth = count <= 2 ? 1 : count <= 4 ? 2 : count <= 16 ? 4 : 8;
+    return palette;
+}
+
+Scanlines indexScanlines(const UnassociatedImage& image, const Palette& palette) {
+    std::unordered_map<uint32_t, uint8_t> indices;
+    for (std::size_t i = 0; i < palette.colors.size(); ++i) {
+        indices.emplace(palette.colors[i], static_cast<uint8_t>(i));
+    }
+
+    Scanlines scanlines;
+    scanlines.stride = (static_cast<std::size_t>(image.size.width) * palette.bitDepth + 7) / 8;
+    scanlines.height = image.size.height;
+    scanlines.bytesPerPixel = 1;
+    scanlines.data.resize(scanlines.stride * scanlines.height);
+
+    // Pixels fill bytes from the most significant bits on
+    const auto* pixels = image.data.get();
+    const int pixelsPerByte = 8 / palette.bitDepth;
+    for (uint32_t y = 0; y < image.size.height; ++y) {
+        uint8_t* row = scanlines.data.data() + y * scanlines.stride;
+        for (uint32_t x = 0; x < image.size.width; ++x) {
+            uint32_t color;
+            std::memcpy(&color, pixels + (static_cast<std::size_t>(y) * image.size.width + x) * 4, 4);
+            const int shift = 8 - palette.bitDepth * (1 + static_cast<int>(x) % pixelsPerByte);
+            row[x / pixelsPerByte] |= static_cast<uint8_t>(indices[color] << shift);
+        }
+    }
+    return scanlines;
+}
+
+uint8_t paeth(uint8_t left, uint8_t up, uint8_t upLeft) {
+    const int p = left + up - upLeft;
+    const int pa = std::abs(p - left);
+    const int pb = std::abs(p - up);
+    const int pc = std::abs(p - upLeft);
+    return pa <= pb && pa <= pc ? left : pb <= pc ? up : upLeft;
+}
+
+// Writes the filter type byte and the filtered row to `out`. `previous` is null for the first row.
+void filterRow(Filter filter,
+               const uint8_t* row,
+               const uint8_t* previous,
+               std::size_t length,
+               std::size_t bpp,
+               uint8_t* out) {
+    out[0] = static_cast<uint8_t>(filter);
+    uint8_t* filtered = out + 1;
+    for (std::size_t i = 0; i < length; ++i) {
+        const uint8_t left = i >= bpp ? row[i - bpp] : 0;
+        const uint8_t up = previous ? previous[i] : 0;
+        const uint8_t upLeft = previous && i >= bpp ? previous[i - bpp] : 0;
+        switch (filter) {
+            case Filter::Sub:
+                filtered[i] = row[i] - left;
+                break;
+            case Filter::Up:
+                filtered[i] = row[i] - up;
+                break;
+            case Filter::Average:
+                filtered[i] = row[i] - static_cast<uint8_t>((left + up) / 2);
+                break;
+            case Filter::Paeth:
+                filtered[i] = row[i] - paeth(left, up, upLeft);
+                break;
+            default:
+                filtered[i] = row[i];
+                break;
+        }
+    }
+}
+
+// Tries each filter and keeps the one whose output has the smallest sum of absolute values, taking bytes as signed
+void filterRowAdaptive(const uint8_t* row,
+                       const uint8_t* previous,
+                       std::size_t length,
+                       std::size_t bpp,
+                       uint8_t* out,
+                       std::vector<uint8_t>& scratch) {
+    scratch.resize(length + 1);
+    uint64_t best = UINT64_MAX;
+    for (const auto filter : {Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth}) {
+        filterRow(filter, row, previous, length, bpp, scratch.data());
+        uint64_t sum = 0;
+        for (std::size_t i = 1; i <= length; ++i) {
+            sum += static_cast<uint64_t>(std::abs(static_cast<int8_t>(scratch[i])));
+        }
+        if (sum < best) {
+            best = sum;
+            std::copy(scratch.begin(), scratch.end(), out);
+        }
+    }
+}
+
+// Filters rows [begin, end) into the bytes that go into the compressed stream
+std::string filterRows(const Scanlines& scanlines, Filter filter, uint32_t begin, uint32_t end) {
+    std::string out((end - begin) * (scanlines.stride + 1), '\0');
+    std::vector<uint8_t> scratch;
+    for (uint32_t y = begin; y < end; ++y) {
+        const uint8_t* previous = y > 0 ? scanlines.row(y - 1) : nullptr;
+        auto* target = reinterpret_cast<uint8_t*>(out.data()) + (y - begin) * (scanlines.stride + 1);
+        if (filter == Filter::Adaptive) {
+            filterRowAdaptive(scanlines.row(y), previous, scanlines.stride, scanlines.bytesPerPixel, target, scratch);
+        } else {
+            filterRow(filter, scanlines.row(y), previous, scanlines.stride, scanlines.bytesPerPixel, target);
+        }
+    }
+    return out;
+}
+
+// One part of the zlib stream: raw deflate blocks of some rows, ending byte aligned so that the next part's
+// blocks can follow. Only the last part has the final block.
+struct Part {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    std::string deflated;
+    uLong adler = 1;
+    std::size_t length = 0;
+};
+
+constexpr std::size_t windowBytes = 32 * 1024;
+
+void deflatePart(const Scanlines& scanlines, Filter filter, int level, bool last, Part& part) {
+    const std::string filtered = filterRows(scanlines, filter, part.begin, part.end);
+    part.length = filtered.size();
+    part.adler = adler32(1, reinterpret_cast<const Bytef*>(filtered.data()), static_cast<uInt>(filtered.size()));
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("failed to initialize deflate");
+    }
+    if (part.begin > 0) {
+        // Prime the window with the end of the previous part, as pigz does, so that matches can reach back
+        // across the part boundary. Filtering only looks one row back, so refiltering those rows here gives
+        // the same bytes the previous part compresses.
+        const uint32_t rows = std::min<uint32_t>(
+            part.begin, static_cast<uint32_t>((windowBytes + scanlines.stride) / (scanlines.stride + 1)));
+        const std::string previous = filterRows(scanlines, filter, part.begin - rows, part.begin);
+        const std::size_t size = std::min(previous.size(), windowBytes);
+        if (deflateSetDictionary(&stream,
+                                 reinterpret_cast<const Bytef*>(previous.data() + previous.size() - size),
+                                 static_cast<uInt>(size)) != Z_OK) {
+            deflateEnd(&stream);
+            throw std::runtime_error("failed to set deflate dictionary");
+        }
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(filtered.data()));
+    stream.avail_in = static_cast<uInt>(filtered.size());
+    part.deflated.resize(deflateBound(&stream, static_cast<uLong>(filtered.size())) + 16);
+    stream.next_out = reinterpret_cast<Bytef*>(part.deflated.data());
+    stream.avail_out = static_cast<uInt>(part.deflated.size());
+    // A sync flush ends with an empty stored block, which leaves the output byte aligned
+    const int code = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    part.deflated.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (code != (last ? Z_STREAM_END : Z_OK) || stream.avail_in != 0) {
+        throw std::runtime_error("failed to deflate image data");
+    }
+}
+
+constexpr std::size_t minPartBytes = 128 * 1024;
+
+// The zlib stream of the filtered scanlines, made of parts deflated independently, like pigz does. Each part
+// after the first starts from the previous part's last 32 KiB, so splitting costs little compression.
+std::string deflateScanlines(const Scanlines& scanlines, const PNGEncodeOptions& options) {
+    const int level = options.compressionLevel < 0 ? 6 : std::min(options.compressionLevel, 9);
+    const std::size_t totalBytes = scanlines.height * (scanlines.stride + 1);
+    const std::size_t partCount = std::clamp<std::size_t>(
+        std::min<std::size_t>(options.threads, totalBytes / minPartBytes), 1, std::max<uint32_t>(scanlines.height, 1));
+
+    std::vector<Part> parts(partCount);
+    for (std::size_t i = 0; i < partCount; ++i) {
+        parts[i].begin = static_cast<uint32_t>(i * scanlines.height / partCount);
+        parts[i].end = static_cast<uint32_t>((i + 1) * scanlines.height / partCount);
+    }
+
+    auto pool = Scheduler::GetBackground();
+    ParallelJobs::run(
+        partCount,
+        [&](std::size_t i) { deflatePart(scanlines, options.filter, level, i + 1 == partCount, parts[i]); },
+        *pool);
+
+    // zlib header for a 32 KiB window, with the level recorded as zlib would
+    const int cmf = 0x78;
+    int flg = (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+    flg += (31 - (cmf * 256 + flg) % 31) % 31;
+
+    std::string stream;
+    std::size_t size = 2 + 4;
+    for (const auto& part : parts) {
+        size += part.deflated.size();
+    }
+    stream.reserve(size);
+    stream.push_back(static_cast<char>(cmf));
+    stream.push_back(static_cast<char>(flg));
+    uLong adler = 1;
+    for (const auto& part : parts) {
+        stream.append(part.deflated);
+        adler = adler32_combine(adler, part.adler, static_cast<z_off_t>(part.length));
+    }
+    const char checksum[4] = {NETWORK_BYTE_UINT32(static_cast<uint32_t>(adler))};
+    stream.append(checksum, 4);
+    return stream;
+}
+
+} // namespace
+
 // Encode PNGs without libpng.
 std::string encodePNG(const PremultipliedImage& pre) {
     // Make copy of the image so that we can unpremultiply it.
@@ -72,4 +334,58 @@ std::string encodePNG(const PremultipliedImage& pre) {
     return png;
 }
 
+std::string encodePNG(const PremultipliedImage& pre, const PNGEncodeOptions& options) {
+    const auto src = util::unpremultiply(pre.clone());
+
+    const char preamble[8] = {char(0x89), 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    const auto palette = options.palette ? findPalette(src) : std::nullopt;
+    const char ihdr[13] = {
+        NETWORK_BYTE_UINT32(src.size.width),
+        NETWORK_BYTE_UINT32(src.size.height),
+        static_cast<char>(palette ? palette->bitDepth : 8),
+        static_cast<char>(palette ? 3 : 6), // color type == indexed or RGBA
+        0,
+        0,
+        0,
+    };
+
+    Scanlines scanlines;
+    if (palette) {
+        scanlines = indexScanlines(src, *palette);
+    } else {
+        scanlines.stride = src.stride();
+        scanlines.height = src.size.height;
+        scanlines.data.assign(src.data.get(), src.data.get() + src.bytes());
+    }
+    const std::string idat = deflateScanlines(scanlines, options);
+
+    std::string png;
+    png.reserve((8 /* preamble */) + (12 + 13 /* IHDR */) + (12 + 3 * 256 /* PLTE */) + (12 + 256 /* tRNS */) +
+                (12 + idat.size() /* IDAT */) + (12 /* IEND */));
+    png.append(preamble, 8);
+    addChunk(png, "IHDR", ihdr, 13);
+    if (palette) {
+        std::string plte;
+        std::string trns;
+        for (const uint32_t color : palette->colors) {
+            char rgba[4];
+            std::memcpy(rgba, &color, 4);
+            plte.append(rgba, 3);
+            trns.push_back(rgba[3]);
+        }
+        // Entries past the end of the transparency chunk are opaque
+        while (!trns.empty() && static_cast<uint8_t>(trns.back()) == 255) {
+            trns.pop_back();
+        }
+        addChunk(png, "PLTE", plte.data(), static_cast<uint32_t>(plte.size()));
+        if (!trns.empty()) {
+            addChunk(png, "tRNS", trns.data(), static_cast<uint32_t>(trns.size()));
+        }
+    }
+    addChunk(png, "IDAT", idat.data(), static_cast<uint32_t>(idat.size()));
+    addChunk(png, "IEND");
+    return png;
+}
+
 } // namespace mbgl
@@ -5,17 +5,26 @@
 #include <mbgl/util/scoped.hpp>
 
 #include <cassert>
+#include <thread>
 
 namespace mbgl {
 
 Mailbox::Mailbox() = default;
 
 Mailbox::Mailbox(Scheduler& scheduler_)
-    : weakScheduler(scheduler_.makeWeakPtr()) {}
+    : weakScheduler(scheduler_.makeWeakPtr()),
+      opened(true) {}
 
 Mailbox::Mailbox(const TaggedScheduler& scheduler_)
     : schedulerTag(scheduler_.tag),
-      weakScheduler(scheduler_.get()->makeWeakPtr()) {}
+      weakScheduler(scheduler_.get()->makeWeakPtr()),
+      opened(true) {}
+
+Mailbox::~Mailbox() {
+    while (Message* message = dequeue()) {
+        delete message;
+    }
+}
 
 void Mailbox::open(const TaggedScheduler& scheduler_) {
     assert(!weakScheduler);
@@ -26,18 +35,20 @@ void Mailbox::open(const TaggedScheduler& scheduler_) {
 void Mailbox::open(Scheduler& scheduler_) {
     assert(!weakScheduler);
 
-    // As with close(), block until neither receive() nor push() are in
-    // progress, and acquire the two mutexes in the same order.
+    // As with close(), block until receive() is not in progress. Calls to push() leave
+    // the scheduler alone until it is opened, and schedule a receive themselves if they
+    // see the mailbox opened after counting their message. Otherwise, this sees the
+    // message counted and schedules it.
     std::scoped_lock receivingLock(receivingMutex);
-    std::scoped_lock pushingLock(pushingMutex);
 
     if (closed) {
         return;
     }
 
     weakScheduler = scheduler_.makeWeakPtr();
+    opened = true;
 
-    if (!queue.empty()) {
+    if (pending > 0) {
         scheduleToRecieve();
     }
 }
@@ -45,16 +56,17 @@ void Mailbox::open(Scheduler& scheduler_) {
 void Mailbox::close() {
     abandon();
 
-    // Block until neither receive() nor push() are in progress. Two mutexes are
-    // used because receive() must not block send(). Of the two, the receiving
-    // mutex must be acquired first, because that is the order that an actor
-    // will obtain them when it self-sends a message, and consistent lock
-    // acquisition order prevents deadlocks. The receiving mutex is recursive to
-    // allow a mailbox (and thus the actor) to close itself.
+    // Block until neither receive() nor push() are in progress. receive() holds a
+    // mutex, which is recursive to allow a mailbox (and thus the actor) to close
+    // itself. push() must not block on receive(), and only counts itself: any call
+    // that counted itself before the mailbox was marked closed is waited for here,
+    // and any later one sees it closed and leaves the scheduler alone.
     std::scoped_lock receivingLock(receivingMutex);
-    std::scoped_lock pushingLock(pushingMutex);
 
     closed = true;
+    while (pushing > 0) {
+        std::this_thread::yield();
+    }
 
     weakScheduler = {};
 }
@@ -87,27 +99,21 @@ void Mailbox::push(std::unique_ptr<Message> message) {
         }
     }};
 
-    {
-        MLN_TRACE_ZONE(push lock);
-        std::scoped_lock pushingLock(pushingMutex);
+    ++pushing;
+    Scoped pushed{[this]() { --pushing; }};
 
-        if (closed) {
-            state = State::Abandoned;
-            return;
-        }
+    if (closed) {
+        state = State::Abandoned;
+        return;
+    }
 
-        bool wasEmpty = false;
-        {
-            MLN_TRACE_ZONE(queue lock);
-            std::scoped_lock queueLock(queueMutex);
-            wasEmpty = queue.empty();
-            queue.push(std::move(message));
-        }
+    enqueue(message.release());
 
-        if (wasEmpty) {
-            MLN_TRACE_ZONE(schedule);
-            scheduleToRecieve(schedulerTag);
-        }
+    // The push that makes the queue nonempty schedules its receipt, unless the
+    // mailbox is still holding messages, in which case open() does.
+    if (pending++ == 0 && opened) {
+        MLN_TRACE_ZONE(schedule);
+        scheduleToRecieve(schedulerTag);
     }
 }
 
@@ -131,26 +137,63 @@ void Mailbox::receive() {
         return;
     }
 
-    std::unique_ptr<Message> message;
-    bool wasEmpty = false;
-
-    {
-        std::scoped_lock queueLock(queueMutex);
-        assert(!queue.empty());
-        message = std::move(queue.front());
-        queue.pop();
-        wasEmpty = queue.empty();
+    std::unique_ptr<Message> message(dequeue());
+    if (!message) {
+        // Either an earlier receive took the message this one was scheduled for,
+        // or a push() is still linking in the next one, which is worth a retry.
+        if (pending > 0) {
+            scheduleToRecieve();
+        }
+        return;
     }
 
     (*message)();
+    message.reset();
 
     // If there are more messages in the queue and the scheduler
     // is still active, create a new task to handle the next one
-    if (!wasEmpty) {
+    if (pending-- > 1) {
         scheduleToRecieve();
     }
 }
 
+void Mailbox::enqueue(Message* message) {
+    message->next.store(nullptr, std::memory_order_relaxed);
+    Message* previous = head.exchange(message, std::memory_order_acq_rel);
+    // Until this store, receive() can't see past `previous`
+    previous->next.store(message, std::memory_order_release);
+}
+
+Message* Mailbox::dequeue() {
+    Message* first = tail;
+    Message* next = first->next.load(std::memory_order_acquire);
+    if (first == &stub) {
+        if (!next) {
+            return nullptr;
+        }
+        // Skip the stub, left behind when the queue last ran empty
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail = next;
+        return first;
+    }
+    if (first != head.load(std::memory_order_acquire)) {
+        // A push() has taken the head, but not linked it to `first` yet
+        return nullptr;
+    }
+    // `first` is the only message. Put the stub behind it so that it can be taken.
+    enqueue(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
 void Mailbox::scheduleToRecieve(const std::optional<util::SimpleIdentity>& tag) {
     if (auto guard = weakScheduler.lock(); weakScheduler) {
         std::weak_ptr<Mailbox> mailbox = shared_from_this();
@@ -159,11 +202,7 @@ void Mailbox::scheduleToRecieve(const std::optional<util::SimpleIdentity>& tag)
                 locked->receive();
             }
         };
-        if (tag) {
-            weakScheduler->schedule(*tag, std::move(setToRecieve));
-        } else {
-            weakScheduler->schedule(std::move(setToRecieve));
-        }
+        weakScheduler->schedule(tag.value_or(util::SimpleIdentity::Empty), priority, std::move(setToRecieve));
     }
 }
 
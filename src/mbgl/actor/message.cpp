@@ -0,0 +1,131 @@
+#include <mbgl/actor/message.hpp>
+
+#include <cassert>
+#include <new>
+
+namespace mbgl {
+
+namespace {
+
+// Precedes each message, to tell where its storage goes back to
+struct alignas(std::max_align_t) MessageHeader {
+    MessagePool* pool;
+};
+
+constexpr uint64_t slotMask = 0xFFFFFFFF;
+constexpr uint64_t changeCount = uint64_t(1) << 32;
+
+} // namespace
+
+void* Message::operator new(std::size_t size) {
+    auto* header = new (::operator new(sizeof(MessageHeader) + size)) MessageHeader{nullptr};
+    return header + 1;
+}
+
+void* Message::operator new(std::size_t size, MessagePool& pool) {
+    auto* header = new (pool.allocate(sizeof(MessageHeader) + size)) MessageHeader{&pool};
+    return header + 1;
+}
+
+void Message::operator delete(void* message) noexcept {
+    if (!message) {
+        return;
+    }
+    auto* header = static_cast<MessageHeader*>(message) - 1;
+    if (header->pool) {
+        header->pool->deallocate(header);
+    } else {
+        ::operator delete(header);
+    }
+}
+
+void Message::operator delete(void* message, MessagePool&) noexcept {
+    operator delete(message);
+}
+
+struct MessagePool::Slab {
+    struct alignas(std::max_align_t) Slot {
+        std::byte storage[slotSize];
+    };
+
+    Slot slots[slotCount];
+    // For each free slot, the index + 1 of the next one, or 0
+    std::atomic<uint32_t> next[slotCount];
+};
+
+MessagePool::~MessagePool() {
+    Slab* current = slab.load(std::memory_order_acquire);
+#ifndef NDEBUG
+    if (current) {
+        std::size_t free = 0;
+        for (auto index = freeSlots.load() & slotMask; index; index = current->next[index - 1]) {
+            ++free;
+        }
+        assert(free == slotCount);
+    }
+#endif
+    delete current;
+}
+
+void* MessagePool::allocate(std::size_t size) {
+    void* storage = size <= slotSize ? allocateSlot() : nullptr;
+    if (!storage) {
+        storage = ::operator new(size);
+    }
+    pending.fetch_add(1, std::memory_order_relaxed);
+    return storage;
+}
+
+void* MessagePool::allocateSlot() {
+    Slab* current = slab.load(std::memory_order_acquire);
+    if (!current) {
+        // Most mailboxes never hold more than a message or two, and don't need a slab
+        if (pending.load(std::memory_order_relaxed) + 1 < burstSize) {
+            return nullptr;
+        }
+        // Not value-initialized, which would zero all the slots
+        std::unique_ptr<Slab> fresh(new Slab);
+        for (uint32_t i = 1; i < slotCount; ++i) {
+            fresh->next[i].store(i + 1 < slotCount ? i + 2 : 0, std::memory_order_relaxed);
+        }
+        if (slab.compare_exchange_strong(current, fresh.get(), std::memory_order_acq_rel)) {
+            // Keep the first slot, and free the others. Nothing is freed before this, as
+            // no slot was taken yet.
+            freeSlots.store(2, std::memory_order_release);
+            return fresh.release()->slots[0].storage;
+        }
+    }
+
+    uint64_t first = freeSlots.load(std::memory_order_acquire);
+    while (first & slotMask) {
+        const auto index = static_cast<uint32_t>(first & slotMask) - 1;
+        // Stale if another thread took the slot meanwhile, in which case the count changed
+        const uint64_t rest = current->next[index].load(std::memory_order_relaxed);
+        if (freeSlots.compare_exchange_weak(
+                first, (first & ~slotMask) + changeCount + rest, std::memory_order_acquire)) {
+            return current->slots[index].storage;
+        }
+    }
+
+    return nullptr;
+}
+
+void MessagePool::deallocate(void* storage) noexcept {
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    Slab* current = slab.load(std::memory_order_acquire);
+    const auto address = reinterpret_cast<uintptr_t>(storage);
+    const auto begin = reinterpret_cast<uintptr_t>(current ? current->slots : nullptr);
+    if (!current || address < begin || address >= begin + sizeof(current->slots)) {
+        ::operator delete(storage);
+        return;
+    }
+
+    const auto index = static_cast<uint32_t>((address - begin) / sizeof(Slab::Slot));
+    uint64_t first = freeSlots.load(std::memory_order_relaxed);
+    do {
+        current->next[index].store(static_cast<uint32_t>(first & slotMask), std::memory_order_relaxed);
+    } while (!freeSlots.compare_exchange_weak(
+        first, (first & ~slotMask) + changeCount + index + 1, std::memory_order_release, std::memory_order_relaxed));
+}
+
+} // namespace mbgl
@@ -47,6 +47,11 @@ std::shared_ptr<Scheduler> Scheduler::GetBackground() {
     return scheduler;
 }
 
+// static
+std::shared_ptr<Scheduler> Scheduler::MakeBackground(std::size_t threadCount) {
+    return std::make_shared<ThreadPool>(threadCount ? threadCount : ThreadPool::defaultThreadCount());
+}
+
 // static
 std::shared_ptr<Scheduler> Scheduler::GetSequenced() {
     constexpr std::size_t kSchedulersCount = 10;
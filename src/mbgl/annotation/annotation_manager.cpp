@@ -11,9 +11,15 @@
 #include <mbgl/style/layers/symbol_layer_impl.hpp>
 #include <mbgl/style/style.hpp>
 #include <mbgl/style/style_impl.hpp>
+#include <mbgl/math/clamp.hpp>
+#include <mbgl/tile/tile_id.hpp>
+#include <mbgl/util/constants.hpp>
 
 #include <boost/iterator/function_output_iterator.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 // Note: LayerManager::annotationsEnabled is defined
 // at compile time, so that linker (with LTO on) is able
 // to optimize out the unreachable code.
@@ -32,6 +38,63 @@ namespace mbgl {
 
 using namespace style;
 
+namespace {
+
+using Point2D = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+using Box = boost::geometry::model::box<Point2D>;
+
+// The projection geojson-vt tiles shape annotations with.
+Point2D project(const Point<double>& point) {
+    const double sine = std::sin(point.y * M_PI / 180);
+    const double y = 0.5 - 0.25 * std::log((1 + sine) / (1 - sine)) / M_PI;
+    return {point.x / 360 + 0.5, util::clamp(y, 0.0, 1.0)};
+}
+
+Box symbolBounds(const SymbolAnnotationImpl& symbol) {
+    const Point2D point = project(symbol.annotation.geometry);
+    return {point, point};
+}
+
+// Returns std::nullopt for empty geometries, which never show up in tiles.
+std::optional<Box> shapeBounds(const ShapeAnnotationImpl& shape) {
+    std::optional<Box> bounds;
+    ShapeAnnotationGeometry::visit(shape.geometry(), [&](const auto& geometry) {
+        mapbox::geometry::for_each_point(geometry, [&](const Point<double>& point) {
+            const Point2D projected = project(point);
+            if (bounds) {
+                boost::geometry::expand(*bounds, projected);
+            } else {
+                bounds = Box{projected, projected};
+            }
+        });
+    });
+    return bounds;
+}
+
+// The area a tile draws its data from, including the buffer around it.
+Box tileBounds(const CanonicalTileID& tileID) {
+    const double size = std::ldexp(1.0, -tileID.z);
+    const double buffer = size * ShapeAnnotationImpl::tileBuffer / util::EXTENT;
+    return {{tileID.x * size - buffer, tileID.y * size - buffer},
+            {(tileID.x + 1) * size + buffer, (tileID.y + 1) * size + buffer}};
+}
+
+Box shifted(const Box& box, double dx) {
+    return {{box.min_corner().get<0>() + dx, box.min_corner().get<1>()},
+            {box.max_corner().get<0>() + dx, box.max_corner().get<1>()}};
+}
+
+// Shapes that cross the antimeridian show up in tiles on both sides of it.
+constexpr double worldCopies[] = {-1, 0, 1};
+
+bool intersectsTile(const Box& bounds, const Box& tile) {
+    return std::ranges::any_of(worldCopies, [&](double dx) {
+        return boost::geometry::intersects(bounds, shifted(tile, dx));
+    });
+}
+
+} // namespace
+
 const std::string AnnotationManager::SourceID = "org.maplibre.annotations";
 const std::string AnnotationManager::PointLayerID = "org.maplibre.annotations.points";
 const std::string AnnotationManager::ShapeLayerID = "org.maplibre.annotations.shape.";
@@ -78,18 +141,21 @@ void AnnotationManager::add(const AnnotationID& id, const SymbolAnnotation& anno
     auto impl = std::make_shared<SymbolAnnotationImpl>(id, annotation);
     symbolTree.insert(impl);
     symbolAnnotations.emplace(id, impl);
+    invalidate(symbolBounds(*impl));
 }
 
 void AnnotationManager::add(const AnnotationID& id, const LineAnnotation& annotation) {
     ShapeAnnotationImpl& impl =
         *shapeAnnotations.emplace(id, std::make_unique<LineAnnotationImpl>(id, annotation)).first->second;
     impl.updateStyle(*style.get().impl);
+    indexShape(impl);
 }
 
 void AnnotationManager::add(const AnnotationID& id, const FillAnnotation& annotation) {
     ShapeAnnotationImpl& impl =
         *shapeAnnotations.emplace(id, std::make_unique<FillAnnotationImpl>(id, annotation)).first->second;
     impl.updateStyle(*style.get().impl);
+    indexShape(impl);
 }
 
 void AnnotationManager::update(const AnnotationID& id, const SymbolAnnotation& annotation) {
@@ -116,6 +182,7 @@ void AnnotationManager::update(const AnnotationID& id, const LineAnnotation& ann
         return;
     }
 
+    unindexShape(*it->second);
     shapeAnnotations.erase(it);
     add(id, annotation);
     dirty = true;
@@ -128,6 +195,7 @@ void AnnotationManager::update(const AnnotationID& id, const FillAnnotation& ann
         return;
     }
 
+    unindexShape(*it->second);
     shapeAnnotations.erase(it);
     add(id, annotation);
     dirty = true;
@@ -136,17 +204,43 @@ void AnnotationManager::update(const AnnotationID& id, const FillAnnotation& ann
 void AnnotationManager::remove(const AnnotationID& id) {
     CHECK_ANNOTATIONS_ENABLED_AND_RETURN_NOARG();
     if (symbolAnnotations.contains(id)) {
-        symbolTree.remove(symbolAnnotations.at(id));
+        const auto& impl = symbolAnnotations.at(id);
+        invalidate(symbolBounds(*impl));
+        symbolTree.remove(impl);
         symbolAnnotations.erase(id);
     } else if (shapeAnnotations.contains(id)) {
         auto it = shapeAnnotations.find(id);
         (void)*style.get().impl->removeLayer(it->second->layerID);
+        unindexShape(*it->second);
         shapeAnnotations.erase(it);
     } else {
         assert(false); // Should never happen
     }
 }
 
+void AnnotationManager::indexShape(const ShapeAnnotationImpl& shape) {
+    if (auto bounds = shapeBounds(shape)) {
+        shapeTree.insert({*bounds, shape.id});
+        invalidate(*bounds);
+    }
+}
+
+void AnnotationManager::unindexShape(const ShapeAnnotationImpl& shape) {
+    if (auto bounds = shapeBounds(shape)) {
+        shapeTree.remove({*bounds, shape.id});
+        invalidate(*bounds);
+    }
+}
+
+void AnnotationManager::invalidate(const Box& bounds) {
+    dirty = true;
+    for (auto* tile : tiles) {
+        if (!dirtyTiles.contains(tile) && intersectsTile(bounds, tileBounds(tile->id.canonical))) {
+            dirtyTiles.insert(tile);
+        }
+    }
+}
+
 std::unique_ptr<AnnotationTileData> AnnotationManager::getTileData(const CanonicalTileID& tileID) {
     if (symbolAnnotations.empty() && shapeAnnotations.empty()) return nullptr;
 
@@ -166,8 +260,18 @@ std::unique_ptr<AnnotationTileData> AnnotationManager::getTileData(const Canonic
         boost::geometry::index::intersects(tileBounds),
         boost::make_function_output_iterator([&](const auto& val) { val->updateLayer(tileID, *pointLayer); }));
 
-    for (const auto& shape : shapeAnnotations) {
-        shape.second->updateTileData(tileID, *tileData);
+    const Box bounds = tileBounds(tileID);
+    std::vector<AnnotationID> shapeIDs;
+    for (double dx : worldCopies) {
+        shapeTree.query(boost::geometry::index::intersects(shifted(bounds, dx)),
+                        boost::make_function_output_iterator([&](const auto& val) { shapeIDs.push_back(val.second); }));
+    }
+
+    // Keep the order of the shapes stable, and skip the ones found in more than one world copy.
+    std::ranges::sort(shapeIDs);
+    shapeIDs.erase(std::unique(shapeIDs.begin(), shapeIDs.end()), shapeIDs.end()); // NOLINT(modernize-use-ranges)
+    for (const auto& shapeID : shapeIDs) {
+        shapeAnnotations.at(shapeID)->updateTileData(tileID, *tileData);
     }
 
     return tileData;
@@ -214,9 +318,14 @@ void AnnotationManager::updateData() {
     CHECK_ANNOTATIONS_ENABLED_AND_RETURN_NOARG();
     std::scoped_lock lock(mutex);
     if (dirty) {
-        for (auto& tile : tiles) {
+        if (symbolAnnotations.empty() && shapeAnnotations.empty()) {
+            // Clear the data of every tile.
+            dirtyTiles = tiles;
+        }
+        for (auto* tile : dirtyTiles) {
             tile->setData(getTileData(tile->id.canonical));
         }
+        dirtyTiles.clear();
         dirty = false;
     }
 }
@@ -232,6 +341,7 @@ void AnnotationManager::removeTile(AnnotationTile& tile) {
     CHECK_ANNOTATIONS_ENABLED_AND_RETURN_NOARG();
     std::scoped_lock lock(mutex);
     tiles.erase(&tile);
+    dirtyTiles.erase(&tile);
 }
 
 namespace {
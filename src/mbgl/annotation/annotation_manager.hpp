@@ -63,6 +63,15 @@ private:
 
     void remove(const AnnotationID&);
 
+    // Bounding box in projected coordinates, where the world spans 0..1 on
+    // both axes as in the tiles generated for shape annotations.
+    using Box = boost::geometry::model::box<boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>>;
+
+    // Add or remove a shape in `shapeTree`, and invalidate the tiles it touches.
+    void indexShape(const ShapeAnnotationImpl&);
+    void unindexShape(const ShapeAnnotationImpl&);
+    void invalidate(const Box&);
+
     void updateStyle();
 
     std::unique_ptr<AnnotationTileData> getTileData(const CanonicalTileID&);
@@ -82,14 +91,20 @@ private:
     // annotations. <https://github.com/mapbox/mapbox-gl-native/issues/5691>
     using SymbolAnnotationMap = std::map<AnnotationID, std::shared_ptr<SymbolAnnotationImpl>>;
     using ShapeAnnotationMap = std::map<AnnotationID, std::unique_ptr<ShapeAnnotationImpl>>;
+    using ShapeAnnotationTree = boost::geometry::index::rtree<std::pair<Box, AnnotationID>,
+                                                              boost::geometry::index::rstar<16, 4>>;
     using ImageMap = std::unordered_map<std::string, style::Image>;
 
     SymbolAnnotationTree symbolTree;
     SymbolAnnotationMap symbolAnnotations;
+    ShapeAnnotationTree shapeTree;
     ShapeAnnotationMap shapeAnnotations;
     ImageMap images;
 
     std::unordered_set<AnnotationTile*> tiles;
+    // Tiles intersecting annotations that were added, updated or removed
+    // since the last updateData(), which regenerates only these.
+    std::unordered_set<AnnotationTile*> dirtyTiles;
     mapbox::base::WeakPtrFactory<AnnotationManager> weakFactory{this};
     // Do not add members here, see `WeakPtrFactory`
 };
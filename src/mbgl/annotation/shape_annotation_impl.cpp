@@ -27,7 +27,7 @@ void ShapeAnnotationImpl::updateTileData(const CanonicalTileID& tileID, Annotati
         // The annotation source is currently hard coded to maxzoom 16, so we're
         // topping out at z16 here as well.
         options.maxZoom = 16;
-        options.buffer = 255u;
+        options.buffer = tileBuffer;
         options.extent = util::EXTENT;
         options.tolerance = baseTolerance;
         shapeTiler = std::make_unique<mapbox::geojsonvt::GeoJSONVT>(features, options);
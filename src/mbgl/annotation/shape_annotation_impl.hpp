@@ -25,6 +25,10 @@ public:
 
     void updateTileData(const CanonicalTileID &, AnnotationTileData &);
 
+    // Tiles include the parts of a shape within this many units of the tile
+    // extent around their edges.
+    static constexpr uint16_t tileBuffer = 255;
+
     const AnnotationID id;
     const std::string layerID;
     std::unique_ptr<mapbox::geojsonvt::GeoJSONVT> shapeTiler;
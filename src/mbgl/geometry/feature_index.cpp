@@ -146,6 +146,45 @@ void FeatureIndex::insert(const GeometryCollection& geometries,
     }
 }
 
+void FeatureIndex::merge(const FeatureIndexShard& shard,
+                         const std::string& sourceLayerName,
+                         const std::string& bucketLeaderID) {
+    if (shard.entries.empty()) {
+        return;
+    }
+    if (uniqueLayerIDs.empty()) {
+        uniqueLayerIDs.reserve(expectedUniqueLayerIDs);
+    }
+    const std::string& emplacedLayerName = *uniqueLayerIDs.insert(sourceLayerName).first;
+    if (bucketLayerIDs.empty()) {
+        bucketLayerIDs.reserve(expectedUniqueLeaderIDs);
+    }
+    const std::string& emplacedLeaderID =
+        bucketLayerIDs.insert(std::make_pair(bucketLeaderID, std::vector<std::string>{})).first->first;
+
+    auto box = shard.boxes.begin();
+    for (const auto& entry : shard.entries) {
+        auto featureSortIndex = sortIndex++;
+        for (std::size_t i = 0; i < entry.boxCount; ++i, ++box) {
+            grid.insert(RefIndexedSubfeature(entry.index, emplacedLayerName, emplacedLeaderID, featureSortIndex),
+                        *box);
+        }
+    }
+}
+
+void FeatureIndexShard::insert(const GeometryCollection& geometries, std::size_t index) {
+    std::size_t boxCount = 0;
+    for (const auto& ring : geometries) {
+        const auto envelope = mapbox::geometry::envelope(ring);
+        if (envelope.min.x < util::EXTENT && envelope.min.y < util::EXTENT && envelope.max.x >= 0 &&
+            envelope.max.y >= 0) {
+            boxes.emplace_back(convertPoint<float>(envelope.min), convertPoint<float>(envelope.max));
+            ++boxCount;
+        }
+    }
+    entries.push_back({.index = index, .boxCount = boxCount});
+}
+
 void FeatureIndex::query(std::unordered_map<std::string, std::vector<Feature>>& result,
                          const GeometryCoordinates& queryGeometry,
                          const TransformState& transformState,
@@ -334,6 +373,12 @@ void FeatureIndex::setBucketLayerIDs(const std::string& bucketLeaderID, const st
     bucketLayerIDs[bucketLeaderID] = layerIDs;
 }
 
+std::vector<std::pair<RefIndexedSubfeature, FeatureIndexShard::BBox>> FeatureIndex::getEntries() const {
+    // A box covering the whole grid visits the elements in insertion order
+    constexpr auto extent = static_cast<float>(util::EXTENT);
+    return grid.queryWithBoxes({{0, 0}, {extent, extent}});
+}
+
 DynamicFeatureIndex::~DynamicFeatureIndex() = default;
 
 void DynamicFeatureIndex::query(std::unordered_map<std::string, std::vector<Feature>>& result,
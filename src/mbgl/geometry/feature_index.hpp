@@ -8,9 +8,11 @@
 #include <mbgl/util/grid_index.hpp>
 #include <mbgl/util/mat4.hpp>
 
+#include <optional>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace mbgl {
 
@@ -104,20 +106,47 @@ protected:
     std::vector<FeatureRecord> features;
 };
 
+/// Feature index entries for a single bucket, collected apart from the index so that buckets can be
+/// filled on other threads. Merging shards in the order their features would otherwise have been
+/// inserted produces exactly the same index.
+class FeatureIndexShard {
+public:
+    using BBox = GridIndex<RefIndexedSubfeature>::BBox;
+
+    void insert(const GeometryCollection&, std::size_t index);
+
+private:
+    struct Entry {
+        std::size_t index;
+        std::size_t boxCount;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<BBox> boxes;
+
+    friend class FeatureIndex;
+};
+
 class FeatureIndex {
 public:
     FeatureIndex(std::unique_ptr<const GeometryTileData> tileData_);
 
     const GeometryTileData* getData() { return tileData.get(); }
 
-    /// Set the expected number of elements per cell to avoid small re-allocations for populated cells
-    void reserve(std::size_t value) { grid.reserve(value); }
+    /// Make room for about `count` indexed geometries to avoid re-allocations while inserting
+    void reserve(std::size_t count) { grid.reserve(count); }
+
+    /// Approximate number of bytes held by the spatial index
+    std::size_t getByteSize() const { return grid.getByteSize(); }
 
     void insert(const GeometryCollection&,
                 std::size_t index,
                 const std::string& sourceLayerName,
                 const std::string& bucketLeaderID);
 
+    /// Insert the entries of a shard, as if each of its features had been passed to `insert`
+    void merge(const FeatureIndexShard&, const std::string& sourceLayerName, const std::string& bucketLeaderID);
+
     void query(std::unordered_map<std::string, std::vector<Feature>>& result,
                const GeometryCoordinates& queryGeometry,
                const TransformState&,
@@ -138,6 +167,14 @@ public:
 
     void setBucketLayerIDs(const std::string& bucketLeaderID, const std::vector<std::string>& layerIDs);
 
+    /// IDs of the layers drawn from each bucket, keyed by the bucket's leader layer
+    const std::unordered_map<std::string, std::vector<std::string>>& getBucketLayerIDs() const {
+        return bucketLayerIDs;
+    }
+
+    /// All indexed geometries with their boxes, in the order they were inserted
+    std::vector<std::pair<RefIndexedSubfeature, FeatureIndexShard::BBox>> getEntries() const;
+
     std::unordered_map<std::string, std::vector<Feature>> lookupSymbolFeatures(
         const std::vector<IndexedSubfeature>& symbolFeatures,
         const RenderedQueryOptions& options,
@@ -7,14 +7,21 @@ namespace gfx {
 
 RendererBackend::RendererBackend(const ContextMode contextMode_)
     : contextMode(contextMode_),
-      threadPool(Scheduler::GetBackground(), uniqueID) {}
+      threadPool(std::in_place, Scheduler::GetBackground(), uniqueID) {}
 
 RendererBackend::RendererBackend(const ContextMode contextMode_, const TaggedScheduler& threadPool_)
     : contextMode(contextMode_),
-      threadPool(threadPool_) {}
+      threadPool(std::in_place, threadPool_) {}
 
 RendererBackend::~RendererBackend() = default;
 
+void RendererBackend::setThreadPool(std::shared_ptr<Scheduler> scheduler) {
+    assert(scheduler);
+    if (scheduler) {
+        threadPool.emplace(std::move(scheduler), uniqueID);
+    }
+}
+
 gfx::Context& RendererBackend::getContext() {
     assert(BackendScope::exists());
     std::call_once(initialized, [this] { context = createContext(); });
@@ -103,6 +103,10 @@ void Map::Impl::onSourceChanged(style::Source& source) {
     }
 }
 
+void Map::Impl::onSourceLoadingProgress(style::Source& source, double progress) {
+    observer.onSourceLoadingProgress(source, progress);
+}
+
 void Map::Impl::onUpdate() {
     // Don't load/render anything in still mode until explicitly requested.
     if (mode != MapMode::Continuous && !stillImageRequest) {
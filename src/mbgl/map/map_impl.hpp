@@ -48,6 +48,7 @@ public:
 
     // StyleObserver
     void onSourceChanged(style::Source&) final;
+    void onSourceLoadingProgress(style::Source&, double) final;
     void onUpdate() final;
     void onStyleLoading() final;
     void onStyleLoaded() final;
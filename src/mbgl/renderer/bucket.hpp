@@ -53,6 +53,14 @@ public:
 
     virtual float getQueryRadius(const RenderLayer&) const { return 0; };
 
+    /// Approximate number of bytes held by the vertex, index and image data of this bucket.
+    /// The same data is mirrored into GPU buffers and textures once the bucket is uploaded.
+    virtual std::size_t getByteSize() const { return 0; }
+
+    /// Approximate number of bytes of the GPU buffers and textures this bucket is uploaded to.
+    /// That's the whole of `getByteSize()` unless the bucket also keeps data for the CPU only.
+    virtual std::size_t getGPUByteSize() const { return getByteSize(); }
+
     bool needsUpload() const { return hasData() && !uploaded; }
 
     // The following methods are implemented by buckets that require cross-tile indexing and placement.
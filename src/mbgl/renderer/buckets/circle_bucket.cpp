@@ -32,6 +32,14 @@ bool CircleBucket::hasData() const {
     return !segments.empty();
 }
 
+std::size_t CircleBucket::getByteSize() const {
+    std::size_t size = vertices.bytes() + triangles.bytes();
+    for (const auto& binders : paintPropertyBinders) {
+        size += binders.second.getByteSize();
+    }
+    return size;
+}
+
 namespace {
 template <class Property>
 float get(const CirclePaintProperties::PossiblyEvaluated& evaluated,
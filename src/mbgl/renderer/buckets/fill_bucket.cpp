@@ -82,6 +82,15 @@ bool FillBucket::hasData() const {
     return !triangleSegments.empty() || !basicLineSegments.empty();
 }
 
+std::size_t FillBucket::getByteSize() const {
+    std::size_t size = vertices.bytes() + triangles.bytes() + lineVertices.bytes() + lineIndexes.bytes() +
+                       basicLines.bytes();
+    for (const auto& binders : paintPropertyBinders) {
+        size += binders.second.getByteSize();
+    }
+    return size;
+}
+
 float FillBucket::getQueryRadius(const RenderLayer& layer) const {
     using namespace style;
     const auto& evaluated = getEvaluated<FillLayerProperties>(layer.evaluatedProperties);
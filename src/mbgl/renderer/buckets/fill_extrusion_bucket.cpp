@@ -179,6 +179,14 @@ bool FillExtrusionBucket::hasData() const {
     return !triangleSegments.empty();
 }
 
+std::size_t FillExtrusionBucket::getByteSize() const {
+    std::size_t size = vertices.bytes() + triangles.bytes();
+    for (const auto& binders : paintPropertyBinders) {
+        size += binders.second.getByteSize();
+    }
+    return size;
+}
+
 float FillExtrusionBucket::getQueryRadius(const RenderLayer& layer) const {
     const auto& evaluated = getEvaluated<FillExtrusionLayerProperties>(layer.evaluatedProperties);
     const std::array<float, 2>& translate = evaluated.get<FillExtrusionTranslate>();
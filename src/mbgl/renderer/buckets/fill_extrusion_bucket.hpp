@@ -37,6 +37,8 @@ public:
 
     bool hasData() const override;
 
+    std::size_t getByteSize() const override;
+
     void upload(gfx::UploadPass&) override;
 
     float getQueryRadius(const RenderLayer&) const override;
@@ -32,6 +32,14 @@ bool HeatmapBucket::hasData() const {
     return !segments.empty();
 }
 
+std::size_t HeatmapBucket::getByteSize() const {
+    std::size_t size = vertices.bytes() + triangles.bytes();
+    for (const auto& binders : paintPropertyBinders) {
+        size += binders.second.getByteSize();
+    }
+    return size;
+}
+
 void HeatmapBucket::addFeature(const GeometryTileFeature& feature,
                                const GeometryCollection& geometry,
                                const ImagePositions&,
@@ -107,4 +107,8 @@ bool HillshadeBucket::hasData() const {
     return demdata.getImage()->valid();
 }
 
+std::size_t HillshadeBucket::getByteSize() const {
+    return demdata.getImage()->bytes() + vertices.bytes() + indices.bytes();
+}
+
 } // namespace mbgl
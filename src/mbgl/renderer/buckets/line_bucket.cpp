@@ -137,6 +137,14 @@ bool LineBucket::hasData() const {
     return !segments.empty();
 }
 
+std::size_t LineBucket::getByteSize() const {
+    std::size_t size = vertices.bytes() + triangles.bytes();
+    for (const auto& binders : paintPropertyBinders) {
+        size += binders.second.getByteSize();
+    }
+    return size;
+}
+
 namespace {
 template <class Property>
 float get(const LinePaintProperties::PossiblyEvaluated& evaluated,
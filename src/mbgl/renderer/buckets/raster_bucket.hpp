@@ -32,6 +32,8 @@ public:
     void upload(gfx::UploadPass&) override;
     bool hasData() const override;
 
+    std::size_t getByteSize() const override;
+
     void clear();
     void setImage(std::shared_ptr<PremultipliedImage>);
     void setMask(TileMask&&);
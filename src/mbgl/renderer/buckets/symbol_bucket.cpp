@@ -96,6 +96,36 @@ bool SymbolBucket::hasData() const {
            hasTextCollisionBoxData() || hasIconCollisionCircleData() || hasTextCollisionCircleData();
 }
 
+std::size_t SymbolBucket::getByteSize() const {
+    std::size_t size = getGPUByteSize() + symbolInstances.size() * sizeof(SymbolInstance);
+    for (const Buffer* buffer : {&text, &icon, &sdfIcon}) {
+        size += buffer->placedSymbols.size() * sizeof(PlacedSymbol);
+    }
+    return size;
+}
+
+std::size_t SymbolBucket::getGPUByteSize() const {
+    std::size_t size = 0;
+    for (const Buffer* buffer : {&text, &icon, &sdfIcon}) {
+        size += buffer->vertices().bytes() + buffer->dynamicVertices().bytes() + buffer->opacityVertices().bytes() +
+                buffer->triangles.bytes();
+    }
+    for (const auto* box : {iconCollisionBox.get(), textCollisionBox.get()}) {
+        if (box) {
+            size += box->vertices().bytes() + box->dynamicVertices().bytes() + box->lines.bytes();
+        }
+    }
+    for (const auto* circle : {iconCollisionCircle.get(), textCollisionCircle.get()}) {
+        if (circle) {
+            size += circle->vertices().bytes() + circle->dynamicVertices().bytes() + circle->triangles.bytes();
+        }
+    }
+    for (const auto& entry : paintProperties) {
+        size += entry.second.iconBinders.getByteSize() + entry.second.textBinders.getByteSize();
+    }
+    return size;
+}
+
 bool SymbolBucket::hasTextData() const {
     return !text.segments.empty();
 }
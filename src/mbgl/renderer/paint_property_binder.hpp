@@ -142,7 +142,11 @@ public:
 
 namespace detail {
 const gfx::VertexVectorBasePtr noVector;
+
+inline std::size_t vertexVectorBytes(const gfx::VertexVectorBasePtr& vector) {
+    return vector ? vector->getRawSize() * vector->getRawCount() : 0;
 }
+} // namespace detail
 
 template <class T, class A>
 class ConstantPaintPropertyBinder : public PaintPropertyBinder<T, T, PossiblyEvaluatedPropertyValue<T>, A> {
@@ -684,6 +688,13 @@ public:
         util::ignore({(binders.template get<Ps>()->setPatternParameters(posA, posB, crossfade), 0)...});
     }
 
+    /// Bytes held by the per-feature attribute vectors of the data-driven properties.
+    std::size_t getByteSize() const {
+        std::size_t size = 0;
+        util::ignore({(size += detail::vertexVectorBytes(binders.template get<Ps>()->getSharedVertexVector()), 0)...});
+        return size;
+    }
+
     template <class P>
     using ZoomInterpolatedAttributeList = typename Property<P>::ZoomInterpolatedAttributeList;
     template <class P>
@@ -338,6 +338,7 @@ std::unique_ptr<RenderTree> RenderOrchestrator::createRenderTree(
         std::unique_ptr<RenderSource> renderSource = RenderSource::create(entry.second, threadPool);
         renderSource->setObserver(this);
         renderSource->setCacheEnabled(tileCacheEnabled);
+        renderSource->setCacheMaxBytes(tileCacheMaxBytes);
         renderSources.emplace(entry.first, std::move(renderSource));
     }
     transformState = updateParameters->transformState;
@@ -504,6 +505,8 @@ std::unique_ptr<RenderTree> RenderOrchestrator::createRenderTree(
         symbolBucketsChanged |= renderTreeParameters->placementChanged;
         if (renderTreeParameters->placementChanged) {
             Mutable<Placement> placement = Placement::create(updateParameters, placementController.getPlacement());
+            placement->setIncremental(incrementalPlacementEnabled);
+            placement->setThreadPool(threadPool);
             placement->placeLayers(layersNeedPlacement);
             placementController.setPlacement(std::move(placement));
             crossTileSymbolIndex.pruneUnusedLayers(usedSymbolLayers);
@@ -523,6 +526,7 @@ std::unique_ptr<RenderTree> RenderOrchestrator::createRenderTree(
         if (renderTreeParameters->placementChanged) {
             Mutable<Placement> placement = Placement::create(updateParameters);
             placement->collectPlacedSymbolData(placedSymbolDataCollected);
+            placement->setThreadPool(threadPool);
             placement->placeLayers(layersNeedPlacement);
             placementController.setPlacement(std::move(placement));
         }
@@ -766,6 +770,26 @@ bool RenderOrchestrator::getTileCacheEnabled() const {
     return tileCacheEnabled;
 }
 
+void RenderOrchestrator::setTileCacheMaxBytes(std::size_t maxBytes) {
+    tileCacheMaxBytes = maxBytes;
+
+    for (const auto& entry : renderSources) {
+        entry.second->setCacheMaxBytes(maxBytes);
+    }
+}
+
+std::size_t RenderOrchestrator::getTileCacheMaxBytes() const {
+    return tileCacheMaxBytes;
+}
+
+TileCacheStats RenderOrchestrator::getTileCacheStats() const {
+    TileCacheStats stats;
+    for (const auto& entry : renderSources) {
+        stats += entry.second->getCacheStats();
+    }
+    return stats;
+}
+
 void RenderOrchestrator::reduceMemoryUse() {
     MLN_TRACE_FUNC();
 
@@ -15,6 +15,7 @@
 #include <mbgl/renderer/image_manager_observer.hpp>
 #include <mbgl/text/placement.hpp>
 #include <mbgl/renderer/render_tree.hpp>
+#include <mbgl/util/constants.hpp>
 
 #include <map>
 #include <memory>
@@ -95,10 +96,15 @@ public:
 
     void setTileCacheEnabled(bool);
     bool getTileCacheEnabled() const;
+    void setTileCacheMaxBytes(std::size_t);
+    std::size_t getTileCacheMaxBytes() const;
+    TileCacheStats getTileCacheStats() const;
     void reduceMemoryUse();
     void dumpDebugLogs();
     void collectPlacedSymbolData(bool);
     const std::vector<PlacedSymbolData>& getPlacedSymbolsData() const;
+    void setIncrementalPlacementEnabled(bool enable) { incrementalPlacementEnabled = enable; }
+    bool getIncrementalPlacementEnabled() const { return incrementalPlacementEnabled; }
     void clearData();
 
     void update(const std::shared_ptr<UpdateParameters>&);
@@ -215,7 +221,9 @@ private:
     const bool backgroundLayerAsColor;
     bool contextLost = false;
     bool placedSymbolDataCollected = false;
+    bool incrementalPlacementEnabled = false;
     bool tileCacheEnabled = true;
+    std::size_t tileCacheMaxBytes = util::DEFAULT_TILE_CACHE_SIZE;
 
 #if MLN_RENDER_BACKEND_OPENGL
     bool androidGoldfishMitigationEnabled{false};
@@ -2,6 +2,7 @@
 
 #include <mbgl/actor/scheduler.hpp>
 #include <mbgl/map/mode.hpp>
+#include <mbgl/renderer/tile_cache_stats.hpp>
 #include <mbgl/tile/tile_id.hpp>
 #include <mbgl/tile/tile_observer.hpp>
 #include <mbgl/util/mat4.hpp>
@@ -105,6 +106,10 @@ public:
 
     virtual void setCacheEnabled(bool) {};
 
+    virtual void setCacheMaxBytes(std::size_t) {}
+
+    virtual TileCacheStats getCacheStats() const { return {}; }
+
     virtual void reduceMemoryUse() = 0;
 
     virtual void dumpDebugLogs() const = 0;
@@ -143,6 +143,14 @@ const std::vector<PlacedSymbolData>& Renderer::getPlacedSymbolsData() const {
     return impl->orchestrator.getPlacedSymbolsData();
 }
 
+void Renderer::setIncrementalPlacementEnabled(bool enable) {
+    impl->orchestrator.setIncrementalPlacementEnabled(enable);
+}
+
+bool Renderer::getIncrementalPlacementEnabled() const {
+    return impl->orchestrator.getIncrementalPlacementEnabled();
+}
+
 void Renderer::setTileCacheEnabled(bool enable) {
     impl->orchestrator.setTileCacheEnabled(enable);
 }
@@ -151,6 +159,18 @@ bool Renderer::getTileCacheEnabled() const {
     return impl->orchestrator.getTileCacheEnabled();
 }
 
+void Renderer::setTileCacheMaxBytes(std::size_t maxBytes) {
+    impl->orchestrator.setTileCacheMaxBytes(maxBytes);
+}
+
+std::size_t Renderer::getTileCacheMaxBytes() const {
+    return impl->orchestrator.getTileCacheMaxBytes();
+}
+
+TileCacheStats Renderer::getTileCacheStats() const {
+    return impl->orchestrator.getTileCacheStats();
+}
+
 void Renderer::reduceMemoryUse() {
     gfx::BackendScope guard{impl->backend};
     impl->reduceMemoryUse();
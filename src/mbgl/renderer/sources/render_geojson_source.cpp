@@ -84,7 +84,7 @@ void RenderGeoJSONSource::update(Immutable<style::Source::Impl> baseImpl_,
     enabled = needsRendering;
 
     auto data_ = impl().getData().lock();
-    if (data.lock() != data_) {
+    if (auto previous = data.lock(); previous != data_) {
         data = data_;
         if (parameters.mode != MapMode::Continuous) {
             // Clearing the tile pyramid in order to avoid render tests being flaky.
@@ -94,8 +94,13 @@ void RenderGeoJSONSource::update(Immutable<style::Source::Impl> baseImpl_,
             const uint8_t maxZ = impl().getZoomRange().max;
             for (const auto& pair : tilePyramid.getTiles()) {
                 if (pair.first.canonical.z <= maxZ) {
-                    static_cast<GeoJSONTile*>(pair.second.get())
-                        ->updateData(data_, needsRelayout, parameters.isUpdateSynchronous);
+                    auto* tile = static_cast<GeoJSONTile*>(pair.second.get());
+                    // Tiles away from the features changed by a diff keep what they have loaded
+                    if (previous && !needsRelayout && !data_->affectsTile(*previous, pair.first.canonical)) {
+                        tile->replaceData(data_);
+                    } else {
+                        tile->updateData(data_, needsRelayout, parameters.isUpdateSynchronous);
+                    }
                 }
             }
         }
@@ -47,6 +47,8 @@ public:
                             const std::optional<std::string>&) override;
 
     void setCacheEnabled(bool) override;
+    void setCacheMaxBytes(std::size_t) override;
+    TileCacheStats getCacheStats() const override;
     void reduceMemoryUse() override;
     void dumpDebugLogs() const override;
 
@@ -187,6 +187,7 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
         if (!tile) {
             tile = createTile(tileID, observer);
             if (!tile) return nullptr;
+            cache.recordMiss();
             tile->setLayers(layers);
         }
 
@@ -275,6 +276,17 @@ void TilePyramid::update(const std::vector<Immutable<style::LayerProperties>>& l
 
     for (auto& pair : tiles) {
         pair.second->setShowCollisionBoxes(parameters.debugOptions & MapDebugOptions::Collision);
+        pair.second->setPriority(TaskPriority::Low);
+    }
+
+    // Parse the ideal tiles closest to the center of the viewport first. `tileCover` returns
+    // them sorted by distance, so their rank is all we need. Prefetched tiles and the parents
+    // or children retained as placeholders keep the low priority set above.
+    const std::size_t highPriorityCount = (idealTiles.size() + 2) / 3;
+    for (std::size_t i = 0; i < idealTiles.size(); ++i) {
+        if (auto it = tiles.find(idealTiles[i]); it != tiles.end()) {
+            it->second->setPriority(i < highPriorityCount ? TaskPriority::High : TaskPriority::Normal);
+        }
     }
 
     // Initialize renderable tiles and update the contained layer render data.
@@ -61,6 +61,8 @@ public:
     std::vector<Feature> querySourceFeatures(const SourceQueryOptions&) const;
 
     void setCacheEnabled(bool);
+    void setCacheMaxBytes(std::size_t maxBytes) { cache.setMaxBytes(maxBytes); }
+    TileCacheStats getCacheStats() const { return cache.getStats(); }
     void reduceMemoryUse();
 
     void setObserver(TileObserver*);
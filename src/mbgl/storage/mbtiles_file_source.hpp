@@ -5,6 +5,10 @@
 #include <mbgl/util/client_options.hpp>
 #include <mbgl/util/thread.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 namespace mbgl {
 // File source for supporting .mbtiles maps.
 // can only load resource URLS that are absolute paths to local files
@@ -24,7 +28,17 @@ public:
 
 private:
     class Impl;
+    class Reader;
     std::unique_ptr<util::Thread<Impl>> thread; // impl
+
+    // Tiles are read on a few threads with their own connections, taking turns. The threads are only
+    // started once tiles are requested, up to `readerCount` of them.
+    util::Thread<Reader>& nextReaderThread();
+
+    const std::size_t readerCount;
+    std::mutex readersMutex;
+    std::vector<std::unique_ptr<util::Thread<Reader>>> readers;
+    std::size_t nextReader = 0;
 };
 
 } // namespace mbgl
@@ -21,6 +21,17 @@ public:
     void setClientOptions(ClientOptions) override;
     ClientOptions getClientOptions() override;
 
+    struct DirectoryCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        std::size_t entries = 0;
+        uint64_t bytes = 0;
+    };
+
+    /// Counters of the directory cache used to resolve tile addresses
+    DirectoryCacheStats getDirectoryCacheStats();
+
 private:
     class Impl;
     std::unique_ptr<util::Thread<Impl>> thread; // impl
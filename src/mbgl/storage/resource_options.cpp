@@ -11,6 +11,9 @@ public:
     std::string cachePath = ":memory:";
     std::string assetPath = ".";
     uint64_t maximumSize = mbgl::util::DEFAULT_MAX_CACHE_SIZE;
+    uint64_t pmtilesDirectoryCacheSize = mbgl::util::DEFAULT_PMTILES_DIRECTORY_CACHE_SIZE;
+    CacheDurability cacheDurability = CacheDurability::Full;
+    util::Codec cacheCodec = util::Codec::Zlib;
     void* platformContext = nullptr;
 };
 
@@ -79,6 +82,33 @@ uint64_t ResourceOptions::maximumCacheSize() const {
     return impl_->maximumSize;
 }
 
+ResourceOptions& ResourceOptions::withPMTilesDirectoryCacheSize(uint64_t size) {
+    impl_->pmtilesDirectoryCacheSize = size;
+    return *this;
+}
+
+uint64_t ResourceOptions::pmtilesDirectoryCacheSize() const {
+    return impl_->pmtilesDirectoryCacheSize;
+}
+
+ResourceOptions& ResourceOptions::withCacheDurability(CacheDurability durability) {
+    impl_->cacheDurability = durability;
+    return *this;
+}
+
+CacheDurability ResourceOptions::cacheDurability() const {
+    return impl_->cacheDurability;
+}
+
+ResourceOptions& ResourceOptions::withCacheCodec(util::Codec codec) {
+    impl_->cacheCodec = codec;
+    return *this;
+}
+
+util::Codec ResourceOptions::cacheCodec() const {
+    return impl_->cacheCodec;
+}
+
 ResourceOptions& ResourceOptions::withPlatformContext(void* context) {
     impl_->platformContext = context;
     return *this;
@@ -14,6 +14,8 @@ public:
     virtual void onSourceLoaded(Source&) {}
     virtual void onSourceChanged(Source&) {}
     virtual void onSourceError(Source&, std::exception_ptr) {}
+    // Fraction of the source's data indexed so far while it loads
+    virtual void onSourceLoadingProgress(Source&, double) {}
 
     // Source description needs to be reloaded
     virtual void onSourceDescriptionChanged(Source&) {}
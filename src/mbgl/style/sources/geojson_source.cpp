@@ -51,6 +51,19 @@ void GeoJSONSource::setGeoJSONData(std::shared_ptr<GeoJSONData> geoJSONData) {
     observer->onSourceChanged(*this);
 }
 
+bool GeoJSONSource::updateGeoJSON(const GeoJSONDiff& diff) {
+    auto data = impl().getData().lock();
+    if (!data) {
+        return false;
+    }
+    auto updated = data->applyDiff(diff);
+    if (!updated) {
+        return false;
+    }
+    setGeoJSONData(std::move(updated));
+    return true;
+}
+
 std::optional<std::string> GeoJSONSource::getURL() const {
     return url;
 }
@@ -79,18 +92,38 @@ void GeoJSONSource::loadDescription(FileSource& fileSource) {
         } else {
             // Note: This task appears to be safe enough to schedule on the generic background queue.
             // This task does not reference other objects who's lifetimes are coupled with a map.
+            const uint64_t generation = ++*requestGeneration;
             Scheduler::GetBackground()->scheduleAndReplyValue(
                 util::SimpleIdentity::Empty,
                 /* makeImplInBackground */
                 [currentImpl = baseImpl,
                  data = res.data,
-                 seqScheduler{sequencedScheduler}]() -> Immutable<Source::Impl> {
+                 seqScheduler{sequencedScheduler},
+                 generations = requestGeneration,
+                 generation,
+                 source = this,
+                 self = makeWeakPtr(),
+                 replyScheduler = Scheduler::GetCurrent()->makeWeakPtr()]() -> Immutable<Source::Impl> {
                     assert(data);
                     auto& current = static_cast<const Impl&>(*currentImpl);
                     conversion::Error error;
                     std::shared_ptr<GeoJSONData> geoJSONData;
                     if (std::optional<GeoJSON> geoJSON = conversion::convertJSON<GeoJSON>(*data, error)) {
-                        geoJSONData = GeoJSONData::create(*geoJSON, std::move(seqScheduler), current.getOptions());
+                        // Stop indexing data that a newer response replaces
+                        GeoJSONData::BuildControl control;
+                        control.isCancelled = [&] { return *generations != generation; };
+                        // Report progress to the observer on the source's thread, ahead of the loaded data
+                        control.onProgress = [&](double progress) {
+                            if (auto guard = replyScheduler.lock(); replyScheduler) {
+                                replyScheduler->schedule([=] {
+                                    if (auto sourceGuard = self.lock(); self && *generations == generation) {
+                                        source->observer->onSourceLoadingProgress(*source, progress);
+                                    }
+                                });
+                            }
+                        };
+                        geoJSONData = GeoJSONData::create(
+                            std::move(*geoJSON), std::move(seqScheduler), current.getOptions(), control);
                     } else {
                         // Create an empty GeoJSON VT object to make sure we're not
                         // infinitely waiting for tiles to load.
@@ -99,12 +132,11 @@ void GeoJSONSource::loadDescription(FileSource& fileSource) {
                     return makeMutable<Impl>(current, std::move(geoJSONData));
                 },
                 /* onImplReady */
-                [this, self = makeWeakPtr(), capturedReqGeneration = ++requestGeneration](
-                    Immutable<Source::Impl> newImpl) {
+                [this, self = makeWeakPtr(), capturedReqGeneration = generation](Immutable<Source::Impl> newImpl) {
                     assert(capturedReqGeneration);
                     if (auto guard = self.lock(); self) {
                         if (capturedReqGeneration ==
-                            requestGeneration) { // If a new request is being processed, ignore this impl.
+                            *requestGeneration) { // If a new request is being processed, ignore this impl.
                             baseImpl = std::move(newImpl);
                             loaded = true;
                             observer->onSourceLoaded(*this);
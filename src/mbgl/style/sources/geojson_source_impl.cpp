@@ -5,6 +5,8 @@
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/thread_pool.hpp>
 #include <mbgl/util/identity.hpp>
+#include <mbgl/util/instrumentation.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -12,29 +14,350 @@
 #endif
 
 #include <mapbox/geojsonvt.hpp>
+#include <mapbox/geometry/envelope.hpp>
 #include <supercluster.hpp>
 
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <iterator>
+#include <numbers>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace mbgl {
 namespace style {
 
-class GeoJSONVTData final : public GeoJSONData {
+namespace {
+
+// Feature collections at least twice this size are indexed in parts on the thread pool
+constexpr std::size_t minFeaturesPerPart = 4096;
+
+/// One GeoJSON-VT index per contiguous run of features. GeoJSON-VT keeps features in input
+/// order and handles each one on its own, so concatenating the parts' tiles in part order
+/// yields the tiles of a single index over all features. Only the copies of features wrapped
+/// around the antimeridian differ in order: an index puts them ahead of or after all of its
+/// other features, so they end up among the features of their own part. They lie beyond the
+/// world's edges, so this changes the draw order of overlapping features in the tiles at the
+/// east and west edges of the world only, and only for collections large enough to be split.
+///
+/// GeoJSON-VT splits tiles lazily on lookup, so each part is looked up on a sequenced
+/// scheduler of its own: lookups of different tiles overlap across parts without pool
+/// workers waiting for each other. The lock only matters for synchronous lookups.
+struct GeoJSONVTPart {
+    std::unique_ptr<mapbox::geojsonvt::GeoJSONVT> index;
+    std::shared_ptr<Scheduler> scheduler;
+    std::mutex mutex;
+
+    GeoJSONData::TileFeatures getTile(const CanonicalTileID& id) {
+        std::scoped_lock lock(mutex);
+        return index->getTile(id.z, id.x, id.y).features;
+    }
+};
+using GeoJSONVTParts = std::vector<GeoJSONVTPart>;
+
+/// Indexes the features in `partCount` parts on the calling thread and on idle workers of the pool. Features of a
+/// non-const collection are moved into the parts. Returns nullptr if the build was cancelled.
+template <class FeatureCollection>
+std::shared_ptr<GeoJSONVTParts> indexInParts(FeatureCollection& features,
+                                             std::size_t partCount,
+                                             const mapbox::geojsonvt::Options& options,
+                                             const GeoJSONData::BuildControl& control,
+                                             Scheduler& pool) {
+    const auto cancelled = [&] {
+        return control.isCancelled && control.isCancelled();
+    };
+
+    auto parts = std::make_shared<GeoJSONVTParts>(partCount);
+    std::atomic<std::size_t> built{0};
+    ParallelJobs::run(
+        partCount,
+        [&](std::size_t i) {
+            if (cancelled()) {
+                return;
+            }
+
+            const auto begin = features.begin() + i * features.size() / partCount;
+            const auto end = features.begin() + (i + 1) * features.size() / partCount;
+            GeoJSONData::Features partFeatures;
+            if constexpr (std::is_const_v<FeatureCollection>) {
+                partFeatures.assign(begin, end);
+            } else {
+                partFeatures.assign(std::make_move_iterator(begin), std::make_move_iterator(end));
+            }
+            (*parts)[i].index = std::make_unique<mapbox::geojsonvt::GeoJSONVT>(partFeatures, options);
+
+            if (control.onProgress) {
+                control.onProgress(static_cast<double>(++built) / partCount);
+            }
+        },
+        pool);
+
+    return cancelled() ? nullptr : parts;
+}
+
+struct FeatureIdentifierHasher {
+    std::size_t operator()(const FeatureIdentifier& id) const { return mapbox::util::apply_visitor(*this, id); }
+    std::size_t operator()(mapbox::feature::null_value_t) const { return 0; }
+    template <class T>
+    std::size_t operator()(const T& value) const {
+        return std::hash<T>()(value);
+    }
+};
+
+using FeatureIdentifierSet = std::unordered_set<FeatureIdentifier, FeatureIdentifierHasher>;
+using FeatureIdentifierMap = std::unordered_map<FeatureIdentifier, std::size_t, FeatureIdentifierHasher>;
+
+/// The features an index was built from, kept to apply diffs by feature id. They are only told apart by their IDs
+/// once the first diff arrives.
+class IndexedFeatures {
+public:
+    explicit IndexedFeatures(GeoJSONData::Features features_)
+        : features(std::move(features_)) {}
+
+    /// The position of each feature by ID, or nullptr if a feature has no ID or shares it with another
+    const FeatureIdentifierMap* getPositions() const {
+        std::call_once(positionsOnce, [&] {
+            FeatureIdentifierMap result;
+            for (std::size_t i = 0; i < features.size(); ++i) {
+                const auto& id = features[i].id;
+                if (id.is<mapbox::feature::null_value_t>() || !result.emplace(id, i).second) {
+                    return;
+                }
+            }
+            positions = std::move(result);
+        });
+        return positions ? &*positions : nullptr;
+    }
+
+    const GeoJSONData::Features features;
+
+private:
+    mutable std::once_flag positionsOnce;
+    mutable std::optional<FeatureIdentifierMap> positions;
+};
+
+/// The features one or more consecutive diffs changed: the current versions of those they added or updated, indexed
+/// on their own, and the IDs of all of them, including removed ones.
+struct Changes {
+    GeoJSONData::Features features;
+    FeatureIdentifierMap positions;
+    FeatureIdentifierSet ids;
+    std::shared_ptr<GeoJSONVTParts> parts;
+
+    /// Indexes the features in a single part, looked up on the given scheduler
+    void index(const mapbox::geojsonvt::Options& options, std::shared_ptr<Scheduler> scheduler) {
+        parts = std::make_shared<GeoJSONVTParts>(features.empty() ? 0 : 1);
+        if (!features.empty()) {
+            parts->front().index = std::make_unique<mapbox::geojsonvt::GeoJSONVT>(features, options);
+            parts->front().scheduler = std::move(scheduler);
+        }
+    }
+
+    /// The changes of `older` followed by those of `newer`. Features both change keep their place in `older`.
+    static std::shared_ptr<Changes> merge(const Changes& older, const Changes& newer) {
+        auto result = std::make_shared<Changes>();
+        result->features.reserve(older.features.size() + newer.features.size());
+        for (const auto& feature : older.features) {
+            if (auto position = newer.positions.find(feature.id); position != newer.positions.end()) {
+                result->features.push_back(newer.features[position->second]);
+            } else if (!newer.ids.contains(feature.id)) {
+                result->features.push_back(feature);
+            }
+        }
+        for (const auto& feature : newer.features) {
+            if (!older.positions.contains(feature.id)) {
+                result->features.push_back(feature);
+            }
+        }
+        for (std::size_t i = 0; i < result->features.size(); ++i) {
+            result->positions.emplace(result->features[i].id, i);
+        }
+        result->ids = older.ids;
+        result->ids.insert(newer.ids.begin(), newer.ids.end());
+        return result;
+    }
+};
+
+/// Bounds of a feature in world coordinates, from 0 to 1 eastwards and southwards
+mapbox::geometry::box<double> getWorldBounds(const GeoJSONData::Features::value_type& feature) {
+    using std::numbers::pi;
+    const auto project = [](double lng, double lat) {
+        lat = std::clamp(lat, -util::LATITUDE_MAX, util::LATITUDE_MAX);
+        return mapbox::geometry::point<double>{lng / 360.0 + 0.5,
+                                               0.5 - std::log(std::tan(pi / 4.0 + lat * pi / 360.0)) / (2.0 * pi)};
+    };
+    const auto bounds = mapbox::geometry::envelope(feature.geometry);
+    return {project(bounds.min.x, bounds.max.y), project(bounds.max.x, bounds.min.y)};
+}
+
+/// Whether a feature within `bounds` may show up in a tile, including its buffer of `buffer` tiles and the copies
+/// of the feature wrapped around the antimeridian
+bool mayIntersect(const mapbox::geometry::box<double>& bounds, const CanonicalTileID& id, double buffer) {
+    const double size = std::ldexp(1.0, -id.z);
+    if (bounds.max.y < (id.y - buffer) * size || bounds.min.y > (id.y + 1 + buffer) * size) {
+        return false;
+    }
+    return std::ranges::any_of(std::array<double, 3>{{-1.0, 0.0, 1.0}}, [&](double wrap) {
+        return bounds.max.x + wrap >= (id.x - buffer) * size && bounds.min.x + wrap <= (id.x + 1 + buffer) * size;
+    });
+}
+
+} // namespace
+
+class GeoJSONVTData final : public GeoJSONData, public std::enable_shared_from_this<GeoJSONVTData> {
+    /// What a tile request reads: the index built with the data, and the changes made since, oldest first. Each
+    /// feature is read from the last of these that has it, so tiles list changed features after the unchanged ones
+    /// until a rebuild puts them back in place.
+    struct Index {
+        std::shared_ptr<GeoJSONVTParts> parts;
+        // Only kept for updatable collections
+        std::shared_ptr<const IndexedFeatures> indexed;
+        std::vector<std::shared_ptr<const Changes>> changes;
+
+        /// Every part a tile is put together from, in order
+        std::vector<GeoJSONVTPart*> getParts() const {
+            std::vector<GeoJSONVTPart*> result;
+            for (auto& part : *parts) {
+                result.push_back(&part);
+            }
+            for (const auto& change : changes) {
+                for (auto& part : *change->parts) {
+                    result.push_back(&part);
+                }
+            }
+            return result;
+        }
+
+        /// Puts a tile together from the tiles of `getParts()`
+        TileFeatures combine(std::vector<TileFeatures> tiles) const {
+            // Whether a feature read from the index or from `changes[first - 1]` changed later
+            const auto changedSince = [&](std::size_t first, const FeatureIdentifier& id) {
+                return std::any_of(changes.begin() + first, changes.end(), [&](const auto& change) {
+                    return change->ids.contains(id);
+                });
+            };
+            const auto append = [&](TileFeatures& features, TileFeatures& tile, std::size_t first) {
+                if (first == changes.size()) {
+                    features.insert(
+                        features.end(), std::make_move_iterator(tile.begin()), std::make_move_iterator(tile.end()));
+                    return;
+                }
+                for (auto& feature : tile) {
+                    if (!changedSince(first, feature.id)) {
+                        features.push_back(std::move(feature));
+                    }
+                }
+            };
+
+            TileFeatures features;
+            auto next = tiles.begin();
+            for (std::size_t i = 0; i < parts->size(); ++i) {
+                append(features, *next++, 0);
+            }
+            for (std::size_t i = 0; i < changes.size(); ++i) {
+                for (std::size_t j = 0; j < changes[i]->parts->size(); ++j) {
+                    append(features, *next++, i + 1);
+                }
+            }
+            return features;
+        }
+
+        TileFeatures getTile(const CanonicalTileID& id) const {
+            std::vector<TileFeatures> tiles;
+            for (auto* part : getParts()) {
+                tiles.push_back(part->getTile(id));
+            }
+            return combine(std::move(tiles));
+        }
+
+        /// The current version of the feature, or nullptr if there is none
+        const Features::value_type* find(const FeatureIdentifier& id) const {
+            for (auto change = changes.rbegin(); change != changes.rend(); ++change) {
+                if ((*change)->ids.contains(id)) {
+                    auto position = (*change)->positions.find(id);
+                    return position != (*change)->positions.end() ? &(*change)->features[position->second] : nullptr;
+                }
+            }
+            const auto& positions = *indexed->getPositions();
+            auto position = positions.find(id);
+            return position != positions.end() ? &indexed->features[position->second] : nullptr;
+        }
+
+        /// The current features, in the order a full index over them should draw them. As with GL JS
+        /// `updateData`, features updated in place keep their position, and added ones follow in the order they
+        /// were first added.
+        Features getFeatures() const {
+            Features features;
+            for (const auto& feature : indexed->features) {
+                if (const auto* current = find(feature.id)) {
+                    features.push_back(*current);
+                }
+            }
+            const auto& positions = *indexed->getPositions();
+            FeatureIdentifierSet added;
+            for (const auto& change : changes) {
+                for (const auto& feature : change->features) {
+                    if (!positions.contains(feature.id) && added.insert(feature.id).second) {
+                        if (const auto* current = find(feature.id)) {
+                            features.push_back(*current);
+                        }
+                    }
+                }
+            }
+            return features;
+        }
+    };
+
+    /// A tile request that looks the tile up in each part on the part's scheduler. The last lookup to finish puts
+    /// the tile together and replies.
+    struct Lookup {
+        Lookup(Index index_, const CanonicalTileID& id_, std::function<void(TileFeatures)> fn_)
+            : index(std::move(index_)),
+              id(id_),
+              fn(std::move(fn_)),
+              tiles(index.getParts().size()),
+              remaining(tiles.size()) {}
+
+        void run(GeoJSONVTPart& part, std::size_t i) {
+            tiles[i] = part.getTile(id);
+            if (--remaining == 0) {
+                if (auto guard = replyScheduler.lock(); replyScheduler) {
+                    replyScheduler->schedule(util::SimpleIdentity::Empty,
+                                             [fn_ = fn, features = index.combine(std::move(tiles))]() mutable {
+                                                 fn_(std::move(features));
+                                             });
+                }
+            }
+        }
+
+        const Index index;
+        const CanonicalTileID id;
+        const std::function<void(TileFeatures)> fn;
+        const mapbox::base::WeakPtr<Scheduler> replyScheduler = Scheduler::GetCurrent()->makeWeakPtr();
+        std::vector<TileFeatures> tiles;
+        std::atomic<std::size_t> remaining;
+    };
+
     void getTile(const CanonicalTileID& id, const std::function<void(TileFeatures)>& fn, bool runSynchronously) final {
         assert(fn);
+        const auto current = getIndex();
         if (runSynchronously) {
-            fn(this->impl->getTile(id.z, id.x, id.y).features);
+            fn(current.getTile(id));
         } else {
-            sequencedScheduler->scheduleAndReplyValue(
-                util::SimpleIdentity::Empty,
-                [id, geoJSONVT_impl = this->impl]() -> TileFeatures {
-                    return geoJSONVT_impl->getTile(id.z, id.x, id.y).features;
-                },
-                fn);
+            auto lookup = std::make_shared<Lookup>(current, id, fn);
+            const auto parts = current.getParts();
+            for (std::size_t i = 0; i < parts.size(); ++i) {
+                parts[i]->scheduler->schedule([lookup, part = parts[i], i] { lookup->run(*part, i); });
+            }
         }
     }
 
@@ -44,19 +367,139 @@ class GeoJSONVTData final : public GeoJSONData {
 
     std::uint8_t getClusterExpansionZoom(std::uint32_t) final { return 0; }
 
+    std::shared_ptr<GeoJSONData> applyDiff(const GeoJSONDiff&) final;
+
+    bool affectsTile(const GeoJSONData& previous, const CanonicalTileID& id) const final {
+        // While the predecessor lives, no other data can have its address
+        if (&previous != predecessor || predecessorLifetime.expired()) {
+            return true;
+        }
+        const double buffer = options->buffer / util::tileSize_D;
+        return std::ranges::any_of(changedBounds, [&](const auto& bounds) { return mayIntersect(bounds, id, buffer); });
+    }
+
     friend GeoJSONData;
-    GeoJSONVTData(const GeoJSON& geoJSON,
-                  const mapbox::geojsonvt::Options& options,
+    GeoJSONVTData(Index index_,
+                  const mapbox::geojsonvt::Options& vtOptions_,
+                  Immutable<GeoJSONOptions> options_,
                   std::shared_ptr<Scheduler> sequencedScheduler_)
-        : impl(std::make_shared<mapbox::geojsonvt::GeoJSONVT>(geoJSON, options)),
-          sequencedScheduler(std::move(sequencedScheduler_)) {
+        : index(std::move(index_)),
+          sequencedScheduler(std::move(sequencedScheduler_)),
+          vtOptions(vtOptions_),
+          options(std::move(options_)) {
         assert(sequencedScheduler);
     }
 
-    std::shared_ptr<mapbox::geojsonvt::GeoJSONVT> impl; // Accessed on worker thread.
+    Index getIndex() const {
+        std::scoped_lock lock(indexMutex);
+        return index;
+    }
+
+    /// Folds the changes into a single index on the background pool, then swaps it in. Tiles keep their features,
+    /// and list them in the order of `Index::getFeatures()` again.
+    void rebuild(const Index&);
+
+    mutable std::mutex indexMutex;
+    Index index; // Accessed on worker threads.
     std::shared_ptr<Scheduler> sequencedScheduler;
+    const mapbox::geojsonvt::Options vtOptions;
+    const Immutable<GeoJSONOptions> options;
+    // Set while a rebuild of this data or of one it was derived from runs
+    std::shared_ptr<std::atomic<bool>> rebuilding = std::make_shared<std::atomic<bool>>(false);
+
+    // The data this was derived from by a diff, and the bounds of the features the diff changed there and here
+    std::shared_ptr<const bool> lifetime = std::make_shared<bool>(true);
+    const GeoJSONData* predecessor = nullptr;
+    std::weak_ptr<const bool> predecessorLifetime;
+    std::vector<mapbox::geometry::box<double>> changedBounds;
 };
 
+std::shared_ptr<GeoJSONData> GeoJSONVTData::applyDiff(const GeoJSONDiff& diff) {
+    MLN_TRACE_FUNC();
+
+    const auto current = getIndex();
+    const bool anonymousUpdate = std::ranges::any_of(
+        diff.update, [](const auto& feature) { return feature.id.template is<mapbox::feature::null_value_t>(); });
+    if (!current.indexed || !current.indexed->getPositions() || anonymousUpdate) {
+        return nullptr;
+    }
+
+    // The diff only looks at the features it changes, however many changes came before
+    auto changes = std::make_shared<Changes>();
+    std::vector<mapbox::geometry::box<double>> bounds;
+
+    // The bounds of the version a feature had before this diff, the first time the diff changes it
+    const auto change = [&](const FeatureIdentifier& id) {
+        if (changes->ids.insert(id).second) {
+            if (const auto* feature = current.find(id)) {
+                bounds.push_back(getWorldBounds(*feature));
+            }
+        }
+    };
+
+    for (const auto& id : diff.remove) {
+        change(id);
+    }
+    for (const auto& feature : diff.update) {
+        change(feature.id);
+        if (auto it = changes->positions.find(feature.id); it != changes->positions.end()) {
+            bounds.push_back(getWorldBounds(changes->features[it->second]));
+            changes->features[it->second] = feature;
+        } else {
+            changes->positions.emplace(feature.id, changes->features.size());
+            changes->features.push_back(feature);
+        }
+        bounds.push_back(getWorldBounds(feature));
+    }
+
+    // Merges the newest changes into the ones before while those are at most twice as large. Each group then has
+    // more than twice the changes of the next, so there are at most log2(n) groups, and a changed feature gets
+    // indexed again that many times at most.
+    Index updated{current.parts, current.indexed, current.changes};
+    while (!updated.changes.empty() && updated.changes.back()->ids.size() <= 2 * changes->ids.size()) {
+        changes = Changes::merge(*updated.changes.back(), *changes);
+        updated.changes.pop_back();
+    }
+    changes->index(vtOptions, sequencedScheduler);
+    updated.changes.push_back(std::move(changes));
+
+    auto result = std::shared_ptr<GeoJSONVTData>(new GeoJSONVTData(updated, vtOptions, options, sequencedScheduler));
+    result->rebuilding = rebuilding;
+    result->predecessor = this;
+    result->predecessorLifetime = lifetime;
+    result->changedBounds = std::move(bounds);
+
+    // Once the changes pile up, tiles are cheaper to get from an index built over all features again
+    std::size_t changed = 0;
+    for (const auto& group : updated.changes) {
+        changed += group->ids.size();
+    }
+    if (changed > std::max(minFeaturesPerPart, updated.indexed->features.size() / 8) && !rebuilding->exchange(true)) {
+        result->rebuild(updated);
+    }
+    return result;
+}
+
+void GeoJSONVTData::rebuild(const Index& current) {
+    Scheduler::GetBackground()->schedule([self = weak_from_this(),
+                                          current,
+                                          flag = rebuilding,
+                                          sequencedScheduler_ = sequencedScheduler,
+                                          options_ = options] {
+        if (self.expired()) {
+            *flag = false;
+            return;
+        }
+        auto rebuilt = std::static_pointer_cast<GeoJSONVTData>(
+            GeoJSONData::create(current.getFeatures(), sequencedScheduler_, options_));
+        if (auto data = self.lock()) {
+            std::scoped_lock lock(data->indexMutex);
+            data->index = rebuilt->getIndex();
+        }
+        *flag = false;
+    });
+}
+
 class SuperclusterData final : public GeoJSONData {
     void getTile(const CanonicalTileID& id, const std::function<void(TileFeatures)>& fn, bool) final {
         assert(fn);
@@ -96,7 +539,30 @@ T evaluateFeature(const mapbox::feature::feature<double>& f,
 // static
 std::shared_ptr<GeoJSONData> GeoJSONData::create(const GeoJSON& geoJSON,
                                                  std::shared_ptr<Scheduler> sequencedScheduler,
-                                                 const Immutable<GeoJSONOptions>& options) {
+                                                 const Immutable<GeoJSONOptions>& options,
+                                                 const BuildControl& control) {
+    return create(geoJSON, nullptr, std::move(sequencedScheduler), options, control);
+}
+
+// static
+std::shared_ptr<GeoJSONData> GeoJSONData::create(GeoJSON&& geoJSON,
+                                                 std::shared_ptr<Scheduler> sequencedScheduler,
+                                                 const Immutable<GeoJSONOptions>& options,
+                                                 const BuildControl& control) {
+    Features* movable = geoJSON.is<Features>() ? &geoJSON.get<Features>() : nullptr;
+    return create(geoJSON, movable, std::move(sequencedScheduler), options, control);
+}
+
+// static
+std::shared_ptr<GeoJSONData> GeoJSONData::create(const GeoJSON& geoJSON,
+                                                 Features* movable,
+                                                 std::shared_ptr<Scheduler> sequencedScheduler,
+                                                 const Immutable<GeoJSONOptions>& options,
+                                                 const BuildControl& control) {
+    if (control.isCancelled && control.isCancelled()) {
+        return nullptr;
+    }
+
     constexpr double scale = util::EXTENT / util::tileSize_D;
     if (options->cluster && geoJSON.is<Features>() && !geoJSON.get<Features>().empty()) {
         mapbox::supercluster::Options clusterOptions;
@@ -134,7 +600,51 @@ std::shared_ptr<GeoJSONData> GeoJSONData::create(const GeoJSON& geoJSON,
     vtOptions.buffer = static_cast<uint16_t>(::round(scale * options->buffer));
     vtOptions.tolerance = scale * options->tolerance;
     vtOptions.lineMetrics = options->lineMetrics;
-    return std::shared_ptr<GeoJSONData>(new GeoJSONVTData(geoJSON, vtOptions, std::move(sequencedScheduler)));
+
+    // Keep the features to apply diffs to. The parts then copy theirs from the kept ones.
+    std::shared_ptr<const IndexedFeatures> indexed;
+    if (options->updatable && geoJSON.is<Features>()) {
+        if (movable) {
+            indexed = std::make_shared<const IndexedFeatures>(std::move(*movable));
+        } else {
+            indexed = std::make_shared<const IndexedFeatures>(geoJSON.get<Features>());
+        }
+    }
+
+    // As many parts as the pool has threads, as long as each gets enough features
+    const auto pool = control.pool ? control.pool : Scheduler::GetBackground();
+    const std::size_t featureCount = indexed ? indexed->features.size()
+                                     : geoJSON.is<Features>() ? geoJSON.get<Features>().size()
+                                                              : 0;
+    const std::size_t partCount = std::clamp<std::size_t>(
+        featureCount / minFeaturesPerPart, 1, std::max<std::size_t>(pool->getThreadCount(), 1));
+
+    std::shared_ptr<GeoJSONVTParts> parts;
+    if (partCount == 1) {
+        parts = std::make_shared<GeoJSONVTParts>(1);
+        parts->front().index = indexed ? std::make_unique<mapbox::geojsonvt::GeoJSONVT>(indexed->features, vtOptions)
+                                       : std::make_unique<mapbox::geojsonvt::GeoJSONVT>(geoJSON, vtOptions);
+        if (control.onProgress) {
+            control.onProgress(1.0);
+        }
+    } else if (indexed) {
+        parts = indexInParts(indexed->features, partCount, vtOptions, control, *pool);
+    } else if (movable) {
+        parts = indexInParts(*movable, partCount, vtOptions, control, *pool);
+    } else {
+        parts = indexInParts(geoJSON.get<Features>(), partCount, vtOptions, control, *pool);
+    }
+    if (!parts) {
+        return nullptr;
+    }
+
+    // The first part is looked up on the source's own thread, like a single index
+    for (std::size_t i = 0; i < parts->size(); ++i) {
+        (*parts)[i].scheduler = i == 0 ? sequencedScheduler : Scheduler::GetSequenced();
+    }
+
+    return std::shared_ptr<GeoJSONData>(new GeoJSONVTData(
+        {std::move(parts), std::move(indexed), {}}, vtOptions, options, std::move(sequencedScheduler)));
 }
 
 GeoJSONSource::Impl::Impl(std::string id_, Immutable<GeoJSONOptions> options_)
@@ -356,6 +356,10 @@ void Style::Impl::onSourceError(Source& source, std::exception_ptr error) {
     observer->onResourceError(error);
 }
 
+void Style::Impl::onSourceLoadingProgress(Source& source, double progress) {
+    observer->onSourceLoadingProgress(source, progress);
+}
+
 void Style::Impl::onSourceDescriptionChanged(Source& source) {
     sources.update(source);
     observer->onSourceDescriptionChanged(source);
@@ -136,6 +136,7 @@ private:
     void onSourceLoaded(Source&) override;
     void onSourceChanged(Source&) override;
     void onSourceError(Source&, std::exception_ptr) override;
+    void onSourceLoadingProgress(Source&, double) override;
     void onSourceDescriptionChanged(Source&) override;
 
     // LayerObserver implementation.
@@ -81,6 +81,11 @@ bool CollisionIndex::isOffscreen(const CollisionBoundaries& boundaries) const {
            boundaries[1] >= screenBottomBoundary;
 }
 
+bool CollisionIndex::isInsideViewport(const CollisionBoundaries& boundaries) const {
+    return boundaries[0] >= viewportPadding && boundaries[2] < screenRightBoundary &&
+           boundaries[1] >= viewportPadding && boundaries[3] < screenBottomBoundary;
+}
+
 bool CollisionIndex::isInsideGrid(const CollisionBoundaries& boundaries) const {
     return boundaries[2] >= 0 && boundaries[0] < gridRightBoundary && boundaries[3] >= 0 &&
            boundaries[1] < gridBottomBoundary;
@@ -146,6 +151,14 @@ IntersectStatus CollisionIndex::intersectsTileEdges(const CollisionBox& box,
     return result;
 }
 
+template <typename Shape>
+bool CollisionIndex::hitTest(
+    const Shape& shape,
+    const std::optional<CollisionGroupPredicate>& collisionGroupPredicate) const {
+    return collisionGroupPredicate ? collisionGrid.hitTest(shape, *collisionGroupPredicate)
+                                   : collisionGrid.hitTest(shape);
+}
+
 std::pair<bool, bool> CollisionIndex::placeFeature(
     const CollisionFeature& feature,
     Point<float> shift,
@@ -159,20 +172,15 @@ std::pair<bool, bool> CollisionIndex::placeFeature(
     const bool pitchWithMap,
     const bool collisionDebug,
     const std::optional<CollisionBoundaries>& avoidEdges,
-    const std::optional<std::function<bool(const RefIndexedSubfeature&)>>& collisionGroupPredicate,
+    const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
     std::vector<ProjectedCollisionBox>& projectedBoxes) {
     assert(projectedBoxes.empty());
     if (!feature.alongLine) {
-        const CollisionBox& box = feature.boxes.front();
-        auto collisionBoundaries = getProjectedCollisionBoundaries(posMatrix, shift, textPixelRatio, box);
-        projectedBoxes.emplace_back(
-            collisionBoundaries[0], collisionBoundaries[1], collisionBoundaries[2], collisionBoundaries[3]);
-        if ((avoidEdges && !isInsideTile(collisionBoundaries, *avoidEdges)) || !isInsideGrid(collisionBoundaries) ||
-            (!allowOverlap && collisionGrid.hitTest(projectedBoxes.back().box(), collisionGroupPredicate))) {
-            return {false, false};
-        }
-
-        return {true, isOffscreen(collisionBoundaries)};
+        return placeProjectedFeature(projectFeature(feature, shift, posMatrix, textPixelRatio),
+                                     allowOverlap,
+                                     avoidEdges,
+                                     collisionGroupPredicate,
+                                     projectedBoxes);
     } else {
         return placeLineFeature(feature,
                                 posMatrix,
@@ -190,6 +198,31 @@ std::pair<bool, bool> CollisionIndex::placeFeature(
     }
 }
 
+CollisionBoundaries CollisionIndex::projectFeature(const CollisionFeature& feature,
+                                                   Point<float> shift,
+                                                   const mat4& posMatrix,
+                                                   const float textPixelRatio) const {
+    assert(!feature.alongLine);
+    return getProjectedCollisionBoundaries(posMatrix, shift, textPixelRatio, feature.boxes.front());
+}
+
+std::pair<bool, bool> CollisionIndex::placeProjectedFeature(
+    const CollisionBoundaries& collisionBoundaries,
+    const bool allowOverlap,
+    const std::optional<CollisionBoundaries>& avoidEdges,
+    const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
+    std::vector<ProjectedCollisionBox>& projectedBoxes) {
+    assert(projectedBoxes.empty());
+    projectedBoxes.emplace_back(
+        collisionBoundaries[0], collisionBoundaries[1], collisionBoundaries[2], collisionBoundaries[3]);
+    if ((avoidEdges && !isInsideTile(collisionBoundaries, *avoidEdges)) || !isInsideGrid(collisionBoundaries) ||
+        (!allowOverlap && hitTest(projectedBoxes.back().box(), collisionGroupPredicate))) {
+        return {false, false};
+    }
+
+    return {true, isOffscreen(collisionBoundaries)};
+}
+
 std::pair<bool, bool> CollisionIndex::placeLineFeature(
     const CollisionFeature& feature,
     const mat4& posMatrix,
@@ -202,7 +235,7 @@ std::pair<bool, bool> CollisionIndex::placeLineFeature(
     const bool pitchWithMap,
     const bool collisionDebug,
     const std::optional<CollisionBoundaries>& avoidEdges,
-    const std::optional<std::function<bool(const RefIndexedSubfeature&)>>& collisionGroupPredicate,
+    const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
     std::vector<ProjectedCollisionBox>& projectedBoxes) {
     assert(feature.alongLine);
     assert(projectedBoxes.empty());
@@ -314,7 +347,7 @@ std::pair<bool, bool> CollisionIndex::placeLineFeature(
         inGrid |= isInsideGrid(collisionBoundaries);
 
         if ((avoidEdges && !isInsideTile(collisionBoundaries, *avoidEdges)) ||
-            (!allowOverlap && collisionGrid.hitTest(projectedBoxes[i].circle(), collisionGroupPredicate))) {
+            (!allowOverlap && hitTest(projectedBoxes[i].circle(), collisionGroupPredicate))) {
             if (!collisionDebug) {
                 return {false, false};
             } else {
@@ -7,6 +7,7 @@
 #include <mbgl/map/transform_state.hpp>
 
 #include <array>
+#include <optional>
 
 namespace mbgl {
 
@@ -25,6 +26,17 @@ struct IntersectStatus {
     // Assuming tile border divides box in two sections
     int minSectionLength = 0;
 };
+
+/// Matches the features of one collision group. The grid queries take it as a template argument,
+/// so testing a candidate is an inlined comparison rather than a call through a `std::function`.
+struct CollisionGroupPredicate {
+    uint16_t collisionGroupId;
+
+    bool operator()(const RefIndexedSubfeature& feature) const {
+        return feature.getCollisionGroupId() == collisionGroupId;
+    }
+};
+
 class CollisionIndex {
 public:
     using CollisionGrid = GridIndex<IndexedSubfeature>;
@@ -48,7 +60,24 @@ public:
         bool pitchWithMap,
         bool collisionDebug,
         const std::optional<CollisionBoundaries>& avoidEdges,
-        const std::optional<std::function<bool(const RefIndexedSubfeature&)>>& collisionGroupPredicate,
+        const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
+        std::vector<ProjectedCollisionBox>& /*out*/
+    );
+
+    // The boundaries of a feature that isn't placed along a line. Only reads
+    // the transform, so it may be called on any thread.
+    CollisionBoundaries projectFeature(const CollisionFeature& feature,
+                                       Point<float> shift,
+                                       const mat4& posMatrix,
+                                       float textPixelRatio) const;
+
+    // Same as placeFeature() for a feature that isn't placed along a line,
+    // given its boundaries from projectFeature().
+    std::pair<bool, bool> placeProjectedFeature(
+        const CollisionBoundaries&,
+        bool allowOverlap,
+        const std::optional<CollisionBoundaries>& avoidEdges,
+        const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
         std::vector<ProjectedCollisionBox>& /*out*/
     );
 
@@ -62,6 +91,9 @@ public:
 
     CollisionBoundaries projectTileBoundaries(const mat4& posMatrix) const;
 
+    // Whether the boundaries lie entirely within the viewport, excluding its padding.
+    bool isInsideViewport(const CollisionBoundaries&) const;
+
     const TransformState& getTransformState() const { return transformState; }
 
     float getViewportPadding() const { return viewportPadding; }
@@ -72,6 +104,10 @@ private:
     bool isInsideTile(const CollisionBoundaries& boundaries, const CollisionBoundaries& tileBoundaries) const;
     bool overlapsTile(const CollisionBoundaries& boundaries, const CollisionBoundaries& tileBoundaries) const;
 
+    template <typename Shape>
+    bool hitTest(const Shape&,
+                 const std::optional<CollisionGroupPredicate>& collisionGroupPredicate) const;
+
     std::pair<bool, bool> placeLineFeature(
         const CollisionFeature& feature,
         const mat4& posMatrix,
@@ -84,7 +120,7 @@ private:
         bool pitchWithMap,
         bool collisionDebug,
         const std::optional<CollisionBoundaries>& avoidEdges,
-        const std::optional<std::function<bool(const RefIndexedSubfeature&)>>& collisionGroupPredicate,
+        const std::optional<CollisionGroupPredicate>& collisionGroupPredicate,
         std::vector<ProjectedCollisionBox>& /*out*/
     );
 
@@ -6,23 +6,48 @@
 #include <mbgl/tile/tile.hpp>
 #include <mbgl/util/instrumentation.hpp>
 
+#include <algorithm>
+#include <cassert>
+
 namespace mbgl {
 
+CrossTileKey makeCrossTileKey(const std::u16string& text) {
+    // 64-bit FNV-1a
+    CrossTileKey hash = 14695981039346656037ull;
+    for (const char16_t c : text) {
+        hash = (hash ^ static_cast<CrossTileKey>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace {
+
+bool keyLess(const IndexedSymbolInstance& a, const IndexedSymbolInstance& b) {
+    return a.key < b.key;
+}
+
+} // namespace
+
 TileLayerIndex::TileLayerIndex(OverscaledTileID coord_,
                                std::vector<SymbolInstance>& symbolInstances,
+                               const std::vector<CrossTileKey>& keys,
                                uint32_t bucketInstanceId_,
                                std::string bucketLeaderId_)
     : coord(coord_),
       bucketInstanceId(bucketInstanceId_),
       bucketLeaderId(std::move(bucketLeaderId_)) {
-    for (const SymbolInstance& symbolInstance : symbolInstances) {
+    assert(keys.size() == symbolInstances.size());
+    indexedSymbolInstances.reserve(symbolInstances.size());
+    for (std::size_t i = 0; i < symbolInstances.size(); ++i) {
+        const SymbolInstance& symbolInstance = symbolInstances[i];
         if (!symbolInstance.check(SYM_GUARD_LOC) ||
             symbolInstance.getCrossTileID() == SymbolInstance::invalidCrossTileID) {
             continue;
         }
-        indexedSymbolInstances[symbolInstance.getKey()].emplace_back(symbolInstance.getCrossTileID(),
-                                                                     getScaledCoordinates(symbolInstance, coord));
+        indexedSymbolInstances.emplace_back(
+            keys[i], symbolInstance.getCrossTileID(), getScaledCoordinates(symbolInstance, coord));
     }
+    std::stable_sort(indexedSymbolInstances.begin(), indexedSymbolInstances.end(), keyLess);
 }
 
 Point<int64_t> TileLayerIndex::getScaledCoordinates(const SymbolInstance& symbolInstance,
@@ -37,35 +62,41 @@ Point<int64_t> TileLayerIndex::getScaledCoordinates(const SymbolInstance& symbol
 }
 
 void TileLayerIndex::findMatches(SymbolBucket& bucket,
+                                 const std::vector<CrossTileKey>& keys,
                                  const OverscaledTileID& newCoord,
-                                 std::set<uint32_t>& zoomCrossTileIDs) const {
+                                 std::unordered_set<uint32_t>& zoomCrossTileIDs) const {
     auto& symbolInstances = bucket.symbolInstances;
     float tolerance = coord.canonical.z < newCoord.canonical.z
                           ? 1.0f
                           : static_cast<float>(std::pow(2, coord.canonical.z - newCoord.canonical.z));
 
-    if (bucket.bucketLeaderID != bucketLeaderId) return;
+    if (bucket.bucketLeaderID != bucketLeaderId || indexedSymbolInstances.empty()) return;
 
-    for (auto& symbolInstance : symbolInstances) {
+    for (std::size_t i = 0; i < symbolInstances.size(); ++i) {
+        auto& symbolInstance = symbolInstances[i];
         if (symbolInstance.getCrossTileID() || !symbolInstance.check(SYM_GUARD_LOC)) {
             // already has a match, skip
             continue;
         }
 
-        auto it = indexedSymbolInstances.find(symbolInstance.getKey());
-        if (it == indexedSymbolInstances.end()) {
+        const auto range = std::equal_range(indexedSymbolInstances.begin(),
+                                            indexedSymbolInstances.end(),
+                                            IndexedSymbolInstance{keys[i], 0, {}},
+                                            keyLess);
+        if (range.first == range.second) {
             // No symbol with this key in this bucket
             continue;
         }
 
         auto scaledSymbolCoord = getScaledCoordinates(symbolInstance, newCoord);
 
-        for (const IndexedSymbolInstance& thisTileSymbol : it->second) {
+        for (auto it = range.first; it != range.second; ++it) {
+            const IndexedSymbolInstance& thisTileSymbol = *it;
             // Return any symbol with the same keys whose coordinates are within
             // 1 grid unit. (with a 4px grid, this covers a 12px by 12px area)
             if (std::abs(thisTileSymbol.coord.x - scaledSymbolCoord.x) <= tolerance &&
                 std::abs(thisTileSymbol.coord.y - scaledSymbolCoord.y) <= tolerance &&
-                zoomCrossTileIDs.find(thisTileSymbol.crossTileID) == zoomCrossTileIDs.end()) {
+                !zoomCrossTileIDs.contains(thisTileSymbol.crossTileID)) {
                 // Once we've marked ourselves duplicate against this parent
                 // symbol, don't let any other symbols at the same zoom level
                 // duplicate against the same parent (see issue #10844)
@@ -158,6 +189,13 @@ bool CrossTileSymbolLayerIndex::addBucket(const OverscaledTileID& tileID,
         }
     }
 
+    // Hash each text once for all the indexes it's looked up in
+    keys.clear();
+    keys.reserve(bucket.symbolInstances.size());
+    for (const auto& symbolInstance : bucket.symbolInstances) {
+        keys.push_back(symbolInstance.check(SYM_GUARD_LOC) ? makeCrossTileKey(symbolInstance.getKey()) : 0);
+    }
+
     auto& thisZoomUsedCrossTileIDs = usedCrossTileIDs[tileID.overscaledZ];
 
     for (auto& it : indexes) {
@@ -166,14 +204,14 @@ bool CrossTileSymbolLayerIndex::addBucket(const OverscaledTileID& tileID,
         if (zoom > tileID.overscaledZ) {
             for (auto& childIndex : zoomIndexes) {
                 if (childIndex.second.coord.isChildOf(tileID)) {
-                    childIndex.second.findMatches(bucket, tileID, thisZoomUsedCrossTileIDs);
+                    childIndex.second.findMatches(bucket, keys, tileID, thisZoomUsedCrossTileIDs);
                 }
             }
         } else {
             auto parentTileID = tileID.scaledTo(zoom);
             auto parentIndex = zoomIndexes.find(parentTileID);
             if (parentIndex != zoomIndexes.end()) {
-                parentIndex->second.findMatches(bucket, tileID, thisZoomUsedCrossTileIDs);
+                parentIndex->second.findMatches(bucket, keys, tileID, thisZoomUsedCrossTileIDs);
             }
         }
     }
@@ -190,15 +228,14 @@ bool CrossTileSymbolLayerIndex::addBucket(const OverscaledTileID& tileID,
     thisZoomIndexes.emplace(
         std::piecewise_construct,
         std::forward_as_tuple(tileID),
-        std::forward_as_tuple(tileID, bucket.symbolInstances, bucket.bucketInstanceId, bucket.bucketLeaderID));
+        std::forward_as_tuple(tileID, bucket.symbolInstances, keys, bucket.bucketInstanceId, bucket.bucketLeaderID));
     return true;
 }
 
 void CrossTileSymbolLayerIndex::removeBucketCrossTileIDs(uint8_t zoom, const TileLayerIndex& removedBucket) {
-    for (const auto& key : removedBucket.indexedSymbolInstances) {
-        for (auto indexedSymbolInstance : key.second) {
-            usedCrossTileIDs[zoom].erase(indexedSymbolInstance.crossTileID);
-        }
+    auto& zoomCrossTileIDs = usedCrossTileIDs[zoom];
+    for (const auto& indexedSymbolInstance : removedBucket.indexedSymbolInstances) {
+        zoomCrossTileIDs.erase(indexedSymbolInstance.crossTileID);
     }
 }
 
@@ -20,30 +20,43 @@ class SymbolInstance;
 class RenderLayer;
 class SymbolBucket;
 
+// Symbols are matched by a 64-bit hash of their text instead of the text itself. A collision
+// only matters for two different texts within a few pixels of each other across zoom levels.
+using CrossTileKey = uint64_t;
+CrossTileKey makeCrossTileKey(const std::u16string&);
+
 class IndexedSymbolInstance {
 public:
-    IndexedSymbolInstance(uint32_t crossTileID_, Point<int64_t> coord_)
-        : crossTileID(crossTileID_),
+    IndexedSymbolInstance(CrossTileKey key_, uint32_t crossTileID_, Point<int64_t> coord_)
+        : key(key_),
+          crossTileID(crossTileID_),
           coord(coord_) {}
 
+    CrossTileKey key;
     uint32_t crossTileID;
     Point<int64_t> coord;
 };
 
 class TileLayerIndex {
 public:
+    // `keys` holds the key of each symbol instance
     TileLayerIndex(OverscaledTileID coord,
                    std::vector<SymbolInstance>&,
+                   const std::vector<CrossTileKey>& keys,
                    uint32_t bucketInstanceId,
                    std::string bucketLeaderId);
 
     Point<int64_t> getScaledCoordinates(const SymbolInstance&, const OverscaledTileID&) const;
-    void findMatches(SymbolBucket&, const OverscaledTileID&, std::set<uint32_t>&) const;
+    void findMatches(SymbolBucket&,
+                     const std::vector<CrossTileKey>& keys,
+                     const OverscaledTileID&,
+                     std::unordered_set<uint32_t>&) const;
 
     OverscaledTileID coord;
     uint32_t bucketInstanceId;
     std::string bucketLeaderId;
-    std::map<std::u16string, std::vector<IndexedSymbolInstance>> indexedSymbolInstances;
+    // Sorted by key, and in bucket order within a key, which decides the match when several are close enough
+    std::vector<IndexedSymbolInstance> indexedSymbolInstances;
 };
 
 class CrossTileSymbolLayerIndex {
@@ -57,7 +70,9 @@ private:
     void removeBucketCrossTileIDs(uint8_t zoom, const TileLayerIndex& removedBucket);
 
     std::map<uint8_t, std::map<OverscaledTileID, TileLayerIndex>> indexes;
-    std::map<uint8_t, std::set<uint32_t>> usedCrossTileIDs;
+    std::map<uint8_t, std::unordered_set<uint32_t>> usedCrossTileIDs;
+    // Keys of the symbols of the bucket being added, reused across calls
+    std::vector<CrossTileKey> keys;
     float lng = 0;
     uint32_t& maxCrossTileID;
 };
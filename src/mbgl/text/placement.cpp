@@ -1,6 +1,7 @@
 #include <mbgl/text/placement.hpp>
 
 #include <mbgl/layout/symbol_layout.hpp>
+#include <mbgl/platform/settings.hpp>
 #include <mbgl/renderer/bucket.hpp>
 #include <mbgl/renderer/buckets/symbol_bucket.hpp>
 #include <mbgl/renderer/render_layer.hpp>
@@ -9,8 +10,10 @@
 #include <mbgl/tile/geometry_tile.hpp>
 #include <mbgl/util/instrumentation.hpp>
 #include <mbgl/util/math.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
 
 #include <list>
+#include <unordered_set>
 #include <utility>
 
 namespace mbgl {
@@ -49,12 +52,7 @@ const CollisionGroups::CollisionGroup& CollisionGroups::get(const std::string& s
     if (!crossSourceCollisions) {
         if (!collisionGroups.contains(sourceID)) {
             uint16_t nextGroupID = ++maxGroupID;
-            collisionGroups.emplace(
-                sourceID,
-                CollisionGroup(nextGroupID,
-                               std::optional<Predicate>([nextGroupID](const RefIndexedSubfeature& feature) -> bool {
-                                   return feature.getCollisionGroupId() == nextGroupID;
-                               })));
+            collisionGroups.emplace(sourceID, CollisionGroup(nextGroupID, CollisionGroupPredicate{nextGroupID}));
         }
         return collisionGroups[sourceID];
     } else {
@@ -199,10 +197,17 @@ Placement::Placement()
 Placement::~Placement() = default;
 
 void Placement::placeLayers(const RenderLayerReferences& layers) {
+    if (incremental) {
+        prepareIncrementalPlacement(layers);
+    }
+    if (threadPool) {
+        projectBuckets(layers);
+    }
     for (auto it = layers.crbegin(); it != layers.crend(); ++it) {
         std::set<uint32_t> seenCrossTileIDs;
         placeLayer(*it, seenCrossTileIDs);
     }
+    projectedBuckets.clear();
     commit();
 }
 
@@ -243,10 +248,32 @@ void Placement::placeSymbolBucket(const BucketPlacementData& params, std::set<ui
                          placementZoom,
                          collisionGroups.get(params.sourceId),
                          getAvoidEdges(symbolBucket, renderTile.matrix)};
-    for (const SymbolInstance& symbol : getSortedSymbols(params, ctx.pixelRatio)) {
+    const auto shift = updateBucketOrigin(symbolBucket, renderTile);
+    const bool reuse = changedRegions && shift && !symbolBucket.justReloaded && !renderTile.holdForFade();
+    auto projected = projectedBuckets.find(&params);
+    const SymbolInstanceReferences symbols = projected != projectedBuckets.end()
+                                                 ? std::move(projected->second.symbols)
+                                                 : getSortedSymbols(params, ctx.pixelRatio);
+    for (std::size_t i = 0; i < symbols.size(); ++i) {
+        const SymbolInstance& symbol = symbols[i];
         if (!symbol.check(SYM_GUARD_LOC)) continue;
-        if (seenCrossTileIDs.contains(symbol.getCrossTileID())) continue;
-        placeSymbol(symbol, ctx);
+        if (seenCrossTileIDs.contains(symbol.getCrossTileID())) {
+            if (changedRegions) markSymbolChanged(symbolBucket.bucketInstanceId, symbol.getCrossTileID(), shift);
+            continue;
+        }
+        if (!reuse || !reuseSymbol(symbol, ctx, *shift)) {
+            if (projected != projectedBuckets.end()) {
+                const auto& textBoundaries = projected->second.textBoundaries[i];
+                const auto& iconBoundaries = projected->second.iconBoundaries[i];
+                placeSymbol(symbol,
+                            ctx,
+                            textBoundaries ? &*textBoundaries : nullptr,
+                            iconBoundaries ? &*iconBoundaries : nullptr);
+            } else {
+                placeSymbol(symbol, ctx);
+            }
+            if (changedRegions) markSymbolChanged(symbolBucket.bucketInstanceId, symbol.getCrossTileID(), shift);
+        }
 
         // Prevent a flickering issue while zooming out.
         if (symbol.getCrossTileID() != SymbolInstance::invalidCrossTileID && !ctx.getRenderTile().holdForFade()) {
@@ -265,7 +292,10 @@ void Placement::placeSymbolBucket(const BucketPlacementData& params, std::set<ui
         std::forward_as_tuple(symbolBucket.bucketInstanceId, params.featureIndex, ctx.getOverscaledID()));
 }
 
-JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, const PlacementContext& ctx) {
+JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance,
+                                     const PlacementContext& ctx,
+                                     const CollisionBoundaries* textBoundaries,
+                                     const CollisionBoundaries* iconBoundaries) {
     static const JointPlacement kUnplaced(false, false, false);
     if (!symbolInstance.check(SYM_GUARD_LOC)) return kUnplaced;
     if (symbolInstance.getCrossTileID() == SymbolInstance::invalidCrossTileID) return kUnplaced;
@@ -326,22 +356,28 @@ JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, cons
         // Line or point label placement
         if (variableTextAnchors.empty()) {
             const auto placeFeature = [&](const CollisionFeature& collisionFeature,
-                                          style::TextWritingModeType orientation) {
+                                          style::TextWritingModeType orientation,
+                                          const CollisionBoundaries* boundaries) {
                 textBoxes.clear();
-                auto placedFeature = collisionIndex.placeFeature(collisionFeature,
-                                                                 {},
-                                                                 posMatrix,
-                                                                 ctx.textLabelPlaneMatrix,
-                                                                 ctx.pixelRatio,
-                                                                 placedSymbol,
-                                                                 ctx.scale,
-                                                                 fontSize,
-                                                                 ctx.textAllowOverlap,
-                                                                 ctx.pitchTextWithMap,
-                                                                 showCollisionBoxes,
-                                                                 ctx.avoidEdges,
-                                                                 collisionGroup.second,
-                                                                 textBoxes);
+                auto placedFeature = boundaries ? collisionIndex.placeProjectedFeature(*boundaries,
+                                                                                       ctx.textAllowOverlap,
+                                                                                       ctx.avoidEdges,
+                                                                                       collisionGroup.second,
+                                                                                       textBoxes)
+                                                : collisionIndex.placeFeature(collisionFeature,
+                                                                              {},
+                                                                              posMatrix,
+                                                                              ctx.textLabelPlaneMatrix,
+                                                                              ctx.pixelRatio,
+                                                                              placedSymbol,
+                                                                              ctx.scale,
+                                                                              fontSize,
+                                                                              ctx.textAllowOverlap,
+                                                                              ctx.pitchTextWithMap,
+                                                                              showCollisionBoxes,
+                                                                              ctx.avoidEdges,
+                                                                              collisionGroup.second,
+                                                                              textBoxes);
                 if (placedFeature.first) {
                     placedOrientations.emplace(symbolInstance.getCrossTileID(), orientation);
                 }
@@ -349,13 +385,15 @@ JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, cons
             };
 
             const auto placeHorizontal = [&] {
-                return placeFeature(symbolInstance.getTextCollisionFeature(), style::TextWritingModeType::Horizontal);
+                return placeFeature(
+                    symbolInstance.getTextCollisionFeature(), style::TextWritingModeType::Horizontal, textBoundaries);
             };
 
             const auto placeVertical = [&] {
                 if (bucket.allowVerticalPlacement && symbolInstance.getVerticalTextCollisionFeature()) {
                     return placeFeature(*symbolInstance.getVerticalTextCollisionFeature(),
-                                        style::TextWritingModeType::Vertical);
+                                        style::TextWritingModeType::Vertical,
+                                        nullptr);
                 }
                 return std::pair<bool, bool>{false, false};
             };
@@ -536,7 +574,13 @@ JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, cons
         const auto& iconBuffer = symbolInstance.hasSdfIcon() ? bucket.sdfIcon : bucket.icon;
         const PlacedSymbol& placedSymbol = iconBuffer.placedSymbols.at(*symbolInstance.getPlacedIconIndex());
         const float fontSize = evaluateSizeForFeature(ctx.partiallyEvaluatedIconSize, placedSymbol);
-        const auto& placeIconFeature = [&](const CollisionFeature& collisionFeature) {
+        const auto& placeIconFeature = [&](const CollisionFeature& collisionFeature,
+                                           const CollisionBoundaries* boundaries) {
+            // The icon was projected without the shift of a variable text anchor
+            if (boundaries && shift.x == 0.0f && shift.y == 0.0f) {
+                return collisionIndex.placeProjectedFeature(
+                    *boundaries, ctx.iconAllowOverlap, ctx.avoidEdges, collisionGroup.second, iconBoxes);
+            }
             return collisionIndex.placeFeature(collisionFeature,
                                                shift,
                                                posMatrix,
@@ -555,9 +599,10 @@ JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, cons
 
         std::pair<bool, bool> placedIcon;
         if (placedVerticalText.first && symbolInstance.getVerticalIconCollisionFeature()) {
-            placedIcon = placedVerticalIcon = placeIconFeature(*symbolInstance.getVerticalIconCollisionFeature());
+            placedIcon = placedVerticalIcon = placeIconFeature(*symbolInstance.getVerticalIconCollisionFeature(),
+                                                               nullptr);
         } else {
-            placedIcon = placeIconFeature(symbolInstance.getIconCollisionFeature());
+            placedIcon = placeIconFeature(symbolInstance.getIconCollisionFeature(), iconBoundaries);
         }
         placeIcon = placedIcon.first;
         offscreen &= placedIcon.second;
@@ -639,9 +684,313 @@ JointPlacement Placement::placeSymbol(const SymbolInstance& symbolInstance, cons
         placeText || ctx.alwaysShowText, placeIcon || ctx.alwaysShowIcon, offscreen || bucket.justReloaded);
     placements.emplace(symbolInstance.getCrossTileID(), result);
     newSymbolPlaced(symbolInstance, ctx, result, ctx.placementType, textBoxes, iconBoxes);
+    if (incremental) {
+        recordSymbol(symbolInstance, ctx, result, placeText, placeIcon);
+    }
+    return result;
+}
+
+namespace {
+
+// Below this many symbols, handing buckets to the pool costs more than projecting them here
+constexpr std::size_t defaultMinProjectedSymbols = 1024;
+
+std::size_t minProjectedSymbols() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD);
+    if (auto* count = value.getUint()) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto* count = value.getInt(); count && *count >= 0) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto* count = value.getDouble(); count && *count >= 0.0) {
+        return static_cast<std::size_t>(*count);
+    }
+    return defaultMinProjectedSymbols;
+}
+
+} // namespace
+
+void Placement::projectBuckets(const RenderLayerReferences& layers) {
+    MLN_TRACE_FUNC();
+
+    std::vector<const BucketPlacementData*> buckets;
+    std::size_t symbolCount = 0;
+    for (const RenderLayer& layer : layers) {
+        for (const BucketPlacementData& data : layer.getPlacementData()) {
+            // Symbols of tiles held for fading aren't placed
+            if (data.tile.get().holdForFade()) continue;
+            buckets.push_back(&data);
+            symbolCount += static_cast<const SymbolBucket&>(data.bucket.get()).symbolInstances.size();
+        }
+    }
+    if (buckets.empty() || symbolCount < minProjectedSymbols()) return;
+
+    // One job per bucket. The render thread is waiting for them, so don't let them queue behind tile work.
+    std::vector<ProjectedBucket> results(buckets.size());
+    ParallelJobs::run(
+        buckets.size(),
+        [&](std::size_t i) { results[i] = projectBucket(*buckets[i]); },
+        *threadPool->get(),
+        threadPool->tag,
+        TaskPriority::High);
+
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        projectedBuckets.emplace(buckets[i], std::move(results[i]));
+    }
+}
+
+Placement::ProjectedBucket Placement::projectBucket(const BucketPlacementData& params) const {
+    const RenderTile& renderTile = params.tile;
+    const mat4& posMatrix = renderTile.matrix;
+    // Same as PlacementContext::pixelRatio
+    const auto& tileID = renderTile.getOverscaledTileID();
+    const auto pixelRatio = static_cast<float>(util::tileSize_D * tileID.overscaleFactor() / util::EXTENT);
+
+    ProjectedBucket result;
+    result.symbols = getSortedSymbols(params, pixelRatio);
+    result.textBoundaries.reserve(result.symbols.size());
+    result.iconBoundaries.reserve(result.symbols.size());
+    for (const SymbolInstance& symbol : result.symbols) {
+        if (!symbol.check(SYM_GUARD_LOC)) {
+            result.textBoundaries.emplace_back();
+            result.iconBoundaries.emplace_back();
+            continue;
+        }
+
+        // Symbols with variable anchors try several shifts, which depend on the previous placement
+        const CollisionFeature& text = symbol.getTextCollisionFeature();
+        if (symbol.getTextAnchors().empty() && !text.alongLine && !text.boxes.empty()) {
+            result.textBoundaries.emplace_back(collisionIndex.projectFeature(text, {}, posMatrix, pixelRatio));
+        } else {
+            result.textBoundaries.emplace_back();
+        }
+
+        const CollisionFeature& icon = symbol.getIconCollisionFeature();
+        if (!icon.alongLine && !icon.boxes.empty()) {
+            result.iconBoundaries.emplace_back(collisionIndex.projectFeature(icon, {}, posMatrix, pixelRatio));
+        } else {
+            result.iconBoundaries.emplace_back();
+        }
+    }
     return result;
 }
 
+void Placement::prepareIncrementalPlacement(const RenderLayerReferences& layers) {
+    const Placement* prev = getPrevPlacement();
+    const TransformState& state = collisionIndex.getTransformState();
+    // Any other camera change alters the shape of the projected boxes, and so does a pan with pitch.
+    const bool sameCamera = prev && !prev->bucketOrder.empty() && !showCollisionBoxes &&
+                            state.getZoom() == prev->collisionIndex.getTransformState().getZoom() &&
+                            state.getBearing() == prev->collisionIndex.getTransformState().getBearing() &&
+                            state.getSize() == prev->collisionIndex.getTransformState().getSize() &&
+                            state.getPitch() == 0.0 && prev->collisionIndex.getTransformState().getPitch() == 0.0 &&
+                            updateParameters->crossSourceCollisions == prev->updateParameters->crossSourceCollisions;
+
+    bucketOrder.clear();
+    std::vector<uint32_t> common;
+    std::optional<Point<float>> cameraShift;
+    for (auto it = layers.crbegin(); it != layers.crend(); ++it) {
+        for (const BucketPlacementData& data : it->get().getPlacementData()) {
+            const auto& bucket = static_cast<const SymbolBucket&>(data.bucket.get());
+            bucketOrder.push_back(bucket.bucketInstanceId);
+            if (!sameCamera) continue;
+            auto prevOrigin = prev->bucketOrigins.find(bucket.bucketInstanceId);
+            if (prevOrigin == prev->bucketOrigins.end()) continue;
+            common.push_back(bucket.bucketInstanceId);
+            if (!cameraShift) {
+                const auto bounds = collisionIndex.projectTileBoundaries(data.tile.get().matrix);
+                cameraShift = Point<float>{bounds[0], bounds[1]} - prevOrigin->second;
+            }
+        }
+    }
+    if (!cameraShift) return;
+
+    // Each symbol's placement depends on the symbols placed before it, so the
+    // buckets both placements have must be placed in the same order.
+    const std::unordered_set<uint32_t> current(bucketOrder.begin(), bucketOrder.end());
+    std::vector<uint32_t> prevCommon;
+    std::copy_if(prev->bucketOrder.begin(),
+                 prev->bucketOrder.end(),
+                 std::back_inserter(prevCommon),
+                 [&](uint32_t id) { return current.contains(id); });
+    if (common != prevCommon) return;
+
+    const Size size = state.getSize();
+    const float padding = collisionIndex.getViewportPadding();
+    changedRegions.emplace(size.width + 2 * padding, size.height + 2 * padding, 25);
+
+    // Symbols of buckets that are gone leave room for the others.
+    for (const auto& [key, record] : prev->symbolRecords) {
+        if (!current.contains(static_cast<uint32_t>(key >> 32))) {
+            markChanged(record, *cameraShift);
+        }
+    }
+}
+
+std::optional<Point<float>> Placement::updateBucketOrigin(const SymbolBucket& bucket, const RenderTile& tile) {
+    if (!incremental) return std::nullopt;
+    const auto bounds = collisionIndex.projectTileBoundaries(tile.matrix);
+    const Point<float> origin{bounds[0], bounds[1]};
+    bucketOrigins.insert_or_assign(bucket.bucketInstanceId, origin);
+    if (!changedRegions) return std::nullopt;
+    auto prevOrigin = getPrevPlacement()->bucketOrigins.find(bucket.bucketInstanceId);
+    if (prevOrigin == getPrevPlacement()->bucketOrigins.end()) return std::nullopt;
+    return origin - prevOrigin->second;
+}
+
+bool Placement::reuseSymbol(const SymbolInstance& symbol, const PlacementContext& ctx, Point<float> shift) {
+    const uint32_t crossTileID = symbol.getCrossTileID();
+    if (crossTileID == SymbolInstance::invalidCrossTileID) return false;
+    const SymbolBucket& bucket = ctx.getBucket();
+    const uint64_t key = symbolKey(bucket.bucketInstanceId, crossTileID);
+    const Placement& prev = *getPrevPlacement();
+    auto found = prev.symbolRecords.find(key);
+    if (found == prev.symbolRecords.end() || !found->second.reusable) return false;
+    const SymbolRecord& prevRecord = found->second;
+
+    SymbolRecord record{prevRecord.placement, {}, {}, prevRecord.textInserted, prevRecord.iconInserted, true};
+    const auto translate = [&](const std::vector<ProjectedCollisionBox>& boxes,
+                               std::vector<ProjectedCollisionBox>& translated) {
+        for (const ProjectedCollisionBox& box : boxes) {
+            const auto& prevBox = box.box();
+            const CollisionBoundaries prevBounds{{prevBox.min.x, prevBox.min.y, prevBox.max.x, prevBox.max.y}};
+            const CollisionBoundaries bounds{
+                {prevBounds[0] + shift.x, prevBounds[1] + shift.y, prevBounds[2] + shift.x, prevBounds[3] + shift.y}};
+            // Near the viewport edges, the grid and offscreen checks may come out differently.
+            if (!prev.collisionIndex.isInsideViewport(prevBounds) || !collisionIndex.isInsideViewport(bounds) ||
+                changedRegions->hitTest(GridIndex<uint32_t>::BBox{{bounds[0], bounds[1]}, {bounds[2], bounds[3]}})) {
+                return false;
+            }
+            translated.emplace_back(bounds[0], bounds[1], bounds[2], bounds[3]);
+        }
+        return true;
+    };
+    if (!translate(prevRecord.textBoxes, record.textBoxes) || !translate(prevRecord.iconBoxes, record.iconBoxes)) {
+        return false;
+    }
+
+    if (record.textInserted) {
+        collisionIndex.insertFeature(symbol.getTextCollisionFeature(),
+                                     record.textBoxes,
+                                     ctx.getLayout().get<TextIgnorePlacement>(),
+                                     bucket.bucketInstanceId,
+                                     ctx.collisionGroup.first);
+    }
+    if (record.iconInserted) {
+        collisionIndex.insertFeature(symbol.getIconCollisionFeature(),
+                                     record.iconBoxes,
+                                     ctx.getLayout().get<IconIgnorePlacement>(),
+                                     bucket.bucketInstanceId,
+                                     ctx.collisionGroup.first);
+    }
+
+    if (auto orientation = prev.placedOrientations.find(crossTileID); orientation != prev.placedOrientations.end()) {
+        placedOrientations.insert_or_assign(crossTileID, orientation->second);
+    }
+    if (auto offset = prev.variableOffsets.find(crossTileID); offset != prev.variableOffsets.end()) {
+        variableOffsets.insert_or_assign(crossTileID, offset->second);
+    }
+
+    // A symbol without boxes counts as offscreen, see placeSymbol().
+    const bool offscreen = record.textBoxes.empty() && record.iconBoxes.empty();
+    placements.erase(crossTileID);
+    placements.emplace(crossTileID, JointPlacement(prevRecord.placement.text, prevRecord.placement.icon, offscreen));
+    symbolRecords.erase(key);
+    symbolRecords.emplace(key, std::move(record));
+    return true;
+}
+
+void Placement::recordSymbol(const SymbolInstance& symbol,
+                             const PlacementContext& ctx,
+                             const JointPlacement& placement,
+                             bool textInserted,
+                             bool iconInserted) {
+    // Variable anchors, vertical writing modes and line labels make placeSymbol()
+    // test boxes it doesn't keep, and tile edges only apply in Tile map mode.
+    const bool reusable = symbol.getTextAnchors().empty() && !ctx.getBucket().allowVerticalPlacement &&
+                          !symbol.getTextCollisionFeature().alongLine && !symbol.getIconCollisionFeature().alongLine &&
+                          !ctx.avoidEdges;
+    SymbolRecord record{placement, {}, {}, textInserted, iconInserted, reusable};
+    if (reusable || textInserted) record.textBoxes = textBoxes;
+    if (reusable || iconInserted) record.iconBoxes = iconBoxes;
+
+    const uint64_t key = symbolKey(ctx.getBucket().bucketInstanceId, symbol.getCrossTileID());
+    auto existing = symbolRecords.find(key);
+    if (existing != symbolRecords.end()) {
+        // The bucket was placed for another layer too; keep all the boxes so
+        // that the next placement marks them changed.
+        record.reusable = false;
+        record.textInserted |= existing->second.textInserted;
+        record.iconInserted |= existing->second.iconInserted;
+        record.textBoxes.insert(
+            record.textBoxes.end(), existing->second.textBoxes.begin(), existing->second.textBoxes.end());
+        record.iconBoxes.insert(
+            record.iconBoxes.end(), existing->second.iconBoxes.begin(), existing->second.iconBoxes.end());
+        symbolRecords.erase(existing);
+    }
+    symbolRecords.emplace(key, std::move(record));
+}
+
+void Placement::markSymbolChanged(uint32_t bucketInstanceId,
+                                  uint32_t crossTileID,
+                                  std::optional<Point<float>> shift) {
+    const uint64_t key = symbolKey(bucketInstanceId, crossTileID);
+    auto found = symbolRecords.find(key);
+    const SymbolRecord* record = found != symbolRecords.end() ? &found->second : nullptr;
+    const SymbolRecord* prevRecord = nullptr;
+    if (shift) {
+        auto prevFound = getPrevPlacement()->symbolRecords.find(key);
+        prevRecord = prevFound != getPrevPlacement()->symbolRecords.end() ? &prevFound->second : nullptr;
+    }
+
+    // Placing a symbol again often gives the same result, which changes nothing for the symbols after it.
+    const auto sameBoxes = [&](const std::vector<ProjectedCollisionBox>& boxes,
+                               const std::vector<ProjectedCollisionBox>& prevBoxes) {
+        constexpr float tolerance = 0.01f;
+        return boxes.size() == prevBoxes.size() &&
+               std::equal(boxes.begin(),
+                          boxes.end(),
+                          prevBoxes.begin(),
+                          [&](const ProjectedCollisionBox& a, const ProjectedCollisionBox& b) {
+                              return a.isBox() && b.isBox() &&
+                                     std::abs(a.box().min.x - b.box().min.x - shift->x) < tolerance &&
+                                     std::abs(a.box().min.y - b.box().min.y - shift->y) < tolerance &&
+                                     std::abs(a.box().max.x - b.box().max.x - shift->x) < tolerance &&
+                                     std::abs(a.box().max.y - b.box().max.y - shift->y) < tolerance;
+                          });
+    };
+    if (record && prevRecord && record->textInserted == prevRecord->textInserted &&
+        record->iconInserted == prevRecord->iconInserted &&
+        (!record->textInserted || sameBoxes(record->textBoxes, prevRecord->textBoxes)) &&
+        (!record->iconInserted || sameBoxes(record->iconBoxes, prevRecord->iconBoxes))) {
+        return;
+    }
+
+    if (record) markChanged(*record, {0.0f, 0.0f});
+    if (prevRecord) markChanged(*prevRecord, *shift);
+}
+
+void Placement::markChanged(const SymbolRecord& record, Point<float> shift) {
+    const auto mark = [&](const std::vector<ProjectedCollisionBox>& boxes) {
+        for (const ProjectedCollisionBox& box : boxes) {
+            if (box.isBox()) {
+                const auto& b = box.box();
+                changedRegions->insert(
+                    0u,
+                    GridIndex<uint32_t>::BBox{{b.min.x + shift.x, b.min.y + shift.y},
+                                              {b.max.x + shift.x, b.max.y + shift.y}});
+            } else if (box.isCircle()) {
+                const auto& c = box.circle();
+                changedRegions->insert(
+                    0u, GridIndex<uint32_t>::BCircle{{c.center.x + shift.x, c.center.y + shift.y}, c.radius});
+            }
+        }
+    };
+    if (record.textInserted) mark(record.textBoxes);
+    if (record.iconInserted) mark(record.iconBoxes);
+}
+
 namespace {
 
 SymbolInstanceReferences getBucketSymbols(const SymbolBucket& bucket,
@@ -658,7 +1007,7 @@ SymbolInstanceReferences getBucketSymbols(const SymbolBucket& bucket,
 
 } // namespace
 
-SymbolInstanceReferences Placement::getSortedSymbols(const BucketPlacementData& params, float) {
+SymbolInstanceReferences Placement::getSortedSymbols(const BucketPlacementData& params, float) const {
     const auto& bucket = static_cast<const SymbolBucket&>(params.bucket.get());
     SymbolInstanceReferences sortedSymbols = getBucketSymbols(
         bucket, params.sortKeyRange, collisionIndex.getTransformState().getBearing());
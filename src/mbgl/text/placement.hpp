@@ -1,10 +1,12 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/layout/symbol_projection.hpp>
 #include <mbgl/renderer/renderer.hpp>
 #include <mbgl/style/transition_options.hpp>
 #include <mbgl/text/collision_index.hpp>
 #include <mbgl/util/chrono.hpp>
+#include <mbgl/util/grid_index.hpp>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -77,8 +79,7 @@ struct RetainedQueryData {
 
 class CollisionGroups {
 public:
-    using Predicate = std::function<bool(const RefIndexedSubfeature&)>;
-    using CollisionGroup = std::pair<uint16_t, std::optional<Predicate>>;
+    using CollisionGroup = std::pair<uint16_t, std::optional<CollisionGroupPredicate>>;
 
     CollisionGroups(const bool crossSourceCollisions_)
         : maxGroupID(0),
@@ -127,6 +128,24 @@ public:
     virtual bool hasTransitions(TimePoint now) const;
     virtual bool transitionsEnabled() const;
     virtual void collectPlacedSymbolData(bool /*enable*/) {}
+    /**
+     * @brief In Continuous map mode, enables taking over the results of the
+     * previous placement for symbols that a pan only moved.
+     *
+     * Only placements of a camera with the same zoom, bearing and size and
+     * without pitch are reused, as the projected collision boxes of such a
+     * placement are a translation of the previous ones. A symbol keeps its
+     * previous result if its boxes are onscreen in both placements and no
+     * symbol placed before it changed around them; all others, including the
+     * ones the pan exposes, are placed again.
+     */
+    void setIncremental(bool enable) { incremental = enable; }
+    /**
+     * @brief Sets the pool on which the symbols' collision boxes are projected
+     * ahead of placement. Collision detection itself stays serial, so the
+     * result is the same as without a pool.
+     */
+    void setThreadPool(const TaggedScheduler& pool) { threadPool.emplace(pool); }
     virtual const std::vector<PlacedSymbolData>& getPlacedSymbolsData() const;
 
     const CollisionIndex& getCollisionIndex() const;
@@ -145,7 +164,12 @@ public:
 protected:
     friend SymbolBucket;
     virtual void placeSymbolBucket(const BucketPlacementData&, std::set<uint32_t>& seenCrossTileIDs);
-    JointPlacement placeSymbol(const SymbolInstance& symbolInstance, const PlacementContext&);
+    // `textBoundaries` and `iconBoundaries` are the projected boxes of the
+    // horizontal text and of the icon, if they were computed beforehand.
+    JointPlacement placeSymbol(const SymbolInstance& symbolInstance,
+                               const PlacementContext&,
+                               const CollisionBoundaries* textBoundaries = nullptr,
+                               const CollisionBoundaries* iconBoundaries = nullptr);
     void placeLayer(const RenderLayer&, std::set<uint32_t>&);
     virtual void commit();
     virtual void newSymbolPlaced(const SymbolInstance&,
@@ -159,7 +183,17 @@ protected:
     virtual std::optional<CollisionBoundaries> getAvoidEdges(const SymbolBucket&, const mat4& /*posMatrix*/) {
         return std::nullopt;
     }
-    SymbolInstanceReferences getSortedSymbols(const BucketPlacementData&, float pixelRatio);
+    SymbolInstanceReferences getSortedSymbols(const BucketPlacementData&, float pixelRatio) const;
+
+    // The symbols of a bucket in placement order, with the boxes
+    // placeSymbol() can take projected beforehand.
+    struct ProjectedBucket {
+        SymbolInstanceReferences symbols;
+        std::vector<std::optional<CollisionBoundaries>> textBoundaries;
+        std::vector<std::optional<CollisionBoundaries>> iconBoundaries;
+    };
+    void projectBuckets(const RenderLayerReferences&);
+    ProjectedBucket projectBucket(const BucketPlacementData&) const;
     virtual bool canPlaceAtVariableAnchor(const CollisionBox&,
                                           style::TextVariableAnchorType,
                                           Point<float> /*shift*/,
@@ -181,6 +215,28 @@ protected:
     const Placement* getPrevPlacement() const { return prevPlacement ? prevPlacement->get() : nullptr; }
     bool isTiltedView() const;
 
+    // Incremental placement, see `setIncremental()`.
+    struct SymbolRecord {
+        JointPlacement placement;
+        std::vector<ProjectedCollisionBox> textBoxes;
+        std::vector<ProjectedCollisionBox> iconBoxes;
+        bool textInserted;
+        bool iconInserted;
+        // Whether the boxes are all the placement tested, so that translating
+        // them reproduces its outcome.
+        bool reusable;
+    };
+    static uint64_t symbolKey(uint32_t bucketInstanceId, uint32_t crossTileID) {
+        return (uint64_t(bucketInstanceId) << 32) | crossTileID;
+    }
+    void prepareIncrementalPlacement(const RenderLayerReferences&);
+    // Records the bucket's tile origin, and returns how far it moved since the previous placement.
+    std::optional<Point<float>> updateBucketOrigin(const SymbolBucket&, const RenderTile&);
+    bool reuseSymbol(const SymbolInstance&, const PlacementContext&, Point<float> shift);
+    void recordSymbol(const SymbolInstance&, const PlacementContext&, const JointPlacement&, bool text, bool icon);
+    void markSymbolChanged(uint32_t bucketInstanceId, uint32_t crossTileID, std::optional<Point<float>> shift);
+    void markChanged(const SymbolRecord&, Point<float> shift);
+
     std::shared_ptr<const UpdateParameters> updateParameters;
     CollisionIndex collisionIndex;
 
@@ -206,6 +262,18 @@ protected:
     std::vector<ProjectedCollisionBox> iconBoxes;
     // Used for debug purposes.
     std::unordered_map<const CollisionFeature*, std::vector<ProjectedCollisionBox>> collisionCircles;
+
+    std::optional<TaggedScheduler> threadPool;
+    std::unordered_map<const BucketPlacementData*, ProjectedBucket> projectedBuckets;
+
+    bool incremental = false;
+    // Symbol results and tile origins of this placement, for the next one.
+    std::unordered_map<uint64_t, SymbolRecord> symbolRecords;
+    std::unordered_map<uint32_t, Point<float>> bucketOrigins;
+    std::vector<uint32_t> bucketOrder;
+    // Set while the previous placement is being reused; covers the boxes of
+    // the symbols placed so far whose outcome may differ from the previous one.
+    std::optional<GridIndex<uint32_t>> changedRegions;
 };
 
 } // namespace mbgl
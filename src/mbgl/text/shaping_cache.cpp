@@ -0,0 +1,277 @@
+#include <mbgl/text/shaping_cache.hpp>
+
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/util/hash.hpp>
+#include <mbgl/util/i18n.hpp>
+
+#include <algorithm>
+
+namespace mbgl {
+
+namespace {
+
+std::optional<std::size_t> configuredMaxSize() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_SHAPING_CACHE_SIZE);
+    if (auto* size = value.getUint()) {
+        return static_cast<std::size_t>(*size);
+    }
+    if (auto* size = value.getInt(); size && *size >= 0) {
+        return static_cast<std::size_t>(*size);
+    }
+    if (auto* size = value.getDouble(); size && *size >= 0.0) {
+        return static_cast<std::size_t>(*size);
+    }
+    return std::nullopt;
+}
+
+// The glyph metrics shapeLines() would see for a glyph, and its position in the atlas
+bool findGlyph(const GlyphID& id,
+               FontStackHash font,
+               const GlyphMap& glyphMap,
+               const GlyphPositions& glyphPositions,
+               Rect<uint16_t>& rect,
+               GlyphMetrics& metrics) {
+    auto positions = glyphPositions.find(font);
+    if (positions == glyphPositions.end()) {
+        return false;
+    }
+    auto position = positions->second.find(id);
+    if (position != positions->second.end()) {
+        rect = position->second.rect;
+        metrics = position->second.metrics;
+        return true;
+    }
+
+    auto glyphs = glyphMap.find(font);
+    if (glyphs == glyphMap.end()) {
+        return false;
+    }
+    auto glyph = glyphs->second.find(id);
+    if (glyph == glyphs->second.end() || !glyph->second) {
+        return false;
+    }
+    rect = {};
+    metrics = (*glyph->second)->metrics;
+    return true;
+}
+
+// Shaping leaves out glyphs and images the tile doesn't have, so only shapings that
+// have all of them can be used for other tiles.
+bool isComplete(const TaggedString& text,
+                const GlyphMap& glyphMap,
+                const GlyphPositions& glyphPositions,
+                const ImagePositions& imagePositions) {
+    Rect<uint16_t> rect;
+    GlyphMetrics metrics;
+    for (std::size_t i = 0; i < text.length(); ++i) {
+        const SectionOptions& section = text.getSection(i);
+        const char16_t codePoint = text.getCharCodeAt(i);
+        if (section.imageID) {
+            if (!imagePositions.contains(*section.imageID)) return false;
+        } else if (!util::i18n::isWhitespace(codePoint)) {
+            const GlyphID id(codePoint, section.type);
+            if (!findGlyph(id, section.fontStackHash, glyphMap, glyphPositions, rect, metrics)) return false;
+        }
+    }
+    return true;
+}
+
+// Points a cached shaping at the atlas positions of this tile. Fails if a glyph is
+// missing or measures differently here, which would change the layout. Images were
+// matched by their display sizes through the key already.
+bool rebind(Shaping& shaping,
+            const GlyphMap& glyphMap,
+            const GlyphPositions& glyphPositions,
+            const ImagePositions& imagePositions) {
+    for (auto& line : shaping.positionedLines) {
+        for (auto& glyph : line.positionedGlyphs) {
+            if (glyph.imageID) {
+                auto image = imagePositions.find(*glyph.imageID);
+                if (image == imagePositions.end()) return false;
+                glyph.rect = image->second.paddedRect;
+            } else {
+                GlyphMetrics metrics;
+                if (!findGlyph(glyph.glyph, glyph.font, glyphMap, glyphPositions, glyph.rect, metrics) ||
+                    !(metrics == glyph.metrics)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ShapingCache::ShapingCache()
+    : maxShardSize(0) {
+    setMaxSize(configuredMaxSize().value_or(defaultMaxSize));
+}
+
+ShapingCache& ShapingCache::get() {
+    static ShapingCache instance;
+    return instance;
+}
+
+void ShapingCache::setMaxSize(std::size_t maxSize) {
+    const std::size_t shardSize = (maxSize + shardCount - 1) / shardCount;
+    maxShardSize = shardSize;
+    for (Shard& shard : shards) {
+        std::scoped_lock lock(shard.mutex);
+        if (shard.entries.size() > shardSize) {
+            shard.entries.clear();
+        }
+    }
+}
+
+std::size_t ShapingCache::getMaxSize() const {
+    return maxShardSize * shardCount;
+}
+
+std::size_t ShapingCache::KeyHasher::operator()(const Key& key) const {
+    std::size_t seed = util::hash(key.text.first,
+                                  key.maxWidth,
+                                  key.lineHeight,
+                                  static_cast<uint8_t>(key.textAnchor),
+                                  static_cast<uint8_t>(key.textJustify),
+                                  key.spacing,
+                                  key.translate[0],
+                                  key.translate[1],
+                                  static_cast<uint8_t>(key.writingMode),
+                                  key.layoutTextSize,
+                                  key.layoutTextSizeAtBucketZoomLevel,
+                                  key.allowVerticalPlacement);
+    for (const auto& section : key.sections) {
+        util::hash_combine(seed, section.fontStackHash);
+        util::hash_combine(seed, section.scale);
+        if (section.imageDisplaySize) {
+            util::hash_combine(seed, (*section.imageDisplaySize)[0]);
+            util::hash_combine(seed, (*section.imageDisplaySize)[1]);
+        }
+    }
+    return seed;
+}
+
+Shaping ShapingCache::getShaping(const TaggedString& text,
+                                 const float maxWidth,
+                                 const float lineHeight,
+                                 const style::SymbolAnchorType textAnchor,
+                                 const style::TextJustifyType textJustify,
+                                 const float spacing,
+                                 const std::array<float, 2>& translate,
+                                 const WritingModeType writingMode,
+                                 BiDi& bidi,
+                                 const GlyphMap& glyphMap,
+                                 const GlyphPositions& glyphPositions,
+                                 const ImagePositions& imagePositions,
+                                 float layoutTextSize,
+                                 float layoutTextSizeAtBucketZoomLevel,
+                                 bool allowVerticalPlacement) {
+    const auto shape = [&] {
+        return mbgl::getShaping(text,
+                                maxWidth,
+                                lineHeight,
+                                textAnchor,
+                                textJustify,
+                                spacing,
+                                translate,
+                                writingMode,
+                                bidi,
+                                glyphMap,
+                                glyphPositions,
+                                imagePositions,
+                                layoutTextSize,
+                                layoutTextSizeAtBucketZoomLevel,
+                                allowVerticalPlacement);
+    };
+
+    const std::size_t shardSize = maxShardSize;
+
+    // HarfBuzz adjustments are computed per feature and aren't part of the key
+    const auto& sections = text.getSections();
+    if (shardSize == 0 || text.empty() ||
+        std::ranges::any_of(sections, [](const SectionOptions& section) { return section.adjusts != nullptr; })) {
+        return shape();
+    }
+
+    Key key{text.getStyledText(),
+            {},
+            maxWidth,
+            lineHeight,
+            textAnchor,
+            textJustify,
+            spacing,
+            translate,
+            writingMode,
+            layoutTextSize,
+            layoutTextSizeAtBucketZoomLevel,
+            allowVerticalPlacement};
+    key.sections.reserve(sections.size());
+    for (const auto& section : sections) {
+        std::optional<std::array<float, 2>> imageDisplaySize;
+        if (section.imageID) {
+            if (auto image = imagePositions.find(*section.imageID); image != imagePositions.end()) {
+                imageDisplaySize = image->second.displaySize();
+            }
+        }
+        key.sections.push_back({section.scale,
+                                section.fontStackHash,
+                                section.type,
+                                section.startIndex,
+                                section.imageID,
+                                imageDisplaySize});
+    }
+
+    const std::size_t hash = KeyHasher()(key);
+    Shard& shard = shardFor(hash);
+
+    std::shared_ptr<const Shaping> cached;
+    {
+        std::scoped_lock lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            cached = it->second;
+        }
+    }
+    if (cached) {
+        Shaping shaping = *cached;
+        if (rebind(shaping, glyphMap, glyphPositions, imagePositions)) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return shaping;
+        }
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    Shaping shaping = shape();
+    if (isComplete(text, glyphMap, glyphPositions, imagePositions)) {
+        auto entry = std::make_shared<const Shaping>(shaping);
+        std::scoped_lock lock(shard.mutex);
+        if (shard.entries.size() >= shardSize) {
+            shard.entries.clear();
+        }
+        shard.entries.insert_or_assign(std::move(key), std::move(entry));
+    }
+    return shaping;
+}
+
+auto ShapingCache::getStats() const -> Stats {
+    Stats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    for (const Shard& shard : shards) {
+        std::scoped_lock lock(shard.mutex);
+        stats.size += shard.entries.size();
+    }
+    return stats;
+}
+
+void ShapingCache::clear() {
+    for (Shard& shard : shards) {
+        std::scoped_lock lock(shard.mutex);
+        shard.entries.clear();
+    }
+    hits = 0;
+    misses = 0;
+}
+
+} // namespace mbgl
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <mbgl/text/shaping.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mbgl {
+
+// Shapings of labels, shared by the symbol layouts of all tiles. Road names, POI
+// categories and house numbers repeat heavily within a tile and across tiles, and
+// for each repeat this skips line breaking, BiDi and glyph positioning.
+//
+// A shaping depends on the tile it was made for only through the atlas positions
+// of its glyphs and images. A cached one is used after looking those up again for
+// the tile at hand, and only if every glyph has the same metrics in that tile.
+// Images are part of the key with the display sizes shaping measures them by.
+//
+// The number of entries is capped by the EXPERIMENTAL_SHAPING_CACHE_SIZE platform
+// setting, read when the cache is first used, or by setMaxSize(); 0 disables it.
+class ShapingCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        std::size_t size = 0;
+    };
+
+    static ShapingCache& get();
+
+    // Same as getShaping(), with its result taken from and added to the cache.
+    Shaping getShaping(const TaggedString&,
+                       float maxWidth,
+                       float lineHeight,
+                       style::SymbolAnchorType,
+                       style::TextJustifyType,
+                       float spacing,
+                       const std::array<float, 2>& translate,
+                       WritingModeType,
+                       BiDi&,
+                       const GlyphMap&,
+                       const GlyphPositions&,
+                       const ImagePositions&,
+                       float layoutTextSize,
+                       float layoutTextSizeAtBucketZoomLevel,
+                       bool allowVerticalPlacement);
+
+    Stats getStats() const;
+    void clear();
+
+    // Caps the number of cached shapings, dropping entries if there are more. 0 turns the cache off.
+    void setMaxSize(std::size_t);
+    std::size_t getMaxSize() const;
+
+private:
+    struct SectionKey {
+        double scale;
+        FontStackHash fontStackHash;
+        GlyphIDType type;
+        int32_t startIndex;
+        std::optional<std::string> imageID;
+        // Compared exactly, as shaping lays the text out with the float display size of the image
+        std::optional<std::array<float, 2>> imageDisplaySize;
+
+        bool operator==(const SectionKey&) const = default;
+    };
+
+    struct Key {
+        StyledText text;
+        std::vector<SectionKey> sections;
+        float maxWidth;
+        float lineHeight;
+        style::SymbolAnchorType textAnchor;
+        style::TextJustifyType textJustify;
+        float spacing;
+        std::array<float, 2> translate;
+        WritingModeType writingMode;
+        float layoutTextSize;
+        float layoutTextSizeAtBucketZoomLevel;
+        bool allowVerticalPlacement;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHasher {
+        std::size_t operator()(const Key&) const;
+    };
+
+    // Entries are spread over shards, each with its own lock, so that the worker
+    // threads laying out tiles rarely wait on each other. A full shard is emptied.
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, std::shared_ptr<const Shaping>, KeyHasher> entries;
+    };
+    static constexpr std::size_t shardCount = 16;
+    static constexpr std::size_t defaultMaxSize = shardCount * 2048;
+
+    ShapingCache();
+
+    Shard& shardFor(std::size_t hash) { return shards[hash % shardCount]; }
+
+    std::array<Shard, shardCount> shards;
+    std::atomic<std::size_t> maxShardSize;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+} // namespace mbgl
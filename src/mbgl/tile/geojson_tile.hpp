@@ -20,11 +20,15 @@ public:
                 TileObserver* observer = nullptr);
 
     void updateData(std::shared_ptr<style::GeoJSONData> data, bool needsRelayout, bool runSynchronously);
+    // Takes data that is the same as the current data within this tile, without loading the tile again
+    void replaceData(std::shared_ptr<style::GeoJSONData> data);
 
     void querySourceFeatures(std::vector<Feature>& result, const SourceQueryOptions&) override;
 
 private:
     std::shared_ptr<style::GeoJSONData> data;
+    // Counts getTile() requests; only the response to the latest one is used
+    uint64_t dataRequest = 0;
     mapbox::base::WeakPtrFactory<GeoJSONTile> weakFactory{this};
     // Do not add members here, see `WeakPtrFactory`
 };
@@ -332,6 +332,10 @@ void GeometryTile::setShowCollisionBoxes(const bool showCollisionBoxes_) {
     }
 }
 
+void GeometryTile::setPriority(const TaskPriority priority) {
+    worker.setPriority(priority);
+}
+
 void GeometryTile::onLayout(std::shared_ptr<LayoutResult> result, const uint64_t resultCorrelationID) {
     MLN_TRACE_FUNC();
 
@@ -450,6 +454,61 @@ std::shared_ptr<FeatureIndex> GeometryTile::getFeatureIndex() const {
     return layoutResult ? layoutResult->featureIndex : nullptr;
 }
 
+namespace {
+std::size_t atlasBytes(const std::vector<gfx::TextureHandle>& handles, const gfx::DynamicTexturePtr& texture) {
+    if (!texture) {
+        return 0;
+    }
+    const std::size_t pixelSize = texture->getPixelFormat() == gfx::TexturePixelType::Alpha ? 1 : 4;
+    std::size_t size = 0;
+    for (const auto& handle : handles) {
+        const auto& rect = handle.getRectangle();
+        size += static_cast<std::size_t>(rect.w) * rect.h * pixelSize;
+    }
+    return size;
+}
+} // namespace
+
+std::size_t GeometryTile::getByteSize() const {
+    if (!layoutResult) {
+        return 0;
+    }
+
+    // Layers of a bucket group share one bucket, count it once.
+    std::size_t size = 0;
+    mbgl::unordered_set<const Bucket*> buckets;
+    for (const auto& entry : layoutResult->layerRenderData) {
+        const Bucket* bucket = entry.second.bucket.get();
+        if (bucket && buckets.insert(bucket).second) {
+            size += bucket->getByteSize();
+        }
+    }
+
+    if (layoutResult->featureIndex) {
+        size += layoutResult->featureIndex->getByteSize();
+    }
+    return size;
+}
+
+std::size_t GeometryTile::getGPUByteSize() const {
+    if (!layoutResult) {
+        return 0;
+    }
+
+    std::size_t size = 0;
+    mbgl::unordered_set<const Bucket*> buckets;
+    for (const auto& entry : layoutResult->layerRenderData) {
+        const Bucket* bucket = entry.second.bucket.get();
+        if (bucket && buckets.insert(bucket).second) {
+            size += bucket->getGPUByteSize();
+        }
+    }
+
+    size += atlasBytes(layoutResult->glyphAtlas.textureHandles, layoutResult->glyphAtlas.dynamicTexture);
+    size += atlasBytes(layoutResult->imageAtlas.textureHandles, layoutResult->imageAtlas.dynamicTexture);
+    return size;
+}
+
 bool GeometryTile::layerPropertiesUpdated(const Immutable<style::LayerProperties>& layerProperties) {
     MLN_TRACE_FUNC();
 
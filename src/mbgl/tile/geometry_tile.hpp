@@ -43,6 +43,7 @@ public:
     std::unique_ptr<TileRenderData> createRenderData() override;
     void setLayers(const std::vector<Immutable<style::LayerProperties>>&) override;
     void setShowCollisionBoxes(bool showCollisionBoxes) override;
+    void setPriority(TaskPriority) override;
 
     void onGlyphsAvailable(GlyphMap, HBShapeRequests) override;
     void onImagesAvailable(ImageMap, ImageMap, ImageVersionMap versionMap, uint64_t imageCorrelationID) override;
@@ -66,6 +67,9 @@ public:
 
     void cancel() override;
 
+    std::size_t getByteSize() const override;
+    std::size_t getGPUByteSize() const override;
+
     class LayoutResult {
     public:
         mbgl::unordered_map<std::string, LayerRenderData> layerRenderData;
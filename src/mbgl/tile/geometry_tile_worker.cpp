@@ -20,8 +20,10 @@
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/exception.hpp>
 #include <mbgl/util/stopwatch.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
 #include <mbgl/util/thread_pool.hpp>
 
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 
@@ -406,6 +408,76 @@ void GeometryTileWorker::requestNewImages(const ImageDependencies& imageDependen
     }
 }
 
+namespace {
+
+/// Fills the buckets of layer groups that don't need a layout step, one job per source layer.
+/// Jobs are independent of each other, so idle pool workers can help while the tile's own worker
+/// does the same. Feature index entries are kept per group and merged afterwards in group order,
+/// which yields the same index as filling the buckets one after another.
+class BucketJobs {
+public:
+    struct Group {
+        const std::vector<Immutable<style::LayerProperties>>* layers;
+        std::shared_ptr<Bucket> bucket;
+        FeatureIndexShard featureIndexShard;
+    };
+
+    struct Job {
+        std::unique_ptr<GeometryTileLayer> geometryLayer;
+        std::vector<Group> groups;
+    };
+
+    BucketJobs(const OverscaledTileID& id_, MapMode mode_, float pixelRatio_, const std::atomic<bool>& obsolete_)
+        : id(id_),
+          mode(mode_),
+          pixelRatio(pixelRatio_),
+          obsolete(obsolete_) {}
+
+    std::vector<Job> jobs;
+
+    /// Decode each feature of the source layer once and run the filters of all its groups against it
+    void fill(std::size_t index) {
+        MLN_TRACE_FUNC();
+
+        Job& job = jobs[index];
+        for (auto& group : job.groups) {
+            const style::Layer::Impl& leaderImpl = *(group.layers->at(0)->baseImpl);
+            BucketParameters parameters{
+                .tileID = id, .mode = mode, .pixelRatio = pixelRatio, .layerType = leaderImpl.getTypeInfo()};
+            group.bucket = LayerManager::get()->createBucket(parameters, *group.layers);
+        }
+
+        for (std::size_t i = 0; !obsolete && i < job.geometryLayer->featureCount(); i++) {
+            std::unique_ptr<GeometryTileFeature> feature = job.geometryLayer->getFeature(i);
+            const auto context = expression::EvaluationContext(static_cast<float>(id.overscaledZ), feature.get())
+                                     .withCanonicalTileID(&id.canonical);
+
+            // Geometries are only decoded once some group wants the feature
+            const GeometryCollection* geometries = nullptr;
+            for (auto& group : job.groups) {
+                if (!group.layers->at(0)->baseImpl->filter(context)) continue;
+
+                if (!geometries) {
+                    geometries = &feature->getGeometries();
+                }
+                group.bucket->addFeature(*feature, *geometries, {}, PatternLayerMap(), i, id.canonical);
+                group.featureIndexShard.insert(*geometries, i);
+            }
+        }
+
+        // The source data isn't needed once the buckets are filled
+        job.geometryLayer.reset();
+    }
+
+private:
+    const OverscaledTileID id;
+    const MapMode mode;
+    const float pixelRatio;
+    const std::atomic<bool>& obsolete;
+};
+
+} // namespace
+
 void GeometryTileWorker::parse() {
     MLN_TRACE_FUNC();
 
@@ -422,11 +494,6 @@ void GeometryTileWorker::parse() {
 
     featureIndex = std::make_unique<FeatureIndex>(*data ? (*data)->clone() : nullptr);
 
-    // Avoid small reallocations for populated cells.
-    // If we had a total feature count, this could be based on that and the cell count.
-    constexpr auto estimatedElementsPerCell = 8;
-    featureIndex->reserve(estimatedElementsPerCell);
-
     GlyphDependencies glyphDependencies;
     ImageDependencies imageDependencies;
 
@@ -438,25 +505,111 @@ void GeometryTileWorker::parse() {
         groupMap[layoutKey(*layer->baseImpl)].push_back(std::move(layer));
     }
 
-    for (auto& pair : groupMap) {
-        const auto& group = pair.second;
+    // Groups with data in this tile, in the order their results go into the feature index.
+    // Groups without a layout step are filled by the bucket job of their source layer, the
+    // others keep their geometry layer until the layout is created.
+    struct GroupEntry {
+        const std::vector<Immutable<style::LayerProperties>>* group;
+        std::unique_ptr<GeometryTileLayer> geometryLayer;
+        std::unique_ptr<Layout> layout;
+        std::optional<std::pair<std::size_t, std::size_t>> job; // job and group within it
+    };
+    std::vector<GroupEntry> entries;
+
+    BucketJobs bucketJobs(id, mode, pixelRatio, obsolete);
+
+    if (*data) {
+        mbgl::unordered_map<std::string, std::size_t> sourceLayerJobs;
+
+        entries.reserve(groupMap.size());
+        for (const auto& pair : groupMap) {
+            const auto& group = pair.second;
+            const style::Layer::Impl& leaderImpl = *(group.at(0)->baseImpl);
+
+            if (leaderImpl.getTypeInfo()->layout == LayerTypeInfo::Layout::Required) {
+                // Layers are decoded lazily and not thread-safe to look up, so do it here
+                auto geometryLayer = (*data)->getLayer(leaderImpl.sourceLayer);
+                if (geometryLayer) {
+                    entries.push_back({.group = &group, .geometryLayer = std::move(geometryLayer)});
+                }
+                continue;
+            }
+
+            auto jobIt = sourceLayerJobs.find(leaderImpl.sourceLayer);
+            if (jobIt == sourceLayerJobs.end()) {
+                auto geometryLayer = (*data)->getLayer(leaderImpl.sourceLayer);
+                if (!geometryLayer) {
+                    continue;
+                }
+                jobIt = sourceLayerJobs.emplace(leaderImpl.sourceLayer, bucketJobs.jobs.size()).first;
+                bucketJobs.jobs.push_back({.geometryLayer = std::move(geometryLayer)});
+            }
+
+            auto& job = bucketJobs.jobs[jobIt->second];
+            entries.push_back({.group = &group, .job = std::make_pair(jobIt->second, job.groups.size())});
+            job.groups.push_back({.layers = &group});
+        }
+    }
+
+    // Avoid reallocations while the index fills up. Most features of a source layer that is used
+    // at all end up in the index about once, so the feature counts are a fair guess.
+    std::size_t estimatedFeatureCount = 0;
+    for (const auto& job : bucketJobs.jobs) {
+        estimatedFeatureCount += job.geometryLayer->featureCount();
+    }
+    for (const auto& entry : entries) {
+        if (entry.geometryLayer) {
+            estimatedFeatureCount += entry.geometryLayer->featureCount();
+        }
+    }
+    featureIndex->reserve(estimatedFeatureCount);
+
+    // This tile's parse is already underway, so don't let its helpers queue behind new work. Jobs
+    // refer to our locals, so leaving early still waits for them.
+    ParallelJobs parallelBucketJobs(
+        bucketJobs.jobs.size(),
+        [&bucketJobs](std::size_t i) { bucketJobs.fill(i); },
+        *scheduler.get(),
+        scheduler.tag,
+        TaskPriority::High);
+
+    // Symbol layers and layers that support pattern properties have an
+    // extra step at layout time to figure out what images/glyphs are needed
+    // to render the layer. They use the intermediate Layout data structure
+    // to accomplish this, and either immediately create a bucket if no
+    // images/glyphs are used, or the Layout is stored until the
+    // images/glyphs are available to add the features to the buckets.
+    // Creating them doesn't touch the feature index, so it overlaps with the bucket jobs.
+    for (auto& entry : entries) {
         if (obsolete) {
             return;
         }
-
-        if (!*data) {
-            continue; // Tile has no data.
+        if (entry.job) {
+            continue;
         }
 
-        const style::Layer::Impl& leaderImpl = *(group.at(0)->baseImpl);
+        const style::Layer::Impl& leaderImpl = *(entry.group->at(0)->baseImpl);
         BucketParameters parameters{
             .tileID = id, .mode = mode, .pixelRatio = pixelRatio, .layerType = leaderImpl.getTypeInfo()};
+        entry.layout = LayerManager::get()->createLayout({.bucketParameters = parameters,
+                                                          .fontFaces = fontFaces,
+                                                          .glyphDependencies = glyphDependencies,
+                                                          .imageDependencies = imageDependencies,
+                                                          .availableImages = availableImages},
+                                                         std::move(entry.geometryLayer),
+                                                         *entry.group);
+    }
 
-        auto geometryLayer = (*data)->getLayer(leaderImpl.sourceLayer);
-        if (!geometryLayer) {
-            continue;
+    parallelBucketJobs.wait();
+
+    for (auto& entry : entries) {
+        if (obsolete) {
+            return;
         }
 
+        const auto& group = *entry.group;
+        const style::Layer::Impl& leaderImpl = *(group.at(0)->baseImpl);
+
         std::vector<std::string> layerIDs;
         layerIDs.reserve(group.size());
         for (const auto& layer : group) {
@@ -465,48 +618,23 @@ void GeometryTileWorker::parse() {
 
         featureIndex->setBucketLayerIDs(leaderImpl.id, layerIDs);
 
-        // Symbol layers and layers that support pattern properties have an
-        // extra step at layout time to figure out what images/glyphs are needed
-        // to render the layer. They use the intermediate Layout data structure
-        // to accomplish this, and either immediately create a bucket if no
-        // images/glyphs are used, or the Layout is stored until the
-        // images/glyphs are available to add the features to the buckets.
-        if (leaderImpl.getTypeInfo()->layout == LayerTypeInfo::Layout::Required) {
-            std::unique_ptr<Layout> layout = LayerManager::get()->createLayout({.bucketParameters = parameters,
-                                                                                .fontFaces = fontFaces,
-                                                                                .glyphDependencies = glyphDependencies,
-                                                                                .imageDependencies = imageDependencies,
-                                                                                .availableImages = availableImages},
-                                                                               std::move(geometryLayer),
-                                                                               group);
-            if (layout->hasDependencies()) {
-                layouts.push_back(std::move(layout));
+        if (!entry.job) {
+            if (entry.layout->hasDependencies()) {
+                layouts.push_back(std::move(entry.layout));
             } else {
-                layout->createBucket({}, featureIndex, renderData, firstLoad, showCollisionBoxes, id.canonical);
+                entry.layout->createBucket({}, featureIndex, renderData, firstLoad, showCollisionBoxes, id.canonical);
             }
         } else {
-            const Filter& filter = leaderImpl.filter;
-            const std::string& sourceLayerID = leaderImpl.sourceLayer;
-            std::shared_ptr<Bucket> bucket = LayerManager::get()->createBucket(parameters, group);
-
-            for (std::size_t i = 0; !obsolete && i < geometryLayer->featureCount(); i++) {
-                std::unique_ptr<GeometryTileFeature> feature = geometryLayer->getFeature(i);
-
-                if (!filter(expression::EvaluationContext(static_cast<float>(this->id.overscaledZ), feature.get())
-                                .withCanonicalTileID(&id.canonical)))
-                    continue;
-
-                const GeometryCollection& geometries = feature->getGeometries();
-                bucket->addFeature(*feature, geometries, {}, PatternLayerMap(), i, id.canonical);
-                featureIndex->insert(geometries, i, sourceLayerID, leaderImpl.id);
-            }
+            auto& jobGroup = bucketJobs.jobs[entry.job->first].groups[entry.job->second];
+            featureIndex->merge(jobGroup.featureIndexShard, leaderImpl.sourceLayer, leaderImpl.id);
 
-            if (!bucket->hasData()) {
+            if (!jobGroup.bucket->hasData()) {
                 continue;
             }
 
             for (const auto& layer : group) {
-                renderData.emplace(layer->baseImpl->id, LayerRenderData{.bucket = bucket, .layerProperties = layer});
+                renderData.emplace(layer->baseImpl->id,
+                                   LayerRenderData{.bucket = jobGroup.bucket, .layerProperties = layer});
             }
         }
     }
@@ -155,6 +155,14 @@ void RasterDEMTile::cancel() {
     markObsolete();
 }
 
+std::size_t RasterDEMTile::getByteSize() const {
+    return bucket ? bucket->getByteSize() : 0;
+}
+
+std::size_t RasterDEMTile::getGPUByteSize() const {
+    return bucket ? bucket->getGPUByteSize() : 0;
+}
+
 void RasterDEMTile::markObsolete() {
     obsolete = true;
     if (pending) {
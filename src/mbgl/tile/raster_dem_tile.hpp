@@ -88,6 +88,8 @@ public:
     void onError(std::exception_ptr, uint64_t correlationID);
 
     void cancel() override;
+    std::size_t getByteSize() const override;
+    std::size_t getGPUByteSize() const override;
 
 private:
     void markObsolete();
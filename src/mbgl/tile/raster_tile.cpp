@@ -110,6 +110,14 @@ void RasterTile::cancel() {
     markObsolete();
 }
 
+std::size_t RasterTile::getByteSize() const {
+    return bucket ? bucket->getByteSize() : 0;
+}
+
+std::size_t RasterTile::getGPUByteSize() const {
+    return bucket ? bucket->getGPUByteSize() : 0;
+}
+
 void RasterTile::markObsolete() {
     obsolete = true;
     if (pending) {
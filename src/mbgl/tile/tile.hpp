@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mbgl/actor/scheduler.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/feature.hpp>
@@ -68,9 +69,22 @@ public:
 
     virtual void setUpdateParameters(const TileUpdateParameters&) {}
 
+    // Sets how urgently background work for this tile is scheduled, e.g.,
+    // based on its distance from the center of the viewport.
+    virtual void setPriority(TaskPriority) {}
+
     // Mark this tile as no longer needed and cancel any pending work.
     virtual void cancel() = 0;
 
+    // Approximate number of bytes of CPU memory kept alive by this tile:
+    // bucket geometry and the feature index.
+    virtual std::size_t getByteSize() const { return 0; }
+
+    // Approximate number of bytes of GPU memory kept alive by this tile: the
+    // buffers and textures its buckets are uploaded to and the tile's share
+    // of the glyph and image atlases.
+    virtual std::size_t getGPUByteSize() const { return 0; }
+
     // Notifies this tile of the updated layer properties.
     //
     // Tile implementation should update the contained layer
@@ -21,20 +21,45 @@ void TileCache::setSize(size_t size_) {
     MLN_TRACE_FUNC();
 
     size = size_;
+    evict();
+}
+
+void TileCache::setMaxBytes(size_t maxBytes_) {
+    MLN_TRACE_FUNC();
+
+    maxBytes = maxBytes_;
+    evict();
+}
 
-    while (orderedKeys.size() > size) {
-        const auto key = orderedKeys.front();
-        orderedKeys.remove(key);
+TileCacheStats TileCache::getStats() const {
+    return {.tiles = entries.size(),
+            .bytes = bytes,
+            .gpuBytes = gpuBytes,
+            .maxBytes = maxBytes,
+            .hits = hits,
+            .misses = misses,
+            .evictions = evictions};
+}
 
-        auto hit = tiles.find(key);
-        if (hit != tiles.end()) {
-            auto tile = std::move(hit->second);
-            tiles.erase(hit);
-            deferredRelease(std::move(tile));
-        }
+void TileCache::evict() {
+    while (!entries.empty() && (entries.size() > size || bytes > maxBytes)) {
+        deferredRelease(erase(entries.begin()));
+        evictions++;
     }
 
-    assert(orderedKeys.size() <= size);
+    assert(entries.size() <= size);
+    assert(bytes <= maxBytes);
+}
+
+std::unique_ptr<Tile> TileCache::erase(Entries::iterator it) {
+    std::unique_ptr<Tile> tile = std::move(it->tile);
+    assert(bytes >= it->bytes);
+    bytes -= it->bytes;
+    assert(gpuBytes >= it->gpuBytes);
+    gpuBytes -= it->gpuBytes;
+    index.erase(it->key);
+    entries.erase(it);
+    return tile;
 }
 
 namespace {
@@ -102,66 +127,65 @@ void TileCache::deferPendingReleases() {
 void TileCache::add(const OverscaledTileID& key, std::unique_ptr<Tile>&& tile) {
     MLN_TRACE_FUNC();
 
-    if (!tile->isRenderable() || !size) {
+    if (!tile->isRenderable() || !size || !maxBytes) {
         deferredRelease(std::move(tile));
         return;
     }
 
-    const auto result = tiles.insert(std::make_pair(key, std::unique_ptr<Tile>{}));
-    if (result.second) {
-        // inserted
-        result.first->second = std::move(tile);
-    } else {
-        // already present
-        // remove existing tile key to move it to the end
-        orderedKeys.remove(key);
-        // release the newly-provided item
+    if (const auto hit = index.find(key); hit != index.end()) {
+        // already present: keep the existing tile, release the newly-provided one, and mark the key as newest
+        entries.splice(entries.end(), entries, hit->second);
         deferredRelease(std::move(tile));
+        return;
     }
 
-    // (re-)insert tile key as newest
-    orderedKeys.push_back(key);
-
-    // purge oldest key/tile if necessary
-    if (orderedKeys.size() > size) {
-        deferredRelease(pop(orderedKeys.front()));
+    const std::size_t tileBytes = tile->getByteSize();
+    if (tileBytes > maxBytes) {
+        // it would evict everything else and still not fit
+        deferredRelease(std::move(tile));
+        evictions++;
+        return;
     }
 
-    assert(orderedKeys.size() <= size);
+    const std::size_t tileGPUBytes = tile->getGPUByteSize();
+    entries.push_back({.key = key, .tile = std::move(tile), .bytes = tileBytes, .gpuBytes = tileGPUBytes});
+    index.emplace(key, std::prev(entries.end()));
+    bytes += tileBytes;
+    gpuBytes += tileGPUBytes;
+
+    // purge oldest tiles if necessary
+    evict();
 }
 
 Tile* TileCache::get(const OverscaledTileID& key) {
-    auto it = tiles.find(key);
-    if (it != tiles.end()) {
-        return it->second.get();
-    } else {
-        return nullptr;
-    }
+    const auto it = index.find(key);
+    return it != index.end() ? it->second->tile.get() : nullptr;
 }
 
 std::unique_ptr<Tile> TileCache::pop(const OverscaledTileID& key) {
-    std::unique_ptr<Tile> tile;
-
-    const auto it = tiles.find(key);
-    if (it != tiles.end()) {
-        tile = std::move(tiles.extract(it).mapped());
-        orderedKeys.remove(key);
-        assert(tile->isRenderable());
+    const auto it = index.find(key);
+    if (it == index.end()) {
+        return {};
     }
 
+    hits++;
+    std::unique_ptr<Tile> tile = erase(it->second);
+    assert(tile->isRenderable());
     return tile;
 }
 
 bool TileCache::has(const OverscaledTileID& key) {
-    return tiles.find(key) != tiles.end();
+    return index.find(key) != index.end();
 }
 
 void TileCache::clear() {
-    for (auto& item : tiles) {
-        deferredRelease(std::move(item.second));
+    for (auto& entry : entries) {
+        deferredRelease(std::move(entry.tile));
     }
-    orderedKeys.clear();
-    tiles.clear();
+    entries.clear();
+    index.clear();
+    bytes = 0;
+    gpuBytes = 0;
 }
 
 } // namespace mbgl
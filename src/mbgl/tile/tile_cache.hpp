@@ -1,36 +1,61 @@
 #pragma once
 
 #include <mbgl/actor/scheduler.hpp>
+#include <mbgl/renderer/tile_cache_stats.hpp>
 #include <mbgl/tile/tile_id.hpp>
 #include <mbgl/tile/tile.hpp>
+#include <mbgl/util/constants.hpp>
+#include <mbgl/util/containers.hpp>
 
 #include <list>
 #include <memory>
-#include <map>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
 
 namespace mbgl {
 
+/// Least-recently-used cache of tiles that left the render set, bounded both by
+/// a number of tiles and by the CPU bytes the tiles hold (see `Tile::getByteSize`).
 class TileCache {
 public:
-    TileCache(const TaggedScheduler& threadPool_, size_t size_ = 0)
+    TileCache(const TaggedScheduler& threadPool_, size_t size_ = 0, size_t maxBytes_ = util::DEFAULT_TILE_CACHE_SIZE)
         : threadPool(threadPool_),
-          size(size_) {}
+          size(size_),
+          maxBytes(maxBytes_) {}
     ~TileCache();
 
-    /// Change the maximum size of the cache.
+    /// Change the maximum number of tiles in the cache.
     void setSize(size_t);
 
-    /// Get the maximum size
+    /// Get the maximum number of tiles
     size_t getMaxSize() const { return size; }
 
+    /// Change the maximum number of bytes held by the cached tiles.
+    void setMaxBytes(size_t);
+
+    /// Get the maximum number of bytes
+    size_t getMaxBytes() const { return maxBytes; }
+
+    /// Get the number of bytes currently held by the cached tiles
+    size_t getBytes() const { return bytes; }
+
+    /// Get the number of GPU bytes currently held by the cached tiles
+    size_t getGPUBytes() const { return gpuBytes; }
+
+    TileCacheStats getStats() const;
+
     /// Add a new tile with the given ID.
     /// If a tile with the same ID is already present, it will be retained and the new one will be discarded.
+    /// The size of the tile is sampled here, tiles don't change while they are cached.
+    /// A tile larger than the whole byte budget is released right away, leaving the cached tiles alone.
     void add(const OverscaledTileID& key, std::unique_ptr<Tile>&& tile);
 
     std::unique_ptr<Tile> pop(const OverscaledTileID& key);
+
+    /// Count a tile that had to be created because `pop` didn't have it
+    void recordMiss() { misses++; }
+
     Tile* get(const OverscaledTileID& key);
     bool has(const OverscaledTileID& key);
     void clear();
@@ -42,14 +67,33 @@ public:
     void deferPendingReleases();
 
 private:
-    std::map<OverscaledTileID, std::unique_ptr<Tile>> tiles;
-    std::list<OverscaledTileID> orderedKeys;
+    struct Entry {
+        OverscaledTileID key;
+        std::unique_ptr<Tile> tile;
+        std::size_t bytes;
+        std::size_t gpuBytes;
+    };
+    using Entries = std::list<Entry>;
+
+    /// Drop the oldest tiles until the cache is within both limits.
+    void evict();
+    std::unique_ptr<Tile> erase(Entries::iterator);
+
+    /// Ordered from least to most recently added
+    Entries entries;
+    mbgl::unordered_map<OverscaledTileID, Entries::iterator> index;
     TaggedScheduler threadPool;
     std::vector<std::unique_ptr<Tile>> pendingReleases;
     size_t deferredDeletionsPending{0};
     std::mutex deferredSignalLock;
     std::condition_variable deferredSignal;
     size_t size;
+    size_t maxBytes;
+    size_t bytes = 0;
+    size_t gpuBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
 };
 
 } // namespace mbgl
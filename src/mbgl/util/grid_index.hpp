@@ -8,9 +8,8 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <optional>
-#include <unordered_set>
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 namespace mbgl {
@@ -61,8 +60,12 @@ public:
     using BBox = mapbox::geometry::box<float>;
     using BCircle = geometry::circle<float>;
 
-    /// Set the expected number of elements per cell to avoid small re-allocations for populated cells
-    void reserve(std::size_t value) { estimatedElementsPerCell = value; }
+    /// Make room for `count` boxes in total, each in a single cell, to avoid re-allocations while inserting
+    void reserve(std::size_t count) {
+        boxElements.reserve(count);
+        boxRanges.reserve(count);
+        boxNodes.reserve(count);
+    }
 
     void insert(T&& t, const BBox&);
     void insert(T&& t, const BCircle&);
@@ -70,19 +73,75 @@ public:
     std::vector<T> query(const BBox&) const;
     std::vector<std::pair<T, BBox>> queryWithBoxes(const BBox&) const;
 
-    bool hitTest(const BBox&, std::optional<std::function<bool(const T&)>> predicate = std::nullopt) const;
-    bool hitTest(const BCircle&, std::optional<std::function<bool(const T&)>> predicate = std::nullopt) const;
+    /// Call `resultFn(const T&, const BBox&)` for each element intersecting the box, until it returns true
+    template <typename ResultFn>
+    void query(const BBox&, ResultFn&& resultFn) const;
+
+    bool hitTest(const BBox& bbox) const {
+        return hitTest(bbox, [](const T&) { return true; });
+    }
+    bool hitTest(const BCircle& bcircle) const {
+        return hitTest(bcircle, [](const T&) { return true; });
+    }
+
+    /// Test for an intersecting element for which `predicate(const T&)` holds
+    template <typename Predicate>
+    bool hitTest(const BBox&, Predicate&& predicate) const;
+    template <typename Predicate>
+    bool hitTest(const BCircle&, Predicate&& predicate) const;
 
     bool empty() const;
 
+    /// Bytes allocated for elements, cell lists and nodes
+    std::size_t getByteSize() const {
+        return boxElements.capacity() * sizeof(std::pair<T, BBox>) +
+               circleElements.capacity() * sizeof(std::pair<T, BCircle>) +
+               (boxRanges.capacity() + circleRanges.capacity()) * sizeof(CellRange) +
+               (boxCells.capacity() + circleCells.capacity()) * sizeof(CellList) +
+               (boxNodes.capacity() + circleNodes.capacity()) * sizeof(CellNode);
+    }
+
 private:
+    // Cells are linked lists threaded through a single node array per element kind, so inserting
+    // doesn't allocate per cell and all cell contents share one contiguous buffer.
+    static constexpr uint32_t noNode = std::numeric_limits<uint32_t>::max();
+
+    struct CellNode {
+        uint32_t uid;
+        uint32_t next;
+    };
+
+    struct CellList {
+        uint32_t head = noNode;
+        uint32_t tail = noNode;
+    };
+
+    struct CellRange {
+        uint32_t x1;
+        uint32_t y1;
+        uint32_t x2;
+        uint32_t y2;
+    };
+
     bool noIntersection(const BBox& queryBBox) const;
     bool completeIntersection(const BBox& queryBBox) const;
     BBox convertToBox(const BCircle& circle) const;
 
-    void query(const BBox&, std::function<bool(const T&, const BBox&)>) const;
-    void query(const BCircle&, std::function<bool(const T&, const BBox&)>) const;
+    template <typename ResultFn>
+    void query(const BCircle&, ResultFn&& resultFn) const;
 
+    /// Visit the elements sharing a cell with the box, each at most once and in cell order.
+    /// An element is only looked at in the first of its cells the query visits, which avoids
+    /// keeping track of visited elements.
+    template <typename BoxTest, typename CircleTest, typename ResultFn>
+    void queryCells(const BBox&, BoxTest&& boxTest, CircleTest&& circleTest, ResultFn&& resultFn) const;
+
+    template <typename ResultFn>
+    bool queryAll(ResultFn& resultFn) const;
+
+    void insertIntoCells(std::vector<CellList>& cells, std::vector<CellNode>& nodes, const CellRange&, uint32_t uid);
+
+    CellRange convertToCellRange(const BBox&) const;
     std::size_t convertToXCellCoord(float x) const;
     std::size_t convertToYCellCoord(float y) const;
 
@@ -93,8 +152,6 @@ private:
     const float width;
     const float height;
 
-    std::size_t estimatedElementsPerCell = 0;
-
     const std::size_t xCellCount;
     const std::size_t yCellCount;
     const double xScale;
@@ -102,9 +159,13 @@ private:
 
     std::vector<std::pair<T, BBox>> boxElements;
     std::vector<std::pair<T, BCircle>> circleElements;
+    std::vector<CellRange> boxRanges;
+    std::vector<CellRange> circleRanges;
 
-    std::vector<std::vector<uint32_t>> boxCells;
-    std::vector<std::vector<uint32_t>> circleCells;
+    std::vector<CellList> boxCells;
+    std::vector<CellList> circleCells;
+    std::vector<CellNode> boxNodes;
+    std::vector<CellNode> circleNodes;
 };
 
 template <class T>
@@ -126,21 +187,8 @@ void GridIndex<T>::insert(T&& t, const BBox& bbox) {
     assert(boxElements.size() < std::numeric_limits<uint32_t>::max());
     const auto uid = static_cast<uint32_t>(boxElements.size());
 
-    const auto cx1 = convertToXCellCoord(bbox.min.x);
-    const auto cy1 = convertToYCellCoord(bbox.min.y);
-    const auto cx2 = convertToXCellCoord(bbox.max.x);
-    const auto cy2 = convertToYCellCoord(bbox.max.y);
-
-    for (std::size_t x = cx1; x <= cx2; ++x) {
-        for (std::size_t y = cy1; y <= cy2; ++y) {
-            auto& cell = boxCells[xCellCount * y + x];
-            if (estimatedElementsPerCell && cell.empty()) {
-                cell.reserve(estimatedElementsPerCell);
-            }
-            cell.push_back(uid);
-        }
-    }
-
+    boxRanges.push_back(convertToCellRange(bbox));
+    insertIntoCells(boxCells, boxNodes, boxRanges.back(), uid);
     boxElements.emplace_back(std::move(t), bbox);
 }
 
@@ -149,22 +197,31 @@ void GridIndex<T>::insert(T&& t, const BCircle& bcircle) {
     assert(circleElements.size() < std::numeric_limits<uint32_t>::max());
     const auto uid = static_cast<uint32_t>(circleElements.size());
 
-    const auto cx1 = convertToXCellCoord(bcircle.center.x - bcircle.radius);
-    const auto cy1 = convertToYCellCoord(bcircle.center.y - bcircle.radius);
-    const auto cx2 = convertToXCellCoord(bcircle.center.x + bcircle.radius);
-    const auto cy2 = convertToYCellCoord(bcircle.center.y + bcircle.radius);
+    circleRanges.push_back(convertToCellRange(convertToBox(bcircle)));
+    insertIntoCells(circleCells, circleNodes, circleRanges.back(), uid);
+    circleElements.emplace_back(std::move(t), bcircle);
+}
 
-    for (std::size_t x = cx1; x <= cx2; ++x) {
-        for (std::size_t y = cy1; y <= cy2; ++y) {
-            auto& cell = circleCells[xCellCount * y + x];
-            if (estimatedElementsPerCell && cell.empty()) {
-                cell.reserve(estimatedElementsPerCell);
+template <class T>
+void GridIndex<T>::insertIntoCells(std::vector<CellList>& cells,
+                                   std::vector<CellNode>& nodes,
+                                   const CellRange& range,
+                                   const uint32_t uid) {
+    for (std::size_t x = range.x1; x <= range.x2; ++x) {
+        for (std::size_t y = range.y1; y <= range.y2; ++y) {
+            assert(nodes.size() < noNode);
+            const auto node = static_cast<uint32_t>(nodes.size());
+            nodes.push_back({.uid = uid, .next = noNode});
+
+            auto& cell = cells[xCellCount * y + x];
+            if (cell.tail == noNode) {
+                cell.head = node;
+            } else {
+                nodes[cell.tail].next = node;
             }
-            cell.push_back(uid);
+            cell.tail = node;
         }
     }
-
-    circleElements.emplace_back(std::move(t), bcircle);
 }
 
 template <class T>
@@ -188,29 +245,23 @@ std::vector<std::pair<T, typename GridIndex<T>::BBox>> GridIndex<T>::queryWithBo
 }
 
 template <class T>
-bool GridIndex<T>::hitTest(const BBox& queryBBox, std::optional<std::function<bool(const T&)>> predicate) const {
+template <typename Predicate>
+bool GridIndex<T>::hitTest(const BBox& queryBBox, Predicate&& predicate) const {
     bool hit = false;
     query(queryBBox, [&](const T& t, const BBox&) -> bool {
-        if (!predicate || (*predicate)(t)) {
-            hit = true;
-            return true;
-        } else {
-            return false;
-        }
+        hit = predicate(t);
+        return hit;
     });
     return hit;
 }
 
 template <class T>
-bool GridIndex<T>::hitTest(const BCircle& queryBCircle, std::optional<std::function<bool(const T&)>> predicate) const {
+template <typename Predicate>
+bool GridIndex<T>::hitTest(const BCircle& queryBCircle, Predicate&& predicate) const {
     bool hit = false;
     query(queryBCircle, [&](const T& t, const BBox&) -> bool {
-        if (!predicate || (*predicate)(t)) {
-            hit = true;
-            return true;
-        } else {
-            return false;
-        }
+        hit = predicate(t);
+        return hit;
     });
     return hit;
 }
@@ -232,135 +283,107 @@ typename GridIndex<T>::BBox GridIndex<T>::convertToBox(const BCircle& circle) co
 }
 
 template <class T>
-void GridIndex<T>::query(const BBox& queryBBox, std::function<bool(const T&, const BBox&)> resultFn) const {
-    std::unordered_set<uint32_t> seenBoxes;
-    std::unordered_set<uint32_t> seenCircles;
+template <typename ResultFn>
+bool GridIndex<T>::queryAll(ResultFn& resultFn) const {
+    for (auto& element : boxElements) {
+        if (resultFn(element.first, element.second)) {
+            return true;
+        }
+    }
+    for (auto& element : circleElements) {
+        if (resultFn(element.first, convertToBox(element.second))) {
+            return true;
+        }
+    }
+    return false;
+}
 
+template <class T>
+template <typename ResultFn>
+void GridIndex<T>::query(const BBox& queryBBox, ResultFn&& resultFn) const {
     if (noIntersection(queryBBox)) {
         return;
     } else if (completeIntersection(queryBBox)) {
-        for (auto& element : boxElements) {
-            if (resultFn(element.first, element.second)) {
-                return;
-            }
-        }
-        for (auto& element : circleElements) {
-            if (resultFn(element.first, convertToBox(element.second))) {
-                return;
-            }
-        }
+        queryAll(resultFn);
         return;
     }
 
-    auto cx1 = convertToXCellCoord(queryBBox.min.x);
-    auto cy1 = convertToYCellCoord(queryBBox.min.y);
-    auto cx2 = convertToXCellCoord(queryBBox.max.x);
-    auto cy2 = convertToYCellCoord(queryBBox.max.y);
-
-    std::size_t x;
-    std::size_t y;
-    std::size_t cellIndex;
-    for (x = cx1; x <= cx2; ++x) {
-        for (y = cy1; y <= cy2; ++y) {
-            cellIndex = xCellCount * y + x;
-            // Look up other boxes
-            for (auto uid : boxCells[cellIndex]) {
-                if (!seenBoxes.contains(uid)) {
-                    seenBoxes.insert(uid);
-
-                    auto& pair = boxElements.at(uid);
-                    auto& bbox = pair.second;
-                    if (boxesCollide(queryBBox, bbox)) {
-                        if (resultFn(pair.first, bbox)) {
-                            return;
-                        }
-                    }
-                }
-            }
-
-            // Look up circles
-            for (auto uid : circleCells[cellIndex]) {
-                if (!seenCircles.contains(uid)) {
-                    seenCircles.insert(uid);
-
-                    auto& pair = circleElements.at(uid);
-                    auto& bcircle = pair.second;
-                    if (circleAndBoxCollide(bcircle, queryBBox)) {
-                        if (resultFn(pair.first, convertToBox(bcircle))) {
-                            return;
-                        }
-                    }
-                }
-            }
-        }
-    }
+    queryCells(
+        queryBBox,
+        [&](const BBox& bbox) { return boxesCollide(queryBBox, bbox); },
+        [&](const BCircle& bcircle) { return circleAndBoxCollide(bcircle, queryBBox); },
+        resultFn);
 }
 
 template <class T>
-void GridIndex<T>::query(const BCircle& queryBCircle, std::function<bool(const T&, const BBox&)> resultFn) const {
-    std::unordered_set<size_t> seenBoxes;
-    std::unordered_set<size_t> seenCircles;
-
-    BBox queryBBox = convertToBox(queryBCircle);
+template <typename ResultFn>
+void GridIndex<T>::query(const BCircle& queryBCircle, ResultFn&& resultFn) const {
+    const BBox queryBBox = convertToBox(queryBCircle);
     if (noIntersection(queryBBox)) {
         return;
     } else if (completeIntersection(queryBBox)) {
-        for (auto& element : boxElements) {
-            if (resultFn(element.first, element.second)) {
-                return;
-            }
-        }
-        for (auto& element : circleElements) {
-            if (resultFn(element.first, convertToBox(element.second))) {
-                return;
-            }
-        }
+        queryAll(resultFn);
+        return;
     }
 
-    auto cx1 = convertToXCellCoord(queryBCircle.center.x - queryBCircle.radius);
-    auto cy1 = convertToYCellCoord(queryBCircle.center.y - queryBCircle.radius);
-    auto cx2 = convertToXCellCoord(queryBCircle.center.x + queryBCircle.radius);
-    auto cy2 = convertToYCellCoord(queryBCircle.center.y + queryBCircle.radius);
-
-    std::size_t x;
-    std::size_t y;
-    std::size_t cellIndex;
-    for (x = cx1; x <= cx2; ++x) {
-        for (y = cy1; y <= cy2; ++y) {
-            cellIndex = xCellCount * y + x;
+    queryCells(
+        queryBBox,
+        [&](const BBox& bbox) { return circleAndBoxCollide(queryBCircle, bbox); },
+        [&](const BCircle& bcircle) { return circlesCollide(queryBCircle, bcircle); },
+        resultFn);
+}
+
+template <class T>
+template <typename BoxTest, typename CircleTest, typename ResultFn>
+void GridIndex<T>::queryCells(const BBox& queryBBox,
+                              BoxTest&& boxTest,
+                              CircleTest&& circleTest,
+                              ResultFn&& resultFn) const {
+    const CellRange range = convertToCellRange(queryBBox);
+    const auto isFirstVisit = [&](const CellRange& elementRange, uint32_t x, uint32_t y) {
+        return x == std::max(elementRange.x1, range.x1) && y == std::max(elementRange.y1, range.y1);
+    };
+
+    for (uint32_t x = range.x1; x <= range.x2; ++x) {
+        for (uint32_t y = range.y1; y <= range.y2; ++y) {
+            const std::size_t cellIndex = xCellCount * y + x;
             // Look up boxes
-            for (auto uid : boxCells[cellIndex]) {
-                if (!seenBoxes.contains(uid)) {
-                    seenBoxes.insert(uid);
-
-                    auto& pair = boxElements.at(uid);
-                    auto& bbox = pair.second;
-                    if (circleAndBoxCollide(queryBCircle, bbox)) {
-                        if (resultFn(pair.first, bbox)) {
-                            return;
-                        }
-                    }
+            for (auto node = boxCells[cellIndex].head; node != noNode; node = boxNodes[node].next) {
+                const auto uid = boxNodes[node].uid;
+                if (!isFirstVisit(boxRanges[uid], x, y)) {
+                    continue;
+                }
+
+                const auto& pair = boxElements[uid];
+                if (boxTest(pair.second) && resultFn(pair.first, pair.second)) {
+                    return;
                 }
             }
 
-            // Look up other circles
-            for (auto uid : circleCells[cellIndex]) {
-                if (!seenCircles.contains(uid)) {
-                    seenCircles.insert(uid);
-
-                    auto& pair = circleElements.at(uid);
-                    auto& bcircle = pair.second;
-                    if (circlesCollide(queryBCircle, bcircle)) {
-                        if (resultFn(pair.first, convertToBox(bcircle))) {
-                            return;
-                        }
-                    }
+            // Look up circles
+            for (auto node = circleCells[cellIndex].head; node != noNode; node = circleNodes[node].next) {
+                const auto uid = circleNodes[node].uid;
+                if (!isFirstVisit(circleRanges[uid], x, y)) {
+                    continue;
+                }
+
+                const auto& pair = circleElements[uid];
+                if (circleTest(pair.second) && resultFn(pair.first, convertToBox(pair.second))) {
+                    return;
                 }
             }
         }
     }
 }
 
+template <class T>
+typename GridIndex<T>::CellRange GridIndex<T>::convertToCellRange(const BBox& bbox) const {
+    return {.x1 = static_cast<uint32_t>(convertToXCellCoord(bbox.min.x)),
+            .y1 = static_cast<uint32_t>(convertToYCellCoord(bbox.min.y)),
+            .x2 = static_cast<uint32_t>(convertToXCellCoord(bbox.max.x)),
+            .y2 = static_cast<uint32_t>(convertToYCellCoord(bbox.max.y))};
+}
+
 template <class T>
 std::size_t GridIndex<T>::convertToXCellCoord(const float x) const {
     return static_cast<size_t>(util::max(0.0, util::min(xCellCount - 1.0, std::floor(x * xScale))));
@@ -0,0 +1,91 @@
+#include <mbgl/util/parallel_jobs.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <utility>
+
+namespace mbgl {
+
+class ParallelJobs::State {
+public:
+    State(std::size_t count_, Job job_)
+        : count(count_),
+          job(std::move(job_)) {}
+
+    /// Claim and run jobs until no unclaimed ones are left
+    void run() {
+        for (auto i = next++; i < count; i = next++) {
+            try {
+                job(i);
+            } catch (...) {
+                std::scoped_lock lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+
+            std::scoped_lock lock(mutex);
+            if (++finished == count) {
+                cv.notify_all();
+            }
+        }
+    }
+
+    /// Help out, then wait for the jobs still running on other threads
+    void finish() {
+        run();
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return finished == count; });
+    }
+
+    std::exception_ptr takeError() {
+        std::scoped_lock lock(mutex);
+        return std::exchange(error, nullptr);
+    }
+
+    const std::size_t count;
+
+private:
+    const Job job;
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t finished = 0;
+    std::exception_ptr error;
+};
+
+ParallelJobs::ParallelJobs(
+    std::size_t count, Job job, Scheduler& scheduler, util::SimpleIdentity tag, TaskPriority priority)
+    : state(std::make_shared<State>(count, std::move(job))) {
+    const auto helpers = std::min(count > 0 ? count - 1 : 0, scheduler.getThreadCount());
+    try {
+        for (std::size_t i = 0; i < helpers; ++i) {
+            scheduler.schedule(tag, priority, [state_ = state] { state_->run(); });
+        }
+    } catch (...) {
+        // The destructor doesn't run for a constructor that throws
+        state->finish();
+        throw;
+    }
+}
+
+ParallelJobs::~ParallelJobs() {
+    state->finish();
+}
+
+void ParallelJobs::wait() {
+    state->finish();
+    if (auto error = state->takeError()) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ParallelJobs::run(
+    std::size_t count, Job job, Scheduler& scheduler, util::SimpleIdentity tag, TaskPriority priority) {
+    ParallelJobs(count, std::move(job), scheduler, tag, priority).wait();
+}
+
+} // namespace mbgl
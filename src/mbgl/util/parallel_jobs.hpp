@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mbgl/actor/scheduler.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace mbgl {
+
+/**
+ @brief Runs a number of independent jobs on the calling thread and on idle workers of a scheduler.
+
+ The calling thread claims jobs too, so it never waits on a job that no thread has started. Workers
+ that only start once every job was claimed return without touching the job function, so jobs may
+ borrow from the caller's stack as long as the `ParallelJobs` outlives what they borrow. At most one
+ helper task per scheduler thread is scheduled.
+*/
+class ParallelJobs {
+public:
+    using Job = std::function<void(std::size_t)>;
+
+    /// @brief Start running `job(i)` for each `i` below `count`.
+    /// @param scheduler Scheduler whose workers may help
+    /// @param tag Tag of the helper tasks
+    /// @param priority Priority of the helper tasks
+    ParallelJobs(std::size_t count,
+                 Job job,
+                 Scheduler& scheduler,
+                 util::SimpleIdentity tag = util::SimpleIdentity::Empty,
+                 TaskPriority priority = TaskPriority::Normal);
+
+    /// Waits for the jobs like `wait()`, dropping any exception they threw.
+    ~ParallelJobs();
+
+    ParallelJobs(const ParallelJobs&) = delete;
+    ParallelJobs& operator=(const ParallelJobs&) = delete;
+
+    /// @brief Help with the unclaimed jobs, then wait for the ones still running on other threads.
+    /// Rethrows the first exception thrown by a job.
+    void wait();
+
+    /// @brief Run `job(i)` for each `i` below `count` and wait for all of them.
+    static void run(std::size_t count,
+                    Job job,
+                    Scheduler& scheduler,
+                    util::SimpleIdentity tag = util::SimpleIdentity::Empty,
+                    TaskPriority priority = TaskPriority::Normal);
+
+private:
+    class State;
+    std::shared_ptr<State> state;
+};
+
+} // namespace mbgl
@@ -1,19 +1,35 @@
 #include <mbgl/util/premultiply.hpp>
 
+#include <atomic>
 #include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MLN_PIXEL_KERNELS_SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define MLN_PIXEL_KERNELS_AVX2
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MLN_PIXEL_KERNELS_NEON
+#endif
 
 namespace mbgl {
 namespace util {
 
-PremultipliedImage premultiply(UnassociatedImage&& src) {
-    PremultipliedImage dst;
+namespace {
 
-    dst.size = src.size;
-    src.size = {0, 0};
-    dst.data = std::move(src.data);
+// The kernels below produce exactly the results of these, which they also use for the pixels
+// left over at the end. Premultiplying divides by 255 with rounding, which the vector versions
+// compute as (t + (t >> 8)) >> 8 with t = c * a + 128. Unpremultiplying divides in single
+// precision floats, whose rounding error stays below 1 / a for dividends below 2^24, so
+// truncating the quotient gives the integer division. Like the cast here, the kernels keep the
+// low byte of quotients above 255, which invalid input with a color above its alpha yields.
 
-    uint8_t* data = dst.data.get();
-    for (size_t i = 0; i < dst.bytes(); i += 4) {
+void premultiplyScalar(uint8_t* data, std::size_t bytes) {
+    for (size_t i = 0; i < bytes; i += 4) {
         uint8_t& r = data[i + 0];
         uint8_t& g = data[i + 1];
         uint8_t& b = data[i + 2];
@@ -22,6 +38,277 @@ PremultipliedImage premultiply(UnassociatedImage&& src) {
         g = (g * a + 127) / 255;
         b = (b * a + 127) / 255;
     }
+}
+
+void unpremultiplyScalar(uint8_t* data, std::size_t bytes) {
+    for (size_t i = 0; i < bytes; i += 4) {
+        uint8_t& r = data[i + 0];
+        uint8_t& g = data[i + 1];
+        uint8_t& b = data[i + 2];
+        uint8_t& a = data[i + 3];
+        if (a) {
+            r = static_cast<uint8_t>((255 * r + (a / 2)) / a);
+            g = static_cast<uint8_t>((255 * g + (a / 2)) / a);
+            b = static_cast<uint8_t>((255 * b + (a / 2)) / a);
+        }
+    }
+}
+
+#ifdef MLN_PIXEL_KERNELS_SSE2
+
+// Premultiplies two pixels widened to 16 bits per channel. The alpha lanes are restored by the caller.
+inline __m128i premultiplySSE2(__m128i pixels) {
+    const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xFF), 0xFF);
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+void premultiplySSE2(uint8_t* data, std::size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    std::size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i result = _mm_packus_epi16(premultiplySSE2(_mm_unpacklo_epi8(pixels, zero)),
+                                                premultiplySSE2(_mm_unpackhi_epi8(pixels, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+                         _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, pixels)));
+    }
+    premultiplyScalar(data + i, bytes - i);
+}
+
+// Unpremultiplies one pixel widened to 32 bits per channel, keeping the low byte of each channel.
+inline __m128i unpremultiplySSE2(__m128i pixel) {
+    const __m128i alpha = _mm_shuffle_epi32(pixel, 0xFF);
+    const __m128i dividend = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(pixel, 8), pixel), _mm_srli_epi32(alpha, 1));
+    const __m128i quotient = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(dividend), _mm_cvtepi32_ps(alpha)));
+    return _mm_and_si128(quotient, _mm_set1_epi32(0xFF));
+}
+
+void unpremultiplySSE2(uint8_t* data, std::size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    std::size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        const __m128i result = _mm_packus_epi16(
+            _mm_packs_epi32(unpremultiplySSE2(_mm_unpacklo_epi16(low, zero)),
+                            unpremultiplySSE2(_mm_unpackhi_epi16(low, zero))),
+            _mm_packs_epi32(unpremultiplySSE2(_mm_unpacklo_epi16(high, zero)),
+                            unpremultiplySSE2(_mm_unpackhi_epi16(high, zero))));
+        // Alpha stays, and so do pixels without any
+        const __m128i keep = _mm_or_si128(alphaMask, _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+                         _mm_or_si128(_mm_andnot_si128(keep, result), _mm_and_si128(keep, pixels)));
+    }
+    unpremultiplyScalar(data + i, bytes - i);
+}
+
+#endif
+
+#ifdef MLN_PIXEL_KERNELS_AVX2
+
+// Same as the SSE2 kernels, for twice the pixels. Packing works within 128 bit lanes, which
+// keeps premultiplied pixels in order and interleaves unpremultiplied ones, undone by a permute.
+
+__attribute__((target("avx2"))) inline __m256i premultiplyAVX2(__m256i pixels) {
+    const __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, 0xFF), 0xFF);
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2"))) void premultiplyAVX2(uint8_t* data, std::size_t bytes) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    std::size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i result = _mm256_packus_epi16(premultiplyAVX2(_mm256_unpacklo_epi8(pixels, zero)),
+                                                   premultiplyAVX2(_mm256_unpackhi_epi8(pixels, zero)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(data + i),
+            _mm256_or_si256(_mm256_andnot_si256(alphaMask, result), _mm256_and_si256(alphaMask, pixels)));
+    }
+    premultiplyScalar(data + i, bytes - i);
+}
+
+// Unpremultiplies the two pixels at `data`, widened to 32 bits per channel
+__attribute__((target("avx2"))) inline __m256i unpremultiplyAVX2(const uint8_t* data) {
+    const __m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)));
+    const __m256i alpha = _mm256_shuffle_epi32(pixels, 0xFF);
+    const __m256i dividend = _mm256_add_epi32(_mm256_sub_epi32(_mm256_slli_epi32(pixels, 8), pixels),
+                                              _mm256_srli_epi32(alpha, 1));
+    const __m256i quotient = _mm256_cvttps_epi32(
+        _mm256_div_ps(_mm256_cvtepi32_ps(dividend), _mm256_cvtepi32_ps(alpha)));
+    return _mm256_and_si256(quotient, _mm256_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx2"))) void unpremultiplyAVX2(uint8_t* data, std::size_t bytes) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    std::size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i packed = _mm256_packus_epi16(
+            _mm256_packs_epi32(unpremultiplyAVX2(data + i), unpremultiplyAVX2(data + i + 8)),
+            _mm256_packs_epi32(unpremultiplyAVX2(data + i + 16), unpremultiplyAVX2(data + i + 24)));
+        const __m256i result = _mm256_permutevar8x32_epi32(packed, order);
+        // Alpha stays, and so do pixels without any
+        const __m256i keep = _mm256_or_si256(alphaMask,
+                                             _mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+                            _mm256_or_si256(_mm256_andnot_si256(keep, result), _mm256_and_si256(keep, pixels)));
+    }
+    unpremultiplyScalar(data + i, bytes - i);
+}
+
+#endif
+
+#ifdef MLN_PIXEL_KERNELS_NEON
+
+inline uint8x8_t premultiplyNEON(uint8x8_t color, uint8x8_t alpha) {
+    const uint16x8_t t = vaddq_u16(vmull_u8(color, alpha), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+inline uint8x16_t premultiplyNEON(uint8x16_t color, uint8x16_t alpha) {
+    return vcombine_u8(premultiplyNEON(vget_low_u8(color), vget_low_u8(alpha)),
+                       premultiplyNEON(vget_high_u8(color), vget_high_u8(alpha)));
+}
+
+void premultiplyNEON(uint8_t* data, std::size_t bytes) {
+    std::size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        uint8x16x4_t pixels = vld4q_u8(data + i);
+        pixels.val[0] = premultiplyNEON(pixels.val[0], pixels.val[3]);
+        pixels.val[1] = premultiplyNEON(pixels.val[1], pixels.val[3]);
+        pixels.val[2] = premultiplyNEON(pixels.val[2], pixels.val[3]);
+        vst4q_u8(data + i, pixels);
+    }
+    premultiplyScalar(data + i, bytes - i);
+}
+
+inline uint16x4_t unpremultiplyNEON(uint16x4_t color, uint16x4_t alpha) {
+    const uint32x4_t dividend = vaddq_u32(vmull_n_u16(color, 255), vmovl_u16(vshr_n_u16(alpha, 1)));
+    const float32x4_t quotient = vdivq_f32(vcvtq_f32_u32(dividend), vcvtq_f32_u32(vmovl_u16(alpha)));
+    return vmovn_u32(vcvtq_u32_f32(quotient));
+}
+
+inline uint8x8_t unpremultiplyNEON(uint8x8_t color, uint8x8_t alpha) {
+    const uint16x8_t color16 = vmovl_u8(color);
+    const uint16x8_t alpha16 = vmovl_u8(alpha);
+    return vmovn_u16(vcombine_u16(unpremultiplyNEON(vget_low_u16(color16), vget_low_u16(alpha16)),
+                                  unpremultiplyNEON(vget_high_u16(color16), vget_high_u16(alpha16))));
+}
+
+inline uint8x16_t unpremultiplyNEON(uint8x16_t color, uint8x16_t alpha) {
+    // Pixels without alpha stay
+    return vbslq_u8(vceqzq_u8(alpha),
+                    color,
+                    vcombine_u8(unpremultiplyNEON(vget_low_u8(color), vget_low_u8(alpha)),
+                                unpremultiplyNEON(vget_high_u8(color), vget_high_u8(alpha))));
+}
+
+void unpremultiplyNEON(uint8_t* data, std::size_t bytes) {
+    std::size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        uint8x16x4_t pixels = vld4q_u8(data + i);
+        pixels.val[0] = unpremultiplyNEON(pixels.val[0], pixels.val[3]);
+        pixels.val[1] = unpremultiplyNEON(pixels.val[1], pixels.val[3]);
+        pixels.val[2] = unpremultiplyNEON(pixels.val[2], pixels.val[3]);
+        vst4q_u8(data + i, pixels);
+    }
+    unpremultiplyScalar(data + i, bytes - i);
+}
+
+#endif
+
+PixelKernels bestPixelKernels() noexcept {
+#if defined(MLN_PIXEL_KERNELS_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return PixelKernels::AVX2;
+    }
+#endif
+#if defined(MLN_PIXEL_KERNELS_SSE2)
+    return PixelKernels::SSE2;
+#elif defined(MLN_PIXEL_KERNELS_NEON)
+    return PixelKernels::NEON;
+#else
+    return PixelKernels::Scalar;
+#endif
+}
+
+std::atomic<PixelKernels>& currentPixelKernels() {
+    static std::atomic<PixelKernels> kernels{bestPixelKernels()};
+    return kernels;
+}
+
+} // namespace
+
+bool isSupported(PixelKernels kernels) noexcept {
+    switch (kernels) {
+        case PixelKernels::Scalar:
+            return true;
+        case PixelKernels::SSE2:
+#ifdef MLN_PIXEL_KERNELS_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case PixelKernels::AVX2:
+            return bestPixelKernels() == PixelKernels::AVX2;
+        case PixelKernels::NEON:
+#ifdef MLN_PIXEL_KERNELS_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+PixelKernels getPixelKernels() noexcept {
+    return currentPixelKernels();
+}
+
+void setPixelKernels(PixelKernels kernels) {
+    if (!isSupported(kernels)) {
+        throw std::invalid_argument("pixel kernels not supported by this CPU or build");
+    }
+    currentPixelKernels() = kernels;
+}
+
+PremultipliedImage premultiply(UnassociatedImage&& src) {
+    PremultipliedImage dst;
+
+    dst.size = src.size;
+    src.size = {0, 0};
+    dst.data = std::move(src.data);
+
+    uint8_t* data = dst.data.get();
+    switch (getPixelKernels()) {
+#ifdef MLN_PIXEL_KERNELS_SSE2
+        case PixelKernels::SSE2:
+            premultiplySSE2(data, dst.bytes());
+            break;
+#endif
+#ifdef MLN_PIXEL_KERNELS_AVX2
+        case PixelKernels::AVX2:
+            premultiplyAVX2(data, dst.bytes());
+            break;
+#endif
+#ifdef MLN_PIXEL_KERNELS_NEON
+        case PixelKernels::NEON:
+            premultiplyNEON(data, dst.bytes());
+            break;
+#endif
+        default:
+            premultiplyScalar(data, dst.bytes());
+            break;
+    }
 
     return dst;
 }
@@ -34,16 +321,25 @@ UnassociatedImage unpremultiply(PremultipliedImage&& src) {
     dst.data = std::move(src.data);
 
     uint8_t* data = dst.data.get();
-    for (size_t i = 0; i < dst.bytes(); i += 4) {
-        uint8_t& r = data[i + 0];
-        uint8_t& g = data[i + 1];
-        uint8_t& b = data[i + 2];
-        uint8_t& a = data[i + 3];
-        if (a) {
-            r = static_cast<uint8_t>((255 * r + (a / 2)) / a);
-            g = static_cast<uint8_t>((255 * g + (a / 2)) / a);
-            b = static_cast<uint8_t>((255 * b + (a / 2)) / a);
-        }
+    switch (getPixelKernels()) {
+#ifdef MLN_PIXEL_KERNELS_SSE2
+        case PixelKernels::SSE2:
+            unpremultiplySSE2(data, dst.bytes());
+            break;
+#endif
+#ifdef MLN_PIXEL_KERNELS_AVX2
+        case PixelKernels::AVX2:
+            unpremultiplyAVX2(data, dst.bytes());
+            break;
+#endif
+#ifdef MLN_PIXEL_KERNELS_NEON
+        case PixelKernels::NEON:
+            unpremultiplyNEON(data, dst.bytes());
+            break;
+#endif
+        default:
+            unpremultiplyScalar(data, dst.bytes());
+            break;
     }
 
     return dst;
@@ -9,8 +9,105 @@
 
 namespace mbgl {
 
+namespace {
+
+// Index of the current worker within its owning scheduler
+thread_local std::size_t workerIndex = 0;
+
+constexpr std::size_t kWorkQueueCapacity = 1024;
+
+// Used when the platform can't tell us how many hardware threads there are
+constexpr std::size_t kFallbackThreadCount = 4;
+
+} // namespace
+
+/// Bounded multi-producer/multi-consumer ring buffer of ready tokens.
+/// Any thread may push, the owning worker pops and idle siblings steal,
+/// all without taking a lock.
+class ThreadedSchedulerBase::WorkQueue {
+public:
+    explicit WorkQueue(std::size_t capacity)
+        : cells(std::make_unique<Cell[]>(capacity)),
+          mask(capacity - 1) {
+        assert(capacity >= 2 && (capacity & mask) == 0);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(std::shared_ptr<Queue>& value) {
+        Cell* cell;
+        auto pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(std::shared_ptr<Queue>& value) {
+        Cell* cell;
+        auto pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        std::shared_ptr<Queue> value;
+    };
+
+    const std::unique_ptr<Cell[]> cells;
+    const std::size_t mask;
+
+    // Keep producers and consumers off each other's cache lines
+    alignas(64) std::atomic<std::size_t> enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos{0};
+};
+
+ThreadedSchedulerBase::ThreadedSchedulerBase(bool workStealing_)
+    : workStealing(workStealing_) {}
+
 ThreadedSchedulerBase::~ThreadedSchedulerBase() = default;
 
+void ThreadedSchedulerBase::makeWorkQueues(std::size_t count) {
+    for (auto& queues : workQueues) {
+        assert(workStealing && queues.empty());
+        queues.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            queues.push_back(std::make_unique<WorkQueue>(kWorkQueueCapacity));
+        }
+    }
+}
+
 void ThreadedSchedulerBase::terminate() {
     {
         std::scoped_lock lock(workerMutex);
@@ -33,76 +130,180 @@ std::thread ThreadedSchedulerBase::makeSchedulerThread(size_t index) {
         platform::attachThread();
 
         owningThreadPool.set(this);
+        workerIndex = index;
 
-        while (true) {
-            std::unique_lock<std::mutex> conditionLock(workerMutex);
-            if (!terminated && taskCount == 0) {
-                cvAvailable.wait(conditionLock);
+        if (workStealing) {
+            runWorkStealing(index);
+        } else {
+            runClassic();
+        }
+
+        platform::detachThread();
+    });
+}
+
+void ThreadedSchedulerBase::runClassic() {
+    while (true) {
+        std::unique_lock<std::mutex> conditionLock(workerMutex);
+        if (!terminated && taskCount == 0) {
+            cvAvailable.wait(conditionLock);
+        }
+
+        if (terminated) {
+            break;
+        }
+
+        // Let other threads run
+        conditionLock.unlock();
+
+        std::vector<std::shared_ptr<Queue>> pending;
+        {
+            // 1. Gather buckets for us to visit this iteration
+            std::scoped_lock lock(taggedQueueLock);
+            for (const auto& [tag, queue] : taggedQueue) {
+                pending.push_back(queue);
             }
+        }
 
-            if (terminated) {
-                platform::detachThread();
+        // 2. Visit a task of the highest pending priority from each, starting over
+        // as soon as a more urgent task comes in
+        const auto priority = highestPendingPriority();
+        for (auto& q : pending) {
+            if (highestPendingPriority() > priority) {
                 break;
             }
 
-            // Let other threads run
-            conditionLock.unlock();
+            std::function<void()> tasklet;
+            {
+                std::scoped_lock lock(q->lock);
+                tasklet = q->pop(priority);
+                if (!tasklet) continue;
+                q->runningCount++;
+            }
+
+            assert(taskCount > 0);
+            taskCount--;
+            pendingByPriority[static_cast<std::size_t>(priority)]--;
 
-            std::vector<std::shared_ptr<Queue>> pending;
+            runTasklet(*q, std::move(tasklet));
+        }
+    }
+}
+
+void ThreadedSchedulerBase::runWorkStealing(std::size_t index) {
+    while (!terminated) {
+        TaskPriority priority;
+        std::shared_ptr<Queue> q;
+        if (popWork(index, priority, q)) {
+            assert(taskCount > 0);
+            taskCount--;
+            pendingByPriority[static_cast<std::size_t>(priority)]--;
+
+            // Every token is pushed after its task, so the queue has a task of its priority here
+            std::function<void()> tasklet;
             {
-                // 1. Gather buckets for us to visit this iteration
-                std::scoped_lock lock(taggedQueueLock);
-                for (const auto& [tag, queue] : taggedQueue) {
-                    pending.push_back(queue);
-                }
+                std::scoped_lock lock(q->lock);
+                tasklet = q->pop(priority);
+                assert(tasklet);
+                q->runningCount++;
             }
 
-            // 2. Visit a task from each
-            for (auto& q : pending) {
-                std::function<void()> tasklet;
-                {
-                    std::scoped_lock lock(q->lock);
-                    if (q->queue.size()) {
-                        q->runningCount++;
-                        tasklet = std::move(q->queue.front());
-                        q->queue.pop();
-                    }
-                    if (!tasklet) continue;
-                }
+            runTasklet(*q, std::move(tasklet));
+            continue;
+        }
 
-                assert(taskCount > 0);
-                taskCount--;
-
-                try {
-                    tasklet();
-                    tasklet = {}; // destroy the function and release its captures before unblocking `waitForEmpty`
-
-                    if (!--q->runningCount) {
-                        std::scoped_lock lock(q->lock);
-                        if (q->queue.empty()) {
-                            q->cv.notify_all();
-                        }
-                    }
-                } catch (...) {
-                    std::scoped_lock lock(q->lock);
-                    if (handler) {
-                        handler(std::current_exception());
-                    }
-
-                    tasklet = {};
-
-                    if (!--q->runningCount && q->queue.empty()) {
-                        q->cv.notify_all();
-                    }
-
-                    if (handler) {
-                        continue;
-                    }
-                    throw;
-                }
+        // Nothing to run or steal, go to sleep. `idleCount` is raised before
+        // checking `taskCount`, and `schedule` raises `taskCount` before
+        // checking `idleCount`, so one of the two always sees the other.
+        std::unique_lock<std::mutex> conditionLock(workerMutex);
+        idleCount++;
+        if (!terminated && taskCount == 0) {
+            cvAvailable.wait(conditionLock);
+        }
+        idleCount--;
+    }
+}
+
+TaskPriority ThreadedSchedulerBase::highestPendingPriority() const {
+    for (std::size_t i = kPriorityCount; i-- > 1;) {
+        if (pendingByPriority[i]) {
+            return static_cast<TaskPriority>(i);
+        }
+    }
+    return TaskPriority::Low;
+}
+
+void ThreadedSchedulerBase::runTasklet(Queue& q, std::function<void()>&& tasklet) {
+    try {
+        tasklet();
+        tasklet = {}; // destroy the function and release its captures before unblocking `waitForEmpty`
+
+        if (!--q.runningCount) {
+            std::scoped_lock lock(q.lock);
+            if (q.empty()) {
+                q.cv.notify_all();
             }
         }
-    });
+    } catch (...) {
+        std::scoped_lock lock(q.lock);
+        if (handler) {
+            handler(std::current_exception());
+        }
+
+        tasklet = {};
+
+        if (!--q.runningCount && q.empty()) {
+            q.cv.notify_all();
+        }
+
+        if (handler) {
+            return;
+        }
+        throw;
+    }
+}
+
+void ThreadedSchedulerBase::pushWork(TaskPriority priority, std::shared_ptr<Queue>&& q) {
+    const auto level = static_cast<std::size_t>(priority);
+    auto& queues = workQueues[level];
+
+    // Keep work spawned by a worker local to it, spread everything else
+    const auto count = queues.size();
+    const auto index = thisThreadIsOwned() ? workerIndex : nextWorkQueue++ % count;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (queues[(index + i) % count]->push(q)) {
+            return;
+        }
+    }
+
+    std::scoped_lock lock(overflowLock);
+    overflow[level].push_back(std::move(q));
+    overflowCount[level]++;
+}
+
+bool ThreadedSchedulerBase::popWork(std::size_t index, TaskPriority& priority, std::shared_ptr<Queue>& q) {
+    for (std::size_t level = kPriorityCount; level-- > 0;) {
+        priority = static_cast<TaskPriority>(level);
+        auto& queues = workQueues[level];
+
+        const auto count = queues.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (queues[(index + i) % count]->pop(q)) {
+                return true;
+            }
+        }
+
+        if (overflowCount[level]) {
+            std::scoped_lock lock(overflowLock);
+            if (!overflow[level].empty()) {
+                q = std::move(overflow[level].front());
+                overflow[level].pop_front();
+                overflowCount[level]--;
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
 void ThreadedSchedulerBase::schedule(std::function<void()>&& fn) {
@@ -110,10 +311,19 @@ void ThreadedSchedulerBase::schedule(std::function<void()>&& fn) {
 }
 
 void ThreadedSchedulerBase::schedule(const util::SimpleIdentity tag, std::function<void()>&& fn) {
+    schedule(tag, TaskPriority::Normal, std::move(fn));
+}
+
+void ThreadedSchedulerBase::schedule(const util::SimpleIdentity tag_,
+                                     const TaskPriority priority,
+                                     std::function<void()>&& fn) {
     MLN_TRACE_FUNC();
     assert(fn);
     if (!fn) return;
 
+    // Untagged tasks belong to the scheduler, same as in `waitForEmpty`
+    const auto tag = tag_.isEmpty() ? uniqueID : tag_;
+
     std::shared_ptr<Queue> q;
     {
         MLN_TRACE_ZONE(queue);
@@ -133,10 +343,22 @@ void ThreadedSchedulerBase::schedule(const util::SimpleIdentity tag, std::functi
     {
         MLN_TRACE_ZONE(push);
         std::scoped_lock lock(q->lock);
-        q->queue.push(std::move(fn));
+        q->push(priority, std::move(fn));
+        pendingByPriority[static_cast<std::size_t>(priority)]++;
         taskCount++;
     }
 
+    if (workStealing) {
+        pushWork(priority, std::move(q));
+
+        // Only pay for the worker lock when someone is actually asleep
+        if (idleCount) {
+            std::scoped_lock workerLock(workerMutex);
+            cvAvailable.notify_one();
+        }
+        return;
+    }
+
     // Take the worker lock before notifying to prevent threads from waiting while we try to wake them
     std::scoped_lock workerLock(workerMutex);
     cvAvailable.notify_one();
@@ -159,7 +381,7 @@ void ThreadedSchedulerBase::waitForEmpty(const util::SimpleIdentity tag) {
         }
 
         std::unique_lock<std::mutex> queueLock(q->lock);
-        while (q->queue.size() + q->runningCount) {
+        while (!q->empty() || q->runningCount) {
             q->cv.wait(queueLock);
         }
 
@@ -171,4 +393,28 @@ void ThreadedSchedulerBase::waitForEmpty(const util::SimpleIdentity tag) {
     }
 }
 
+std::size_t ThreadPool::defaultThreadCount() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_THREAD_POOL_SIZE);
+    if (auto* count = value.getUint(); count && *count > 0) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto* count = value.getInt(); count && *count > 0) {
+        return static_cast<std::size_t>(*count);
+    }
+    if (auto* count = value.getDouble(); count && *count >= 1.0) {
+        return static_cast<std::size_t>(*count);
+    }
+
+    const auto hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : kFallbackThreadCount;
+}
+
+bool ThreadPool::defaultWorkStealing() {
+    auto value = platform::Settings::getInstance().get(platform::EXPERIMENTAL_THREAD_POOL_WORK_STEALING);
+    if (auto* workStealing = value.getBool()) {
+        return *workStealing;
+    }
+    return true;
+}
+
 } // namespace mbgl
@@ -7,7 +7,12 @@
 #include <mbgl/util/identity.hpp>
 #include <mbgl/util/instrumentation.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -26,15 +31,29 @@ public:
     /// @param tag Identifier object to indicate ownership of `fn`
     /// @param fn Task to run
     void schedule(const util::SimpleIdentity tag, std::function<void()>&& fn) override;
+
+    /// @brief Schedule a task assigned to the given owner `tag` with a priority.
+    /// Higher priority tasks are started before lower priority ones, whichever
+    /// tag they belong to. Tags take turns among tasks of the same priority.
+    /// @param tag Identifier object to indicate ownership of `fn`
+    /// @param priority Urgency of the task
+    /// @param fn Task to run
+    void schedule(const util::SimpleIdentity tag, TaskPriority priority, std::function<void()>&& fn) override;
     const util::SimpleIdentity uniqueID;
 
 protected:
-    ThreadedSchedulerBase() = default;
+    /// @param workStealing Distribute work through per-worker run queues
+    /// instead of having every worker scan all tagged queues.
+    ThreadedSchedulerBase(bool workStealing_ = false);
     ~ThreadedSchedulerBase() override;
 
     void terminate();
     std::thread makeSchedulerThread(size_t index);
 
+    /// @brief Create the per-worker run queues used in work-stealing mode.
+    /// Must be called before any scheduler thread is started.
+    void makeWorkQueues(std::size_t count);
+
     /// @brief Wait until there's nothing pending or in process
     /// Must not be called from a task provided to this scheduler.
     /// @param tag Tag of the owner to identify the collection of tasks to
@@ -50,16 +69,76 @@ protected:
     std::mutex taggedQueueLock;
     util::ThreadLocal<ThreadedSchedulerBase> owningThreadPool;
     std::atomic<size_t> taskCount{0};
-    bool terminated{false};
+    std::atomic<bool> terminated{false};
+
+    static constexpr std::size_t kPriorityCount = static_cast<std::size_t>(TaskPriority::High) + 1;
 
     // Task queues bucketed by tag address
     struct Queue {
-        std::atomic<std::size_t> runningCount;   /* running tasks */
-        std::condition_variable cv;              /* queue empty condition */
-        std::mutex lock;                         /* lock */
-        std::queue<std::function<void()>> queue; /* pending task queue */
+        std::atomic<std::size_t> runningCount; /* running tasks */
+        std::condition_variable cv;            /* queue empty condition */
+        std::mutex lock;                       /* lock */
+        std::array<std::queue<std::function<void()>>, kPriorityCount> queues; /* pending tasks by priority */
+        std::size_t pendingCount{0};                                          /* pending tasks in all queues */
+
+        bool empty() const { return pendingCount == 0; }
+
+        void push(TaskPriority priority, std::function<void()>&& fn) {
+            queues[static_cast<std::size_t>(priority)].push(std::move(fn));
+            pendingCount++;
+        }
+
+        /// Take the oldest task of the given priority, if there is one
+        std::function<void()> pop(TaskPriority priority) {
+            auto& queue = queues[static_cast<std::size_t>(priority)];
+            if (queue.empty()) {
+                return {};
+            }
+            auto fn = std::move(queue.front());
+            queue.pop();
+            pendingCount--;
+            return fn;
+        }
     };
     mbgl::unordered_map<util::SimpleIdentity, std::shared_ptr<Queue>> taggedQueue;
+
+    // Pending tasks of all tags, by priority
+    std::array<std::atomic<std::size_t>, kPriorityCount> pendingByPriority{};
+
+private:
+    class WorkQueue;
+
+    void runClassic();
+    void runWorkStealing(std::size_t index);
+
+    /// The highest priority with pending tasks in any tag, or the lowest if none
+    TaskPriority highestPendingPriority() const;
+
+    /// Run a task previously taken from `q`, maintaining its running count
+    /// and dispatching exceptions to the handler.
+    void runTasklet(Queue& q, std::function<void()>&& tasklet);
+
+    /// Hand a ready token for a task of `priority` in `q` to one of the workers
+    void pushWork(TaskPriority priority, std::shared_ptr<Queue>&& q);
+    /// Take a token of the highest priority there is from our own run queue,
+    /// steal one from another worker, or fall back to the overflow queue.
+    bool popWork(std::size_t index, TaskPriority& priority, std::shared_ptr<Queue>& q);
+
+    const bool workStealing;
+
+    // Work-stealing mode: each entry is a token meaning "one task of this
+    // priority is ready in this tagged queue", with run queues for each
+    // priority. Tasks themselves stay in their tagged queue, so tasks sharing
+    // a tag and priority are always started in FIFO order no matter which
+    // worker picks up the token.
+    std::array<std::vector<std::unique_ptr<WorkQueue>>, kPriorityCount> workQueues;
+    std::atomic<std::size_t> nextWorkQueue{0};
+    std::atomic<std::size_t> idleCount{0};
+
+    // Tokens that did not fit in a full run queue, by priority
+    std::mutex overflowLock;
+    std::array<std::deque<std::shared_ptr<Queue>>, kPriorityCount> overflow;
+    std::array<std::atomic<std::size_t>, kPriorityCount> overflowCount{};
 };
 
 /**
@@ -72,8 +151,12 @@ protected:
  */
 class ThreadedScheduler : public ThreadedSchedulerBase {
 public:
-    ThreadedScheduler(std::size_t n)
-        : threads(n) {
+    ThreadedScheduler(std::size_t n, bool workStealing_ = false)
+        : ThreadedSchedulerBase(workStealing_),
+          threads(n) {
+        if (workStealing_) {
+            makeWorkQueues(n);
+        }
         for (std::size_t i = 0u; i < threads.size(); ++i) {
             threads[i] = makeSchedulerThread(i);
         }
@@ -143,6 +226,8 @@ public:
 
     mapbox::base::WeakPtr<Scheduler> makeWeakPtr() override { return weakFactory.makeWeakPtr(); }
 
+    std::size_t getThreadCount() const override { return threads.size(); }
+
 protected:
     // Allows derived classes to invalidate weak pointers in
     // their destructor before their own members are torn down.
@@ -176,11 +261,38 @@ public:
     ~ParallelScheduler() override { invalidateWeakPtrsEarly(); }
 };
 
-class ThreadPool final : public ParallelScheduler {
+/**
+ * @brief Parallel scheduler using per-worker run queues with work stealing.
+ *
+ * Workers pull ready tokens from their own lock-free run queue and steal from
+ * their siblings when it runs dry, instead of all contending on a global lock
+ * and rescanning every tagged queue. Per-tag FIFO ordering and
+ * `waitForEmpty(tag)` behave exactly as with `ParallelScheduler`.
+ */
+class WorkStealingScheduler final : public ThreadedScheduler {
 public:
-    ThreadPool()
-        : ParallelScheduler(3) {}
+    WorkStealingScheduler(std::size_t extra)
+        : ThreadedScheduler(1 + extra, true) {}
+    ~WorkStealingScheduler() override { invalidateWeakPtrsEarly(); }
+};
+
+class ThreadPool final : public ThreadedScheduler {
+public:
+    /// @param threadCount Number of worker threads, at least one
+    /// @param workStealing Run the workers like `WorkStealingScheduler` rather than `ParallelScheduler`
+    explicit ThreadPool(std::size_t threadCount = defaultThreadCount(), bool workStealing = defaultWorkStealing())
+        : ThreadedScheduler(std::max<std::size_t>(threadCount, 1), workStealing) {}
     ~ThreadPool() override { invalidateWeakPtrsEarly(); }
+
+    /// @brief Worker count used when none is given explicitly.
+    /// Taken from the `EXPERIMENTAL_THREAD_POOL_SIZE` platform setting if
+    /// present, otherwise from the number of hardware threads.
+    static std::size_t defaultThreadCount();
+
+    /// @brief Whether pools use work stealing when not told explicitly.
+    /// True unless the `EXPERIMENTAL_THREAD_POOL_WORK_STEALING` platform
+    /// setting is false.
+    static bool defaultWorkStealing();
 };
 
 } // namespace mbgl
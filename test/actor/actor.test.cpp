@@ -5,10 +5,13 @@
 #include <mbgl/util/run_loop.hpp>
 
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <future>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace mbgl;
 using namespace std::chrono_literals;
@@ -266,6 +269,112 @@ TEST(Actor, NonConcurrentMailbox) {
     endedFuture.wait();
 }
 
+TEST(Actor, ConcurrentSenders) {
+    // Messages from each of many threads sending at once all arrive, in the order sent.
+
+    struct TestActor {
+        std::vector<int> last;
+        int received = 0;
+
+        TestActor(ActorRef<TestActor>, std::size_t senders)
+            : last(senders, 0) {}
+
+        void receive(std::size_t sender, int i, std::string payload) {
+            EXPECT_EQ(i, last[sender] + 1);
+            EXPECT_EQ(payload.size(), static_cast<std::size_t>(i % 512));
+            last[sender] = i;
+            ++received;
+        }
+
+        int count() { return received; }
+    };
+
+    constexpr std::size_t senders = 8;
+    constexpr int messages = 2000;
+    Actor<TestActor> test(Scheduler::GetBackground(), senders);
+
+    std::vector<std::thread> threads;
+    for (std::size_t sender = 0; sender < senders; ++sender) {
+        threads.emplace_back([sender, ref = test.self()] {
+            // The strings are on the heap, so each message fits a slot of the mailbox's pool. With all
+            // senders at once the slots run out, and the other messages go to the heap.
+            for (auto i = 1; i <= messages; ++i) {
+                ref.invoke(&TestActor::receive, sender, i, std::string(i % 512, 'x'));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(static_cast<int>(senders) * messages, test.self().ask(&TestActor::count).get());
+}
+
+TEST(Actor, MessagePoolSlots) {
+    // Messages take slots of one block once a burst of them waits at once, and go to the heap
+    // before that and when every slot is taken.
+    MessagePool pool;
+    const auto inSlots = [&](void* slot, void* storage) {
+        const auto* begin = static_cast<std::byte*>(slot);
+        return storage >= begin && storage < begin + MessagePool::slotCount * MessagePool::slotSize;
+    };
+
+    std::vector<void*> heap;
+    for (std::size_t i = 1; i < MessagePool::burstSize; ++i) {
+        heap.push_back(pool.allocate(MessagePool::slotSize));
+    }
+    std::vector<void*> slots;
+    for (std::size_t i = 0; i < MessagePool::slotCount; ++i) {
+        slots.push_back(pool.allocate(MessagePool::slotSize));
+        EXPECT_EQ(static_cast<std::byte*>(slots[0]) + i * MessagePool::slotSize, slots.back());
+    }
+    for (auto* storage : heap) {
+        EXPECT_FALSE(inSlots(slots[0], storage));
+    }
+    heap.push_back(pool.allocate(MessagePool::slotSize));
+    EXPECT_FALSE(inSlots(slots[0], heap.back()));
+    for (auto* storage : heap) {
+        std::memset(storage, 0xFF, MessagePool::slotSize);
+    }
+    for (auto* storage : slots) {
+        std::memset(storage, 0xFF, MessagePool::slotSize);
+    }
+
+    // Heap storage goes back to the heap, and freed slots are taken again
+    for (auto* storage : heap) {
+        pool.deallocate(storage);
+    }
+    pool.deallocate(slots[5]);
+    EXPECT_EQ(slots[5], pool.allocate(MessagePool::slotSize));
+    for (auto* storage : slots) {
+        pool.deallocate(storage);
+    }
+}
+
+TEST(Actor, MessagePoolOversized) {
+    // Messages that don't fit a slot go to the heap, even with free slots
+    MessagePool pool;
+    std::vector<void*> slots;
+    for (std::size_t i = 0; i < MessagePool::burstSize; ++i) {
+        slots.push_back(pool.allocate(MessagePool::slotSize));
+    }
+    void* const slot = slots.back();
+
+    void* large = pool.allocate(MessagePool::slotSize + 1);
+    const auto* begin = static_cast<std::byte*>(slot);
+    EXPECT_FALSE(large >= begin && large < begin + MessagePool::slotCount * MessagePool::slotSize);
+    std::memset(large, 0xFF, MessagePool::slotSize + 1);
+    pool.deallocate(large);
+
+    pool.deallocate(slot);
+    slots.pop_back();
+    EXPECT_EQ(slot, pool.allocate(MessagePool::slotSize / 2));
+    slots.push_back(slot);
+    for (auto* storage : slots) {
+        pool.deallocate(storage);
+    }
+}
+
 TEST(Actor, Ask) {
     // Asking for a result
 
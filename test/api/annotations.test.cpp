@@ -14,6 +14,7 @@
 #include <mbgl/gfx/headless_frontend.hpp>
 
 #include <algorithm>
+#include <set>
 
 using namespace mbgl;
 
@@ -290,6 +291,64 @@ TEST(Annotations, UpdateFillAnnotationStyle) {
     test.checkRendering("update_fill_style");
 }
 
+TEST(Annotations, UpdateAnnotationsAcrossTiles) {
+    AnnotationTest test;
+
+    test.map.getStyle().loadJSON(util::read_file("test/fixtures/api/empty.json"));
+    test.map.addAnnotationImage(namedMarker("default_marker"));
+    test.map.jumpTo(CameraOptions().withCenter(LatLng{0, 0}).withZoom(3));
+
+    // Each quadrant of the view is a different tile.
+    const LatLng northEast{5, 5};
+    const LatLng southEast{-5, 5};
+    const LatLng southWest{-5, -5};
+    const LatLng northWest{5, -5};
+    auto square = [](const LatLng& center) {
+        const double lat = center.latitude();
+        const double lng = center.longitude();
+        return Polygon<double>{{{lng - 2, lat - 2}, {lng + 2, lat - 2}, {lng + 2, lat + 2}, {lng - 2, lat + 2}}};
+    };
+
+    AnnotationID point = test.map.addAnnotation(SymbolAnnotation{Point<double>{5, 5}, "default_marker"});
+    AnnotationID fixedPoint = test.map.addAnnotation(SymbolAnnotation{Point<double>{-5, -5}, "default_marker"});
+    FillAnnotation fill{square(northWest)};
+    fill.color = Color::blue();
+    AnnotationID shape = test.map.addAnnotation(fill);
+
+    auto featuresAt = [&](const LatLng& latLng) {
+        std::set<uint64_t> ids;
+        for (const auto& feature :
+             test.frontend.getRenderer()->queryRenderedFeatures(test.map.pixelForLatLng(latLng))) {
+            ids.insert(feature.id.get<uint64_t>());
+        }
+        return ids;
+    };
+
+    test.frontend.render(test.map);
+    EXPECT_EQ(std::set<uint64_t>{point}, featuresAt(northEast));
+    EXPECT_EQ(std::set<uint64_t>{fixedPoint}, featuresAt(southWest));
+    EXPECT_EQ(std::set<uint64_t>{shape}, featuresAt(northWest));
+    EXPECT_TRUE(featuresAt(southEast).empty());
+
+    test.map.updateAnnotation(point, SymbolAnnotation{Point<double>{5, -5}, "default_marker"});
+    test.frontend.render(test.map);
+    EXPECT_TRUE(featuresAt(northEast).empty());
+    EXPECT_EQ(std::set<uint64_t>{point}, featuresAt(southEast));
+    EXPECT_EQ(std::set<uint64_t>{fixedPoint}, featuresAt(southWest));
+
+    fill.geometry = square(northEast);
+    test.map.updateAnnotation(shape, fill);
+    test.frontend.render(test.map);
+    EXPECT_TRUE(featuresAt(northWest).empty());
+    EXPECT_EQ(std::set<uint64_t>{shape}, featuresAt(northEast));
+
+    test.map.removeAnnotation(point);
+    test.frontend.render(test.map);
+    EXPECT_TRUE(featuresAt(southEast).empty());
+    EXPECT_EQ(std::set<uint64_t>{fixedPoint}, featuresAt(southWest));
+    EXPECT_EQ(std::set<uint64_t>{shape}, featuresAt(northEast));
+}
+
 TEST(Annotations, RemovePoint) {
     AnnotationTest test;
 
@@ -12,6 +12,8 @@
 #include <mbgl/gfx/shader_registry.hpp>
 #include <mbgl/map/map_options.hpp>
 #include <mbgl/math/log2.hpp>
+#include <mbgl/platform/settings.hpp>
+#include <mbgl/renderer/query.hpp>
 #include <mbgl/renderer/renderer.hpp>
 #include <mbgl/renderer/update_parameters.hpp>
 #include <mbgl/storage/file_source_manager.hpp>
@@ -43,7 +45,12 @@
 #include <mbgl/util/logging.hpp>
 #include <mbgl/util/run_loop.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <set>
 
 using namespace mbgl;
 using namespace mbgl::style;
@@ -172,6 +179,77 @@ TEST(Map, RendererState) {
     EXPECT_TRUE(test.frontend.hasLayer("SymbolLayer"));
 }
 
+TEST(Map, RenderBatch) {
+    MapTest<> test;
+    test.map.getStyle().loadJSON(R"STYLE({
+      "version": 8,
+      "layers": [{"id": "background", "type": "background", "paint": {"background-color": "red"}}]
+    })STYLE");
+
+    std::vector<CameraOptions> cameras;
+    for (int i = 0; i < 10; ++i) {
+        cameras.push_back(CameraOptions().withCenter(LatLng{0.0, i * 10.0}).withZoom(i % 3));
+    }
+
+    // Frames come out in camera order however the encoding tasks finish
+    std::vector<std::size_t> indices;
+    auto stats = test.frontend.renderBatch(
+        test.map,
+        cameras,
+        [](const PremultipliedImage& image) { return encodePNG(image); },
+        [&](std::size_t index, std::string encoded) {
+            indices.push_back(index);
+            const auto image = decodeImage(encoded);
+            ASSERT_EQ(test.frontend.getSize(), image.size);
+            EXPECT_EQ(255, image.data[0]);
+            EXPECT_EQ(0, image.data[1]);
+        },
+        3);
+    EXPECT_EQ(cameras.size(), stats.frames);
+    EXPECT_GT(stats.framesPerSecond(), 0.0);
+    std::vector<std::size_t> expected(cameras.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(expected, indices);
+
+    // Encoding errors surface on the calling thread
+    EXPECT_THROW(test.frontend.renderBatch(
+                     test.map,
+                     cameras,
+                     [](const PremultipliedImage&) -> std::string { throw std::runtime_error("encode"); },
+                     [](std::size_t, std::string) {}),
+                 std::runtime_error);
+}
+
+TEST(Map, RenderMetatile) {
+    MapTest<> test;
+    test.map.getStyle().loadJSON(R"STYLE({
+      "version": 8,
+      "sources": {
+        "north-east": {
+          "type": "geojson",
+          "data": {"type": "Polygon", "coordinates": [[[0, 0], [180, 0], [180, 85], [0, 85], [0, 0]]]}
+        }
+      },
+      "layers": [
+        {"id": "background", "type": "background", "paint": {"background-color": "white"}},
+        {"id": "fill", "type": "fill", "source": "north-east", "paint": {"fill-color": "red"}}
+      ]
+    })STYLE");
+
+    // The block is cut at the edges of the world, which has 2 by 2 tiles at zoom 1
+    auto tiles = test.frontend.renderMetatile(test.map, {1, 0, 0}, 4, 256, 32);
+    ASSERT_EQ(4u, tiles.size());
+    const std::vector<CanonicalTileID> ids{{1, 0, 0}, {1, 1, 0}, {1, 0, 1}, {1, 1, 1}};
+    for (std::size_t i = 0; i < tiles.size(); ++i) {
+        EXPECT_EQ(ids[i], tiles[i].id);
+        ASSERT_EQ((Size{256, 256}), tiles[i].image.size);
+        // The centre pixel is red only in the north-eastern tile
+        const auto* pixel = tiles[i].image.data.get() + (128 * 256 + 128) * 4;
+        EXPECT_EQ(255, pixel[0]);
+        EXPECT_EQ(ids[i] == CanonicalTileID(1, 1, 0) ? 0 : 255, pixel[1]);
+    }
+}
+
 TEST(Map, LatLngBehavior) {
     MapTest<> test;
 
@@ -1559,6 +1637,92 @@ TEST(Map, DISABLED_PlacedSymbolData) {
     EXPECT_TRUE(test.frontend.getRenderer()->getPlacedSymbolsData().empty());
 }
 
+namespace {
+
+// A grid of labels over the whole world, overlapping enough that placement rejects many of them
+std::string denseSymbolStyle() {
+    std::string features;
+    for (int x = 0; x < 48; ++x) {
+        for (int y = 0; y < 48; ++y) {
+            if (!features.empty()) features += ",";
+            features += R"({"type":"Feature","properties":{"name":")" + std::to_string(x * 48 + y) +
+                        R"("},"geometry":{"type":"Point","coordinates":[)" + std::to_string(-170.0 + x * 7.2) + "," +
+                        std::to_string(-80.0 + y * 3.4) + "]}}";
+        }
+    }
+    return R"({
+      "version": 8,
+      "glyphs": "local://glyphs/{fontstack}/{range}.pbf",
+      "sources": {
+        "points": {"type": "geojson", "data": {"type": "FeatureCollection", "features": [)" +
+           features + R"(]}}
+      },
+      "layers": [{
+        "id": "labels",
+        "type": "symbol",
+        "source": "points",
+        "layout": {"text-field": "{name}", "text-size": 14, "text-padding": 4}
+      }, {
+        "id": "offset-labels",
+        "type": "symbol",
+        "source": "points",
+        "layout": {"text-field": "{name}", "text-size": 10, "text-anchor": "top", "text-offset": [0, 1]}
+      }]
+    })";
+}
+
+struct DenseSymbolPlacement {
+    PremultipliedImage image;
+    std::map<std::string, std::vector<std::string>> placedLabels;
+};
+
+// Renders with the collision boxes drawn, so the image shows both which labels are visible and the boxes they took
+DenseSymbolPlacement placeDenseSymbols(uint64_t projectionThreshold) {
+    platform::Settings::getInstance().set(platform::EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD, projectionThreshold);
+
+    MapTest<> test;
+    test.fileSource->glyphsResponse = makeResponse("glyphs.pbf");
+    test.map.getStyle().loadJSON(denseSymbolStyle());
+    test.map.setDebug(MapDebugOptions::Collision);
+
+    DenseSymbolPlacement result;
+    result.image = test.frontend.render(test.map).image;
+    const auto size = test.frontend.getSize();
+    for (const char* layer : {"labels", "offset-labels"}) {
+        RenderedQueryOptions options;
+        options.layerIDs = std::vector<std::string>{layer};
+        auto& labels = result.placedLabels[layer];
+        for (const auto& feature : test.frontend.getRenderer()->queryRenderedFeatures(
+                 ScreenBox{{0, 0}, {static_cast<double>(size.width), static_cast<double>(size.height)}}, options)) {
+            labels.push_back(feature.properties.at("name").get<std::string>());
+        }
+        std::ranges::sort(labels);
+    }
+
+    platform::Settings::getInstance().set(platform::EXPERIMENTAL_PLACEMENT_PROJECTION_THRESHOLD,
+                                          mapbox::base::NullValue());
+    return result;
+}
+
+} // namespace
+
+// Collision boxes projected on the thread pool ahead of placement give exactly the result of projecting them inline
+TEST(Map, PlacementProjectionMatchesSerial) {
+    const auto serial = placeDenseSymbols(std::numeric_limits<uint64_t>::max());
+    const auto parallel = placeDenseSymbols(0);
+
+    EXPECT_EQ(serial.placedLabels, parallel.placedLabels);
+    // Some labels collide, and some don't
+    for (const auto& [layer, labels] : serial.placedLabels) {
+        EXPECT_LT(0u, labels.size()) << layer;
+        EXPECT_GT(48u * 48u, labels.size()) << layer;
+    }
+
+    ASSERT_EQ(serial.image.size, parallel.image.size);
+    EXPECT_TRUE(std::equal(
+        serial.image.data.get(), serial.image.data.get() + serial.image.bytes(), parallel.image.data.get()));
+}
+
 TEST(Map, VolatileSource) {
     MapTest<> test{1, MapMode::Continuous};
 
@@ -2039,3 +2203,61 @@ TEST(Map, SetFrustumOffset) {
 
     test::checkImage("test/fixtures/map/setFrustumOffset/after", test.frontend.render(test.map).image, 0.0006, 0.1);
 }
+
+TEST(Map, IncrementalPlacement) {
+    MapTest<> test{1, MapMode::Continuous};
+    test.frontend.getRenderer()->setIncrementalPlacementEnabled(true);
+
+    // A grid of overlapping icons, so that placement has collisions to resolve.
+    std::string features;
+    for (int x = 0; x < 40; ++x) {
+        for (int y = 0; y < 40; ++y) {
+            features += (features.empty() ? "" : ",") + R"({"type": "Feature", "id": )"s +
+                        std::to_string(x * 40 + y) + R"(, "properties": {}, "geometry": {"type": "Point", )" +
+                        R"("coordinates": [)" + std::to_string(-0.06 + x * 0.003) + ", " +
+                        std::to_string(-0.06 + y * 0.003) + "]}}";
+        }
+    }
+    test.map.getStyle().loadJSON(R"({
+        "version": 8,
+        "sources": {"points": {"type": "geojson", "data": {"type": "FeatureCollection", "features": [)" +
+                                 features + R"(]}}},
+        "layers": [{"id": "points", "type": "symbol", "source": "points", "layout": {"icon-image": "marker"}}]
+    })");
+    test.map.getStyle().addImage(std::make_unique<style::Image>("marker", PremultipliedImage({20, 20}), 1.0f));
+    // Without placement transitions, every frame places the symbols again.
+    test.map.getStyle().setTransitionOptions(TransitionOptions{{}, {}, false});
+    test.map.jumpTo(CameraOptions().withCenter(LatLng{}).withZoom(12));
+
+    test.observer.didFinishRenderingFrameCallback = [&](MapObserver::RenderFrameStatus status) {
+        if (status.mode == MapObserver::RenderMode::Full) {
+            test.runLoop.stop();
+        }
+    };
+    test.runLoop.run();
+
+    const auto placedIDs = [&] {
+        std::set<uint64_t> ids;
+        for (const auto& feature : test.frontend.getRenderer()->queryRenderedFeatures(
+                 ScreenBox{{0, 0}, {256, 256}}, {{{"points"}}, {}})) {
+            ids.insert(feature.id.get<uint64_t>());
+        }
+        return ids;
+    };
+
+    test.observer.didFinishRenderingFrameCallback = [&](MapObserver::RenderFrameStatus) {
+        test.runLoop.stop();
+    };
+    for (int i = 0; i < 10; ++i) {
+        test.map.moveBy({7, 3});
+        test.runLoop.run();
+    }
+    const auto incrementalIDs = placedIDs();
+    EXPECT_FALSE(incrementalIDs.empty());
+
+    // Placing all symbols again gives the same result.
+    test.frontend.getRenderer()->setIncrementalPlacementEnabled(false);
+    test.map.triggerRepaint();
+    test.runLoop.run();
+    EXPECT_EQ(incrementalIDs, placedIDs());
+}
@@ -23,6 +23,10 @@ public:
         if (sourceError) sourceError(source, error);
     }
 
+    void onSourceLoadingProgress(Source& source, double progress) override {
+        if (sourceLoadingProgress) sourceLoadingProgress(source, progress);
+    }
+
     void onSourceDescriptionChanged(Source& source) override {
         if (sourceDescriptionChanged) sourceDescriptionChanged(source);
     }
@@ -34,6 +38,7 @@ public:
     std::function<void(Source&)> sourceLoaded;
     std::function<void(Source&)> sourceChanged;
     std::function<void(Source&, std::exception_ptr)> sourceError;
+    std::function<void(Source&, double)> sourceLoadingProgress;
     std::function<void(Source&)> sourceDescriptionChanged;
     std::function<void(std::exception_ptr)> resourceError;
 };
@@ -1,3 +1,4 @@
+#include <mbgl/platform/settings.hpp>
 #include <mbgl/storage/mbtiles_file_source.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/resource_options.hpp>
@@ -5,6 +6,8 @@
 #include <mbgl/util/run_loop.hpp>
 
 #include <filesystem>
+#include <utility>
+#include <vector>
 
 #include <climits>
 #include <gtest/gtest.h>
@@ -124,3 +127,112 @@ TEST(MBTilesFileSource, NonExistentTile) {
 
     loop.run();
 }
+
+namespace {
+
+// Every tile of the fixture, each requested several times
+std::vector<Resource> fixtureTiles() {
+    const auto url = toAbsoluteURL("geography-class-png.mbtiles?file={z}/{x}/{y}.png");
+    std::vector<Resource> resources;
+    for (int repeat = 0; repeat < 8; ++repeat) {
+        resources.push_back(Resource::tile(url, 1.0, 0, 0, 0, Tileset::Scheme::XYZ));
+        for (int x = 0; x < 2; ++x) {
+            for (int y = 0; y < 2; ++y) {
+                resources.push_back(Resource::tile(url, 1.0, x, y, 1, Tileset::Scheme::XYZ));
+            }
+        }
+    }
+    return resources;
+}
+
+// Requests all of `resources` at once and collects the responses in the order they arrive
+std::vector<std::pair<std::size_t, Response>> requestAll(MBTilesFileSource& mbtiles,
+                                                         const std::vector<Resource>& resources) {
+    util::RunLoop loop;
+    std::vector<std::pair<std::size_t, Response>> responses;
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    for (std::size_t i = 0; i < resources.size(); ++i) {
+        requests.push_back(mbtiles.request(resources[i], [&, i](Response res) {
+            responses.emplace_back(i, std::move(res));
+            if (responses.size() == resources.size()) {
+                loop.stop();
+            }
+        }));
+    }
+    loop.run();
+    return responses;
+}
+
+} // namespace
+
+// Tiles read on several threads at once are the same as tiles read one after another
+TEST(MBTilesFileSource, ConcurrentTiles) {
+    auto& settings = platform::Settings::getInstance();
+    const auto resources = fixtureTiles();
+
+    settings.set(platform::EXPERIMENTAL_MBTILES_READER_THREADS, uint64_t{1});
+    MBTilesFileSource serial(ResourceOptions::Default(), ClientOptions());
+    settings.set(platform::EXPERIMENTAL_MBTILES_READER_THREADS, uint64_t{4});
+    MBTilesFileSource concurrent(ResourceOptions::Default(), ClientOptions());
+    settings.set(platform::EXPERIMENTAL_MBTILES_READER_THREADS, mapbox::base::NullValue());
+
+    std::vector<std::shared_ptr<const std::string>> expected(resources.size());
+    for (auto& [index, response] : requestAll(serial, resources)) {
+        EXPECT_EQ(nullptr, response.error);
+        ASSERT_TRUE(response.data);
+        expected[index] = response.data;
+    }
+
+    const auto responses = requestAll(concurrent, resources);
+    ASSERT_EQ(resources.size(), responses.size());
+    for (const auto& [index, response] : responses) {
+        EXPECT_EQ(nullptr, response.error);
+        ASSERT_TRUE(response.data);
+        EXPECT_EQ(*expected[index], *response.data);
+    }
+}
+
+// A single reader answers in the order tiles were requested
+TEST(MBTilesFileSource, TileOrder) {
+    auto& settings = platform::Settings::getInstance();
+    settings.set(platform::EXPERIMENTAL_MBTILES_READER_THREADS, uint64_t{1});
+    MBTilesFileSource mbtiles(ResourceOptions::Default(), ClientOptions());
+    settings.set(platform::EXPERIMENTAL_MBTILES_READER_THREADS, mapbox::base::NullValue());
+
+    const auto resources = fixtureTiles();
+    const auto responses = requestAll(mbtiles, resources);
+    ASSERT_EQ(resources.size(), responses.size());
+    for (std::size_t i = 0; i < responses.size(); ++i) {
+        EXPECT_EQ(i, responses[i].first);
+    }
+}
+
+// Cancelled tile requests never call back, the others still do
+TEST(MBTilesFileSource, CancelTiles) {
+    util::RunLoop loop;
+
+    MBTilesFileSource mbtiles(ResourceOptions::Default(), ClientOptions());
+
+    const auto resources = fixtureTiles();
+    std::vector<std::unique_ptr<AsyncRequest>> requests;
+    std::size_t kept = 0;
+    std::size_t answered = 0;
+    for (std::size_t i = 0; i < resources.size(); ++i) {
+        const bool cancel = i % 2 == 0;
+        requests.push_back(mbtiles.request(resources[i], [&, cancel](Response res) {
+            EXPECT_FALSE(cancel);
+            EXPECT_EQ(nullptr, res.error);
+            if (++answered == kept) {
+                loop.stop();
+            }
+        }));
+        if (cancel) {
+            requests.back().reset();
+        } else {
+            ++kept;
+        }
+    }
+
+    loop.run();
+    EXPECT_EQ(kept, answered);
+}
@@ -5,6 +5,7 @@
 #include <mbgl/storage/offline_database.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
+#include <mbgl/util/compression.hpp>
 #include <mbgl/util/io.hpp>
 #include <mbgl/util/string.hpp>
 
@@ -28,6 +29,7 @@ static void deleteDatabaseFiles() {
     // Delete leftover journaling files as well.
     util::deleteFile(filename);
     util::deleteFile(filename + "-wal"s);
+    util::deleteFile(filename + "-shm"s);
     util::deleteFile(filename + "-journal"s);
 }
 
@@ -236,7 +238,7 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(SchemaVersion)) {
         OfflineDatabase db(filename, fixture::tileServerOptions);
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
 
     OfflineDatabase db(filename, fixture::tileServerOptions);
     // Now try inserting and reading back to make sure we have a valid database.
@@ -1413,6 +1415,43 @@ TEST(OfflineDatabase, BatchInsertion) {
     EXPECT_EQ(0u, log.uncheckedCount());
 }
 
+TEST(OfflineDatabase, BatchInsertionEncoded) {
+    FixtureLog log;
+    OfflineDatabase db(":memory:", fixture::tileServerOptions);
+
+    OfflineTilePyramidRegionDefinition definition{"", LatLngBounds::world(), 0, INFINITY, 1.0, true};
+    auto region = db.createRegion(definition, OfflineRegionMetadata());
+    ASSERT_TRUE(region);
+
+    Response compressible;
+    compressible.data = std::make_shared<std::string>(1024, 'a');
+    Response incompressible;
+    incompressible.data = randomString(1024);
+
+    const auto encoder = db.getEncoder();
+    std::list<OfflineDatabase::EncodedResource> resources;
+    resources.push_back({fixture::tile, compressible, encoder.encode(*compressible.data)});
+    resources.push_back({fixture::resource, incompressible, encoder.encode(*incompressible.data)});
+    EXPECT_EQ(util::Codec::Zlib, resources.front().data.second);
+    EXPECT_EQ(util::Codec::None, resources.back().data.second);
+
+    OfflineRegionStatus status;
+    db.putRegionResources(region->getID(), resources, status);
+    EXPECT_EQ(2u, status.completedResourceCount);
+    EXPECT_EQ(1u, status.completedTileCount);
+    EXPECT_EQ(resources.front().data.first.size(), status.completedTileSize);
+    EXPECT_EQ(resources.front().data.first.size() + 1024u, status.completedResourceSize);
+
+    auto tile = db.get(fixture::tile);
+    ASSERT_TRUE(tile && tile->data);
+    EXPECT_EQ(*compressible.data, *tile->data);
+    auto resource = db.get(fixture::resource);
+    ASSERT_TRUE(resource && resource->data);
+    EXPECT_EQ(*incompressible.data, *resource->data);
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
 TEST(OfflineDatabase, BatchInsertionMapboxTileCountExceeded) {
     FixtureLog log;
     OfflineDatabase db(":memory:", fixture::tileServerOptions);
@@ -1465,7 +1504,7 @@ TEST(OfflineDatabase, MigrateFromV2Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
     EXPECT_LT(databasePageCount(filename), databasePageCount("test/fixtures/offline_database/v2.db"));
 
     EXPECT_EQ(0u, log.uncheckedCount());
@@ -1487,7 +1526,7 @@ TEST(OfflineDatabase, MigrateFromV3Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
 
     EXPECT_EQ(0u, log.uncheckedCount());
 }
@@ -1509,7 +1548,7 @@ TEST(OfflineDatabase, MigrateFromV4Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
 
     // Journal mode should be DELETE after migration to v5.
     EXPECT_EQ("delete", databaseJournalMode(filename));
@@ -1536,7 +1575,7 @@ TEST(OfflineDatabase, MigrateFromV5Schema) {
         }
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
 
     EXPECT_EQ((std::vector<std::string>{"id",
                                         "url_template",
@@ -1593,7 +1632,7 @@ TEST(OfflineDatabase, DowngradeSchema) {
         db.setMaximumAmbientCacheSize(0);
     }
 
-    EXPECT_EQ(6, databaseUserVersion(filename));
+    EXPECT_EQ(7, databaseUserVersion(filename));
 
     EXPECT_EQ((std::vector<std::string>{"id",
                                         "url_template",
@@ -2070,3 +2109,213 @@ TEST(OfflineDatabase, TEST_REQUIRES_WRITE(UpdateDatabaseReadOnlyMode)) {
 
     EXPECT_EQ(0u, log.uncheckedCount());
 }
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(BatchedWrites)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    const Resource resource = Resource::tile("http://example.com/{z}-{x}-{y}", 1, 0, 0, 0, Tileset::Scheme::XYZ);
+    Response response;
+    response.data = std::make_shared<std::string>("tile");
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions, CacheDurability::Normal);
+        OfflineDatabase other(filename, fixture::tileServerOptions, CacheDurability::Normal);
+
+        EXPECT_TRUE(db.put(resource, response).first);
+        EXPECT_TRUE(db.hasPendingWrites());
+
+        // Queued writes are visible to the database that queued them right away...
+        auto getResult = db.get(resource);
+        ASSERT_TRUE(getResult);
+        EXPECT_EQ("tile", *getResult->data);
+        EXPECT_FALSE(other.get(resource));
+
+        // ...and to everyone else once the batch is committed.
+        db.flushPendingWrites();
+        EXPECT_FALSE(db.hasPendingWrites());
+        getResult = other.get(resource);
+        ASSERT_TRUE(getResult);
+        EXPECT_EQ("tile", *getResult->data);
+
+        // Revalidating a queued response updates it in place.
+        db.put(resource, response);
+        Response notModified;
+        notModified.notModified = true;
+        notModified.expires = Timestamp{Seconds(42)};
+        db.put(resource, notModified);
+        getResult = db.get(resource);
+        ASSERT_TRUE(getResult);
+        EXPECT_EQ("tile", *getResult->data);
+        EXPECT_EQ(Timestamp{Seconds(42)}, getResult->expires);
+    }
+
+    EXPECT_EQ("wal", databaseJournalMode(filename));
+
+    // Pending writes are committed when the database is closed.
+    OfflineDatabase db(filename, fixture::tileServerOptions);
+    auto getResult = db.get(resource);
+    ASSERT_TRUE(getResult);
+    EXPECT_EQ(Timestamp{Seconds(42)}, getResult->expires);
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, BatchedWritesCommitWhenFull) {
+    FixtureLog log;
+    OfflineDatabase db(":memory:", fixture::tileServerOptions, CacheDurability::Off);
+
+    Response response;
+    response.data = std::make_shared<std::string>("style");
+
+    for (std::size_t i = 1; i < OfflineDatabase::maxPendingWrites; ++i) {
+        db.put(Resource::style("http://example.com/"s + util::toString(i)), response);
+    }
+    EXPECT_TRUE(db.hasPendingWrites());
+
+    db.put(Resource::style("http://example.com/last"), response);
+    EXPECT_FALSE(db.hasPendingWrites());
+    EXPECT_TRUE(bool(db.get(Resource::style("http://example.com/1"))));
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+static std::vector<int64_t> databaseTileCodecs(const std::string& path) {
+    mapbox::sqlite::Database db = mapbox::sqlite::Database::open(path, mapbox::sqlite::ReadOnly);
+    mapbox::sqlite::Statement stmt{db, "SELECT compressed FROM tiles ORDER BY id"};
+    mapbox::sqlite::Query query{stmt};
+    std::vector<int64_t> codecs;
+    while (query.run()) {
+        codecs.push_back(query.get<int64_t>(0));
+    }
+    return codecs;
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(MigrateFromV6Schema)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        EXPECT_TRUE(db.put(fixture::tile, fixture::response).first);
+    }
+    {
+        mapbox::sqlite::Database db = mapbox::sqlite::Database::open(filename, mapbox::sqlite::ReadWrite);
+        db.exec("DROP TABLE dictionaries");
+        db.exec("PRAGMA user_version = 6");
+    }
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        EXPECT_TRUE(bool(db.get(fixture::tile)));
+    }
+
+    EXPECT_EQ(7, databaseUserVersion(filename));
+    EXPECT_EQ((std::vector<std::string>{"id", "created", "data"}), databaseTableColumns(filename, "dictionaries"));
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(Codecs)) {
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    Response compressible;
+    compressible.data = std::make_shared<std::string>(1024, 'x');
+    Response incompressible;
+    incompressible.data = randomString(1024);
+
+    const auto tile = [](int32_t x) {
+        return Resource::tile("http://example.com/{z}-{x}-{y}", 1, x, 0, 1, Tileset::Scheme::XYZ);
+    };
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions);
+        db.put(tile(0), compressible);
+        db.put(tile(1), incompressible);
+    }
+    EXPECT_EQ((std::vector<int64_t>{1, 0}), databaseTileCodecs(filename));
+
+    if (util::isAvailable(util::Codec::Zstd)) {
+        OfflineDatabase db(filename, fixture::tileServerOptions, CacheDurability::Full, util::Codec::Zstd);
+        db.put(tile(2), compressible);
+
+        // Tiles written with another codec stay readable.
+        for (int32_t x = 0; x < 3; ++x) {
+            auto result = db.get(tile(x));
+            ASSERT_TRUE(result && result->data);
+            EXPECT_EQ(x == 1 ? *incompressible.data : *compressible.data, *result->data);
+        }
+        EXPECT_EQ((std::vector<int64_t>{1, 0, 2}), databaseTileCodecs(filename));
+    } else {
+        OfflineDatabase db(filename, fixture::tileServerOptions, CacheDurability::Full, util::Codec::Zstd);
+        EXPECT_EQ(1u,
+                  log.count({EventSeverity::Warning,
+                             Event::Database,
+                             -1,
+                             "Cache codec not available in this build, using zlib"}));
+        EXPECT_TRUE(db.trainCompressionDictionary());
+        EXPECT_EQ(1u,
+                  log.count({EventSeverity::Error,
+                             Event::Database,
+                             -1,
+                             "Can't train compression dictionary: Compression dictionaries need the Zstd cache codec"}));
+    }
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
+
+TEST(OfflineDatabase, TEST_REQUIRES_WRITE(CompressionDictionary)) {
+    if (!util::isAvailable(util::Codec::Zstd)) {
+        return;
+    }
+
+    FixtureLog log;
+    deleteDatabaseFiles();
+
+    // Tiles sharing most of their contents, like vector tiles of one source do.
+    const auto tile = [](int32_t x) {
+        return Resource::tile("http://example.com/{z}-{x}-{y}", 1, x, 0, 10, Tileset::Scheme::XYZ);
+    };
+    const auto tileData = [](int32_t x) {
+        std::string data;
+        for (int32_t i = 0; i < 32; ++i) {
+            data += "{\"layer\":\"transportation\",\"class\":\"" + util::toString((x * 31 + i) % 7) + "\",\"id\":" +
+                    util::toString(x * 1000 + i) + "}";
+        }
+        return data;
+    };
+
+    {
+        OfflineDatabase db(filename, fixture::tileServerOptions, CacheDurability::Full, util::Codec::Zstd);
+        db.setMaximumAmbientCacheSize(0);
+        OfflineTilePyramidRegionDefinition definition{
+            "http://example.com/style", LatLngBounds::world(), 0, 10, 1.0, false};
+        auto region = db.createRegion(definition, OfflineRegionMetadata());
+        ASSERT_TRUE(region);
+        for (int32_t x = 0; x < 500; ++x) {
+            Response response;
+            response.data = std::make_shared<std::string>(tileData(x));
+            db.putRegionResource(region->getID(), tile(x), response);
+        }
+
+        const auto before = db.getRegionCompletedStatus(region->getID())->completedTileSize;
+        EXPECT_EQ(nullptr, db.trainCompressionDictionary());
+        const auto after = db.getRegionCompletedStatus(region->getID())->completedTileSize;
+        EXPECT_LT(after, before);
+
+        Response response;
+        response.data = std::make_shared<std::string>(tileData(500));
+        db.putRegionResource(region->getID(), tile(500), response);
+    }
+
+    // The dictionary is stored with the tiles that need it.
+    OfflineDatabase db(filename, fixture::tileServerOptions, CacheDurability::Full, util::Codec::Zstd);
+    for (int32_t x = 0; x <= 500; ++x) {
+        auto result = db.get(tile(x));
+        ASSERT_TRUE(result && result->data);
+        EXPECT_EQ(tileData(x), *result->data);
+    }
+
+    EXPECT_EQ(0u, log.uncheckedCount());
+}
@@ -14,6 +14,7 @@
 #include <mbgl/util/io.hpp>
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/string.hpp>
+#include <mbgl/util/tile_cover.hpp>
 
 #include <mbgl/storage/sqlite3.hpp>
 #include <gtest/gtest.h>
@@ -52,9 +53,14 @@ public:
         if (mapboxTileCountLimitExceededFn) mapboxTileCountLimitExceededFn(limit);
     }
 
+    void downloadMetricsChanged(OfflineRegionDownloadMetrics metrics) override {
+        if (downloadMetricsChangedFn) downloadMetricsChangedFn(metrics);
+    }
+
     std::function<void(OfflineRegionStatus)> statusChangedFn;
     std::function<void(Response::Error)> responseErrorFn;
     std::function<void(uint64_t)> mapboxTileCountLimitExceededFn;
+    std::function<void(OfflineRegionDownloadMetrics)> downloadMetricsChangedFn;
 };
 
 class OfflineTest {
@@ -398,6 +404,45 @@ TEST(OfflineDownload, DoesNotFloodTheFileSourceWithRequests) {
     EXPECT_EQ(*fileSource.getProperty(MAX_CONCURRENT_REQUESTS_KEY).getUint(), fileSource.requests.size());
 }
 
+TEST(OfflineDownload, TilesAreGeneratedOnDemand) {
+    OfflineTest test;
+    FakeOnlineFileSource fileSource;
+    auto region = test.createRegion();
+    ASSERT_TRUE(region);
+    OfflineDownload download(region->getID(),
+                             OfflineTilePyramidRegionDefinition(
+                                 "http://127.0.0.1:3000/style.json", LatLngBounds::world(), 0.0, 8.0, 1.0, false),
+                             test.db,
+                             fileSource);
+
+    download.setState(OfflineRegionDownloadState::Active);
+    test.loop.runOnce();
+
+    fileSource.respond(Resource::Kind::Style, test.response("inline_source.style.json"));
+    test.loop.runOnce();
+
+    uint64_t tileCount = 0;
+    for (uint8_t z = 0; z <= 8; z++) {
+        tileCount += util::tileCover(LatLngBounds::world(), z).size();
+    }
+
+    // Every tile is counted up front, but only as many are requested as
+    // there are request slots.
+    const auto maxConcurrentRequests = *fileSource.getProperty(MAX_CONCURRENT_REQUESTS_KEY).getUint();
+    OfflineRegionStatus status = download.getStatus();
+    EXPECT_TRUE(status.requiredResourceCountIsPrecise);
+    EXPECT_EQ(tileCount, status.requiredTileCount);
+    EXPECT_EQ(tileCount + 1, status.requiredResourceCount);
+    EXPECT_LT(maxConcurrentRequests, tileCount);
+    EXPECT_EQ(maxConcurrentRequests, fileSource.requests.size());
+
+    // A completed request makes room for the next tile.
+    ASSERT_TRUE(fileSource.respond(Resource::Kind::Tile, test.response("0-0-0.vector.pbf")));
+    test.loop.runOnce();
+    EXPECT_EQ(maxConcurrentRequests, fileSource.requests.size());
+    EXPECT_EQ(tileCount, download.getStatus().requiredTileCount);
+}
+
 TEST(OfflineDownload, GetStatusNoResources) {
     OfflineTest test;
     auto region = test.createRegion();
@@ -1160,3 +1205,46 @@ TEST(OfflineDownload, NoFreezingOnNotFoundError) {
     test.loop.run();
     // Passes if does not freeze.
 }
+
+TEST(OfflineDownload, DownloadMetrics) {
+    OfflineTest test;
+    auto region = test.createRegion();
+    ASSERT_TRUE(region);
+    OfflineDownload download(region->getID(),
+                             OfflineTilePyramidRegionDefinition(
+                                 "http://127.0.0.1:3000/style.json", LatLngBounds::world(), 0.0, 0.0, 1.0, true),
+                             test.db,
+                             test.fileSource);
+
+    test.fileSource.styleResponse = [&](const Resource&) {
+        return test.response("inline_source.style.json");
+    };
+
+    test.fileSource.tileResponse = [&](const Resource&) {
+        return test.response("0-0-0.vector.pbf");
+    };
+
+    auto observer = std::make_unique<MockObserver>();
+    std::vector<OfflineRegionDownloadMetrics> reports;
+    observer->downloadMetricsChangedFn = [&](OfflineRegionDownloadMetrics metrics) {
+        reports.push_back(metrics);
+    };
+    observer->statusChangedFn = [&](OfflineRegionStatus status) {
+        if (status.complete()) {
+            test.loop.stop();
+        }
+    };
+
+    download.setObserver(std::move(observer));
+    download.setState(OfflineRegionDownloadState::Active);
+
+    test.loop.run();
+
+    // Reported after each written batch.
+    ASSERT_FALSE(reports.empty());
+    EXPECT_EQ(0u, reports.back().pendingWriteCount);
+    EXPECT_EQ(0u, reports.back().pendingRequestCount);
+    EXPECT_LT(0.0, reports.back().resourcesPerSecond);
+    EXPECT_LT(0.0, reports.back().tilesPerSecond);
+    EXPECT_LT(0.0, reports.back().bytesPerSecond);
+}
@@ -103,3 +103,138 @@ TEST(PMTilesFileSource, NonExistentTile) {
 
     loop.run();
 }
+
+// Directories are deserialized once and reused by later tile requests
+TEST(PMTilesFileSource, DirectoryCache) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+    const auto resource = Resource::tile(
+        toAbsoluteURL("geography-class-png.pmtiles"), 1.0, 0, 0, 0, Tileset::Scheme::XYZ);
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(resource, [&](Response res) {
+        req.reset();
+        EXPECT_EQ(nullptr, res.error);
+        loop.stop();
+    });
+    loop.run();
+
+    auto stats = pmtiles.getDirectoryCacheStats();
+    EXPECT_EQ(0u, stats.hits);
+    EXPECT_EQ(1u, stats.misses);
+    EXPECT_EQ(1u, stats.entries);
+    EXPECT_LT(0u, stats.bytes);
+
+    req = pmtiles.request(resource, [&](Response res) {
+        req.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        loop.stop();
+    });
+    loop.run();
+
+    stats = pmtiles.getDirectoryCacheStats();
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(1u, stats.misses);
+    EXPECT_EQ(1u, stats.entries);
+}
+
+// Tiles still load when directories don't fit in the cache
+TEST(PMTilesFileSource, DirectoryCacheBudget) {
+    util::RunLoop loop;
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default().withPMTilesDirectoryCacheSize(0), ClientOptions());
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(
+        Resource::tile(toAbsoluteURL("geography-class-png.pmtiles"), 1.0, 0, 0, 0, Tileset::Scheme::XYZ),
+        [&](Response res) {
+            req.reset();
+            EXPECT_EQ(nullptr, res.error);
+            ASSERT_TRUE(res.data.get());
+            loop.stop();
+        });
+    loop.run();
+
+    const auto stats = pmtiles.getDirectoryCacheStats();
+    EXPECT_EQ(0u, stats.entries);
+    EXPECT_EQ(0u, stats.bytes);
+    EXPECT_EQ(1u, stats.evictions);
+}
+
+// Local archives replaced or truncated after they were first read are read again from the new file
+TEST(PMTilesFileSource, ChangedFile) {
+    util::RunLoop loop;
+
+    const auto fixture = std::filesystem::current_path() / "test/fixtures/storage/pmtiles/geography-class-png.pmtiles";
+    const auto path = std::filesystem::temp_directory_path() / "mbgl-pmtiles-changed-file.pmtiles";
+    std::filesystem::copy_file(fixture, path, std::filesystem::copy_options::overwrite_existing);
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+    const auto resource = Resource::tile(std::string(util::PMTILES_PROTOCOL) + util::FILE_PROTOCOL + path.string(),
+                                         1.0,
+                                         0,
+                                         0,
+                                         0,
+                                         Tileset::Scheme::XYZ);
+    const auto requestTile = [&] {
+        Response response;
+        std::unique_ptr<AsyncRequest> req = pmtiles.request(resource, [&](Response res) {
+            req.reset();
+            response = res;
+            loop.stop();
+        });
+        loop.run();
+        return response;
+    };
+
+    const Response original = requestTile();
+    ASSERT_EQ(nullptr, original.error);
+    ASSERT_TRUE(original.data.get());
+
+    // Reading the old mapping past the new end of the file would crash
+    std::filesystem::resize_file(path, 0);
+    const Response truncated = requestTile();
+    ASSERT_NE(nullptr, truncated.error);
+    EXPECT_NE(truncated.error->message.find("Error parsing PMTiles header"), std::string::npos);
+    EXPECT_FALSE(truncated.data.get());
+
+    std::filesystem::copy_file(fixture, path, std::filesystem::copy_options::overwrite_existing);
+    const Response restored = requestTile();
+    ASSERT_EQ(nullptr, restored.error);
+    ASSERT_TRUE(restored.data.get());
+    EXPECT_EQ(*original.data, *restored.data);
+
+    std::filesystem::remove(path);
+}
+
+// Archives that couldn't be opened are tried again by later requests
+TEST(PMTilesFileSource, FileCreatedLater) {
+    util::RunLoop loop;
+
+    const auto fixture = std::filesystem::current_path() / "test/fixtures/storage/pmtiles/geography-class-png.pmtiles";
+    const auto path = std::filesystem::temp_directory_path() / "mbgl-pmtiles-created-later.pmtiles";
+    std::filesystem::remove(path);
+
+    PMTilesFileSource pmtiles(ResourceOptions::Default(), ClientOptions());
+    const Resource resource{Resource::Unknown,
+                            std::string(util::PMTILES_PROTOCOL) + util::FILE_PROTOCOL + path.string()};
+
+    std::unique_ptr<AsyncRequest> req = pmtiles.request(resource, [&](Response res) {
+        req.reset();
+        ASSERT_NE(nullptr, res.error);
+        EXPECT_EQ(Response::Error::Reason::NotFound, res.error->reason);
+        loop.stop();
+    });
+    loop.run();
+
+    std::filesystem::copy_file(fixture, path);
+    req = pmtiles.request(resource, [&](Response res) {
+        req.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        loop.stop();
+    });
+    loop.run();
+
+    std::filesystem::remove(path);
+}
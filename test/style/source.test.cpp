@@ -46,7 +46,10 @@
 #include <mbgl/text/glyph_manager.hpp>
 #include <mbgl/gfx/dynamic_texture_atlas.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <gmock/gmock.h>
 
@@ -1013,6 +1016,363 @@ TEST(Source, GeoJSONSourceTilesAfterDataReset) {
     EXPECT_TRUE(renderSource.isLoaded()); // Tiles are reset in static mode.
 }
 
+namespace {
+
+// Points spread over the world, every tenth of them replaced by a line across many tiles
+GeoJSONData::Features makeManyFeatures() {
+    GeoJSONData::Features features;
+    for (uint64_t i = 0; i < 20000; ++i) {
+        const mapbox::geometry::point<double> point{-170.0 + (i % 200) * 1.7, -80.0 + (i / 200) * 1.6};
+        mapbox::feature::feature<double> feature{point};
+        if (i % 10 == 0) {
+            feature.geometry = mapbox::geometry::line_string<double>{point, {point.x + 40.0, point.y / 2.0}};
+        }
+        feature.id = i;
+        features.push_back(std::move(feature));
+    }
+    return features;
+}
+
+} // namespace
+
+TEST(Source, GeoJSONDataParts) {
+    util::RunLoop loop;
+    const auto features = makeManyFeatures();
+
+    double progress = 0.0;
+    GeoJSONData::BuildControl control;
+    control.onProgress = [&](double fraction) {
+        static std::mutex mutex;
+        std::scoped_lock lock(mutex);
+        progress = std::max(progress, fraction);
+    };
+    control.pool = Scheduler::MakeBackground(4);
+    auto data = GeoJSONData::create(features, Scheduler::GetSequenced(), GeoJSONOptions::defaultOptions(), control);
+    ASSERT_TRUE(data);
+    EXPECT_EQ(1.0, progress);
+
+    GeoJSONData::BuildControl single;
+    single.pool = Scheduler::MakeBackground(1);
+    auto singleData = GeoJSONData::create(
+        features, Scheduler::GetSequenced(), GeoJSONOptions::defaultOptions(), single);
+    ASSERT_TRUE(singleData);
+    const auto getTile = [](GeoJSONData& data_, const CanonicalTileID& id) {
+        GeoJSONData::TileFeatures result;
+        data_.getTile(id, [&](GeoJSONData::TileFeatures tile) { result = std::move(tile); }, true);
+        return result;
+    };
+
+    // Away from the antimeridian, features come back in input order however the index was split
+    const auto interior = getTile(*data, {2, 1, 1});
+    ASSERT_FALSE(interior.empty());
+    for (std::size_t i = 1; i < interior.size(); ++i) {
+        ASSERT_LT(interior[i - 1].id.get<uint64_t>(), interior[i].id.get<uint64_t>());
+    }
+    EXPECT_TRUE(interior == getTile(*singleData, {2, 1, 1}));
+
+    // The tiles match those of a single index at every zoom level, clipped and simplified alike. The one difference:
+    // copies of features wrapped around the antimeridian come first or last among the features of their part, rather
+    // than among all features. They lie beyond the world's edges, so only the buffers of the tiles at its east and
+    // west edges reach them, and only there may overlapping features draw in another order.
+    const auto sorted = [](GeoJSONData::TileFeatures tile) {
+        std::ranges::stable_sort(tile, {}, [](const auto& feature) { return feature.id.template get<uint64_t>(); });
+        return tile;
+    };
+    for (uint8_t z = 0; z <= 5; ++z) {
+        for (uint32_t x = 0; x < (1u << z); ++x) {
+            for (uint32_t y = 0; y < (1u << z); ++y) {
+                const auto tile = getTile(*data, {z, x, y});
+                const auto expected = getTile(*singleData, {z, x, y});
+                if (x == 0 || x + 1 == (1u << z)) {
+                    ASSERT_TRUE(sorted(tile) == sorted(expected)) << int(z) << "/" << x << "/" << y;
+                } else {
+                    ASSERT_TRUE(tile == expected) << int(z) << "/" << x << "/" << y;
+                }
+            }
+        }
+    }
+    for (const CanonicalTileID& id : {CanonicalTileID(10, 300, 400), CanonicalTileID(14, 9000, 6000)}) {
+        EXPECT_TRUE(getTile(*data, id) == getTile(*singleData, id));
+    }
+
+    // Lookups on the parts' own threads put the same tile together
+    GeoJSONData::TileFeatures asyncFeatures;
+    data->getTile(
+        {2, 1, 1},
+        [&](GeoJSONData::TileFeatures result) {
+            asyncFeatures = std::move(result);
+            loop.stop();
+        },
+        false);
+    loop.run();
+    EXPECT_FALSE(asyncFeatures.empty());
+    EXPECT_TRUE(asyncFeatures == getTile(*singleData, {2, 1, 1}));
+
+    // A cancelled build yields no data
+    control.onProgress = nullptr;
+    control.isCancelled = [] {
+        return true;
+    };
+    EXPECT_FALSE(GeoJSONData::create(features, Scheduler::GetSequenced(), GeoJSONOptions::defaultOptions(), control));
+}
+
+TEST(Source, GeoJSONSourceLoadingProgress) {
+    SourceTest test;
+
+    test.fileSource->sourceResponse = [&](const Resource& resource) {
+        EXPECT_EQ("url", resource.url);
+        Response response;
+        std::string json = R"({"type": "FeatureCollection", "features": [)";
+        for (std::size_t i = 0; i < 20000; ++i) {
+            json += std::string(i ? "," : "") + R"({"type": "Feature", "id": )" + std::to_string(i) +
+                    R"(, "properties": {}, "geometry": {"type": "Point", "coordinates": [)" +
+                    std::to_string(-170.0 + (i % 200) * 1.7) + "," + std::to_string(-80.0 + (i / 200) * 1.6) + "]}}";
+        }
+        response.data = std::make_shared<std::string>(json + "]}");
+        return response;
+    };
+
+    std::vector<double> progress;
+    test.styleObserver.sourceLoadingProgress = [&](Source&, double fraction) {
+        progress.push_back(fraction);
+    };
+    test.styleObserver.sourceLoaded = [&](Source&) {
+        // The whole collection was indexed before the data arrived
+        ASSERT_FALSE(progress.empty());
+        EXPECT_EQ(1.0, *std::ranges::max_element(progress));
+        test.end();
+    };
+
+    GeoJSONSource source("source");
+    source.setURL("url");
+    source.setObserver(&test.styleObserver);
+    source.loadDescription(*test.fileSource);
+    test.run();
+}
+
+TEST(Source, GeoJSONDataDiff) {
+    // One point in each quadrant of the world
+    GeoJSONData::Features features;
+    const std::vector<mapbox::geometry::point<double>> points{
+        {-90.0, 45.0}, {90.0, 45.0}, {-90.0, -45.0}, {90.0, -45.0}};
+    for (uint64_t i = 0; i < points.size(); ++i) {
+        mapbox::feature::feature<double> feature{points[i]};
+        feature.id = i;
+        features.push_back(std::move(feature));
+    }
+    Mutable<GeoJSONOptions> options = makeMutable<GeoJSONOptions>();
+    options->updatable = true;
+    auto data = GeoJSONData::create(features, Scheduler::GetSequenced(), std::move(options));
+    ASSERT_TRUE(data);
+
+    const auto getIDs = [](GeoJSONData& data_, const CanonicalTileID& id) {
+        std::vector<mapbox::feature::identifier> ids;
+        data_.getTile(
+            id,
+            [&](GeoJSONData::TileFeatures result) {
+                for (const auto& feature : result) ids.push_back(feature.id);
+            },
+            true);
+        return ids;
+    };
+
+    // Moves the north-western point within its tile and removes the south-eastern one
+    GeoJSONDiff diff;
+    mapbox::feature::feature<double> moved{mapbox::geometry::point<double>{-100.0, 50.0}};
+    moved.id = uint64_t(0);
+    diff.update.push_back(moved);
+    diff.remove.emplace_back(uint64_t(3));
+    auto updated = data->applyDiff(diff);
+    ASSERT_TRUE(updated);
+
+    EXPECT_TRUE(updated->affectsTile(*data, {0, 0, 0}));
+    EXPECT_TRUE(updated->affectsTile(*data, {1, 0, 0}));
+    EXPECT_FALSE(updated->affectsTile(*data, {1, 1, 0}));
+    EXPECT_FALSE(updated->affectsTile(*data, {1, 0, 1}));
+    EXPECT_TRUE(updated->affectsTile(*data, {1, 1, 1}));
+    // Other data may differ anywhere
+    EXPECT_TRUE(updated->affectsTile(*updated, {1, 1, 0}));
+
+    using IDs = std::vector<mapbox::feature::identifier>;
+    EXPECT_EQ((IDs{uint64_t(0)}), getIDs(*updated, {1, 0, 0}));
+    EXPECT_EQ((IDs{uint64_t(2)}), getIDs(*updated, {1, 0, 1}));
+    EXPECT_EQ((IDs{}), getIDs(*updated, {1, 1, 1}));
+    // The data the diff was applied to is unchanged
+    EXPECT_EQ((IDs{uint64_t(3)}), getIDs(*data, {1, 1, 1}));
+
+    // Later diffs replace the changed features again
+    GeoJSONDiff second;
+    second.remove.emplace_back(uint64_t(0));
+    auto updatedAgain = updated->applyDiff(second);
+    ASSERT_TRUE(updatedAgain);
+    EXPECT_EQ((IDs{}), getIDs(*updatedAgain, {1, 0, 0}));
+    EXPECT_EQ((IDs{uint64_t(2)}), getIDs(*updatedAgain, {1, 0, 1}));
+
+    // Features without IDs can't be diffed, nor can features that weren't kept for updates
+    GeoJSONData::Features anonymous{mapbox::feature::feature<double>{points[0]}};
+    Mutable<GeoJSONOptions> updatable = makeMutable<GeoJSONOptions>();
+    updatable->updatable = true;
+    EXPECT_FALSE(GeoJSONData::create(anonymous, Scheduler::GetSequenced(), std::move(updatable))->applyDiff(diff));
+    EXPECT_FALSE(GeoJSONData::create(features, Scheduler::GetSequenced())->applyDiff(diff));
+}
+
+TEST(Source, GeoJSONDataDiffHistory) {
+    // A row of points along the equator, far enough from the antimeridian not to be wrapped around it at z0
+    std::map<uint64_t, mapbox::geometry::point<double>> expected;
+    GeoJSONData::Features features;
+    for (uint64_t i = 0; i < 100; ++i) {
+        expected[i] = {-85.0 + i * 1.7, 0.0};
+        mapbox::feature::feature<double> feature{expected[i]};
+        feature.id = i;
+        features.push_back(std::move(feature));
+    }
+    Mutable<GeoJSONOptions> options = makeMutable<GeoJSONOptions>();
+    options->updatable = true;
+    std::shared_ptr<GeoJSONData> data = GeoJSONData::create(features, Scheduler::GetSequenced(), std::move(options));
+    ASSERT_TRUE(data);
+
+    // Every feature shows up once, in its latest version
+    const auto expectCurrent = [&](GeoJSONData& data_) {
+        std::map<uint64_t, mapbox::geometry::point<double>> actual;
+        data_.getTile(
+            {0, 0, 0},
+            [&](GeoJSONData::TileFeatures result) {
+                for (const auto& feature : result) {
+                    const auto& point = feature.geometry.get<mapbox::geometry::point<int16_t>>();
+                    const mapbox::geometry::point<double> position(point.x, point.y);
+                    EXPECT_TRUE(actual.emplace(feature.id.get<uint64_t>(), position).second);
+                }
+            },
+            true);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (const auto& [id, point] : expected) {
+            ASSERT_TRUE(actual.contains(id)) << id;
+            // Tile coordinates of the point, from 0 to 8192 across the world
+            EXPECT_NEAR((point.x + 180.0) / 360.0 * util::EXTENT, actual[id].x, 1.0) << id;
+        }
+    };
+
+    // Many small diffs moving, removing and adding points, each applied to the result of the last one
+    for (uint64_t step = 0; step < 300; ++step) {
+        GeoJSONDiff diff;
+        const uint64_t id = (step * 37) % 120;
+        if (step % 7 == 0) {
+            diff.remove.emplace_back(id);
+            expected.erase(id);
+        } else {
+            mapbox::feature::feature<double> feature{mapbox::geometry::point<double>{-85.0 + step * 0.5, 10.0}};
+            feature.id = id;
+            diff.update.push_back(feature);
+            expected[id] = feature.geometry.get<mapbox::geometry::point<double>>();
+        }
+        data = data->applyDiff(diff);
+        ASSERT_TRUE(data);
+    }
+    expectCurrent(*data);
+
+    // Changing more features than a diff is worth applying to rebuilds the index in the background
+    GeoJSONDiff large;
+    for (uint64_t id = 1000; id < 6000; ++id) {
+        mapbox::feature::feature<double> feature{mapbox::geometry::point<double>{-85.0 + (id % 1700) / 10.0, -20.0}};
+        feature.id = id;
+        large.update.push_back(feature);
+        expected[id] = feature.geometry.get<mapbox::geometry::point<double>>();
+    }
+    auto rebuilt = data->applyDiff(large);
+    ASSERT_TRUE(rebuilt);
+    expectCurrent(*rebuilt);
+    Scheduler::GetBackground()->waitForEmpty();
+    expectCurrent(*rebuilt);
+
+    // Later diffs start from the rebuilt index
+    GeoJSONDiff last;
+    last.remove.emplace_back(uint64_t(1000));
+    expected.erase(1000);
+    auto updated = rebuilt->applyDiff(last);
+    ASSERT_TRUE(updated);
+    expectCurrent(*updated);
+    EXPECT_TRUE(updated->affectsTile(*rebuilt, {1, 1, 1}));
+    EXPECT_FALSE(updated->affectsTile(*rebuilt, {4, 0, 0}));
+}
+
+TEST(Source, GeoJSONDataDiffOrder) {
+    // Points along the equator, drawn in input order
+    GeoJSONData::Features features;
+    std::vector<uint64_t> expected;
+    for (uint64_t i = 0; i < 100; ++i) {
+        mapbox::feature::feature<double> feature{mapbox::geometry::point<double>{-85.0 + i * 1.7, 0.0}};
+        feature.id = i;
+        features.push_back(std::move(feature));
+        if (i != 20) {
+            expected.push_back(i);
+        }
+    }
+    Mutable<GeoJSONOptions> options = makeMutable<GeoJSONOptions>();
+    options->updatable = true;
+    auto data = GeoJSONData::create(features, Scheduler::GetSequenced(), std::move(options));
+    ASSERT_TRUE(data);
+
+    const auto getOrder = [](GeoJSONData& data_) {
+        std::vector<uint64_t> ids;
+        data_.getTile(
+            {0, 0, 0},
+            [&](GeoJSONData::TileFeatures result) {
+                for (const auto& feature : result) {
+                    ids.push_back(feature.id.get<uint64_t>());
+                }
+            },
+            true);
+        return ids;
+    };
+
+    const auto makePoint = [](uint64_t id, double lat) {
+        mapbox::feature::feature<double> feature{mapbox::geometry::point<double>{-85.0 + (id % 1700) / 10.0, lat}};
+        feature.id = id;
+        return feature;
+    };
+
+    // Move one feature and remove another, then add enough features for the index to be rebuilt
+    GeoJSONDiff diff;
+    mapbox::feature::feature<double> moved{mapbox::geometry::point<double>{-60.0, 20.0}};
+    moved.id = uint64_t(10);
+    diff.update.push_back(moved);
+    diff.remove.emplace_back(uint64_t(20));
+    for (uint64_t id = 1000; id < 6000; ++id) {
+        diff.update.push_back(makePoint(id, -20.0));
+        expected.push_back(id);
+    }
+    auto updated = data->applyDiff(diff);
+    ASSERT_TRUE(updated);
+    Scheduler::GetBackground()->waitForEmpty();
+
+    // The moved feature keeps its place, and the added ones follow in the order they were added
+    EXPECT_EQ(expected, getOrder(*updated));
+
+    // The same holds for changes merged over several diffs, including features added by one and updated by another
+    moved.geometry = mapbox::geometry::point<double>{-50.0, 30.0};
+    GeoJSONDiff first;
+    first.update.push_back(moved);
+    for (uint64_t id = 6000; id < 7000; ++id) {
+        first.update.push_back(makePoint(id, 20.0));
+    }
+    GeoJSONDiff second;
+    second.update.push_back(makePoint(6000, 30.0));
+    second.remove.emplace_back(uint64_t(1000));
+    for (uint64_t id = 7000; id < 11000; ++id) {
+        second.update.push_back(makePoint(id, 40.0));
+    }
+    std::erase(expected, uint64_t(1000));
+    for (uint64_t id = 6000; id < 11000; ++id) {
+        expected.push_back(id);
+    }
+    auto once = updated->applyDiff(first);
+    ASSERT_TRUE(once);
+    auto twice = once->applyDiff(second);
+    ASSERT_TRUE(twice);
+    Scheduler::GetBackground()->waitForEmpty();
+    EXPECT_EQ(expected, getOrder(*twice));
+}
+
 TEST(Source, SetMaxParentOverscaleFactor) {
     SourceTest test;
     test.transform.jumpTo(CameraOptions().withCenter(LatLng()).withZoom(8.0));
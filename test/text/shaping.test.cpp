@@ -1,9 +1,11 @@
 
 #include <mbgl/test/util.hpp>
 
+#include <mbgl/style/image_impl.hpp>
 #include <mbgl/text/bidi.hpp>
 #include <mbgl/text/tagged_string.hpp>
 #include <mbgl/text/shaping.hpp>
+#include <mbgl/text/shaping_cache.hpp>
 #include <mbgl/util/constants.hpp>
 
 using namespace mbgl;
@@ -104,6 +106,240 @@ TEST(Shaping, ZWSP) {
     }
 }
 
+TEST(Shaping, Cache) {
+    GlyphMetrics metrics;
+    metrics.width = 18;
+    metrics.height = 18;
+    metrics.left = 2;
+    metrics.top = -8;
+    metrics.advance = 21;
+
+    BiDi bidi;
+    const std::vector<std::string> fontStack{{"font-stack"}};
+    const FontStackHash fontStackHash = FontStackHasher()(fontStack);
+    const SectionOptions sectionOptions(1.0f, fontStack, GlyphIDType::FontPBF, 0);
+    const TaggedString string(u"ab ab", sectionOptions);
+    GlyphMap glyphs;
+    for (const char16_t c : std::u16string(u"ab")) {
+        Glyph glyph;
+        glyph.id = c;
+        glyph.metrics = metrics;
+        glyphs[fontStackHash].emplace(c, Immutable<Glyph>(makeMutable<Glyph>(std::move(glyph))));
+    }
+    ImagePositions imagePositions;
+
+    // The same glyphs at different places in the atlases of two tiles
+    GlyphPositions firstTile = {{fontStackHash, {{u'a', {{0, 0, 24, 24}, metrics}}, {u'b', {{24, 0, 24, 24}, metrics}}}}};
+    GlyphPositions secondTile = {
+        {fontStackHash, {{u'a', {{48, 0, 24, 24}, metrics}}, {u'b', {{72, 0, 24, 24}, metrics}}}}};
+
+    const auto shape = [&](const GlyphPositions& glyphPositions) {
+        return getShaping(string,
+                          10 * ONE_EM,
+                          ONE_EM, // lineHeight
+                          style::SymbolAnchorType::Center,
+                          style::TextJustifyType::Center,
+                          0,              // spacing
+                          {{0.0f, 0.0f}}, // translate
+                          WritingModeType::Horizontal,
+                          bidi,
+                          glyphs,
+                          glyphPositions,
+                          imagePositions,
+                          16.0f,
+                          16.0f,
+                          /*allowVerticalPlacement*/ false);
+    };
+    const auto shapeCached = [&](const GlyphPositions& glyphPositions) {
+        return ShapingCache::get().getShaping(string,
+                                              10 * ONE_EM,
+                                              ONE_EM, // lineHeight
+                                              style::SymbolAnchorType::Center,
+                                              style::TextJustifyType::Center,
+                                              0,              // spacing
+                                              {{0.0f, 0.0f}}, // translate
+                                              WritingModeType::Horizontal,
+                                              bidi,
+                                              glyphs,
+                                              glyphPositions,
+                                              imagePositions,
+                                              16.0f,
+                                              16.0f,
+                                              /*allowVerticalPlacement*/ false);
+    };
+    const auto rects = [](const Shaping& shaping) {
+        std::vector<Rect<uint16_t>> result;
+        for (const auto& line : shaping.positionedLines) {
+            for (const auto& glyph : line.positionedGlyphs) {
+                result.push_back(glyph.rect);
+            }
+        }
+        return result;
+    };
+
+    ShapingCache::get().clear();
+    const Shaping first = shapeCached(firstTile);
+    EXPECT_EQ(ShapingCache::get().getStats().misses, 1u);
+    EXPECT_EQ(rects(first), rects(shape(firstTile)));
+
+    // Reused for the second tile, with its atlas positions
+    const Shaping second = shapeCached(secondTile);
+    EXPECT_EQ(ShapingCache::get().getStats().hits, 1u);
+    EXPECT_EQ(rects(second), rects(shape(secondTile)));
+    EXPECT_EQ(second.left, first.left);
+    EXPECT_EQ(second.right, first.right);
+
+    // Not reused where a glyph measures differently
+    GlyphPositions thirdTile = secondTile;
+    thirdTile[fontStackHash][u'b'].metrics.advance = 30;
+    const Shaping third = shapeCached(thirdTile);
+    EXPECT_EQ(ShapingCache::get().getStats().misses, 2u);
+    EXPECT_NE(third.right, second.right);
+    ShapingCache::get().clear();
+}
+
+TEST(Shaping, CacheImageSizes) {
+    GlyphMetrics metrics;
+    metrics.width = 18;
+    metrics.height = 18;
+    metrics.left = 2;
+    metrics.top = -8;
+    metrics.advance = 21;
+
+    BiDi bidi;
+    const std::vector<std::string> fontStack{{"font-stack"}};
+    const FontStackHash fontStackHash = FontStackHasher()(fontStack);
+    TaggedString string;
+    string.addTextSection(u"ab", 1.0, fontStack, GlyphIDType::FontPBF);
+    string.addImageSection("icon");
+    GlyphMap glyphs;
+    for (const char16_t c : std::u16string(u"ab")) {
+        Glyph glyph;
+        glyph.id = c;
+        glyph.metrics = metrics;
+        glyphs[fontStackHash].emplace(c, Immutable<Glyph>(makeMutable<Glyph>(std::move(glyph))));
+    }
+    const GlyphPositions glyphPositions = {
+        {fontStackHash, {{u'a', {{0, 0, 24, 24}, metrics}}, {u'b', {{24, 0, 24, 24}, metrics}}}}};
+
+    const auto imagePositions = [](Rect<uint16_t> rect, float pixelRatio) {
+        const style::Image::Impl image("icon", PremultipliedImage({rect.w, rect.h}), pixelRatio);
+        return ImagePositions{{"icon", ImagePosition(rect, image)}};
+    };
+    const auto shapeCached = [&](const ImagePositions& images) {
+        return ShapingCache::get().getShaping(string,
+                                              10 * ONE_EM,
+                                              ONE_EM, // lineHeight
+                                              style::SymbolAnchorType::Center,
+                                              style::TextJustifyType::Center,
+                                              0,              // spacing
+                                              {{0.0f, 0.0f}}, // translate
+                                              WritingModeType::Horizontal,
+                                              bidi,
+                                              glyphs,
+                                              glyphPositions,
+                                              images,
+                                              16.0f,
+                                              16.0f,
+                                              /*allowVerticalPlacement*/ false);
+    };
+    const auto imageGlyph = [](const Shaping& shaping) {
+        for (const auto& line : shaping.positionedLines) {
+            for (const auto& glyph : line.positionedGlyphs) {
+                if (glyph.imageID) return glyph;
+            }
+        }
+        ADD_FAILURE() << "no image in the shaping";
+        return PositionedGlyph(0, 0, 0, false, 0, 1.0, {}, {}, std::nullopt);
+    };
+
+    ShapingCache::get().clear();
+    const Shaping first = shapeCached(imagePositions({0, 0, 22, 22}, 1.0f));
+    EXPECT_EQ(ShapingCache::get().getStats().misses, 1u);
+
+    // Reused where the image is elsewhere in the atlas, but displays at the same size
+    const Shaping second = shapeCached(imagePositions({30, 0, 22, 22}, 1.0f));
+    EXPECT_EQ(ShapingCache::get().getStats().hits, 1u);
+    EXPECT_EQ(imageGlyph(second).rect, (Rect<uint16_t>{30, 0, 22, 22}));
+    EXPECT_EQ(imageGlyph(second).y, imageGlyph(first).y);
+
+    // Not reused for a size that only differs after the decimal point, which moves the image
+    const Shaping third = shapeCached(imagePositions({0, 0, 43, 43}, 2.0f));
+    EXPECT_EQ(ShapingCache::get().getStats().hits, 1u);
+    EXPECT_EQ(ShapingCache::get().getStats().misses, 2u);
+    EXPECT_NE(imageGlyph(third).y, imageGlyph(second).y);
+    ShapingCache::get().clear();
+}
+
+TEST(Shaping, CacheMaxSize) {
+    GlyphMetrics metrics;
+    metrics.width = 18;
+    metrics.height = 18;
+    metrics.advance = 21;
+
+    BiDi bidi;
+    const std::vector<std::string> fontStack{{"font-stack"}};
+    const FontStackHash fontStackHash = FontStackHasher()(fontStack);
+    GlyphMap glyphs;
+    GlyphPositions glyphPositions;
+    for (char16_t c = u'a'; c <= u'z'; ++c) {
+        Glyph glyph;
+        glyph.id = c;
+        glyph.metrics = metrics;
+        glyphs[fontStackHash].emplace(c, Immutable<Glyph>(makeMutable<Glyph>(std::move(glyph))));
+        const auto x = static_cast<uint16_t>((c - u'a') * 24);
+        glyphPositions[fontStackHash].emplace(c, GlyphPosition{{x, 0, 24, 24}, metrics});
+    }
+    const auto shapeCached = [&](char16_t c) {
+        const TaggedString string(std::u16string(3, c), SectionOptions(1.0, fontStack, GlyphIDType::FontPBF, 0));
+        return ShapingCache::get().getShaping(string,
+                                              10 * ONE_EM,
+                                              ONE_EM, // lineHeight
+                                              style::SymbolAnchorType::Center,
+                                              style::TextJustifyType::Center,
+                                              0,              // spacing
+                                              {{0.0f, 0.0f}}, // translate
+                                              WritingModeType::Horizontal,
+                                              bidi,
+                                              glyphs,
+                                              glyphPositions,
+                                              {},
+                                              16.0f,
+                                              16.0f,
+                                              /*allowVerticalPlacement*/ false);
+    };
+
+    auto& cache = ShapingCache::get();
+    const std::size_t defaultMaxSize = cache.getMaxSize();
+    cache.clear();
+
+    // Turned off, nothing is kept
+    cache.setMaxSize(0);
+    shapeCached(u'a');
+    shapeCached(u'a');
+    EXPECT_EQ(0u, cache.getStats().size);
+    EXPECT_EQ(0u, cache.getStats().hits);
+
+    // Bounded, never more than the cap
+    cache.setMaxSize(16);
+    for (char16_t c = u'a'; c <= u'z'; ++c) {
+        shapeCached(c);
+        EXPECT_GE(16u, cache.getStats().size);
+    }
+
+    // Lowering the cap drops entries beyond it
+    cache.setMaxSize(defaultMaxSize);
+    for (char16_t c = u'a'; c <= u'z'; ++c) {
+        shapeCached(c);
+    }
+    EXPECT_EQ(26u, cache.getStats().size);
+    cache.setMaxSize(16);
+    EXPECT_GE(16u, cache.getStats().size);
+
+    cache.setMaxSize(defaultMaxSize);
+    cache.clear();
+}
+
 void setupShapedText(Shaping& shapedText, float textSize) {
     const auto glyph = PositionedGlyph(32,
                                        0.0f,
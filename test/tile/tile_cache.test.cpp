@@ -40,7 +40,12 @@ public:
 
     void setData(const std::shared_ptr<const std::string>&) override {}
 
+    std::size_t getByteSize() const override { return byteSize; }
+    std::size_t getGPUByteSize() const override { return gpuByteSize; }
+
     util::SimpleIdentity uniqueId;
+    std::size_t byteSize = 0;
+    std::size_t gpuByteSize = 0;
 };
 
 } // namespace
@@ -96,3 +101,85 @@ TEST(TileCache, Issue15926) {
         EXPECT_FALSE(cache.has(id1));
     }
 }
+
+TEST(TileCache, ByteBudget) {
+    VectorTileTest test;
+    {
+        TileCache cache(test.threadPool, 10, 100);
+        const OverscaledTileID id0(1, 0, 0);
+        const OverscaledTileID id1(1, 0, 1);
+        const OverscaledTileID id2(1, 1, 0);
+        const OverscaledTileID id3(1, 1, 1);
+        auto makeTile = [&](const OverscaledTileID& id, std::size_t byteSize) {
+            auto tile = std::make_unique<VectorTileMock>(id, "source", test.tileParameters, test.tileset);
+            tile->byteSize = byteSize;
+            return tile;
+        };
+
+        cache.add(id0, makeTile(id0, 40));
+        cache.add(id1, makeTile(id1, 40));
+        EXPECT_EQ(80u, cache.getBytes());
+
+        // Re-adding a cached tile makes it the newest one
+        cache.add(id0, makeTile(id0, 40));
+        EXPECT_EQ(80u, cache.getBytes());
+
+        // Going over the budget evicts the least recently added tiles
+        cache.add(id2, makeTile(id2, 40));
+        EXPECT_TRUE(cache.has(id0));
+        EXPECT_FALSE(cache.has(id1));
+        EXPECT_TRUE(cache.has(id2));
+        EXPECT_EQ(80u, cache.getBytes());
+
+        // A tile larger than the whole budget isn't retained, and doesn't push out the others
+        cache.add(id3, makeTile(id3, 120));
+        EXPECT_FALSE(cache.has(id3));
+        EXPECT_TRUE(cache.has(id0));
+        EXPECT_TRUE(cache.has(id2));
+        EXPECT_EQ(80u, cache.getBytes());
+
+        cache.add(id1, makeTile(id1, 40));
+        EXPECT_FALSE(cache.has(id0));
+        cache.add(id0, makeTile(id0, 40));
+        EXPECT_FALSE(cache.has(id2));
+        cache.add(id1, makeTile(id1, 40));
+        cache.setMaxBytes(50);
+        EXPECT_FALSE(cache.has(id0));
+        EXPECT_TRUE(cache.has(id1));
+        EXPECT_EQ(40u, cache.getBytes());
+    }
+}
+
+TEST(TileCache, Stats) {
+    VectorTileTest test;
+    {
+        TileCache cache(test.threadPool, 1, 100);
+        const OverscaledTileID id0(0, 0, 0);
+        const OverscaledTileID id1(1, 0, 0);
+        auto tile0 = std::make_unique<VectorTileMock>(id0, "source", test.tileParameters, test.tileset);
+        auto tile1 = std::make_unique<VectorTileMock>(id1, "source", test.tileParameters, test.tileset);
+        tile0->byteSize = 10;
+        tile1->byteSize = 20;
+        tile1->gpuByteSize = 30;
+
+        cache.add(id0, std::move(tile0));
+        cache.add(id1, std::move(tile1));
+        EXPECT_EQ(20u, cache.getStats().bytes);
+        EXPECT_EQ(30u, cache.getStats().gpuBytes);
+
+        // Only tiles that had to be created count as misses, not every lookup
+        EXPECT_FALSE(cache.pop(id0));
+        EXPECT_FALSE(cache.pop(id0));
+        cache.recordMiss();
+        EXPECT_TRUE(cache.pop(id1));
+
+        const TileCacheStats stats = cache.getStats();
+        EXPECT_EQ(0u, stats.tiles);
+        EXPECT_EQ(0u, stats.bytes);
+        EXPECT_EQ(0u, stats.gpuBytes);
+        EXPECT_EQ(100u, stats.maxBytes);
+        EXPECT_EQ(1u, stats.hits);
+        EXPECT_EQ(1u, stats.misses);
+        EXPECT_EQ(1u, stats.evictions);
+    }
+}
@@ -9,9 +9,19 @@
 #include <mbgl/util/run_loop.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/style/style.hpp>
+#include <mbgl/style/expression/dsl.hpp>
+#include <mbgl/style/layers/fill_layer.hpp>
+#include <mbgl/style/layers/fill_layer_impl.hpp>
+#include <mbgl/style/layers/fill_layer_properties.hpp>
+#include <mbgl/style/layers/line_layer.hpp>
+#include <mbgl/style/layers/line_layer_impl.hpp>
+#include <mbgl/style/layers/line_layer_properties.hpp>
 #include <mbgl/style/layers/symbol_layer.hpp>
 #include <mbgl/renderer/tile_parameters.hpp>
+#include <mbgl/renderer/buckets/fill_bucket.hpp>
+#include <mbgl/renderer/buckets/line_bucket.hpp>
 #include <mbgl/renderer/buckets/symbol_bucket.hpp>
+#include <mbgl/renderer/tile_render_data.hpp>
 #include <mbgl/renderer/query.hpp>
 #include <mbgl/geometry/feature_index.hpp>
 #include <mbgl/annotation/annotation_manager.hpp>
@@ -19,6 +29,7 @@
 #include <mbgl/test/vector_tile_test.hpp>
 #include <mbgl/text/glyph_manager.hpp>
 
+#include <cstring>
 #include <memory>
 
 using namespace mbgl;
@@ -85,3 +96,132 @@ TEST(VectorTileData, ParseResults) {
 
     ASSERT_EQ(feature->getValue("invalid"), std::nullopt);
 }
+
+namespace {
+
+bool sameVertices(const gfx::VertexVectorBase& a, const gfx::VertexVectorBase& b) {
+    return a.getRawCount() == b.getRawCount() && a.getRawSize() == b.getRawSize() &&
+           (a.getRawCount() == 0 ||
+            std::memcmp(a.getRawData(), b.getRawData(), a.getRawCount() * a.getRawSize()) == 0);
+}
+
+} // namespace
+
+TEST(VectorTile, ParallelParsing) {
+    using namespace mbgl::style;
+    using namespace mbgl::style::expression::dsl;
+
+    VectorTileTest test;
+    const auto data = std::make_shared<std::string>(
+        util::read_file("test/fixtures/api/assets/streets/10-163-395.vector.pbf"));
+
+    // Several groups per source layer, one of them with two layers sharing a bucket
+    std::vector<Immutable<LayerProperties>> layers;
+    const auto addFill = [&](const std::string& id, const char* sourceLayer, const char* className) {
+        FillLayer layer(id, "source");
+        layer.setSourceLayer(sourceLayer);
+        layer.setFilter(Filter(eq(get("class"), literal(className))));
+        layers.push_back(makeMutable<FillLayerProperties>(staticImmutableCast<FillLayer::Impl>(layer.baseImpl)));
+    };
+    const auto addLine = [&](const std::string& id, const char* sourceLayer, const char* className) {
+        LineLayer layer(id, "source");
+        layer.setSourceLayer(sourceLayer);
+        layer.setFilter(Filter(eq(get("class"), literal(className))));
+        layers.push_back(makeMutable<LineLayerProperties>(staticImmutableCast<LineLayer::Impl>(layer.baseImpl)));
+    };
+    for (const auto* className : {"wood", "scrub", "grass"}) {
+        addFill(std::string("landcover-") + className, "landcover", className);
+    }
+    for (const auto* className : {"park", "residential", "industrial"}) {
+        addFill(std::string("landuse-") + className, "landuse", className);
+    }
+    addLine("road-street-casing", "road", "street");
+    for (const auto* className : {"motorway", "main", "street", "path"}) {
+        addLine(std::string("road-") + className, "road", className);
+    }
+    addLine("waterway-river", "waterway", "river");
+
+    const auto parse = [&](const TaggedScheduler& threadPool) {
+        TileParameters parameters{.pixelRatio = 1.0,
+                                  .debugOptions = MapDebugOptions(),
+                                  .transformState = test.transformState,
+                                  .fileSource = test.fileSource,
+                                  .mode = MapMode::Continuous,
+                                  .annotationManager = test.annotationManager.makeWeakPtr(),
+                                  .imageManager = test.imageManager,
+                                  .glyphManager = test.glyphManager,
+                                  .prefetchZoomDelta = 0,
+                                  .threadPool = threadPool,
+                                  .dynamicTextureAtlas = test.dynamicTextureAtlas,
+                                  .isUpdateSynchronous = true};
+        auto tile = std::make_unique<VectorMVTTile>(OverscaledTileID(10, 163, 395), "source", parameters, test.tileset);
+        tile->setLayers(layers);
+        tile->setData(data);
+        return tile;
+    };
+
+    TaggedScheduler serialPool{Scheduler::MakeBackground(1), test.uniqueID};
+    TaggedScheduler parallelPool{Scheduler::MakeBackground(4), test.uniqueID};
+    auto serial = parse(serialPool);
+    auto parallel = parse(parallelPool);
+
+    const auto serialIndex = serial->getFeatureIndex();
+    const auto parallelIndex = parallel->getFeatureIndex();
+    ASSERT_TRUE(serialIndex);
+    ASSERT_TRUE(parallelIndex);
+
+    // Layers drawn from each bucket, in style order
+    EXPECT_EQ(serialIndex->getBucketLayerIDs(), parallelIndex->getBucketLayerIDs());
+    EXPECT_EQ(serialIndex->getBucketLayerIDs().at("road-street-casing"),
+              (std::vector<std::string>{"road-street-casing", "road-street"}));
+
+    // The same geometries with the same sort indices, which decide the order of query results
+    const auto serialEntries = serialIndex->getEntries();
+    const auto parallelEntries = parallelIndex->getEntries();
+    ASSERT_FALSE(serialEntries.empty());
+    ASSERT_EQ(serialEntries.size(), parallelEntries.size());
+    for (std::size_t i = 0; i < serialEntries.size(); ++i) {
+        const auto& expected = serialEntries[i];
+        const auto& actual = parallelEntries[i];
+        ASSERT_EQ(expected.first.getIndex(), actual.first.getIndex()) << i;
+        ASSERT_EQ(expected.first.getSortIndex(), actual.first.getSortIndex()) << i;
+        ASSERT_EQ(expected.first.getSourceLayerName(), actual.first.getSourceLayerName()) << i;
+        ASSERT_EQ(expected.first.getBucketLeaderID(), actual.first.getBucketLeaderID()) << i;
+        ASSERT_TRUE(expected.second == actual.second) << i;
+    }
+
+    const auto serialData = serial->createRenderData();
+    const auto parallelData = parallel->createRenderData();
+    for (const auto& layer : layers) {
+        const auto& impl = *layer->baseImpl;
+        SCOPED_TRACE(impl.id);
+
+        Bucket* expected = serialData->getBucket(impl);
+        Bucket* actual = parallelData->getBucket(impl);
+        ASSERT_EQ(expected == nullptr, actual == nullptr);
+        if (!expected) {
+            continue;
+        }
+        EXPECT_EQ(expected->getByteSize(), actual->getByteSize());
+
+        if (std::strcmp(impl.getTypeInfo()->type, "fill") == 0) {
+            const auto& expectedFill = static_cast<const FillBucket&>(*expected);
+            const auto& actualFill = static_cast<const FillBucket&>(*actual);
+            EXPECT_TRUE(sameVertices(expectedFill.vertices, actualFill.vertices));
+            EXPECT_EQ(expectedFill.triangles.vector(), actualFill.triangles.vector());
+            EXPECT_EQ(expectedFill.basicLines.vector(), actualFill.basicLines.vector());
+        } else {
+            const auto& expectedLine = static_cast<const LineBucket&>(*expected);
+            const auto& actualLine = static_cast<const LineBucket&>(*actual);
+            EXPECT_TRUE(sameVertices(expectedLine.vertices, actualLine.vertices));
+            EXPECT_EQ(expectedLine.triangles.vector(), actualLine.triangles.vector());
+        }
+    }
+    EXPECT_EQ(serialData->getBucket(*layers[6]->baseImpl), serialData->getBucket(*layers[9]->baseImpl));
+    EXPECT_EQ(parallelData->getBucket(*layers[6]->baseImpl), parallelData->getBucket(*layers[9]->baseImpl));
+
+    serial.reset();
+    parallel.reset();
+    serialPool.runRenderJobs(true);
+    parallelPool.runRenderJobs(true);
+}
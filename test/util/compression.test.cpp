@@ -0,0 +1,123 @@
+#include <mbgl/test/util.hpp>
+
+#include <mbgl/util/compression.hpp>
+
+#include <random>
+#include <stdexcept>
+
+using namespace mbgl;
+using namespace mbgl::util;
+
+namespace {
+
+std::string sampleData(uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::string data;
+    while (data.size() < 4096) {
+        data += "{\"layer\":\"water\",\"class\":\"" + std::to_string(gen() % 16) + "\"}";
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(Compression, ZlibFormats) {
+    const auto data = sampleData(0);
+
+    const auto zlib = compress(data);
+    EXPECT_TRUE(is_compressed(zlib));
+    EXPECT_LT(zlib.size(), data.size());
+    EXPECT_EQ(data, decompress(zlib));
+
+    const auto gzip = compress(data, CompressionFormat::GZIP);
+    EXPECT_TRUE(is_compressed(gzip));
+    EXPECT_EQ(data, decompress(gzip));
+    EXPECT_EQ(data, decompress(gzip, CompressionFormat::GZIP));
+
+    const auto deflate = compress(data, CompressionFormat::DEFLATE);
+    EXPECT_EQ(data, decompress(deflate, CompressionFormat::DEFLATE));
+
+    EXPECT_EQ("", decompress(compress("")));
+    EXPECT_THROW(decompress("\x78\x9c garbage"), std::runtime_error);
+}
+
+TEST(Compression, GzipRecordedSize) {
+    // A tiny stream whose trailer claims 1 GiB fails its length check without allocating that much up front
+    auto forged = compress(std::string("x"), CompressionFormat::GZIP);
+    ASSERT_LT(forged.size(), 32u);
+    forged.replace(forged.size() - 4, 4, std::string("\x00\x00\x00\x40", 4));
+    EXPECT_THROW(decompress(forged), std::runtime_error);
+    EXPECT_THROW(decompress(forged, CompressionFormat::GZIP), std::runtime_error);
+
+    // Outputs beyond the size trusted up front still decompress
+    std::string data;
+    while (data.size() < 20 * 1024 * 1024) {
+        data += sampleData(static_cast<uint32_t>(data.size()));
+    }
+    EXPECT_EQ(data, decompress(compress(data, CompressionFormat::GZIP)));
+}
+
+TEST(Compression, Codecs) {
+    const auto data = sampleData(1);
+
+    EXPECT_TRUE(isAvailable(Codec::None));
+    EXPECT_TRUE(isAvailable(Codec::Zlib));
+
+    EXPECT_EQ(data, compress(data, Codec::None));
+    EXPECT_EQ(compress(data), compress(data, Codec::Zlib));
+    EXPECT_EQ(data, decompress(compress(data, Codec::Zlib), Codec::Zlib));
+
+    if (!isAvailable(Codec::Zstd)) {
+        EXPECT_THROW(compress(data, Codec::Zstd), std::runtime_error);
+        EXPECT_EQ(nullptr, CompressionDictionary::train({data}));
+        return;
+    }
+
+    const auto zstd = compress(data, Codec::Zstd);
+    EXPECT_LT(zstd.size(), data.size());
+    EXPECT_EQ(0u, getDictionaryID(zstd));
+    EXPECT_EQ(data, decompress(zstd, Codec::Zstd));
+}
+
+TEST(Compression, ZstdLargeFrame) {
+    if (!isAvailable(Codec::Zstd)) {
+        return;
+    }
+
+    // Bigger than the size decompression allocates up front on the header's word
+    std::string data;
+    while (data.size() < 20 * 1024 * 1024) {
+        data += sampleData(static_cast<uint32_t>(data.size()));
+    }
+    const auto zstd = compress(data, Codec::Zstd);
+    EXPECT_EQ(data, decompress(zstd, Codec::Zstd));
+
+    // A frame that ends early is an error, whichever way it is decompressed
+    EXPECT_THROW(decompress(zstd.substr(0, zstd.size() / 2), Codec::Zstd), std::runtime_error);
+    const auto small = compress(sampleData(3), Codec::Zstd);
+    EXPECT_THROW(decompress(small.substr(0, small.size() / 2), Codec::Zstd), std::runtime_error);
+}
+
+TEST(Compression, Dictionary) {
+    EXPECT_THROW(CompressionDictionary("not a dictionary"), std::runtime_error);
+
+    if (!isAvailable(Codec::Zstd)) {
+        return;
+    }
+
+    std::vector<std::string> samples;
+    for (uint32_t i = 0; i < 200; ++i) {
+        samples.push_back(sampleData(i).substr(0, 512));
+    }
+    const auto dictionary = CompressionDictionary::train(samples);
+    ASSERT_TRUE(dictionary);
+    EXPECT_NE(0u, dictionary->getID());
+    EXPECT_EQ(dictionary->getID(), CompressionDictionary(dictionary->getData()).getID());
+
+    const auto data = sampleData(1000).substr(0, 512);
+    const auto withDictionary = compress(data, Codec::Zstd, dictionary.get());
+    EXPECT_LT(withDictionary.size(), compress(data, Codec::Zstd).size());
+    EXPECT_EQ(dictionary->getID(), getDictionaryID(withDictionary));
+    EXPECT_EQ(data, decompress(withDictionary, Codec::Zstd, dictionary.get()));
+    EXPECT_THROW(decompress(withDictionary, Codec::Zstd), std::runtime_error);
+}
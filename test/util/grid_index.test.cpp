@@ -55,3 +55,24 @@ TEST(GridIndex, IndexesFeaturesOverflow) {
     grid.insert(0, {{4500, 4500}, {4900, 4900}});
     EXPECT_EQ(grid.query({{4000, 4000}, {5000, 5000}}), (std::vector<int16_t>{0}));
 }
+
+TEST(GridIndex, HitTestPredicate) {
+    GridIndex<int16_t> grid(100, 100, 10);
+    grid.insert(0, {{10, 10}, {30, 30}});
+    grid.insert(1, {{50, 50}, 10});
+
+    EXPECT_TRUE(grid.hitTest({{20, 20}, {25, 25}}, [](int16_t key) { return key == 0; }));
+    EXPECT_FALSE(grid.hitTest({{20, 20}, {25, 25}}, [](int16_t key) { return key == 1; }));
+    EXPECT_TRUE(grid.hitTest({{55, 55}, 2}, [](int16_t key) { return key == 1; }));
+    EXPECT_FALSE(grid.hitTest({{55, 55}, 2}, [](int16_t key) { return key == 0; }));
+}
+
+TEST(GridIndex, SpanningElementsReportedOnce) {
+    GridIndex<int16_t> grid(100, 100, 10);
+    grid.insert(0, {{5, 5}, {95, 95}});
+    grid.insert(1, {{50, 50}, 40});
+    grid.insert(2, {{35, 35}, {45, 45}});
+
+    EXPECT_EQ(grid.query({{20, 20}, {80, 80}}), (std::vector<int16_t>{0, 1, 2}));
+    EXPECT_EQ(grid.query({{60, 10}, {90, 40}}), (std::vector<int16_t>{0, 1}));
+}
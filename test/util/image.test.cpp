@@ -4,6 +4,8 @@
 #include <mbgl/util/image.hpp>
 #include <mbgl/util/io.hpp>
 
+#include <vector>
+
 using namespace mbgl;
 
 TEST(Image, PNGRoundTrip) {
@@ -34,6 +36,48 @@ TEST(Image, PNGRoundTripAlpha) {
     EXPECT_EQ(128, image.data[3]);
 }
 
+TEST(Image, PNGEncodeOptions) {
+    // Stripes of few colors, some translucent, large enough to be compressed in several parts
+    PremultipliedImage rgba({700, 300});
+    for (uint32_t i = 0; i < rgba.size.width * rgba.size.height; ++i) {
+        const uint8_t stripe = (i / 7 + i % 5) % 3;
+        rgba.data[i * 4 + 0] = stripe == 0 ? 128 : 0;
+        rgba.data[i * 4 + 1] = stripe == 1 ? 255 : 0;
+        rgba.data[i * 4 + 2] = 0;
+        rgba.data[i * 4 + 3] = stripe == 0 ? 128 : 255;
+    }
+    const auto expected = decodeImage(encodePNG(rgba));
+
+    using Filter = PNGEncodeOptions::Filter;
+    for (const auto filter : {Filter::None, Filter::Sub, Filter::Up, Filter::Average, Filter::Paeth, Filter::Adaptive}) {
+        for (const bool palette : {false, true}) {
+            PNGEncodeOptions options;
+            options.filter = filter;
+            options.palette = palette;
+            options.compressionLevel = 1;
+            options.threads = 4;
+            const auto png = encodePNG(rgba, options);
+            // Color type: three colors fit a palette of two bits per pixel
+            EXPECT_EQ(palette ? 3 : 6, png[25]);
+            EXPECT_EQ(palette ? 2 : 8, png[24]);
+            EXPECT_EQ(expected, decodeImage(png)) << "filter " << int(filter) << ", palette " << palette;
+        }
+    }
+
+    // Images with more than 256 colors are written as RGBA
+    PremultipliedImage gradient({300, 1});
+    for (uint32_t x = 0; x < 300; ++x) {
+        gradient.data[x * 4 + 0] = static_cast<uint8_t>(x);
+        gradient.data[x * 4 + 1] = static_cast<uint8_t>(x / 256);
+        gradient.data[x * 4 + 3] = 255;
+    }
+    PNGEncodeOptions options;
+    options.palette = true;
+    const auto png = encodePNG(gradient, options);
+    EXPECT_EQ(6, png[25]);
+    EXPECT_EQ(gradient, decodeImage(png));
+}
+
 TEST(Image, PNGReadNoProfile) {
     PremultipliedImage image = decodeImage(util::read_file("test/fixtures/image/no_profile.png"));
     EXPECT_EQ(128, image.data[0]);
@@ -163,3 +207,46 @@ TEST(Image, Premultiply) {
     EXPECT_EQ(0u, rgba.size.width);
     EXPECT_EQ(0u, rgba.size.height);
 }
+
+TEST(Image, PremultiplyKernels) {
+    // Every color with every alpha, including colors above their alpha that aren't valid premultiplied, and widths
+    // that leave pixels over after the vector loops
+    std::vector<UnassociatedImage> inputs;
+    for (const uint32_t width : {65536u, 1u, 3u, 7u, 9u, 17u, 33u}) {
+        UnassociatedImage image({width, 1});
+        for (uint32_t i = 0; i < width; ++i) {
+            const auto color = static_cast<uint8_t>(width == 65536 ? i : i * 37);
+            image.data[i * 4 + 0] = color;
+            image.data[i * 4 + 1] = 255 - color;
+            image.data[i * 4 + 2] = color ^ 0x55;
+            image.data[i * 4 + 3] = static_cast<uint8_t>(width == 65536 ? i >> 8 : i * 91);
+        }
+        inputs.push_back(std::move(image));
+    }
+
+    const auto original = util::getPixelKernels();
+    const auto run = [&](util::PixelKernels kernels) {
+        util::setPixelKernels(kernels);
+        std::vector<std::pair<PremultipliedImage, UnassociatedImage>> results;
+        for (const auto& input : inputs) {
+            auto premultiplied = util::premultiply(input.clone());
+            auto unpremultiplied = util::unpremultiply(input.clone<PremultipliedImage>());
+            results.emplace_back(std::move(premultiplied), std::move(unpremultiplied));
+        }
+        return results;
+    };
+
+    const auto expected = run(util::PixelKernels::Scalar);
+    for (const auto kernels : {util::PixelKernels::SSE2, util::PixelKernels::AVX2, util::PixelKernels::NEON}) {
+        if (!util::isSupported(kernels)) {
+            EXPECT_THROW(util::setPixelKernels(kernels), std::invalid_argument);
+            continue;
+        }
+        const auto actual = run(kernels);
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            EXPECT_EQ(expected[i].first, actual[i].first) << "premultiply, width " << inputs[i].size.width;
+            EXPECT_EQ(expected[i].second, actual[i].second) << "unpremultiply, width " << inputs[i].size.width;
+        }
+    }
+    util::setPixelKernels(original);
+}
@@ -0,0 +1,57 @@
+#include <mbgl/test/util.hpp>
+#include <mbgl/util/parallel_jobs.hpp>
+#include <mbgl/util/thread_pool.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace mbgl;
+
+TEST(ParallelJobs, RunsEachJobOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(4u, pool.getThreadCount());
+
+    std::vector<std::atomic<int>> runs(1000);
+    ParallelJobs::run(runs.size(), [&](std::size_t i) { runs[i]++; }, pool);
+
+    for (const auto& count : runs) {
+        EXPECT_EQ(1, count.load());
+    }
+}
+
+TEST(ParallelJobs, NoJobs) {
+    ThreadPool pool(2);
+    ParallelJobs::run(0, [](std::size_t) { FAIL(); }, pool);
+}
+
+TEST(ParallelJobs, RethrowsAfterAllJobsFinished) {
+    ThreadPool pool(4);
+
+    std::atomic<std::size_t> finished{0};
+    EXPECT_THROW(ParallelJobs::run(
+                     64,
+                     [&](std::size_t i) {
+                         if (i == 3) {
+                             throw std::runtime_error("job failed");
+                         }
+                         finished++;
+                     },
+                     pool),
+                 std::runtime_error);
+    // The other jobs still ran, and none of them is still running
+    EXPECT_EQ(63u, finished.load());
+}
+
+TEST(ParallelJobs, DestructorWaits) {
+    ThreadPool pool(4);
+
+    std::vector<int> results(256, 0);
+    {
+        ParallelJobs jobs(results.size(), [&](std::size_t i) { results[i] = static_cast<int>(i); }, pool);
+        // Leaving without wait(), e.g. because of an exception, must not leave jobs touching `results`
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(static_cast<int>(i), results[i]);
+    }
+}
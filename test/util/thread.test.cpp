@@ -5,10 +5,13 @@
 #include <mbgl/platform/settings.hpp>
 #include <mbgl/test/util.hpp>
 #include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/thread_pool.hpp>
 #include <mbgl/util/timer.hpp>
 
+#include <array>
 #include <atomic>
 #include <memory>
+#include <set>
 
 using namespace mbgl;
 using namespace mbgl::util;
@@ -477,3 +480,171 @@ TEST(Thread, TaggedPools) {
     // Same for queue 2
     ASSERT_TRUE(totalRuns2 == runCount2);
 }
+
+TEST(Thread, WorkStealingRunsAllTasks) {
+    WorkStealingScheduler pool(3);
+    Scheduler& scheduler = pool;
+
+    constexpr int taskCount = 10000;
+    std::array<util::SimpleIdentity, 4> tags;
+    std::atomic<int> executed{0};
+    for (int i = 0; i < taskCount; ++i) {
+        scheduler.schedule(tags[i % tags.size()], [&] { executed++; });
+    }
+
+    for (const auto& tag : tags) {
+        scheduler.waitForEmpty(tag);
+    }
+    EXPECT_EQ(taskCount, executed);
+}
+
+TEST(Thread, WorkStealingTagOrder) {
+    // With a single worker, tasks sharing a tag must run in submission order
+    WorkStealingScheduler pool(0);
+    Scheduler& scheduler = pool;
+    const util::SimpleIdentity tag;
+
+    std::vector<int> order;
+    constexpr int taskCount = 5000;
+    for (int i = 0; i < taskCount; ++i) {
+        scheduler.schedule(tag, [&, i] { order.push_back(i); });
+    }
+    scheduler.waitForEmpty(tag);
+
+    ASSERT_EQ(static_cast<std::size_t>(taskCount), order.size());
+    for (int i = 0; i < taskCount; ++i) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(Thread, WorkStealingRecursiveAddAndException) {
+    WorkStealingScheduler pool(3);
+    Scheduler& scheduler = pool;
+
+    std::atomic<int> caught{0};
+    scheduler.setExceptionHandler([&](const auto) { caught++; });
+
+    std::atomic<int> executed{0};
+    for (int i = 0; i < 100; ++i) {
+        scheduler.schedule([&] {
+            // Tasks scheduled from a worker go to its own run queue and can be stolen
+            scheduler.schedule([&] { executed++; });
+            throw std::runtime_error("test");
+        });
+    }
+
+    // The nested tasks share the scheduler's own tag, so this covers them too
+    scheduler.waitForEmpty();
+    EXPECT_EQ(100, caught);
+    EXPECT_EQ(100, executed);
+}
+
+TEST(Thread, PoolSizeSetting) {
+    auto& settings = platform::Settings::getInstance();
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_SIZE, uint64_t{3});
+    EXPECT_EQ(3u, ThreadPool::defaultThreadCount());
+
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_SIZE, mapbox::base::NullValue());
+    EXPECT_LE(1u, ThreadPool::defaultThreadCount());
+}
+
+TEST(Thread, PoolWorkStealingSetting) {
+    auto& settings = platform::Settings::getInstance();
+    EXPECT_TRUE(ThreadPool::defaultWorkStealing());
+
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_WORK_STEALING, false);
+    EXPECT_FALSE(ThreadPool::defaultWorkStealing());
+
+    // Both loops run everything scheduled on a pool
+    for (const bool workStealing : {false, true}) {
+        ThreadPool pool(3, workStealing);
+        Scheduler& scheduler = pool;
+        std::atomic<int> executed{0};
+        for (int i = 0; i < 1000; ++i) {
+            scheduler.schedule([&] { executed++; });
+        }
+        scheduler.waitForEmpty();
+        EXPECT_EQ(1000, executed) << "work stealing " << workStealing;
+    }
+
+    settings.set(platform::EXPERIMENTAL_THREAD_POOL_WORK_STEALING, mapbox::base::NullValue());
+    EXPECT_TRUE(ThreadPool::defaultWorkStealing());
+}
+
+TEST(Thread, IsolatedPool) {
+    auto isolated = Scheduler::MakeBackground(2);
+    ASSERT_TRUE(isolated);
+    EXPECT_NE(isolated, Scheduler::GetBackground());
+
+    std::atomic<int> executed{0};
+    for (int i = 0; i < 100; ++i) {
+        isolated->schedule([&] { executed++; });
+    }
+    isolated->waitForEmpty();
+    EXPECT_EQ(100, executed);
+}
+
+TEST(Thread, TaskPriority) {
+    SequencedScheduler sequenced;
+    Scheduler& scheduler = sequenced;
+    const util::SimpleIdentity tag;
+
+    // Hold the only worker so that everything below is queued before anything runs
+    std::promise<void> started;
+    std::promise<void> release;
+    scheduler.schedule(tag, [&, wait = release.get_future().share()] {
+        started.set_value();
+        wait.wait();
+    });
+    started.get_future().wait();
+
+    std::vector<std::string> order;
+    scheduler.schedule(tag, TaskPriority::Low, [&] { order.emplace_back("low"); });
+    scheduler.schedule(tag, TaskPriority::Normal, [&] { order.emplace_back("normal 1"); });
+    scheduler.schedule(tag, TaskPriority::High, [&] { order.emplace_back("high"); });
+    scheduler.schedule(tag, TaskPriority::Normal, [&] { order.emplace_back("normal 2"); });
+
+    release.set_value();
+    scheduler.waitForEmpty(tag);
+
+    EXPECT_EQ((std::vector<std::string>{"high", "normal 1", "normal 2", "low"}), order);
+}
+
+TEST(Thread, TaskPriorityAcrossTags) {
+    // Higher priority tasks start first even when other tags have older, less urgent ones waiting
+    for (const bool workStealing : {false, true}) {
+        ThreadPool pool(1, workStealing);
+        Scheduler& scheduler = pool;
+        const util::SimpleIdentity blocked;
+        const std::array<util::SimpleIdentity, 2> tags{};
+
+        std::promise<void> started;
+        std::promise<void> release;
+        scheduler.schedule(blocked, [&, wait = release.get_future().share()] {
+            started.set_value();
+            wait.wait();
+        });
+        started.get_future().wait();
+
+        std::vector<std::string> order;
+        scheduler.schedule(tags[0], TaskPriority::Low, [&] { order.emplace_back("low 0"); });
+        scheduler.schedule(tags[1], TaskPriority::Low, [&] { order.emplace_back("low 1"); });
+        scheduler.schedule(tags[0], TaskPriority::Normal, [&] { order.emplace_back("normal 0"); });
+        scheduler.schedule(tags[1], TaskPriority::High, [&] { order.emplace_back("high 1"); });
+        scheduler.schedule(tags[0], TaskPriority::High, [&] { order.emplace_back("high 0"); });
+
+        release.set_value();
+        scheduler.waitForEmpty(blocked);
+        for (const auto& tag : tags) {
+            scheduler.waitForEmpty(tag);
+        }
+
+        // Tags take turns within a priority, starting with either
+        ASSERT_EQ(5u, order.size()) << "work stealing " << workStealing;
+        EXPECT_EQ((std::set<std::string>{"high 0", "high 1"}), std::set<std::string>(order.begin(), order.begin() + 2))
+            << "work stealing " << workStealing;
+        EXPECT_EQ("normal 0", order[2]) << "work stealing " << workStealing;
+        EXPECT_EQ((std::set<std::string>{"low 0", "low 1"}), std::set<std::string>(order.begin() + 3, order.end()))
+            << "work stealing " << workStealing;
+    }
+}